@@ -0,0 +1,247 @@
+
+#
+# This source file is part of appleseed.
+# Visit https://appleseedhq.net/ for additional information and resources.
+#
+# This software is released under the MIT license.
+#
+# Copyright (c) 2020 The appleseedhq Organization
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+
+from __future__ import print_function
+
+import os
+
+# Generates a many-lights benchmark scene: a grid of LED walls made of small
+# emitting quads, lighting a plane from above. The LED wall mesh is written
+# once and instanced, so the light tree sees
+#   WallCount^2 * LedCount^2 * 2
+# emitting triangles.
+#
+# The generated project and mesh are not checked in: the project is written
+# next to the other test scenes of this directory, so its reference image must
+# be rendered (see scripts/updatetestsuiterefimages.py) before it can be added
+# to the test suite.
+
+WallCount = 8
+LedCount = 32
+LedSize = 0.2
+LedSpacing = 0.3
+PlaneSize = 100
+
+TriangleCount = WallCount * WallCount * LedCount * LedCount * 2
+output_scene_name = "04 - {0} emitting triangles".format(TriangleCount)
+wall_filename = "led_wall.obj"
+
+
+ProjectTemplate = """<?xml version="1.0" encoding="UTF-8"?>
+<!-- File generated by led_walls_emt.py. -->
+<project format_revision="34">
+    <search_paths>
+        <search_path>
+            data
+        </search_path>
+    </search_paths>
+    <scene>
+        <camera name="camera" model="orthographic_camera">
+            <parameter name="controller_target" value="0 0 0" />
+            <parameter name="film_dimensions" value="128 128" />
+            <parameter name="near_z" value="-0.1" />
+            <parameter name="shutter_close_begin_time" value="1.0" />
+            <parameter name="shutter_close_end_time" value="1.0" />
+            <parameter name="shutter_open_begin_time" value="0.0" />
+            <parameter name="shutter_open_end_time" value="0.0" />
+            <transform time="0">
+                <matrix>
+                    1.0 0.0 0.0 0.0
+                    0.0 0.0 1.0 0.0
+                    0.0 -1.0 0.0 0.0
+                    0.0 0.0 0.0 1.0
+                </matrix>
+            </transform>
+        </camera>
+        <environment name="env" model="generic_environment" />
+        <assembly name="assembly">
+            <color name="light_color">
+                <parameter name="color_space" value="linear_rgb" />
+                <parameter name="multiplier" value="1" />
+                <parameter name="wavelength_range" value="400.0 700.0" />
+                <values>
+                    1.000000000 0.830633998 0.378439993
+                </values>
+                <alpha>
+                    1.000000000
+                </alpha>
+            </color>
+            <bsdf name="bsdf1" model="lambertian_brdf">
+                <parameter name="reflectance" value="1.0" />
+                <parameter name="reflectance_multiplier" value="1.0" />
+            </bsdf>
+            <edf name="light_material_edf" model="diffuse_edf">
+                <parameter name="cast_indirect_light" value="true" />
+                <parameter name="importance_multiplier" value="1.0" />
+                <parameter name="light_near_start" value="0.0" />
+                <parameter name="radiance" value="light_color" />
+                <parameter name="radiance_multiplier" value="9" />
+            </edf>
+            <material name="01 - Default_mat" model="generic_material">
+                <parameter name="bsdf" value="bsdf1" />
+                <parameter name="bump_amplitude" value="1.0" />
+                <parameter name="bump_offset" value="0.5" />
+                <parameter name="default_tangent_mode" value="uv" />
+                <parameter name="displacement_method" value="bump" />
+                <parameter name="normal_map_up" value="z" />
+            </material>
+            <material name="light_material" model="generic_material">
+                <parameter name="bump_amplitude" value="1.0" />
+                <parameter name="displacement_method" value="bump" />
+                <parameter name="edf" value="light_material_edf" />
+                <parameter name="normal_map_up" value="z" />
+            </material>
+            <object name="plane" model="mesh_object">
+                <parameter name="filename" value="Plane001.binarymesh" />
+            </object>
+            <object name="led_wall" model="mesh_object">
+                <parameter name="filename" value="{wall_filename}" />
+            </object>
+            <object_instance name="plane.Plane001_inst" object="plane.Plane001">
+                <transform>
+                    <matrix>
+                        1.0 0.0 0.0 0.0
+                        0.0 0.0 1.0 0.0
+                        0.0 -1.0 0.0 0.0
+                        0.0 0.0 0.0 1.0
+                    </matrix>
+                </transform>
+                <assign_material slot="material_slot_0" side="front" material="01 - Default_mat" />
+                <assign_material slot="material_slot_0" side="back" material="01 - Default_mat" />
+            </object_instance>
+{instances}        </assembly>
+        <assembly_instance name="assembly_inst" assembly="assembly">
+        </assembly_instance>
+    </scene>
+    <output>
+        <frame name="beauty">
+            <parameter name="camera" value="camera" />
+            <parameter name="filter" value="box" />
+            <parameter name="filter_size" value="0.5" />
+            <parameter name="resolution" value="512 512" />
+            <parameter name="tile_size" value="64 64" />
+        </frame>
+    </output>
+    <configurations>
+        <configuration name="final" base="base_final">
+            <parameters name="light_sampler">
+                <parameter name="algorithm" value="lighttree" />
+                <parameter name="light_tree_split_threshold" value="0.8" />
+            </parameters>
+            <parameters name="pt">
+                <parameter name="max_bounces" value="-1" />
+                <parameter name="max_diffuse_bounces" value="-1" />
+                <parameter name="max_glossy_bounces" value="-1" />
+                <parameter name="max_specular_bounces" value="-1" />
+            </parameters>
+            <parameters name="uniform_pixel_renderer">
+                <parameter name="samples" value="1" />
+            </parameters>
+        </configuration>
+        <configuration name="interactive" base="base_interactive">
+            <parameters name="light_sampler">
+                <parameter name="algorithm" value="lighttree" />
+                <parameter name="light_tree_split_threshold" value="0.8" />
+            </parameters>
+            <parameters name="pt">
+                <parameter name="max_bounces" value="-1" />
+                <parameter name="max_diffuse_bounces" value="-1" />
+                <parameter name="max_glossy_bounces" value="-1" />
+                <parameter name="max_specular_bounces" value="-1" />
+            </parameters>
+        </configuration>
+    </configurations>
+</project>
+"""
+
+
+def write_led_wall(path):
+    half_extent = (LedCount - 1) * LedSpacing / 2
+    half_size = LedSize / 2
+
+    with open(path, "w") as f:
+        f.write("# {0}x{0} LED wall generated by led_walls_emt.py.\n".format(LedCount))
+
+        for j in range(LedCount):
+            for i in range(LedCount):
+                x = i * LedSpacing - half_extent
+                y = j * LedSpacing - half_extent
+                f.write("v {0:.4f} {1:.4f} 0\n".format(x - half_size, y - half_size))
+                f.write("v {0:.4f} {1:.4f} 0\n".format(x + half_size, y - half_size))
+                f.write("v {0:.4f} {1:.4f} 0\n".format(x - half_size, y + half_size))
+                f.write("v {0:.4f} {1:.4f} 0\n".format(x + half_size, y + half_size))
+
+        f.write("vn 0 0 1\n")
+        f.write("o part_0\n")
+
+        for k in range(LedCount * LedCount):
+            base = 4 * k + 1
+            f.write("f {0}//1 {1}//1 {2}//1 {3}//1\n".format(base, base + 1, base + 3, base + 2))
+
+
+def wall_instance(index, x, z):
+    return """            <object_instance name="led_wall.part_0_inst_{0}" object="led_wall.part_0">
+                <parameters name="visibility">
+                    <parameter name="camera" value="false" />
+                </parameters>
+                <transform>
+                    <matrix>
+                        1.0 0.0 0.0 {1}
+                        0.0 0.0 1.0 1.0
+                        0.0 -1.0 0.0 {2}
+                        0.0 0.0 0.0 1.0
+                    </matrix>
+                </transform>
+                <assign_material slot="material_slot_0" side="front" material="01 - Default_mat" />
+                <assign_material slot="material_slot_0" side="back" material="light_material" />
+            </object_instance>
+""".format(index, x, z)
+
+
+def write_project(path):
+    step = float(PlaneSize) / WallCount
+    positions = [(i + 0.5) * step - PlaneSize / 2.0 for i in range(WallCount)]
+
+    instances = ""
+    index = 0
+    for z in positions:
+        for x in positions:
+            instances += wall_instance(index, x, z)
+            index += 1
+
+    with open(path, "w") as f:
+        f.write(ProjectTemplate.replace("{wall_filename}", wall_filename).replace("{instances}", instances))
+
+
+def main():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    write_led_wall(os.path.join(root, "data", wall_filename))
+    write_project(os.path.join(root, output_scene_name + ".appleseed"))
+
+if __name__ == "__main__":
+    main()
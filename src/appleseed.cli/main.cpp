@@ -490,11 +490,20 @@ namespace
             / "schemas"
             / "project.xsd";
 
+        // Read mesh files on as many threads as will be used for rendering.
+        ParamArray thread_params;
+        if (g_cl.m_threads.is_set())
+            thread_params.insert("rendering_threads", g_cl.m_threads.value());
+
         // Load the project from disk.
         return
             ProjectFileReader::read(
                 project_filepath.c_str(),
-                schema_filepath.string().c_str());
+                schema_filepath.string().c_str(),
+                ProjectFileReader::ReadMeshFilesAsynchronously |
+                ProjectFileReader::DeferMeshGeometryLoading |
+                ProjectFileReader::DeduplicateMeshObjects,
+                get_rendering_thread_count(thread_params));
     }
 
     bool configure_project(Project& project, ParamArray& params)
@@ -571,6 +580,13 @@ namespace
         SearchPaths resource_search_paths;
         Application::initialize_resource_search_paths(resource_search_paths);
 
+        // Stream recorded light paths to disk while rendering instead of keeping them in memory.
+        if (g_cl.m_save_light_paths.is_set())
+        {
+            const std::string spill_file_path = g_cl.m_save_light_paths.value() + ".tmp";
+            project->get_light_path_recorder().enable_streaming(spill_file_path.c_str());
+        }
+
         // Create the master renderer.
         DefaultRendererController renderer_controller;
         MasterRenderer renderer(
@@ -157,7 +157,7 @@ QString get_project_files_filter(const int filters)
     QStringList filter_list;
 
     if (filters & ProjectFilesFilterAllProjects)
-        filter_list << "Project Files (*.appleseed *.appleseedz)";
+        filter_list << "Project Files (*.appleseed *.appleseedz *.appleseedb)";
 
     if (filters & ProjectFilesFilterPlainProjects)
         filter_list << "Plain Project Files (*.appleseed)";
@@ -165,6 +165,9 @@ QString get_project_files_filter(const int filters)
     if (filters & ProjectFilesFilterPackedProjects)
         filter_list << "Packed Project Files (*.appleseedz)";
 
+    if (filters & ProjectFilesFilterBinaryProjects)
+        filter_list << "Binary Project Files (*.appleseedb)";
+
     filter_list << "All Files (*.*)";
 
     return filter_list.join(";;");
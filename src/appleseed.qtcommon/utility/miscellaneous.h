@@ -59,10 +59,12 @@ enum ProjectFilesFilter
     ProjectFilesFilterAllProjects       = 1UL << 0,     // all project files extensions
     ProjectFilesFilterPlainProjects     = 1UL << 1,     // .appleseed extension
     ProjectFilesFilterPackedProjects    = 1UL << 2,     // .appleseedz extension
+    ProjectFilesFilterBinaryProjects    = 1UL << 3,     // .appleseedb extension
     ProjectFilesFilterDefault           =
           ProjectFilesFilterAllProjects
         | ProjectFilesFilterPlainProjects
         | ProjectFilesFilterPackedProjects
+        | ProjectFilesFilterBinaryProjects
 };
 
 // Return a file dialog filter string for appleseed projects.
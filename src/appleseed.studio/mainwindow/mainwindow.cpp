@@ -98,6 +98,7 @@
 #include <QVariant>
 
 // Boost headers.
+#include "boost/filesystem/operations.hpp"
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
@@ -1254,6 +1255,16 @@ void MainWindow::start_rendering(const RenderingMode rendering_mode)
         rendering_mode == RenderingMode::InteractiveRendering ? "interactive" : "final";
     const ParamArray params = get_project_params(configuration_name);
 
+    // Stream recorded light paths to a temporary file while rendering instead of keeping them in memory.
+    LightPathRecorder& light_path_recorder = project->get_light_path_recorder();
+    if (params.get_path_optional<bool>("pt.record_light_paths", false) &&
+        !light_path_recorder.is_streaming())
+    {
+        const bf::path spill_file_path =
+            bf::temp_directory_path() / bf::unique_path("appleseed-light-paths-%%%%-%%%%-%%%%-%%%%.tmp");
+        light_path_recorder.enable_streaming(spill_file_path.string().c_str());
+    }
+
     // Effectively start rendering.
     m_rendering_manager.start_rendering(
         project,
@@ -31,27 +31,138 @@
 #include "dictionary.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/utility/foreach.h"
 
 // Standard headers.
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace foundation
 {
 
-typedef std::map<InternedString, std::string> StringMap;
 typedef std::map<InternedString, Dictionary> DictionaryMap;
 
 
+//
+// StringDictionary::Item class implementation.
+//
+
+struct StringDictionary::Item
+  : public NonCopyable
+{
+    const InternedString                m_key;
+    std::string                         m_value;
+    mutable std::atomic<ParsedValue*>   m_parsed_value;
+
+    Item(const InternedString& key, const char* value)
+      : m_key(key)
+      , m_value(value)
+      , m_parsed_value(nullptr)
+    {
+    }
+
+    ~Item()
+    {
+        delete m_parsed_value.load();
+    }
+
+    void set_value(const char* value)
+    {
+        m_value = value;
+        delete m_parsed_value.exchange(nullptr);
+    }
+};
+
+
+//
+// StringDictionary::Impl class implementation.
+//
+
+struct StringDictionary::Impl
+{
+    // Items are individually allocated so that pointers to their values remain valid
+    // when other items are inserted or removed, as they would in a node-based map.
+    typedef std::vector<std::unique_ptr<Item>> ItemVector;
+
+    // Items sorted by key, in the same order as they would be in a map.
+    ItemVector m_items;
+
+    Impl() = default;
+
+    Impl(const Impl& rhs)
+    {
+        copy_items(rhs);
+    }
+
+    Impl& operator=(const Impl& rhs)
+    {
+        if (this != &rhs)
+        {
+            m_items.clear();
+            copy_items(rhs);
+        }
+
+        return *this;
+    }
+
+    // Parsed values are not copied.
+    void copy_items(const Impl& rhs)
+    {
+        m_items.reserve(rhs.m_items.size());
+
+        for (const std::unique_ptr<Item>& item : rhs.m_items)
+            m_items.emplace_back(new Item(item->m_key, item->m_value.c_str()));
+    }
+
+    ItemVector::iterator lower_bound(const InternedString& key)
+    {
+        return
+            std::lower_bound(
+                m_items.begin(),
+                m_items.end(),
+                key,
+                [](const std::unique_ptr<Item>& item, const InternedString& key)
+                {
+                    return item->m_key < key;
+                });
+    }
+
+    ItemVector::iterator find(const InternedString& key)
+    {
+        // Most dictionaries only hold a handful of items. Searching them linearly
+        // only involves pointer comparisons since keys are interned strings.
+        const size_t LinearSearchMaxItemCount = 16;
+
+        if (m_items.size() <= LinearSearchMaxItemCount)
+        {
+            for (ItemVector::iterator i = m_items.begin(), e = m_items.end(); i != e; ++i)
+            {
+                if ((*i)->m_key == key)
+                    return i;
+            }
+
+            return m_items.end();
+        }
+
+        const ItemVector::iterator i = lower_bound(key);
+        return i != m_items.end() && (*i)->m_key == key ? i : m_items.end();
+    }
+};
+
+
 //
 // StringDictionary::const_iterator class implementation.
 //
 
 struct StringDictionary::const_iterator::Impl
 {
-    StringMap::const_iterator m_it;
+    StringDictionary::Impl::ItemVector::const_iterator m_it;
 };
 
 StringDictionary::const_iterator::const_iterator()
@@ -104,12 +215,12 @@ const StringDictionary::const_iterator::value_type& StringDictionary::const_iter
 
 const char* StringDictionary::const_iterator::key() const
 {
-    return impl->m_it->first.c_str();
+    return (*impl->m_it)->m_key.c_str();
 }
 
 const char* StringDictionary::const_iterator::value() const
 {
-    return impl->m_it->second.c_str();
+    return (*impl->m_it)->m_value.c_str();
 }
 
 
@@ -117,11 +228,6 @@ const char* StringDictionary::const_iterator::value() const
 // StringDictionary class implementation.
 //
 
-struct StringDictionary::Impl
-{
-    StringMap m_strings;
-};
-
 StringDictionary::StringDictionary()
   : impl(new Impl())
 {
@@ -149,11 +255,11 @@ bool StringDictionary::operator==(const StringDictionary& rhs) const
         return false;
 
     for (
-        StringMap::const_iterator it = impl->m_strings.begin(), rhs_it = rhs.impl->m_strings.begin();
-        it != impl->m_strings.end();
+        Impl::ItemVector::const_iterator it = impl->m_items.begin(), rhs_it = rhs.impl->m_items.begin();
+        it != impl->m_items.end();
         ++it, ++rhs_it)
     {
-        if (it->first != rhs_it->first || it->second != rhs_it->second)
+        if ((*it)->m_key != (*rhs_it)->m_key || (*it)->m_value != (*rhs_it)->m_value)
             return false;
     }
 
@@ -167,17 +273,17 @@ bool StringDictionary::operator!=(const StringDictionary& rhs) const
 
 size_t StringDictionary::size() const
 {
-    return impl->m_strings.size();
+    return impl->m_items.size();
 }
 
 bool StringDictionary::empty() const
 {
-    return impl->m_strings.empty();
+    return impl->m_items.empty();
 }
 
 void StringDictionary::clear()
 {
-    impl->m_strings.clear();
+    impl->m_items.clear();
 }
 
 StringDictionary& StringDictionary::insert(const char* key, const char* value)
@@ -185,7 +291,12 @@ StringDictionary& StringDictionary::insert(const char* key, const char* value)
     assert(key);
     assert(value);
 
-    impl->m_strings[InternedString(key)] = value;
+    const InternedString interned_key(key);
+    const Impl::ItemVector::iterator i = impl->lower_bound(interned_key);
+
+    if (i != impl->m_items.end() && (*i)->m_key == interned_key)
+        (*i)->set_value(value);
+    else impl->m_items.emplace(i, new Item(interned_key, value));
 
     return *this;
 }
@@ -195,12 +306,12 @@ StringDictionary& StringDictionary::set(const char* key, const char* value)
     assert(key);
     assert(value);
 
-    const StringMap::iterator i = impl->m_strings.find(InternedString(key));
+    const Impl::ItemVector::iterator i = impl->find(InternedString(key));
 
-    if (i == impl->m_strings.end())
+    if (i == impl->m_items.end())
         throw ExceptionDictionaryKeyNotFound(key);
 
-    i->second = value;
+    (*i)->set_value(value);
 
     return *this;
 }
@@ -209,29 +320,34 @@ const char* StringDictionary::get(const char* key) const
 {
     assert(key);
 
-    const StringMap::const_iterator i = impl->m_strings.find(InternedString(key));
-
-    if (i == impl->m_strings.end())
-        throw ExceptionDictionaryKeyNotFound(key);
+    return get(InternedString(key));
+}
 
-    return i->second.c_str();
+const char* StringDictionary::get(const InternedString& key) const
+{
+    return get_item(key).m_value.c_str();
 }
 
 bool StringDictionary::exist(const char* key) const
 {
     assert(key);
 
-    return impl->m_strings.find(InternedString(key)) != impl->m_strings.end();
+    return exist(InternedString(key));
+}
+
+bool StringDictionary::exist(const InternedString& key) const
+{
+    return impl->find(key) != impl->m_items.end();
 }
 
 StringDictionary& StringDictionary::remove(const char* key)
 {
     assert(key);
 
-    const StringMap::iterator i = impl->m_strings.find(InternedString(key));
+    const Impl::ItemVector::iterator i = impl->find(InternedString(key));
 
-    if (i != impl->m_strings.end())
-        impl->m_strings.erase(i);
+    if (i != impl->m_items.end())
+        impl->m_items.erase(i);
 
     return *this;
 }
@@ -239,17 +355,45 @@ StringDictionary& StringDictionary::remove(const char* key)
 StringDictionary::const_iterator StringDictionary::begin() const
 {
     const_iterator it;
-    it.impl->m_it = impl->m_strings.begin();
+    it.impl->m_it = impl->m_items.begin();
     return it;
 }
 
 StringDictionary::const_iterator StringDictionary::end() const
 {
     const_iterator it;
-    it.impl->m_it = impl->m_strings.end();
+    it.impl->m_it = impl->m_items.end();
     return it;
 }
 
+const StringDictionary::Item& StringDictionary::get_item(const InternedString& key) const
+{
+    const Impl::ItemVector::const_iterator i = impl->find(key);
+
+    if (i == impl->m_items.end())
+        throw ExceptionDictionaryKeyNotFound(key.c_str());
+
+    return **i;
+}
+
+const char* StringDictionary::get_value(const Item& item)
+{
+    return item.m_value.c_str();
+}
+
+const StringDictionary::ParsedValue* StringDictionary::get_parsed_value(const Item& item)
+{
+    return item.m_parsed_value.load(std::memory_order_acquire);
+}
+
+void StringDictionary::set_parsed_value(const Item& item, ParsedValue* parsed_value)
+{
+    ParsedValue* expected = nullptr;
+
+    if (!item.m_parsed_value.compare_exchange_strong(expected, parsed_value, std::memory_order_acq_rel))
+        delete parsed_value;
+}
+
 
 //
 // DictionaryDictionary::iterator class implementation.
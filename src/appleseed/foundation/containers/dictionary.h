@@ -143,12 +143,17 @@ class APPLESEED_DLLSYMBOL StringDictionary
     template <typename T> StringDictionary& set(const char* key, const T& value);
 
     // Retrieve an item from the dictionary.
+    // The typed variants parse the value of an item the first time it is retrieved as a given
+    // type and return the parsed value from then on, until the value of the item is modified.
     // Throws a ExceptionDictionaryKeyNotFound exception if the item could not be found.
     const char* get(const char* key) const;
+    const char* get(const InternedString& key) const;
     template <typename T> T get(const char* key) const;
+    template <typename T> T get(const InternedString& key) const;
 
     // Return true if an item with a given key exists in the dictionary.
     bool exist(const char* key) const;
+    bool exist(const InternedString& key) const;
 
     // Remove an item from the dictionary, if it exists.
     // Returns the dictionary itself to allow chaining of operations.
@@ -159,8 +164,36 @@ class APPLESEED_DLLSYMBOL StringDictionary
     const_iterator end() const;
 
   private:
+    struct Item;
     struct Impl;
     Impl* impl;
+
+    // Value of an item, parsed from its string representation.
+    struct ParsedValue
+    {
+        virtual ~ParsedValue() {}
+    };
+
+    template <typename T>
+    struct TypedParsedValue
+      : public ParsedValue
+    {
+        const T m_value;
+
+        explicit TypedParsedValue(const T& value)
+          : m_value(value)
+        {
+        }
+    };
+
+    const Item& get_item(const InternedString& key) const;
+
+    static const char* get_value(const Item& item);
+
+    // Parsed values may be retrieved and set concurrently from multiple threads.
+    // Only the first parsed value set on an item is kept.
+    static const ParsedValue* get_parsed_value(const Item& item);
+    static void set_parsed_value(const Item& item, ParsedValue* parsed_value);
 };
 
 
@@ -403,7 +436,32 @@ inline StringDictionary& StringDictionary::set(const char* key, const T& value)
 template <typename T>
 inline T StringDictionary::get(const char* key) const
 {
-    return from_string<T>(get(key));
+    return get<T>(InternedString(key));
+}
+
+template <typename T>
+inline T StringDictionary::get(const InternedString& key) const
+{
+    const Item& item = get_item(key);
+
+    const ParsedValue* parsed_value = get_parsed_value(item);
+
+    if (parsed_value != nullptr)
+    {
+        // This item may have been parsed as a different type.
+        const TypedParsedValue<T>* typed_parsed_value =
+            dynamic_cast<const TypedParsedValue<T>*>(parsed_value);
+
+        if (typed_parsed_value != nullptr)
+            return typed_parsed_value->m_value;
+
+        return from_string<T>(get_value(item));
+    }
+
+    const T value = from_string<T>(get_value(item));
+    set_parsed_value(item, new TypedParsedValue<T>(value));
+
+    return value;
 }
 
 
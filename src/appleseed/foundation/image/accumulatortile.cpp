@@ -95,4 +95,20 @@ void AccumulatorTile::atomic_add(
         foundation::atomic_add(ptr++, values[i]);
 }
 
+void AccumulatorTile::atomic_add(
+    const Vector2u&         pi,
+    const float*            values,
+    const float             weight)
+{
+    // Ignore samples outside the crop window.
+    if (!m_crop_window.contains(pi))
+        return;
+
+    float* APPLESEED_RESTRICT ptr = reinterpret_cast<float*>(pixel(pi.x, pi.y));
+    foundation::atomic_add(ptr++, weight);
+
+    for (size_t i = 0, e = m_channel_count - 1; i < e; ++i)
+        foundation::atomic_add(ptr++, values[i]);
+}
+
 }   // namespace foundation
@@ -124,6 +124,12 @@ class AccumulatorTile
         const Vector2u&     pi,
         const float*        values);
 
+    // Thread-safe variant of add() for values accumulated over a given number of samples.
+    void atomic_add(
+        const Vector2u&     pi,
+        const float*        values,
+        const float         weight);
+
   protected:
     const AABB2u m_crop_window;
 };
@@ -0,0 +1,72 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+namespace foundation
+{
+
+//
+// 2D density estimation kernels, as functions of the squared distance to the
+// center of the kernel divided by the squared radius of the kernel.
+//
+// References:
+//
+//   http://en.wikipedia.org/wiki/Kernel_(statistics)
+//
+//   http://graphics.cs.kuleuven.be/publications/phdSuykens/suykens_8.pdf p. 154
+//
+
+// Box (constant) kernel.
+template <typename T> T box2d(const T r2);
+
+// Epanechnikov kernel.
+template <typename T> T epanechnikov2d(const T r2);
+
+
+//
+// Implementation.
+//
+
+template <typename T>
+inline T box2d(const T r2)
+{
+    return RcpPi<T>();
+}
+
+template <typename T>
+inline T epanechnikov2d(const T r2)
+{
+    return RcpHalfPi<T>() * (T(1.0) - r2);
+}
+
+}   // namespace foundation
@@ -33,6 +33,7 @@
 #include "foundation/math/knn/knn_anyquery.h"
 #include "foundation/math/knn/knn_answer.h"
 #include "foundation/math/knn/knn_builder.h"
+#include "foundation/math/knn/knn_gatherquery.h"
 #include "foundation/math/knn/knn_query.h"
 #include "foundation/math/knn/knn_statistics.h"
 #include "foundation/math/knn/knn_tree.h"
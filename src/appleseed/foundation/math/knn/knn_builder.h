@@ -37,6 +37,8 @@
 #include "foundation/math/permutation.h"
 #include "foundation/math/split.h"
 #include "foundation/math/vector.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
@@ -75,6 +77,17 @@ class Builder
     void build_move_points(
         std::vector<VectorType>&    points);
 
+    // Like build_move_points() but the subtrees are built in parallel using the
+    // worker threads of a given job queue. The resulting tree is equivalent.
+    template <typename Timer>
+    void build_move_points(
+        std::vector<VectorType>&    points,
+        JobQueue&                   job_queue);
+
+    // Store a copy of the points of the tree in structure-of-arrays blocks,
+    // as required by GatherQuery. Must be called after the tree is built.
+    void build_point_blocks();
+
     // Return the construction time.
     double get_build_time() const;
 
@@ -98,10 +111,35 @@ class Builder
             const size_t            index) const;
     };
 
+    typedef std::vector<NodeType> NodeVector;
+
+    struct Subtree
+    {
+        size_t                      m_node_index;
+        size_t                      m_begin;
+        size_t                      m_end;
+        NodeVector                  m_nodes;
+    };
+
+    class SubtreeJob;
+
     TreeType&   m_tree;
     double      m_build_time;
 
+    void move_points(
+        std::vector<VectorType>&    points);
+
+    void reorder_points();
+
+    // Split a node in two. Return false and make the node a leaf if it must not be split.
+    bool split(
+        NodeType&                   node,
+        const size_t                begin,
+        const size_t                end,
+        size_t&                     pivot) const;
+
     void partition(
+        NodeVector&                 nodes,
         const size_t                parent_node_index,
         const size_t                begin,
         const size_t                end) const;
@@ -153,6 +191,131 @@ void Builder<T, N>::build_move_points(
     Stopwatch<Timer> stopwatch;
     stopwatch.start();
 
+    move_points(points);
+
+    partition(m_tree.m_nodes, 0, 0, m_tree.m_points.size());
+
+    reorder_points();
+
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
+template <typename T, size_t N>
+class Builder<T, N>::SubtreeJob
+  : public IJob
+{
+  public:
+    SubtreeJob(
+        const Builder&              builder,
+        Subtree&                    subtree)
+      : m_builder(builder)
+      , m_subtree(subtree)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        m_subtree.m_nodes.reserve((m_subtree.m_end - m_subtree.m_begin) * 2 + 1);
+        m_subtree.m_nodes.push_back(NodeType());
+
+        m_builder.partition(m_subtree.m_nodes, 0, m_subtree.m_begin, m_subtree.m_end);
+    }
+
+  private:
+    const Builder&  m_builder;
+    Subtree&        m_subtree;
+};
+
+template <typename T, size_t N>
+template <typename Timer>
+void Builder<T, N>::build_move_points(
+    std::vector<VectorType>&    points,
+    JobQueue&                   job_queue)
+{
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    move_points(points);
+
+    const size_t count = m_tree.m_points.size();
+
+    // Nodes holding more points than this are split serially, smaller ones become subtrees.
+    const size_t max_subtree_size = std::max<size_t>(count / 256, 4096);
+
+    // Split the top of the tree breadth-first until the remaining nodes are small enough.
+    std::vector<Subtree> subtrees;
+    std::vector<Subtree> pending(1);
+    pending[0].m_node_index = 0;
+    pending[0].m_begin = 0;
+    pending[0].m_end = count;
+
+    while (!pending.empty())
+    {
+        const Subtree task = pending.back();
+        pending.pop_back();
+
+        if (task.m_end - task.m_begin <= max_subtree_size)
+        {
+            subtrees.push_back(task);
+            continue;
+        }
+
+        size_t pivot;
+        if (!split(m_tree.m_nodes[task.m_node_index], task.m_begin, task.m_end, pivot))
+            continue;
+
+        const size_t left_node_index = m_tree.m_nodes.size();
+        m_tree.m_nodes.push_back(NodeType());
+        m_tree.m_nodes.push_back(NodeType());
+        m_tree.m_nodes[task.m_node_index].set_child_node_index(left_node_index);
+
+        pending.resize(pending.size() + 2);
+        Subtree& right = pending[pending.size() - 1];
+        right.m_node_index = left_node_index + 1;
+        right.m_begin = pivot;
+        right.m_end = task.m_end;
+        Subtree& left = pending[pending.size() - 2];
+        left.m_node_index = left_node_index;
+        left.m_begin = task.m_begin;
+        left.m_end = pivot;
+    }
+
+    // Build the subtrees in parallel, each into its own node vector.
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+        job_queue.schedule(new SubtreeJob(*this, subtrees[i]));
+    job_queue.wait_until_completion();
+
+    // Append the subtrees to the tree, remapping their child node indices.
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+    {
+        const Subtree& subtree = subtrees[i];
+        const size_t base = m_tree.m_nodes.size();
+
+        for (size_t j = 0, f = subtree.m_nodes.size(); j < f; ++j)
+        {
+            NodeType node = subtree.m_nodes[j];
+
+            // Child node indices are local to the subtree, where index 0 is the subtree root.
+            if (node.is_interior())
+                node.set_child_node_index(base + node.get_child_node_index() - 1);
+
+            if (j == 0)
+                m_tree.m_nodes[subtree.m_node_index] = node;
+            else m_tree.m_nodes.push_back(node);
+        }
+    }
+
+    reorder_points();
+
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::move_points(
+    std::vector<VectorType>&    points)
+{
     const size_t count = points.size();
 
     if (count > 0)
@@ -167,8 +330,12 @@ void Builder<T, N>::build_move_points(
 
     m_tree.m_nodes.reserve(count * 2 + 1);
     m_tree.m_nodes.push_back(NodeType());
+}
 
-    partition(0, 0, count);
+template <typename T, size_t N>
+void Builder<T, N>::reorder_points()
+{
+    const size_t count = m_tree.m_points.size();
 
     if (count > 0)
     {
@@ -180,9 +347,26 @@ void Builder<T, N>::build_move_points(
             &m_tree.m_indices[0],
             count);
     }
+}
 
-    stopwatch.measure();
-    m_build_time = stopwatch.get_seconds();
+template <typename T, size_t N>
+void Builder<T, N>::build_point_blocks()
+{
+    const size_t BlockSize = TreeType::PointBlockSize;
+    const size_t count = m_tree.m_points.size();
+    const size_t block_count = (count + BlockSize - 1) / BlockSize;
+
+    // Unused slots of the last block are never reported by queries.
+    m_tree.m_point_blocks.assign(block_count * BlockSize * N, ValueType(0.0));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        ValueType* block = &m_tree.m_point_blocks[(i / BlockSize) * BlockSize * N];
+        const size_t lane = i % BlockSize;
+
+        for (size_t d = 0; d < N; ++d)
+            block[d * BlockSize + lane] = m_tree.m_points[i][d];
+    }
 }
 
 template <typename T, size_t N>
@@ -209,58 +393,74 @@ inline bool Builder<T, N>::PartitionPredicate::operator()(
 }
 
 template <typename T, size_t N>
-void Builder<T, N>::partition(
-    const size_t                parent_node_index,
+bool Builder<T, N>::split(
+    NodeType&                   node,
     const size_t                begin,
-    const size_t                end) const
+    const size_t                end,
+    size_t&                     pivot) const
 {
     const size_t count = end - begin;
 
+    node.set_point_index(begin);
+    node.set_point_count(count);
+
     if (count <= 1)
     {
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
-        parent_node.make_leaf();
-        parent_node.set_point_index(begin);
-        parent_node.set_point_count(count);
+        node.make_leaf();
+        return false;
     }
-    else
-    {
-        const BboxType bbox = compute_bbox(begin, end);
-        SplitType split = SplitType::middle(bbox);
-
-        const size_t* bound =
-            std::partition(
-                &m_tree.m_indices[0] + begin,
-                &m_tree.m_indices[0] + end,
-                PartitionPredicate(m_tree.m_points, split));
-
-        size_t pivot = bound - &m_tree.m_indices[0];
-        assert(pivot >= begin);
-        assert(pivot <= end);
-
-        // Given a split-the-longest-axis-in-the-middle strategy, the only case where
-        // the left or right leaf may be empty is when all the points are coincident.
-        // In that degenerate case, we simply split the point set in two and recurse.
-        // Without this treatment, we would recurse until we exhaust stack space.
-        if (pivot == begin || pivot == end)
-            pivot = (begin + end) / 2;
 
-        const size_t left_node_index = m_tree.m_nodes.size();
+    const BboxType bbox = compute_bbox(begin, end);
+    SplitType split = SplitType::middle(bbox);
+
+    // Subtrees built in parallel partition disjoint ranges of the index array.
+    size_t* indices = &m_tree.m_indices[0];
+
+    const size_t* bound =
+        std::partition(
+            indices + begin,
+            indices + end,
+            PartitionPredicate(m_tree.m_points, split));
+
+    pivot = bound - indices;
+    assert(pivot >= begin);
+    assert(pivot <= end);
+
+    // Given a split-the-longest-axis-in-the-middle strategy, the only case where
+    // the left or right leaf may be empty is when all the points are coincident.
+    // In that degenerate case, we simply split the point set in two and recurse.
+    // Without this treatment, we would recurse until we exhaust stack space.
+    if (pivot == begin || pivot == end)
+        pivot = (begin + end) / 2;
+
+    node.make_interior();
+    node.set_split_dim(split.m_dimension);
+    node.set_split_abs(split.m_abscissa);
+
+    return true;
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::partition(
+    NodeVector&                 nodes,
+    const size_t                parent_node_index,
+    const size_t                begin,
+    const size_t                end) const
+{
+    size_t pivot;
+
+    if (split(nodes[parent_node_index], begin, end, pivot))
+    {
+        const size_t left_node_index = nodes.size();
         const size_t right_node_index = left_node_index + 1;
 
-        m_tree.m_nodes.push_back(NodeType());
-        m_tree.m_nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
 
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
-        parent_node.make_interior();
-        parent_node.set_split_dim(split.m_dimension);
-        parent_node.set_split_abs(split.m_abscissa);
-        parent_node.set_child_node_index(left_node_index);
-        parent_node.set_point_index(begin);
-        parent_node.set_point_count(count);
+        nodes[parent_node_index].set_child_node_index(left_node_index);
 
-        partition(left_node_index, begin, pivot);
-        partition(right_node_index, pivot, end);
+        partition(nodes, left_node_index, begin, pivot);
+        partition(nodes, right_node_index, pivot, end);
     }
 }
 
@@ -0,0 +1,328 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/knn/knn_tree.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace foundation {
+namespace knn {
+
+//
+// Find all the points within a given distance of a query point, without sorting them
+// nor limiting their number. Each point found is passed to a visitor, which allows to
+// accumulate per-point values in the same pass.
+//
+// Points are tested in blocks of Tree::PointBlockSize points stored in structure-of-arrays
+// layout, using SIMD instructions when available. The tree must have been built with
+// Builder::build_point_blocks().
+//
+
+template <typename T, std::size_t N>
+class GatherQuery
+  : public NonCopyable
+{
+  public:
+    typedef T ValueType;
+    static const std::size_t Dimension = N;
+
+    typedef Vector<T, N> VectorType;
+    typedef Tree<T, N> TreeType;
+
+    explicit GatherQuery(const TreeType& tree);
+
+    // Call visitor(index, square_dist) for each point within the query distance,
+    // in no particular order. index is an internal index, see Tree::remap().
+    template <typename Visitor>
+    void run(
+        const VectorType&   query_point,
+        const ValueType     query_max_square_distance,
+        Visitor&            visitor) const;
+
+  private:
+    typedef typename TreeType::NodeType NodeType;
+
+    struct NodeEntry
+    {
+        const NodeType*     m_node;
+        VectorType          m_dvec;
+    };
+
+    const TreeType& m_tree;
+
+    template <typename Visitor>
+    void visit_points(
+        const std::size_t   begin,
+        const std::size_t   end,
+        const VectorType&   query_point,
+        const ValueType     query_max_square_distance,
+        Visitor&            visitor) const;
+};
+
+typedef GatherQuery<float, 2>  GatherQuery2f;
+typedef GatherQuery<double, 2> GatherQuery2d;
+typedef GatherQuery<float, 3>  GatherQuery3f;
+typedef GatherQuery<double, 3> GatherQuery3d;
+
+
+//
+// Implementation.
+//
+
+namespace impl
+{
+    // Compute the square distances between a query point and a block of points,
+    // and return a bit mask of the points within the query distance.
+    template <typename T, std::size_t N, std::size_t BlockSize>
+    struct PointBlockTest
+    {
+        static std::uint32_t run(
+            const T*                    block,
+            const Vector<T, N>&         query_point,
+            const T                     query_max_square_distance,
+            T                           square_dists[])
+        {
+            std::uint32_t mask = 0;
+
+            for (std::size_t lane = 0; lane < BlockSize; ++lane)
+            {
+                T square_dist(0.0);
+
+                for (std::size_t d = 0; d < N; ++d)
+                {
+                    const T diff = block[d * BlockSize + lane] - query_point[d];
+                    square_dist += diff * diff;
+                }
+
+                square_dists[lane] = square_dist;
+
+                if (square_dist <= query_max_square_distance)
+                    mask |= 1u << lane;
+            }
+
+            return mask;
+        }
+    };
+
+#ifdef APPLESEED_USE_SSE
+
+    template <>
+    struct PointBlockTest<float, 3, 8>
+    {
+        static std::uint32_t run(
+            const float*                block,
+            const Vector<float, 3>&     query_point,
+            const float                 query_max_square_distance,
+            float                       square_dists[])
+        {
+#ifdef APPLESEED_USE_AVX
+            const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(block +  0), _mm256_set1_ps(query_point.x));
+            const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(block +  8), _mm256_set1_ps(query_point.y));
+            const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(block + 16), _mm256_set1_ps(query_point.z));
+
+            const __m256 d2 =
+                _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                    _mm256_mul_ps(dz, dz));
+
+            _mm256_storeu_ps(square_dists, d2);
+
+            return
+                static_cast<std::uint32_t>(
+                    _mm256_movemask_ps(
+                        _mm256_cmp_ps(d2, _mm256_set1_ps(query_max_square_distance), _CMP_LE_OQ)));
+#else
+            const __m128 qx = _mm_set1_ps(query_point.x);
+            const __m128 qy = _mm_set1_ps(query_point.y);
+            const __m128 qz = _mm_set1_ps(query_point.z);
+            const __m128 r2 = _mm_set1_ps(query_max_square_distance);
+
+            const __m128 dx0 = _mm_sub_ps(_mm_load_ps(block +  0), qx);
+            const __m128 dx1 = _mm_sub_ps(_mm_load_ps(block +  4), qx);
+            const __m128 dy0 = _mm_sub_ps(_mm_load_ps(block +  8), qy);
+            const __m128 dy1 = _mm_sub_ps(_mm_load_ps(block + 12), qy);
+            const __m128 dz0 = _mm_sub_ps(_mm_load_ps(block + 16), qz);
+            const __m128 dz1 = _mm_sub_ps(_mm_load_ps(block + 20), qz);
+
+            const __m128 d20 =
+                _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(dx0, dx0), _mm_mul_ps(dy0, dy0)),
+                    _mm_mul_ps(dz0, dz0));
+            const __m128 d21 =
+                _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(dx1, dx1), _mm_mul_ps(dy1, dy1)),
+                    _mm_mul_ps(dz1, dz1));
+
+            _mm_storeu_ps(square_dists + 0, d20);
+            _mm_storeu_ps(square_dists + 4, d21);
+
+            return
+                static_cast<std::uint32_t>(
+                    _mm_movemask_ps(_mm_cmple_ps(d20, r2)) |
+                    (_mm_movemask_ps(_mm_cmple_ps(d21, r2)) << 4));
+#endif
+        }
+    };
+
+#endif  // APPLESEED_USE_SSE
+}
+
+template <typename T, std::size_t N>
+inline GatherQuery<T, N>::GatherQuery(const TreeType& tree)
+  : m_tree(tree)
+{
+}
+
+template <typename T, std::size_t N>
+template <typename Visitor>
+void GatherQuery<T, N>::run(
+    const VectorType&       query_point,
+    const ValueType         query_max_square_distance,
+    Visitor&                visitor) const
+{
+    if (m_tree.empty())
+        return;
+
+    assert(m_tree.has_point_blocks());
+
+    const NodeType* APPLESEED_RESTRICT root_node = &m_tree.m_nodes.front();
+
+    // Nodes with fewer points than this are not split further: their points are tested directly.
+    const std::size_t MinSplitSize = 2 * TreeType::PointBlockSize;
+
+    static constexpr std::size_t NodeStackSize = 128;
+    NodeEntry node_stack[NodeStackSize];
+    std::size_t node_stack_size = 0;
+
+    node_stack[node_stack_size].m_node = root_node;
+    node_stack[node_stack_size].m_dvec = VectorType(ValueType(0.0));
+    ++node_stack_size;
+
+    while (node_stack_size > 0)
+    {
+        --node_stack_size;
+
+        const NodeType* APPLESEED_RESTRICT node = node_stack[node_stack_size].m_node;
+        const VectorType dvec = node_stack[node_stack_size].m_dvec;
+
+        while (node->is_interior() && node->get_point_count() >= MinSplitSize)
+        {
+            const std::size_t split_dim = node->get_split_dim();
+            const ValueType split_abs = node->get_split_abs();
+            const ValueType split_dist = query_point[split_dim] - split_abs;
+
+            // Points on the split plane belong to the right child node.
+            const std::size_t follow_index = split_dist >= ValueType(0.0) ? 1 : 0;
+            const NodeType* APPLESEED_RESTRICT left_child_node = root_node + node->get_child_node_index();
+            const NodeType* APPLESEED_RESTRICT follow_node = left_child_node + follow_index;
+            const NodeType* APPLESEED_RESTRICT stack_node = left_child_node + 1 - follow_index;
+
+            // Push the other child node if it may contain points within the query distance.
+            VectorType stack_dvec = dvec;
+            stack_dvec[split_dim] = split_dist;
+            if (square_norm(stack_dvec) <= query_max_square_distance)
+            {
+                assert(node_stack_size < NodeStackSize);
+                node_stack[node_stack_size].m_node = stack_node;
+                node_stack[node_stack_size].m_dvec = stack_dvec;
+                ++node_stack_size;
+            }
+
+            // Continue with the child node containing the query point.
+            node = follow_node;
+        }
+
+        const std::size_t point_index = node->get_point_index();
+
+        visit_points(
+            point_index,
+            point_index + node->get_point_count(),
+            query_point,
+            query_max_square_distance,
+            visitor);
+    }
+}
+
+template <typename T, std::size_t N>
+template <typename Visitor>
+inline void GatherQuery<T, N>::visit_points(
+    const std::size_t       begin,
+    const std::size_t       end,
+    const VectorType&       query_point,
+    const ValueType         query_max_square_distance,
+    Visitor&                visitor) const
+{
+    const std::size_t BlockSize = TreeType::PointBlockSize;
+
+    if (begin == end)
+        return;
+
+    const ValueType* APPLESEED_RESTRICT blocks = &m_tree.m_point_blocks.front();
+    const std::size_t first_block = begin / BlockSize;
+    const std::size_t last_block = (end - 1) / BlockSize;
+
+    for (std::size_t b = first_block; b <= last_block; ++b)
+    {
+        APPLESEED_SIMD8_ALIGN ValueType square_dists[BlockSize];
+
+        std::uint32_t mask =
+            impl::PointBlockTest<T, N, BlockSize>::run(
+                blocks + b * BlockSize * N,
+                query_point,
+                query_max_square_distance,
+                square_dists);
+
+        // Ignore the points of the block that don't belong to the node.
+        const std::size_t block_begin = b * BlockSize;
+        if (block_begin < begin)
+            mask &= ~0u << (begin - block_begin);
+        if (block_begin + BlockSize > end)
+            mask &= (1u << (end - block_begin)) - 1;
+
+        for (std::size_t lane = 0; mask != 0; ++lane, mask >>= 1)
+        {
+            if (mask & 1)
+                visitor(block_begin + lane, square_dists[lane]);
+        }
+    }
+}
+
+}   // namespace knn
+}   // namespace foundation
@@ -32,6 +32,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/knn/knn_node.h"
 #include "foundation/math/vector.h"
+#include "foundation/memory/alignedallocator.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -42,6 +43,7 @@
 DECLARE_TEST_CASE(Foundation_Math_Knn_Builder, Build_GivenZeroPoint_BuildsEmptyTree);
 DECLARE_TEST_CASE(Foundation_Math_Knn_Builder, Build_GivenTwoPoints_BuildsCorrectTree);
 DECLARE_TEST_CASE(Foundation_Math_Knn_Builder, Build_GivenEightPoints_GeneratesFifteenNodes);
+DECLARE_TEST_CASE(Foundation_Math_Knn_Builder, BuildMovePoints_GivenJobQueue_BuildsTreeEquivalentToSerialBuild);
 
 namespace foundation {
 namespace knn {
@@ -56,9 +58,15 @@ class Tree
     typedef Vector<T, N> VectorType;
     typedef Node<T> NodeType;
 
+    // Number of points per block in the structure-of-arrays copy of the points.
+    static const size_t PointBlockSize = 8;
+
     // Return true if the tree does not contain any point.
     bool empty() const;
 
+    // Return true if the points are also stored in structure-of-arrays blocks.
+    bool has_point_blocks() const;
+
     // Transform an internal index to a user-data index.
     size_t remap(const size_t i) const;
 
@@ -71,16 +79,23 @@ class Tree
   private:
     template <typename, size_t> friend class AnyQuery;
     template <typename, size_t> friend class Builder;
+    template <typename, size_t> friend class GatherQuery;
     template <typename, size_t> friend class Query;
     template <typename> friend class TreeStatistics;
 
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Knn_Builder, Build_GivenZeroPoint_BuildsEmptyTree);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Knn_Builder, Build_GivenTwoPoints_BuildsCorrectTree);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Knn_Builder, Build_GivenEightPoints_GeneratesFifteenNodes);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Knn_Builder, BuildMovePoints_GivenJobQueue_BuildsTreeEquivalentToSerialBuild);
 
     std::vector<VectorType> m_points;
     std::vector<size_t>     m_indices;
     std::vector<NodeType>   m_nodes;
+
+    // Copy of the points in blocks of PointBlockSize points: the block of points
+    // [i * PointBlockSize, (i + 1) * PointBlockSize) stores the PointBlockSize
+    // x coordinates, then the PointBlockSize y coordinates, etc.
+    std::vector<ValueType, AlignedAllocator<ValueType>> m_point_blocks;
 };
 
 typedef Tree<float, 2>  Tree2f;
@@ -99,6 +114,12 @@ inline bool Tree<T, N>::empty() const
     return m_points.empty();
 }
 
+template <typename T, size_t N>
+inline bool Tree<T, N>::has_point_blocks() const
+{
+    return !m_point_blocks.empty();
+}
+
 template <typename T, size_t N>
 inline size_t Tree<T, N>::remap(const size_t i) const
 {
@@ -120,6 +141,7 @@ inline size_t Tree<T, N>::get_memory_size() const
     mem_size += m_points.capacity() * sizeof(VectorType);
     mem_size += m_indices.capacity() * sizeof(size_t);
     mem_size += m_nodes.capacity() * sizeof(NodeType);
+    mem_size += m_point_blocks.capacity() * sizeof(ValueType);
     return mem_size;
 }
 
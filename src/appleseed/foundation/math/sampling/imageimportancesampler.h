@@ -83,6 +83,22 @@ class ImageImportanceSampler
         ImageSampler&       sampler,
         IAbortSwitch*       abort_switch = nullptr);
 
+    // Resample rows [begin, end) of the image and rebuild their CDFs. This method may be
+    // called concurrently on disjoint row ranges, for instance to rebuild the sampler in
+    // parallel. Once all rows are rebuilt, call rebuild_rows_cdf() to finish the rebuild.
+    template <typename ImageSampler>
+    void rebuild_rows(
+        ImageSampler&       sampler,
+        const size_t        begin,
+        const size_t        end);
+
+    // Rebuild the CDF over rows from the CDFs of the individual rows.
+    void rebuild_rows_cdf();
+
+    // Return the dimensions of the image.
+    size_t get_width() const;
+    size_t get_height() const;
+
     // Sample the image and return the coordinates of the chosen pixel
     // and its probability density.
     void sample(
@@ -164,16 +180,30 @@ void ImageImportanceSampler<Payload, Importance>::rebuild(
     IAbortSwitch*           abort_switch)
 {
     m_rows_cdf.clear();
-    m_rows_cdf.reserve(m_height);
 
     for (size_t y = 0, ye = m_height; y < ye; ++y)
     {
         if (is_aborted(abort_switch))
-        {
-            m_rows_cdf.clear();
-            break;
-        }
+            return;
+
+        rebuild_rows(sampler, y, y + 1);
+    }
+
+    rebuild_rows_cdf();
+}
 
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void ImageImportanceSampler<Payload, Importance>::rebuild_rows(
+    ImageSampler&           sampler,
+    const size_t            begin,
+    const size_t            end)
+{
+    assert(begin <= end);
+    assert(end <= m_height);
+
+    for (size_t y = begin; y < end; ++y)
+    {
         m_cols_cdf[y].clear();
         m_cols_cdf[y].reserve(m_width);
 
@@ -189,14 +219,34 @@ void ImageImportanceSampler<Payload, Importance>::rebuild(
 
         if (m_cols_cdf[y].valid())
             m_cols_cdf[y].prepare();
+    }
+}
 
+template <typename Payload, typename Importance>
+void ImageImportanceSampler<Payload, Importance>::rebuild_rows_cdf()
+{
+    m_rows_cdf.clear();
+    m_rows_cdf.reserve(m_height);
+
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
         m_rows_cdf.insert(y, m_cols_cdf[y].weight());
-    }
 
     if (m_rows_cdf.valid())
         m_rows_cdf.prepare();
 }
 
+template <typename Payload, typename Importance>
+inline size_t ImageImportanceSampler<Payload, Importance>::get_width() const
+{
+    return m_width;
+}
+
+template <typename Payload, typename Importance>
+inline size_t ImageImportanceSampler<Payload, Importance>::get_height() const
+{
+    return m_height;
+}
+
 template <typename Payload, typename Importance>
 inline void ImageImportanceSampler<Payload, Importance>::sample(
     const Vector2Type&      s,
@@ -35,6 +35,7 @@
 #include "foundation/math/vector.h"
 #include "foundation/memory/memory.h"
 #include "foundation/meshio/imeshbuilder.h"
+#include "foundation/meshio/mappedbinarymeshfile.h"
 #include "foundation/utility/bufferedfile.h"
 
 // Standard headers.
@@ -101,6 +102,16 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
         }
         break;
 
+      // Uncompressed, single-precision, page-aligned and pre-triangulated geometry,
+      // with (since version 6) the bounding box of each mesh.
+      case 5:
+      case 6:
+        {
+            const MappedBinaryMeshFile mapped_file(m_filename.c_str());
+            read_mapped_meshes(mapped_file, builder);
+        }
+        break;
+
       // Unknown format.
       default:
         throw ExceptionIOError("unknown binarymesh format version");
@@ -264,4 +275,56 @@ void BinaryMeshFileReader::read_face(ReaderAdapter& reader, IMeshBuilder& builde
     builder.end_face();
 }
 
+void BinaryMeshFileReader::read_mapped_meshes(const MappedBinaryMeshFile& file, IMeshBuilder& builder)
+{
+    ensure_minimum_size(m_vertices, 3);
+    ensure_minimum_size(m_vertex_normals, 3);
+    ensure_minimum_size(m_tex_coords, 3);
+
+    for (size_t mesh_index = 0, mesh_count = file.get_mesh_count(); mesh_index < mesh_count; ++mesh_index)
+    {
+        const MappedBinaryMeshFile::Mesh& mesh = file.get_mesh(mesh_index);
+
+        builder.begin_mesh(mesh.m_name.c_str());
+
+        for (size_t i = 0; i < mesh.m_vertex_count; ++i)
+            builder.push_vertex(Vector3d(mesh.m_vertices[i]));
+
+        for (size_t i = 0; i < mesh.m_vertex_normal_count; ++i)
+            builder.push_vertex_normal(Vector3d(mesh.m_vertex_normals[i]));
+
+        for (size_t i = 0; i < mesh.m_tex_coords_count; ++i)
+            builder.push_tex_coords(Vector2d(mesh.m_tex_coords[i]));
+
+        for (size_t i = 0, e = mesh.m_material_slots.size(); i < e; ++i)
+            builder.push_material_slot(mesh.m_material_slots[i].c_str());
+
+        for (size_t i = 0; i < mesh.m_triangle_count; ++i)
+        {
+            const std::uint32_t* triangle = mesh.m_triangles + i * MappedBinaryMeshFile::TriangleSize;
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                m_vertices[j] = triangle[j];
+                m_vertex_normals[j] = triangle[3 + j];
+                m_tex_coords[j] = triangle[6 + j];
+            }
+
+            builder.begin_face(3);
+            builder.set_face_vertices(&m_vertices[0]);
+
+            // Absent features are stored as ~0.
+            if (triangle[3] != ~std::uint32_t(0))
+                builder.set_face_vertex_normals(&m_vertex_normals[0]);
+            if (triangle[6] != ~std::uint32_t(0))
+                builder.set_face_vertex_tex_coords(&m_tex_coords[0]);
+
+            builder.set_face_material(triangle[9]);
+            builder.end_face();
+        }
+
+        builder.end_mesh();
+    }
+}
+
 }   // namespace foundation
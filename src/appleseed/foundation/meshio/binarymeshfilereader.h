@@ -41,6 +41,7 @@
 // Forward declarations.
 namespace foundation    { class BufferedFile; }
 namespace foundation    { class IMeshBuilder; }
+namespace foundation    { class MappedBinaryMeshFile; }
 namespace foundation    { class ReaderAdapter; }
 
 namespace foundation
@@ -77,6 +78,7 @@ class BinaryMeshFileReader
     void read_material_slots(ReaderAdapter& reader, IMeshBuilder& builder);
     void read_faces(ReaderAdapter& reader, IMeshBuilder& builder);
     void read_face(ReaderAdapter& reader, IMeshBuilder& builder);
+    void read_mapped_meshes(const MappedBinaryMeshFile& file, IMeshBuilder& builder);
 };
 
 }   // namespace foundation
@@ -32,8 +32,11 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/triangulator.h"
 #include "foundation/math/vector.h"
 #include "foundation/meshio/imeshwalker.h"
+#include "foundation/meshio/mappedbinarymeshfile.h"
 
 // Standard headers.
 #include <cstdint>
@@ -50,10 +53,31 @@ namespace
 {
     // Version of the BinaryMesh file format being written by this code.
     const std::uint16_t Version = 4;
+
+    // Version of the page-aligned BinaryMesh file format.
+    const std::uint16_t PageAlignedVersion = MappedBinaryMeshFile::Version;
+
+    template <typename File>
+    void write_string(File& file, const char* s)
+    {
+        const std::uint16_t length = static_cast<std::uint16_t>(strlen(s));
+
+        checked_write(file, length);
+        checked_write(file, s, length);
+    }
+
+    std::uint32_t get_feature_index(const size_t index, const size_t feature_count)
+    {
+        // Missing and out-of-range features are stored as ~0.
+        return index < feature_count ? static_cast<std::uint32_t>(index) : ~std::uint32_t(0);
+    }
 }
 
-BinaryMeshFileWriter::BinaryMeshFileWriter(const std::string& filename)
+BinaryMeshFileWriter::BinaryMeshFileWriter(
+    const std::string&      filename,
+    const int               options)
   : m_filename(filename)
+  , m_options(options)
   , m_writer(m_file, 256 * 1024)
 {
 }
@@ -74,7 +98,9 @@ void BinaryMeshFileWriter::write(const IMeshWalker& walker)
         write_version();
     }
 
-    write_mesh(walker);
+    if (m_options & PageAligned)
+        write_page_aligned_mesh(walker);
+    else write_mesh(walker);
 }
 
 void BinaryMeshFileWriter::write_signature()
@@ -85,15 +111,12 @@ void BinaryMeshFileWriter::write_signature()
 
 void BinaryMeshFileWriter::write_version()
 {
-    checked_write(m_file, Version);
+    checked_write(m_file, (m_options & PageAligned) ? PageAlignedVersion : Version);
 }
 
 void BinaryMeshFileWriter::write_string(const char* s)
 {
-    const std::uint16_t length = static_cast<std::uint16_t>(strlen(s));
-
-    checked_write(m_writer, length);
-    checked_write(m_writer, s, length);
+    foundation::write_string(m_writer, s);
 }
 
 void BinaryMeshFileWriter::write_mesh(const IMeshWalker& walker)
@@ -166,4 +189,130 @@ void BinaryMeshFileWriter::write_face(const IMeshWalker& walker, const size_t fa
     checked_write(m_writer, static_cast<std::uint16_t>(walker.get_face_material(face_index)));
 }
 
+void BinaryMeshFileWriter::write_page_aligned_mesh(const IMeshWalker& walker)
+{
+    // Polygonal faces are triangulated at write time so that the triangles can be used as is when reading.
+    collect_triangles(walker);
+
+    const std::uint32_t vertex_count = static_cast<std::uint32_t>(walker.get_vertex_count());
+    const std::uint32_t vertex_normal_count = static_cast<std::uint32_t>(walker.get_vertex_normal_count());
+    const std::uint32_t tex_coords_count = static_cast<std::uint32_t>(walker.get_tex_coords_count());
+    const std::uint16_t material_slot_count = static_cast<std::uint16_t>(walker.get_material_slot_count());
+    const std::uint32_t triangle_count = static_cast<std::uint32_t>(m_triangles.size() / MappedBinaryMeshFile::TriangleSize);
+
+    // Compute the bounding box of the vertices as they will be stored in the file.
+    AABB3f bbox;
+    bbox.invalidate();
+    for (std::uint32_t i = 0; i < vertex_count; ++i)
+        bbox.insert(Vector3f(walker.get_vertex(i)));
+
+    // Write the mesh header.
+    foundation::write_string(m_file, walker.get_name());
+    checked_write(m_file, vertex_count);
+    checked_write(m_file, vertex_normal_count);
+    checked_write(m_file, tex_coords_count);
+    checked_write(m_file, material_slot_count);
+    for (std::uint16_t i = 0; i < material_slot_count; ++i)
+        foundation::write_string(m_file, walker.get_material_slot(i));
+    checked_write(m_file, triangle_count);
+    checked_write(m_file, bbox.min);
+    checked_write(m_file, bbox.max);
+
+    // Write the vertices.
+    write_padding();
+    for (std::uint32_t i = 0; i < vertex_count; ++i)
+        checked_write(m_file, Vector3f(walker.get_vertex(i)));
+
+    // Write the vertex normals, normalized as mesh objects expect them.
+    write_padding();
+    for (std::uint32_t i = 0; i < vertex_normal_count; ++i)
+    {
+        const Vector3d n = walker.get_vertex_normal(i);
+        const double norm_n = norm(n);
+        checked_write(m_file, norm_n > 0.0 ? Vector3f(n / norm_n) : Vector3f(1.0f, 0.0f, 0.0f));
+    }
+
+    // Write the texture coordinates.
+    write_padding();
+    for (std::uint32_t i = 0; i < tex_coords_count; ++i)
+        checked_write(m_file, Vector2f(walker.get_tex_coords(i)));
+
+    // Write the triangles.
+    write_padding();
+    if (!m_triangles.empty())
+        checked_write(m_file, &m_triangles[0], m_triangles.size() * sizeof(std::uint32_t));
+}
+
+void BinaryMeshFileWriter::collect_triangles(const IMeshWalker& walker)
+{
+    const size_t vertex_normal_count = walker.get_vertex_normal_count();
+    const size_t tex_coords_count = walker.get_tex_coords_count();
+
+    Triangulator<double> triangulator(Triangulator<double>::KeepDegenerateTriangles);
+    std::vector<Vector3d> polygon;
+    std::vector<size_t> triangulation;
+
+    m_triangles.clear();
+
+    for (size_t face_index = 0, face_count = walker.get_face_count(); face_index < face_count; ++face_index)
+    {
+        const size_t face_vertex_count = walker.get_face_vertex_count(face_index);
+
+        triangulation.clear();
+
+        if (face_vertex_count > 3)
+        {
+            polygon.clear();
+            for (size_t i = 0; i < face_vertex_count; ++i)
+                polygon.push_back(walker.get_vertex(walker.get_face_vertex(face_index, i)));
+
+            // Faces that cannot be triangulated are replaced by zero-area triangles.
+            if (!triangulator.triangulate(polygon, triangulation))
+                triangulation.assign(3 * (face_vertex_count - 2), 0);
+        }
+        else
+        {
+            triangulation.push_back(0);
+            triangulation.push_back(1);
+            triangulation.push_back(2);
+        }
+
+        const std::uint32_t material = static_cast<std::uint32_t>(walker.get_face_material(face_index));
+
+        for (size_t i = 0; i < triangulation.size(); i += 3)
+        {
+            for (size_t j = 0; j < 3; ++j)
+                m_triangles.push_back(static_cast<std::uint32_t>(walker.get_face_vertex(face_index, triangulation[i + j])));
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                m_triangles.push_back(
+                    get_feature_index(
+                        walker.get_face_vertex_normal(face_index, triangulation[i + j]),
+                        vertex_normal_count));
+            }
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                m_triangles.push_back(
+                    get_feature_index(
+                        walker.get_face_tex_coords(face_index, triangulation[i + j]),
+                        tex_coords_count));
+            }
+
+            m_triangles.push_back(material);
+        }
+    }
+}
+
+void BinaryMeshFileWriter::write_padding()
+{
+    static const std::uint8_t Zeros[MappedBinaryMeshFile::PageSize] = { 0 };
+
+    const size_t remainder = static_cast<size_t>(m_file.tell()) % MappedBinaryMeshFile::PageSize;
+
+    if (remainder > 0)
+        checked_write(m_file, Zeros, MappedBinaryMeshFile::PageSize - remainder);
+}
+
 }   // namespace foundation
@@ -36,7 +36,9 @@
 
 // Standard headers.
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IMeshWalker; }
@@ -52,21 +54,36 @@ class BinaryMeshFileWriter
   : public IMeshFileWriter
 {
   public:
+    enum Options
+    {
+        Defaults    = 0,
+        PageAligned = 1UL << 0      // write uncompressed, page-aligned arrays that can be memory-mapped (format version 6)
+    };
+
     // Constructor.
-    explicit BinaryMeshFileWriter(const std::string& filename);
+    explicit BinaryMeshFileWriter(
+        const std::string&      filename,
+        const int               options = Defaults);
 
     // Write a mesh.
     void write(const IMeshWalker& walker) override;
 
   private:
     const std::string           m_filename;
+    const int                   m_options;
     BufferedFile                m_file;
     LZ4CompressedWriterAdapter  m_writer;
+    std::vector<std::uint32_t>  m_triangles;
 
     void write_signature();
     void write_version();
 
     void write_string(const char* s);
+
+    // Page-aligned format.
+    void write_page_aligned_mesh(const IMeshWalker& walker);
+    void collect_triangles(const IMeshWalker& walker);
+    void write_padding();
     void write_mesh(const IMeshWalker& walker);
     void write_vertices(const IMeshWalker& walker);
     void write_vertex_normals(const IMeshWalker& walker);
@@ -51,6 +51,8 @@ struct GenericMeshFileReader::Impl
 {
     std::string  m_filename;
     int          m_obj_options;
+    Logger*      m_obj_logger;
+    size_t       m_obj_thread_count;
 };
 
 GenericMeshFileReader::GenericMeshFileReader(const char* filename)
@@ -58,6 +60,8 @@ GenericMeshFileReader::GenericMeshFileReader(const char* filename)
 {
     impl->m_filename = filename;
     impl->m_obj_options = OBJMeshFileReader::Default;
+    impl->m_obj_logger = nullptr;
+    impl->m_obj_thread_count = 0;
 }
 
 GenericMeshFileReader::~GenericMeshFileReader()
@@ -75,6 +79,14 @@ void GenericMeshFileReader::set_obj_options(const int obj_options)
     impl->m_obj_options = obj_options;
 }
 
+void GenericMeshFileReader::enable_obj_parallel_parsing(
+    Logger&             logger,
+    const size_t        thread_count)
+{
+    impl->m_obj_logger = &logger;
+    impl->m_obj_thread_count = thread_count;
+}
+
 void GenericMeshFileReader::read(IMeshBuilder& builder)
 {
     const bf::path filepath(impl->m_filename);
@@ -83,6 +95,8 @@ void GenericMeshFileReader::read(IMeshBuilder& builder)
     if (extension == ".obj")
     {
         OBJMeshFileReader reader(impl->m_filename, impl->m_obj_options);
+        if (impl->m_obj_logger != nullptr)
+            reader.enable_parallel_parsing(*impl->m_obj_logger, impl->m_obj_thread_count);
         reader.read(builder);
     }
     else if (extension == ".binarymesh")
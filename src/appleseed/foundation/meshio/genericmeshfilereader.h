@@ -35,8 +35,12 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class IMeshBuilder; }
+namespace foundation    { class Logger; }
 
 namespace foundation
 {
@@ -59,6 +63,11 @@ class APPLESEED_DLLSYMBOL GenericMeshFileReader
     int get_obj_options() const;
     void set_obj_options(const int obj_options);
 
+    // Parse large Wavefront OBJ files on multiple threads, see OBJMeshFileReader::enable_parallel_parsing().
+    void enable_obj_parallel_parsing(
+        Logger&             logger,
+        const size_t        thread_count);
+
     // Read a mesh.
     void read(IMeshBuilder& builder) override;
 
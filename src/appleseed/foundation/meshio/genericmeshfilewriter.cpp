@@ -47,7 +47,9 @@ namespace bf = boost::filesystem;
 namespace foundation
 {
 
-GenericMeshFileWriter::GenericMeshFileWriter(const char* filename)
+GenericMeshFileWriter::GenericMeshFileWriter(
+    const char*     filename,
+    const int       binarymesh_options)
 {
     const bf::path filepath(filename);
     const std::string extension = lower_case(filepath.extension().string());
@@ -55,7 +57,7 @@ GenericMeshFileWriter::GenericMeshFileWriter(const char* filename)
     if (extension == ".obj")
         m_writer = new OBJMeshFileWriter(filename);
     else if (extension == ".binarymesh")
-        m_writer = new BinaryMeshFileWriter(filename);
+        m_writer = new BinaryMeshFileWriter(filename, binarymesh_options);
     else throw ExceptionUnsupportedFileFormat(filename);
 }
 
@@ -0,0 +1,188 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "mappedbinarymeshfile.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/utility/bufferedfile.h"
+
+// Standard headers.
+#include <cstring>
+
+namespace foundation
+{
+
+//
+// MappedBinaryMeshFile class implementation.
+//
+
+namespace
+{
+    const char Signature[10] = { 'B', 'I', 'N', 'A', 'R', 'Y', 'M', 'E', 'S', 'H' };
+
+    static_assert(sizeof(Vector3f) == 3 * sizeof(float), "foundation::Vector3f is expected to be tightly packed");
+    static_assert(sizeof(Vector2f) == 2 * sizeof(float), "foundation::Vector2f is expected to be tightly packed");
+
+    class Cursor
+    {
+      public:
+        Cursor(const void* data, const size_t size)
+          : m_data(static_cast<const std::uint8_t*>(data))
+          , m_size(size)
+          , m_offset(0)
+        {
+        }
+
+        bool at_end() const
+        {
+            return m_offset == m_size;
+        }
+
+        template <typename T>
+        T read()
+        {
+            T value;
+            std::memcpy(&value, skip(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string read_string()
+        {
+            const std::uint16_t length = read<std::uint16_t>();
+            const char* s = reinterpret_cast<const char*>(skip(length));
+            return std::string(s, length);
+        }
+
+        template <typename T>
+        const T* read_array(const size_t count)
+        {
+            skip(padding());
+            return reinterpret_cast<const T*>(skip(count * sizeof(T)));
+        }
+
+      private:
+        const std::uint8_t* m_data;
+        const size_t        m_size;
+        size_t              m_offset;
+
+        size_t padding() const
+        {
+            const size_t remainder = m_offset % MappedBinaryMeshFile::PageSize;
+            return remainder > 0 ? MappedBinaryMeshFile::PageSize - remainder : 0;
+        }
+
+        const std::uint8_t* skip(const size_t size)
+        {
+            if (size > m_size - m_offset)
+                throw ExceptionIOError("unexpected end of binarymesh file");
+
+            const std::uint8_t* p = m_data + m_offset;
+            m_offset += size;
+            return p;
+        }
+    };
+}
+
+bool MappedBinaryMeshFile::is_mappable(const char* filename)
+{
+    BufferedFile file(filename, BufferedFile::BinaryType, BufferedFile::ReadMode);
+
+    if (!file.is_open())
+        return false;
+
+    char signature[sizeof(Signature)];
+    std::uint16_t version;
+
+    return
+        file.read(signature, sizeof(signature)) == sizeof(signature) &&
+        std::memcmp(signature, Signature, sizeof(Signature)) == 0 &&
+        file.read(version) == sizeof(version) &&
+        version >= OldestVersion &&
+        version <= Version;
+}
+
+MappedBinaryMeshFile::MappedBinaryMeshFile(const char* filename)
+{
+    if (!m_file.open(filename))
+        throw ExceptionIOError("could not map binarymesh file in memory");
+
+    Cursor cursor(m_file.data(), m_file.size());
+
+    char signature[sizeof(Signature)];
+    for (size_t i = 0; i < sizeof(Signature); ++i)
+        signature[i] = cursor.read<char>();
+
+    if (std::memcmp(signature, Signature, sizeof(Signature)))
+        throw ExceptionIOError("invalid binarymesh format signature");
+
+    const std::uint16_t version = cursor.read<std::uint16_t>();
+    if (version < OldestVersion || version > Version)
+        throw ExceptionIOError("binarymesh file is not in the page-aligned format");
+
+    while (!cursor.at_end())
+    {
+        Mesh mesh;
+        mesh.m_name = cursor.read_string();
+
+        mesh.m_vertex_count = cursor.read<std::uint32_t>();
+        mesh.m_vertex_normal_count = cursor.read<std::uint32_t>();
+        mesh.m_tex_coords_count = cursor.read<std::uint32_t>();
+
+        const std::uint16_t material_slot_count = cursor.read<std::uint16_t>();
+        for (std::uint16_t i = 0; i < material_slot_count; ++i)
+            mesh.m_material_slots.push_back(cursor.read_string());
+
+        mesh.m_triangle_count = cursor.read<std::uint32_t>();
+
+        if (version >= 6)
+        {
+            mesh.m_bbox.min = cursor.read<Vector3f>();
+            mesh.m_bbox.max = cursor.read<Vector3f>();
+        }
+
+        mesh.m_vertices = cursor.read_array<Vector3f>(mesh.m_vertex_count);
+        mesh.m_vertex_normals = cursor.read_array<Vector3f>(mesh.m_vertex_normal_count);
+        mesh.m_tex_coords = cursor.read_array<Vector2f>(mesh.m_tex_coords_count);
+        mesh.m_triangles = cursor.read_array<std::uint32_t>(mesh.m_triangle_count * TriangleSize);
+
+        // Version 5 files don't store bounding boxes.
+        if (version < 6)
+        {
+            mesh.m_bbox.invalidate();
+            for (size_t i = 0; i < mesh.m_vertex_count; ++i)
+                mesh.m_bbox.insert(mesh.m_vertices[i]);
+        }
+
+        m_meshes.push_back(mesh);
+    }
+}
+
+}   // namespace foundation
@@ -0,0 +1,135 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/memorymappedfile.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Zero-copy access to the meshes of a binarymesh file in the page-aligned format (versions 5 and 6).
+//
+// Page-aligned binarymesh files store each mesh as a small header followed by
+// uncompressed, single-precision arrays of vertices, unit-length vertex normals
+// and texture coordinates, and by an array of pre-triangulated faces. Each array
+// starts on a page boundary so that, once the file is mapped in memory, the arrays
+// can be used in place.
+//
+// Since version 6, mesh headers also store the bounding box of the vertices, so that
+// meshes can be placed in a scene without touching their arrays. The bounding boxes
+// of meshes read from version 5 files are computed from their vertices.
+//
+// Each triangle is stored as ten 32-bit indices, in the same order as in renderer::Triangle:
+//
+//   v0 v1 v2       vertex indices
+//   n0 n1 n2       vertex normal indices, or ~0 if absent
+//   t0 t1 t2       texture coordinates indices, or ~0 if absent
+//   m              material slot index
+//
+
+class APPLESEED_DLLSYMBOL MappedBinaryMeshFile
+  : public NonCopyable
+{
+  public:
+    // Version of the binarymesh file format written in the page-aligned format.
+    static const std::uint16_t Version = 6;
+
+    // Oldest version of the page-aligned format still handled by this class.
+    static const std::uint16_t OldestVersion = 5;
+
+    // Alignment of the arrays in the file, in bytes.
+    static const size_t PageSize = 4096;
+
+    // Number of 32-bit values per triangle.
+    static const size_t TriangleSize = 10;
+
+    struct Mesh
+    {
+        std::string                 m_name;
+        std::vector<std::string>    m_material_slots;
+        size_t                      m_vertex_count;
+        const Vector3f*             m_vertices;
+        size_t                      m_vertex_normal_count;
+        const Vector3f*             m_vertex_normals;
+        size_t                      m_tex_coords_count;
+        const Vector2f*             m_tex_coords;
+        size_t                      m_triangle_count;
+        const std::uint32_t*        m_triangles;
+        AABB3f                      m_bbox;
+    };
+
+    // Return true if a given file is a binarymesh file in the page-aligned format.
+    static bool is_mappable(const char* filename);
+
+    // Constructor, maps the file in memory and reads the mesh headers.
+    // Throws foundation::ExceptionIOError if the file cannot be mapped or is not valid.
+    explicit MappedBinaryMeshFile(const char* filename);
+
+    // Access the meshes of the file. The arrays remain valid for the lifetime of this object.
+    size_t get_mesh_count() const;
+    const Mesh& get_mesh(const size_t index) const;
+
+  private:
+    MemoryMappedFile        m_file;
+    std::vector<Mesh>       m_meshes;
+};
+
+
+//
+// MappedBinaryMeshFile class implementation.
+//
+
+inline size_t MappedBinaryMeshFile::get_mesh_count() const
+{
+    return m_meshes.size();
+}
+
+inline const MappedBinaryMeshFile::Mesh& MappedBinaryMeshFile::get_mesh(const size_t index) const
+{
+    assert(index < m_meshes.size());
+    return m_meshes[index];
+}
+
+}   // namespace foundation
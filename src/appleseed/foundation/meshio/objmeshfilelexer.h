@@ -40,6 +40,7 @@
 #include <cctype>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -62,6 +63,8 @@ class OBJMeshFileLexer
     // Constructor.
     explicit OBJMeshFileLexer(const ParsingMode parsing_mode = Precise)
       : m_parsing_mode(parsing_mode)
+      , m_input(nullptr)
+      , m_input_end(nullptr)
       , m_eof(false)
       , m_line_number(0)
       , m_line(4096)
@@ -95,16 +98,47 @@ class OBJMeshFileLexer
         return true;
     }
 
-    // Close the input file.
+    // Lex a range of characters in memory, starting at the beginning of a line.
+    // `line_number_offset` is the number of lines preceding the range, used to
+    // report line numbers relative to the whole file.
+    void open(
+        const char*         begin,
+        const char*         end,
+        const size_t        line_number_offset)
+    {
+        assert(begin);
+        assert(begin <= end);
+
+        m_eof = false;
+        m_line_number = line_number_offset;
+        m_line_size = 0;
+        m_line_index = 0;
+
+        m_input = begin;
+        m_input_end = end;
+
+        read_next_line();
+    }
+
+    // Close the input file or forget the input range.
     void close()
     {
         m_file.close();
+
+        m_input = nullptr;
+        m_input_end = nullptr;
+    }
+
+    // Return true if an input file or an input range is open.
+    bool is_open() const
+    {
+        return m_input != nullptr || m_file.is_open();
     }
 
     // Return the position of the current line in the file.
     size_t get_line_number() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_number;
     }
@@ -112,7 +146,7 @@ class OBJMeshFileLexer
     // Return the current character in the line.
     APPLESEED_FORCE_INLINE unsigned char get_char() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size ? '\n' : m_line[m_line_index];
     }
@@ -120,7 +154,7 @@ class OBJMeshFileLexer
     // Advance to the next character in the line.
     APPLESEED_FORCE_INLINE void next_char()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (m_line_index < m_line_size)
             ++m_line_index;
@@ -140,7 +174,7 @@ class OBJMeshFileLexer
     // Return true if the end of the line has been reached.
     APPLESEED_FORCE_INLINE bool is_eol() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size;
     }
@@ -148,7 +182,7 @@ class OBJMeshFileLexer
     // Return true if the end of the file has been reached.
     APPLESEED_FORCE_INLINE bool is_eof() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_eof && is_eol();
     }
@@ -156,7 +190,7 @@ class OBJMeshFileLexer
     // Eat blank characters and comments.
     void eat_blanks()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         while (true)
         {
@@ -191,7 +225,7 @@ class OBJMeshFileLexer
     // Accept a end-of-line character, or generate a parse error.
     void accept_newline()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (!is_eol())
             parse_error();
@@ -202,7 +236,7 @@ class OBJMeshFileLexer
     // Accept a string of non-blank characters, or generate a parse error.
     void accept_string(const char** begin, size_t* length)
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (is_eof())
             parse_error();
@@ -235,7 +269,7 @@ class OBJMeshFileLexer
     // Accept a long integer, or generate a parse error.
     APPLESEED_FORCE_INLINE long accept_long()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read an integer value at the current position in the line.
         const char* base_ptr = &m_line[0];
@@ -254,7 +288,7 @@ class OBJMeshFileLexer
     // Accept a double-precision floating point number, or generate a parse error.
     APPLESEED_FORCE_INLINE double accept_double()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read a floating-point value at the current position in the line.
         char* base_ptr = &m_line[0];
@@ -278,6 +312,8 @@ class OBJMeshFileLexer
     const ParsingMode   m_parsing_mode;     // parsing mode for floating-point values
     bool                m_is_space[256];    // precomputed values of std::isspace(c) for all c
     BufferedFile        m_file;
+    const char*         m_input;            // next character of the input range, if lexing from memory
+    const char*         m_input_end;        // end of the input range, if lexing from memory
     bool                m_eof;              // has the end of the file been reached?
     size_t              m_line_number;      // position of the current line in the file
     std::vector<char>   m_line;             // current line
@@ -287,14 +323,21 @@ class OBJMeshFileLexer
     // Close the input file and throw an ExceptionParseError exception.
     void parse_error()
     {
-        m_file.close();
-        throw OBJMeshFileReader::ExceptionParseError(m_line_number);
+        const size_t line_number = m_line_number;
+        close();
+        throw OBJMeshFileReader::ExceptionParseError(line_number);
     }
 
-    // Read the next line from the input file.
+    // Read the next line from the input file or range.
     void read_next_line()
     {
-        assert(m_file.is_open());
+        assert(is_open());
+
+        if (m_input != nullptr)
+        {
+            read_next_line_from_memory();
+            return;
+        }
 
         m_line_size = 0;
 
@@ -325,6 +368,39 @@ class OBJMeshFileLexer
         // Append a null terminator.
         m_line[m_line_size] = 0;
     }
+
+    // Read the next line from the input range. Lines are not limited in length.
+    void read_next_line_from_memory()
+    {
+        m_line_size = 0;
+
+        if (!m_eof)
+        {
+            ++m_line_number;
+
+            const char* line_end =
+                static_cast<const char*>(std::memchr(m_input, '\n', m_input_end - m_input));
+
+            if (line_end == nullptr)
+            {
+                // Reached the end of the range.
+                line_end = m_input_end;
+                m_eof = true;
+            }
+
+            m_line_size = line_end - m_input;
+
+            if (m_line_size + 1 > m_line.size())
+                m_line.resize(m_line_size + 1);
+
+            std::memcpy(&m_line[0], m_input, m_line_size);
+
+            m_input = m_eof ? m_input_end : line_end + 1;
+        }
+
+        // Append a null terminator.
+        m_line[m_line_size] = 0;
+    }
 };
 
 }   // namespace foundation
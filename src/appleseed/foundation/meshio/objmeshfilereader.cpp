@@ -36,10 +36,19 @@
 #include "foundation/memory/memory.h"
 #include "foundation/meshio/imeshbuilder.h"
 #include "foundation/meshio/objmeshfilelexer.h"
+#include "foundation/platform/memorymappedfile.h"
+#include "foundation/utility/job.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
 #include <cstring>
+#include <exception>
 #include <map>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -53,14 +62,55 @@ namespace foundation
 namespace
 {
     const size_t Undefined = ~size_t(0);
+
+    // Files smaller than two chunks are parsed on the calling thread.
+    const size_t MinChunkSize = 1024 * 1024;
+
+    // Larger files are split into more chunks, so that fewer statements are recorded at once.
+    const size_t MaxChunkSize = 16 * 1024 * 1024;
+
+    // Number of chunks per worker thread, for load balancing.
+    const size_t ChunksPerThread = 4;
+
+    // Number of chunks per worker thread parsed while the previous chunks are being replayed.
+    const size_t ChunksPerThreadInFlight = 2;
+
+    // A face recorded while parsing a chunk. Its feature indices are
+    // stored in the chunk's index array, relative to the whole file.
+    struct RecordedFace
+    {
+        std::uint32_t   m_vertex_count;
+        bool            m_has_tex_coords;
+        bool            m_has_normals;
+    };
+
+    // An 'o', 'g' or 'usemtl' statement recorded while parsing a chunk.
+    struct RecordedStatement
+    {
+        enum Type { MeshName, MaterialSlot };
+
+        Type            m_type;
+        size_t          m_face_count;           // number of faces of the chunk preceding this statement
+        std::string     m_name;
+    };
 }
 
 struct OBJMeshFileReader::Impl
 {
     const int                         m_options;
-    IMeshBuilder&                     m_builder;
+    IMeshBuilder*                     m_builder;                      // null when recording a chunk
     OBJMeshFileLexer                  m_lexer;
 
+    // Number of features defined before the parsed range (nonzero only when recording a chunk).
+    size_t                            m_vertex_base;
+    size_t                            m_tex_coord_base;
+    size_t                            m_normal_base;
+
+    // Statements recorded while parsing a chunk.
+    std::vector<RecordedFace>         m_recorded_faces;
+    std::vector<size_t>               m_recorded_indices;
+    std::vector<RecordedStatement>    m_recorded_statements;
+
     // Current state.
     bool                              m_inside_mesh_def;              // currently inside a mesh definition?
     std::string                       m_current_mesh_name;            // name of the current mesh
@@ -82,16 +132,19 @@ struct OBJMeshFileReader::Impl
     std::vector<size_t>               m_face_tex_coord_indices;
     std::vector<size_t>               m_face_normal_indices;
 
-    // Constructor.
+    // Constructor. Pass a null builder to record statements instead of building meshes.
     Impl(
         const int           options,
-        IMeshBuilder&       builder)
+        IMeshBuilder*       builder)
       : m_options(options)
       , m_builder(builder)
       , m_lexer(
             (options & FavorSpeedOverPrecision)
                 ? OBJMeshFileLexer::Fast
                 : OBJMeshFileLexer::Precise)
+      , m_vertex_base(0)
+      , m_tex_coord_base(0)
+      , m_normal_base(0)
       , m_inside_mesh_def(false)
       , m_current_material_slot_index(0)
     {
@@ -187,7 +240,12 @@ struct OBJMeshFileReader::Impl
 
         // End the definition of the last object.
         if (m_inside_mesh_def)
-            m_builder.end_mesh();
+            m_builder->end_mesh();
+    }
+
+    bool is_recording() const
+    {
+        return m_builder == nullptr;
     }
 
     void parse_f_statement()
@@ -210,7 +268,7 @@ struct OBJMeshFileReader::Impl
 
             {
                 const long n = m_lexer.accept_long();
-                const size_t v = fix_index(n, m_vertices.size());
+                const size_t v = fix_index(n, m_vertex_base + m_vertices.size());
                 m_face_vertex_indices.push_back(v);
             }
 
@@ -243,7 +301,7 @@ struct OBJMeshFileReader::Impl
                 else
                 {
                     const long n = m_lexer.accept_long();
-                    const size_t vt = fix_index(n, m_tex_coords.size());
+                    const size_t vt = fix_index(n, m_tex_coord_base + m_tex_coords.size());
                     m_face_tex_coord_indices.push_back(vt);
                 }
             }
@@ -276,7 +334,7 @@ struct OBJMeshFileReader::Impl
                 else
                 {
                     const long n = m_lexer.accept_long();
-                    const size_t vn = fix_index(n, m_normals.size());
+                    const size_t vn = fix_index(n, m_normal_base + m_normals.size());
                     m_face_normal_indices.push_back(vn);
                 }
             }
@@ -294,7 +352,9 @@ struct OBJMeshFileReader::Impl
         if (well_formed)
         {
             // The face is well-formed, insert it into the mesh.
-            insert_face_into_mesh();
+            if (is_recording())
+                record_face();
+            else insert_face_into_mesh();
         }
         else
         {
@@ -328,6 +388,81 @@ struct OBJMeshFileReader::Impl
         }
     }
 
+    void record_face()
+    {
+        RecordedFace face;
+        face.m_vertex_count = static_cast<std::uint32_t>(m_face_vertex_indices.size());
+        face.m_has_tex_coords = !m_face_tex_coord_indices.empty();
+        face.m_has_normals = !m_face_normal_indices.empty();
+        m_recorded_faces.push_back(face);
+
+        m_recorded_indices.insert(m_recorded_indices.end(), m_face_vertex_indices.begin(), m_face_vertex_indices.end());
+        m_recorded_indices.insert(m_recorded_indices.end(), m_face_tex_coord_indices.begin(), m_face_tex_coord_indices.end());
+        m_recorded_indices.insert(m_recorded_indices.end(), m_face_normal_indices.begin(), m_face_normal_indices.end());
+    }
+
+    void record_statement(const RecordedStatement::Type type, const std::string& name)
+    {
+        RecordedStatement statement;
+        statement.m_type = type;
+        statement.m_face_count = m_recorded_faces.size();
+        statement.m_name = name;
+        m_recorded_statements.push_back(statement);
+    }
+
+    // Replay the statements recorded by a chunk parser, whose features have already been appended to ours.
+    void replay(const Impl& chunk)
+    {
+        size_t index = 0;
+        size_t statement_index = 0;
+
+        for (size_t i = 0, e = chunk.m_recorded_faces.size(); i < e; ++i)
+        {
+            while (statement_index < chunk.m_recorded_statements.size() &&
+                   chunk.m_recorded_statements[statement_index].m_face_count == i)
+                replay_statement(chunk.m_recorded_statements[statement_index++]);
+
+            const RecordedFace& face = chunk.m_recorded_faces[i];
+            const size_t* indices = &chunk.m_recorded_indices[index];
+            const size_t n = face.m_vertex_count;
+
+            m_face_vertex_indices.assign(indices, indices + n);
+            indices += n;
+
+            clear_keep_memory(m_face_tex_coord_indices);
+            if (face.m_has_tex_coords)
+            {
+                m_face_tex_coord_indices.assign(indices, indices + n);
+                indices += n;
+            }
+
+            clear_keep_memory(m_face_normal_indices);
+            if (face.m_has_normals)
+            {
+                m_face_normal_indices.assign(indices, indices + n);
+                indices += n;
+            }
+
+            index = indices - &chunk.m_recorded_indices[0];
+
+            insert_face_into_mesh();
+        }
+
+        while (statement_index < chunk.m_recorded_statements.size())
+            replay_statement(chunk.m_recorded_statements[statement_index++]);
+    }
+
+    void replay_statement(const RecordedStatement& statement)
+    {
+        if (statement.m_type == RecordedStatement::MeshName)
+            set_mesh_name(statement.m_name);
+        else
+        {
+            ensure_mesh_def();
+            set_material_slot(statement.m_name);
+        }
+    }
+
     void insert_face_into_mesh()
     {
         // Begin a mesh definition if we're not already inside one.
@@ -346,24 +481,24 @@ struct OBJMeshFileReader::Impl
         const size_t n = m_face_vertex_indices.size();
 
         // Begin defining a new face.
-        m_builder.begin_face(n);
+        m_builder->begin_face(n);
 
         // Set face vertices.
-        m_builder.set_face_vertices(&m_face_vertex_indices.front());
+        m_builder->set_face_vertices(&m_face_vertex_indices.front());
 
         // Set face vertex normals (if any).
         if (m_face_normal_indices.size() == n)
-            m_builder.set_face_vertex_normals(&m_face_normal_indices.front());
+            m_builder->set_face_vertex_normals(&m_face_normal_indices.front());
 
         // Set face vertex texture coordinates (if any).
         if (m_face_tex_coord_indices.size() == n)
-            m_builder.set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
+            m_builder->set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
 
         // Set face material.
-        m_builder.set_face_material(m_current_material_slot_index);
+        m_builder->set_face_material(m_current_material_slot_index);
 
         // End defining the face.
-        m_builder.end_face();
+        m_builder->end_face();
     }
 
     void insert_vertices_into_mesh()
@@ -375,7 +510,7 @@ struct OBJMeshFileReader::Impl
             const size_t vertex_index = m_face_vertex_indices[i];
             ensure_minimum_size(m_vertex_index_mapping, vertex_index + 1, Undefined);
             if (m_vertex_index_mapping[vertex_index] == Undefined)
-                m_vertex_index_mapping[vertex_index] = m_builder.push_vertex(m_vertices[vertex_index]);
+                m_vertex_index_mapping[vertex_index] = m_builder->push_vertex(m_vertices[vertex_index]);
         }
     }
 
@@ -388,7 +523,7 @@ struct OBJMeshFileReader::Impl
             const size_t normal_index = m_face_normal_indices[i];
             ensure_minimum_size(m_normal_index_mapping, normal_index + 1, Undefined);
             if (m_normal_index_mapping[normal_index] == Undefined)
-                m_normal_index_mapping[normal_index] = m_builder.push_vertex_normal(m_normals[normal_index]);
+                m_normal_index_mapping[normal_index] = m_builder->push_vertex_normal(m_normals[normal_index]);
         }
     }
 
@@ -401,7 +536,7 @@ struct OBJMeshFileReader::Impl
             const size_t tex_coord_index = m_face_tex_coord_indices[i];
             ensure_minimum_size(m_tex_coord_index_mapping, tex_coord_index + 1, Undefined);
             if (m_tex_coord_index_mapping[tex_coord_index] == Undefined)
-                m_tex_coord_index_mapping[tex_coord_index] = m_builder.push_tex_coords(m_tex_coords[tex_coord_index]);
+                m_tex_coord_index_mapping[tex_coord_index] = m_builder->push_tex_coords(m_tex_coords[tex_coord_index]);
         }
     }
 
@@ -420,13 +555,20 @@ struct OBJMeshFileReader::Impl
         // Retrieve the name of the upcoming mesh.
         const std::string upcoming_mesh_name = parse_compound_identifier();
 
+        if (is_recording())
+            record_statement(RecordedStatement::MeshName, upcoming_mesh_name);
+        else set_mesh_name(upcoming_mesh_name);
+    }
+
+    void set_mesh_name(const std::string& upcoming_mesh_name)
+    {
         // Start a new mesh only if the name of the object or group actually changes.
         if (upcoming_mesh_name != m_current_mesh_name)
         {
             // End the current mesh.
             if (m_inside_mesh_def)
             {
-                m_builder.end_mesh();
+                m_builder->end_mesh();
                 m_inside_mesh_def = false;
             }
 
@@ -518,12 +660,21 @@ struct OBJMeshFileReader::Impl
 
     void parse_usemtl_statement()
     {
+        if (is_recording())
+        {
+            record_statement(RecordedStatement::MaterialSlot, parse_compound_identifier());
+            return;
+        }
+
         // Begin a mesh definition if we're not already inside one.
         ensure_mesh_def();
 
         // Retrieve the name of the material slot.
-        const std::string material_slot_name = parse_compound_identifier();
+        set_material_slot(parse_compound_identifier());
+    }
 
+    void set_material_slot(const std::string& material_slot_name)
+    {
         // Check whether this material slot has already been defined for this mesh.
         const std::map<std::string, size_t>::const_iterator& it =
             m_material_slots.find(material_slot_name);
@@ -536,7 +687,7 @@ struct OBJMeshFileReader::Impl
         else
         {
             // It hasn't: insert it into the mesh and make it the active material slot.
-            m_current_material_slot_index = m_builder.push_material_slot(material_slot_name.c_str());
+            m_current_material_slot_index = m_builder->push_material_slot(material_slot_name.c_str());
             m_material_slots.insert(std::make_pair(material_slot_name, m_current_material_slot_index));
         }
     }
@@ -546,7 +697,7 @@ struct OBJMeshFileReader::Impl
         if (!m_inside_mesh_def)
         {
             // Begin the definition of the new mesh.
-            m_builder.begin_mesh(m_current_mesh_name.c_str());
+            m_builder->begin_mesh(m_current_mesh_name.c_str());
             m_inside_mesh_def = true;
 
             // Clear material slot definitions.
@@ -554,19 +705,275 @@ struct OBJMeshFileReader::Impl
             m_current_material_slot_index = 0;
         }
     }
+
+    struct Chunk;
+    class CountJob;
+    class ParseJob;
+
+    // Parse a file mapped in memory by splitting it into chunks of lines that are parsed concurrently.
+    void parse_file_in_parallel(
+        const char*         data,
+        const size_t        size,
+        Logger&             logger,
+        const size_t        thread_count);
+};
+
+// A range of lines of the input file, parsed by a worker thread.
+struct OBJMeshFileReader::Impl::Chunk
+{
+    const char*                 m_begin;
+    const char*                 m_end;
+
+    // Number of lines and feature statements in the chunk.
+    size_t                      m_line_count;
+    size_t                      m_vertex_count;
+    size_t                      m_tex_coord_count;
+    size_t                      m_normal_count;
+
+    // Parser recording the statements of the chunk, and the error it stopped on, if any.
+    std::unique_ptr<Impl>       m_parser;
+    std::exception_ptr          m_error;
+
+    Chunk(const char* begin, const char* end)
+      : m_begin(begin)
+      , m_end(end)
+      , m_line_count(0)
+      , m_vertex_count(0)
+      , m_tex_coord_count(0)
+      , m_normal_count(0)
+    {
+    }
+};
+
+// Count the lines and the 'v', 'vt' and 'vn' statements of a chunk, the way the parser recognizes them.
+class OBJMeshFileReader::Impl::CountJob
+  : public IJob
+{
+  public:
+    explicit CountJob(Chunk& chunk)
+      : m_chunk(chunk)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        const char* end = m_chunk.m_end;
+
+        for (const char* p = m_chunk.m_begin; p < end; )
+        {
+            while (p < end && *p != '\n' && is_space(*p))
+                ++p;
+
+            if (p < end && p[0] == 'v')
+            {
+                if (is_keyword_end(p + 1, end))
+                    ++m_chunk.m_vertex_count;
+                else if (p + 1 < end && p[1] == 't' && is_keyword_end(p + 2, end))
+                    ++m_chunk.m_tex_coord_count;
+                else if (p + 1 < end && p[1] == 'n' && is_keyword_end(p + 2, end))
+                    ++m_chunk.m_normal_count;
+            }
+
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+
+            if (newline == nullptr)
+                break;
+
+            ++m_chunk.m_line_count;
+            p = newline + 1;
+        }
+    }
+
+  private:
+    Chunk& m_chunk;
+
+    static bool is_space(const char c)
+    {
+        return std::isspace(static_cast<unsigned char>(c)) != 0;
+    }
+
+    static bool is_keyword_end(const char* p, const char* end)
+    {
+        return p == end || is_space(*p);
+    }
+};
+
+// Parse a chunk, recording its statements.
+class OBJMeshFileReader::Impl::ParseJob
+  : public IJob
+{
+  public:
+    ParseJob(Chunk& chunk, const size_t line_number_offset)
+      : m_chunk(chunk)
+      , m_line_number_offset(line_number_offset)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        try
+        {
+            Impl& parser = *m_chunk.m_parser;
+            parser.m_lexer.open(m_chunk.m_begin, m_chunk.m_end, m_line_number_offset);
+            parser.parse_file();
+            parser.m_lexer.close();
+        }
+        catch (...)
+        {
+            m_chunk.m_error = std::current_exception();
+        }
+    }
+
+  private:
+    Chunk&          m_chunk;
+    const size_t    m_line_number_offset;
 };
 
+void OBJMeshFileReader::Impl::parse_file_in_parallel(
+    const char*             data,
+    const size_t            size,
+    Logger&                 logger,
+    const size_t            thread_count)
+{
+    const size_t chunk_size =
+        std::min(MaxChunkSize, std::max(MinChunkSize, size / (thread_count * ChunksPerThread)));
+
+    // Split the input into chunks of whole lines.
+    std::vector<Chunk> chunks;
+    const char* end = data + size;
+    for (const char* begin = data; begin < end; )
+    {
+        const char* chunk_end = begin + std::min(chunk_size, static_cast<size_t>(end - begin));
+
+        if (chunk_end < end)
+        {
+            const char* newline = static_cast<const char*>(std::memchr(chunk_end - 1, '\n', end - chunk_end + 1));
+            chunk_end = newline != nullptr ? newline + 1 : end;
+        }
+
+        chunks.emplace_back(begin, chunk_end);
+        begin = chunk_end;
+    }
+
+    // Jobs never throw; errors are stored in their chunk.
+    JobQueue job_queue;
+    JobManager job_manager(logger, job_queue, thread_count, JobManager::KeepRunningOnEmptyQueue);
+    job_manager.start();
+
+    for (size_t i = 0, e = chunks.size(); i < e; ++i)
+        job_queue.schedule(new CountJob(chunks[i]));
+
+    job_queue.wait_until_completion();
+
+    // Now that the number of lines and features preceding each chunk is known,
+    // chunks can resolve relative indices and report line numbers on their own.
+    std::vector<size_t> line_number_offsets(chunks.size());
+    size_t line_number_offset = 0;
+    size_t vertex_base = 0;
+    size_t tex_coord_base = 0;
+    size_t normal_base = 0;
+
+    for (size_t i = 0, e = chunks.size(); i < e; ++i)
+    {
+        Chunk& chunk = chunks[i];
+
+        chunk.m_parser.reset(new Impl(m_options, nullptr));
+        chunk.m_parser->m_vertex_base = vertex_base;
+        chunk.m_parser->m_tex_coord_base = tex_coord_base;
+        chunk.m_parser->m_normal_base = normal_base;
+        line_number_offsets[i] = line_number_offset;
+
+        line_number_offset += chunk.m_line_count;
+        vertex_base += chunk.m_vertex_count;
+        tex_coord_base += chunk.m_tex_coord_count;
+        normal_base += chunk.m_normal_count;
+    }
+
+    m_vertices.reserve(vertex_base);
+    m_tex_coords.reserve(tex_coord_base);
+    m_normals.reserve(normal_base);
+
+    // Parse the chunks in batches and feed the builder in file order: the statements of a batch are
+    // replayed on this thread while the next batch is being parsed, then released. A chunk only
+    // references features defined before its end.
+    const size_t batch_size = thread_count * ChunksPerThreadInFlight;
+
+    for (size_t i = 0, e = std::min(batch_size, chunks.size()); i < e; ++i)
+        job_queue.schedule(new ParseJob(chunks[i], line_number_offsets[i]));
+
+    for (size_t batch_begin = 0; batch_begin < chunks.size(); batch_begin += batch_size)
+    {
+        const size_t batch_end = std::min(batch_begin + batch_size, chunks.size());
+
+        job_queue.wait_until_completion();
+
+        // Report the first error in file order.
+        for (size_t i = batch_begin; i < batch_end; ++i)
+        {
+            if (chunks[i].m_error)
+                std::rethrow_exception(chunks[i].m_error);
+        }
+
+        for (size_t i = batch_end, e = std::min(batch_end + batch_size, chunks.size()); i < e; ++i)
+            job_queue.schedule(new ParseJob(chunks[i], line_number_offsets[i]));
+
+        for (size_t i = batch_begin; i < batch_end; ++i)
+        {
+            Impl& parser = *chunks[i].m_parser;
+
+            m_vertices.insert(m_vertices.end(), parser.m_vertices.begin(), parser.m_vertices.end());
+            m_tex_coords.insert(m_tex_coords.end(), parser.m_tex_coords.begin(), parser.m_tex_coords.end());
+            m_normals.insert(m_normals.end(), parser.m_normals.begin(), parser.m_normals.end());
+
+            replay(parser);
+
+            chunks[i].m_parser.reset();
+        }
+    }
+
+    // End the definition of the last object.
+    if (m_inside_mesh_def)
+        m_builder->end_mesh();
+}
+
 OBJMeshFileReader::OBJMeshFileReader(
     const std::string&   filename,
     const int            options)
   : m_filename(filename)
   , m_options(options)
+  , m_logger(nullptr)
+  , m_thread_count(0)
 {
 }
 
+void OBJMeshFileReader::enable_parallel_parsing(
+    Logger&                 logger,
+    const size_t            thread_count)
+{
+    assert(thread_count > 0);
+
+    m_logger = &logger;
+    m_thread_count = thread_count;
+}
+
 void OBJMeshFileReader::read(IMeshBuilder& builder)
 {
-    Impl impl(m_options, builder);
+    Impl impl(m_options, &builder);
+
+    // Parse large files on multiple threads.
+    if (m_logger != nullptr)
+    {
+        MemoryMappedFile file;
+        if (file.open(m_filename.c_str()) && file.size() >= 2 * MinChunkSize)
+        {
+            impl.parse_file_in_parallel(
+                static_cast<const char*>(file.data()),
+                file.size(),
+                *m_logger,
+                m_thread_count);
+            return;
+        }
+    }
 
     // Open the input file.
     if (!impl.m_lexer.open(m_filename))
@@ -40,6 +40,7 @@
 
 // Forward declarations.
 namespace foundation    { class IMeshBuilder; }
+namespace foundation    { class Logger; }
 
 namespace foundation
 {
@@ -90,6 +91,12 @@ class OBJMeshFileReader
         const std::string&  filename,
         const int           options = Default);
 
+    // Parse files of a few megabytes or more on `thread_count` worker threads, which report
+    // their errors to `logger`. By default, files are parsed on the calling thread.
+    void enable_parallel_parsing(
+        Logger&             logger,
+        const size_t        thread_count);
+
     // Read a mesh.
     void read(IMeshBuilder& builder) override;
 
@@ -98,6 +105,8 @@ class OBJMeshFileReader
 
     const std::string       m_filename;
     const int               m_options;
+    Logger*                 m_logger;
+    size_t                  m_thread_count;
 };
 
 }   // namespace foundation
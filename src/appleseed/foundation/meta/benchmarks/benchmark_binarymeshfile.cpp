@@ -0,0 +1,246 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/meshio/binarymeshfilereader.h"
+#include "foundation/meshio/binarymeshfilewriter.h"
+#include "foundation/meshio/imeshwalker.h"
+#include "foundation/meshio/mappedbinarymeshfile.h"
+#include "foundation/meshio/meshbuilderbase.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace foundation;
+
+BENCHMARK_SUITE(Foundation_Mesh_BinaryMeshFile)
+{
+    const size_t GridSize = 256;
+
+    // A flat grid of GridSize x GridSize quads, each split into two triangles.
+    struct GridMeshWalker
+      : public IMeshWalker
+    {
+        const char* get_name() const override
+        {
+            return "grid";
+        }
+
+        size_t get_vertex_count() const override
+        {
+            return (GridSize + 1) * (GridSize + 1);
+        }
+
+        Vector3d get_vertex(const size_t i) const override
+        {
+            return Vector3d(
+                static_cast<double>(i % (GridSize + 1)),
+                static_cast<double>(i / (GridSize + 1)),
+                0.0);
+        }
+
+        size_t get_vertex_normal_count() const override
+        {
+            return get_vertex_count();
+        }
+
+        Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return Vector3d(0.0, 0.0, 1.0);
+        }
+
+        size_t get_tex_coords_count() const override
+        {
+            return get_vertex_count();
+        }
+
+        Vector2d get_tex_coords(const size_t i) const override
+        {
+            const Vector3d v = get_vertex(i);
+            return Vector2d(v[0], v[1]) / static_cast<double>(GridSize);
+        }
+
+        size_t get_material_slot_count() const override
+        {
+            return 0;
+        }
+
+        const char* get_material_slot(const size_t i) const override
+        {
+            return nullptr;
+        }
+
+        size_t get_face_count() const override
+        {
+            return 2 * GridSize * GridSize;
+        }
+
+        size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return 3;
+        }
+
+        size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            const size_t quad = face_index / 2;
+            const size_t v00 = (quad / GridSize) * (GridSize + 1) + quad % GridSize;
+            const size_t v10 = v00 + 1;
+            const size_t v01 = v00 + GridSize + 1;
+            const size_t v11 = v01 + 1;
+
+            const size_t Lower[3] = { v00, v10, v11 };
+            const size_t Upper[3] = { v00, v11, v01 };
+
+            return (face_index % 2 == 0 ? Lower : Upper)[vertex_index];
+        }
+
+        size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            return get_face_vertex(face_index, vertex_index);
+        }
+
+        size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            return get_face_vertex(face_index, vertex_index);
+        }
+
+        size_t get_face_material(const size_t face_index) const override
+        {
+            return 0;
+        }
+    };
+
+    // Store meshes the way renderer::MeshObject does.
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        std::vector<Vector3f>       m_vertices;
+        std::vector<Vector3f>       m_vertex_normals;
+        std::vector<Vector2f>       m_tex_coords;
+        std::vector<std::uint32_t>  m_triangles;
+
+        void clear()
+        {
+            m_vertices.clear();
+            m_vertex_normals.clear();
+            m_tex_coords.clear();
+            m_triangles.clear();
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_vertices.emplace_back(v);
+            return m_vertices.size() - 1;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_vertex_normals.emplace_back(v);
+            return m_vertex_normals.size() - 1;
+        }
+
+        size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_tex_coords.emplace_back(v);
+            return m_tex_coords.size() - 1;
+        }
+
+        void set_face_vertices(const size_t vertices[]) override
+        {
+            for (size_t i = 0; i < 3; ++i)
+                m_triangles.push_back(static_cast<std::uint32_t>(vertices[i]));
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            for (size_t i = 0; i < 3; ++i)
+                m_triangles.push_back(static_cast<std::uint32_t>(vertex_normals[i]));
+        }
+
+        void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            for (size_t i = 0; i < 3; ++i)
+                m_triangles.push_back(static_cast<std::uint32_t>(tex_coords[i]));
+        }
+
+        void set_face_material(const size_t material) override
+        {
+            m_triangles.push_back(static_cast<std::uint32_t>(material));
+        }
+
+        void insert_mapped_mesh(const MappedBinaryMeshFile::Mesh& mesh)
+        {
+            m_vertices.assign(mesh.m_vertices, mesh.m_vertices + mesh.m_vertex_count);
+            m_vertex_normals.assign(mesh.m_vertex_normals, mesh.m_vertex_normals + mesh.m_vertex_normal_count);
+            m_tex_coords.assign(mesh.m_tex_coords, mesh.m_tex_coords + mesh.m_tex_coords_count);
+            m_triangles.assign(
+                mesh.m_triangles,
+                mesh.m_triangles + mesh.m_triangle_count * MappedBinaryMeshFile::TriangleSize);
+        }
+    };
+
+    const char* CompressedFilename = "unit benchmarks/outputs/benchmark_binarymeshfile_compressed.binarymesh";
+    const char* PageAlignedFilename = "unit benchmarks/outputs/benchmark_binarymeshfile_pagealigned.binarymesh";
+
+    struct Fixture
+    {
+        MeshBuilder m_builder;
+
+        Fixture()
+        {
+            const GridMeshWalker walker;
+
+            BinaryMeshFileWriter compressed_writer(CompressedFilename);
+            compressed_writer.write(walker);
+
+            BinaryMeshFileWriter page_aligned_writer(PageAlignedFilename, BinaryMeshFileWriter::PageAligned);
+            page_aligned_writer.write(walker);
+        }
+    };
+
+    BENCHMARK_CASE_F(ReadLZ4CompressedFile, Fixture)
+    {
+        m_builder.clear();
+
+        BinaryMeshFileReader reader(CompressedFilename);
+        reader.read(m_builder);
+    }
+
+    BENCHMARK_CASE_F(ReadMemoryMappedPageAlignedFile, Fixture)
+    {
+        m_builder.clear();
+
+        const MappedBinaryMeshFile file(PageAlignedFilename);
+        m_builder.insert_mapped_mesh(file.get_mesh(0));
+    }
+}
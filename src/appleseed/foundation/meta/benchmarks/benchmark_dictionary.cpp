@@ -0,0 +1,87 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/string/internedstring.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/benchmark.h"
+
+using namespace foundation;
+
+BENCHMARK_SUITE(Foundation_Utility_StringDictionary)
+{
+    struct Fixture
+    {
+        StringDictionary        m_dictionary;
+        const InternedString    m_key;
+        float                   m_dummy;
+
+        Fixture()
+          : m_key("roughness")
+          , m_dummy(0.0f)
+        {
+            // A typical set of entity parameters.
+            m_dictionary.insert("alpha_map", "0.5");
+            m_dictionary.insert("anisotropy", "0.0");
+            m_dictionary.insert("base_color", "0.8");
+            m_dictionary.insert("ior", "1.5");
+            m_dictionary.insert("metallic", "0.0");
+            m_dictionary.insert("roughness", "0.35");
+            m_dictionary.insert("sheen", "0.0");
+            m_dictionary.insert("specular", "0.5");
+        }
+    };
+
+    BENCHMARK_CASE_F(Exist, Fixture)
+    {
+        m_dummy += m_dictionary.exist("roughness") ? 1.0f : 0.0f;
+    }
+
+    BENCHMARK_CASE_F(GetAsString_ParseValue, Fixture)
+    {
+        m_dummy += from_string<float>(m_dictionary.get("roughness"));
+    }
+
+    BENCHMARK_CASE_F(GetAsFloat, Fixture)
+    {
+        m_dummy += m_dictionary.get<float>("roughness");
+    }
+
+    BENCHMARK_CASE_F(GetAsFloat_InternedKey, Fixture)
+    {
+        m_dummy += m_dictionary.get<float>(m_key);
+    }
+
+    BENCHMARK_CASE_F(CopyAndGetAsFloat, Fixture)
+    {
+        const StringDictionary copy(m_dictionary);
+        m_dummy += copy.get<float>("roughness");
+    }
+}
@@ -231,6 +231,7 @@ namespace
             {
                 knn::Builder3f builder(m_tree);
                 builder.build<DefaultWallclockTimer>(&m_points[0], m_points.size());
+                builder.build_point_blocks();
 
                 LOG_DEBUG(
                     m_logger, "%s",
@@ -406,3 +407,82 @@ BENCHMARK_SUITE(Foundation_Math_Knn_AnyQuery)
     BENCHMARK_CASE_F(Particles_RandomQueryPoints, ParticlesFixture) { run_queries(); }
     BENCHMARK_CASE_F(PhotonMap_RandomQueryPoints, PhotonMapFixture) { run_queries(); }
 }
+
+BENCHMARK_SUITE(Foundation_Math_Knn_GatherQuery)
+{
+    // Compare gathering all the points within a fixed radius and accumulating
+    // their contributions with knn::Query (bounded sorted answer) and knn::GatherQuery.
+
+    class Fixture
+      : public FixtureBase
+    {
+      public:
+        explicit Fixture(const std::string& benchmark_name, const std::string& dataset_filepath)
+          : FixtureBase(benchmark_name, dataset_filepath)
+          , m_answer(MaxAnswerSize)
+        {
+            m_query_max_square_distance = m_bbox.square_diameter() * square(0.01f);
+        }
+
+        void run_queries()
+        {
+            const knn::Query3f query(m_tree, m_answer);
+
+            for (const Vector3f& query_point : m_query_points)
+            {
+                query.run(query_point, m_query_max_square_distance);
+
+                for (std::size_t i = 0, e = m_answer.size(); i < e; ++i)
+                    m_accumulator += m_answer.get(i).m_square_dist;
+            }
+        }
+
+        void run_gather_queries()
+        {
+            const knn::GatherQuery3f query(m_tree);
+
+            auto visitor = [this](const std::size_t index, const float square_dist)
+            {
+                m_accumulator += square_dist;
+            };
+
+            for (const Vector3f& query_point : m_query_points)
+                query.run(query_point, m_query_max_square_distance, visitor);
+        }
+
+      private:
+        static const std::size_t MaxAnswerSize = 1000;
+
+        knn::Answer<float>      m_answer;
+        float                   m_query_max_square_distance;
+        float                   m_accumulator = 0.0f;
+    };
+
+    const std::size_t QueryPointCount = 100;
+
+    struct ParticlesFixture
+      : public Fixture
+    {
+        ParticlesFixture()
+          : Fixture("particles_gather", "unit benchmarks/inputs/test_knn_particles.bin")
+        {
+            establish_query_points_in_cloud(QueryPointCount);
+        }
+    };
+
+    struct PhotonMapFixture
+      : public Fixture
+    {
+        PhotonMapFixture()
+          : Fixture("photons_gather", "unit benchmarks/inputs/test_knn_photons.bin")
+        {
+            establish_query_points_in_cloud(QueryPointCount);
+        }
+    };
+
+    BENCHMARK_CASE_F(Particles_QueryPointsInCloud_Query, ParticlesFixture)          { run_queries(); }
+    BENCHMARK_CASE_F(Particles_QueryPointsInCloud_GatherQuery, ParticlesFixture)    { run_gather_queries(); }
+
+    BENCHMARK_CASE_F(PhotonMap_QueryPointsInCloud_Query, PhotonMapFixture)          { run_queries(); }
+    BENCHMARK_CASE_F(PhotonMap_QueryPointsInCloud_GatherQuery, PhotonMapFixture)    { run_gather_queries(); }
+}
@@ -0,0 +1,184 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/log/logger.h"
+#include "foundation/math/vector.h"
+#include "foundation/meshio/meshbuilderbase.h"
+#include "foundation/meshio/objmeshfilereader.h"
+#include "foundation/platform/system.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace foundation;
+
+BENCHMARK_SUITE(Foundation_Mesh_OBJMeshFileReader)
+{
+    // A grid of 2 x GridSize x GridSize triangles with positions, texture coordinates and
+    // normals, split into GroupCount objects. The resulting file weighs about 60 MB.
+    const size_t GridSize = 640;
+    const size_t GroupCount = 16;
+
+    // Store meshes the way renderer::MeshObject does.
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        std::vector<Vector3f>       m_vertices;
+        std::vector<Vector3f>       m_vertex_normals;
+        std::vector<Vector2f>       m_tex_coords;
+        std::vector<std::uint32_t>  m_triangles;
+
+        void clear()
+        {
+            m_vertices.clear();
+            m_vertex_normals.clear();
+            m_tex_coords.clear();
+            m_triangles.clear();
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_vertices.emplace_back(v);
+            return m_vertices.size() - 1;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_vertex_normals.emplace_back(v);
+            return m_vertex_normals.size() - 1;
+        }
+
+        size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_tex_coords.emplace_back(v);
+            return m_tex_coords.size() - 1;
+        }
+
+        void set_face_vertices(const size_t vertices[]) override
+        {
+            for (size_t i = 0; i < 3; ++i)
+                m_triangles.push_back(static_cast<std::uint32_t>(vertices[i]));
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            for (size_t i = 0; i < 3; ++i)
+                m_triangles.push_back(static_cast<std::uint32_t>(vertex_normals[i]));
+        }
+
+        void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            for (size_t i = 0; i < 3; ++i)
+                m_triangles.push_back(static_cast<std::uint32_t>(tex_coords[i]));
+        }
+
+        void set_face_material(const size_t material) override
+        {
+            m_triangles.push_back(static_cast<std::uint32_t>(material));
+        }
+    };
+
+    const char* Filename = "unit benchmarks/outputs/benchmark_objmeshfilereader.obj";
+
+    struct Fixture
+    {
+        Logger      m_logger;
+        MeshBuilder m_builder;
+
+        Fixture()
+        {
+            std::FILE* file = std::fopen(Filename, "wt");
+
+            if (file == nullptr)
+                return;
+
+            const size_t RowsPerGroup = GridSize / GroupCount;
+
+            for (size_t g = 0; g < GroupCount; ++g)
+            {
+                std::fprintf(file, "o grid_%u\n", static_cast<unsigned int>(g));
+
+                for (size_t y = 0; y <= RowsPerGroup; ++y)
+                {
+                    for (size_t x = 0; x <= GridSize; ++x)
+                    {
+                        const double fx = static_cast<double>(x) / GridSize;
+                        const double fy = static_cast<double>(g * RowsPerGroup + y) / GridSize;
+                        std::fprintf(file, "v %.6f %.6f %.6f\n", fx, fy, 0.1 * fx * fy);
+                        std::fprintf(file, "vt %.6f %.6f\n", fx, fy);
+                    }
+                }
+
+                std::fprintf(file, "vn 0 0 1\n");
+
+                for (size_t y = 0; y < RowsPerGroup; ++y)
+                {
+                    for (size_t x = 0; x < GridSize; ++x)
+                    {
+                        // Negative indices are relative to the end of the current group.
+                        const int v00 = -static_cast<int>((RowsPerGroup + 1 - y) * (GridSize + 1) - x);
+                        const int v10 = v00 + 1;
+                        const int v01 = v00 + static_cast<int>(GridSize + 1);
+                        const int v11 = v01 + 1;
+
+                        std::fprintf(
+                            file,
+                            "f %d/%d/-1 %d/%d/-1 %d/%d/-1\nf %d/%d/-1 %d/%d/-1 %d/%d/-1\n",
+                            v00, v00, v10, v10, v11, v11,
+                            v00, v00, v11, v11, v01, v01);
+                    }
+                }
+            }
+
+            std::fclose(file);
+        }
+    };
+
+    BENCHMARK_CASE_F(ReadFile_SingleThreaded, Fixture)
+    {
+        m_builder.clear();
+
+        OBJMeshFileReader reader(Filename);
+        reader.read(m_builder);
+    }
+
+    BENCHMARK_CASE_F(ReadFile_WithParallelParsing, Fixture)
+    {
+        m_builder.clear();
+
+        OBJMeshFileReader reader(Filename);
+        reader.enable_parallel_parsing(m_logger, System::get_logical_cpu_core_count());
+        reader.read(m_builder);
+    }
+}
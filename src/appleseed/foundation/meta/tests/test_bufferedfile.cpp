@@ -277,6 +277,42 @@ TEST_SUITE(Foundation_Utility_BufferedFile)
         EXPECT_EQ(Value2, value);
     }
 
+    TEST_CASE(TestSeekingBackwardInsideBufferWhileWriting_PreservesSubsequentData)
+    {
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::WriteMode,
+            4 * BufferSize);
+
+        const std::uint32_t Value1 = 0xDEADBEEFu;
+        file.write(Value1);
+
+        const std::uint32_t Value2 = 0xFADEBABEu;
+        file.write(Value2);
+
+        EXPECT_TRUE(file.seek(0, BufferedFile::SeekFromBeginning));
+
+        const std::uint32_t Value3 = 0x12345678u;
+        file.write(Value3);
+
+        file.close();
+
+        file.open(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode,
+            BufferSize);
+
+        std::uint32_t value;
+
+        EXPECT_EQ(4, file.read(value));
+        EXPECT_EQ(Value3, value);
+
+        EXPECT_EQ(4, file.read(value));
+        EXPECT_EQ(Value2, value);
+    }
+
     TEST_CASE(TestSeekingBackwardOutsideBufferWhileWriting)
     {
         BufferedFile file(
@@ -123,6 +123,84 @@ TEST_SUITE(Foundation_Utility_StringDictionary)
         });
     }
 
+    TEST_CASE(GetAsInt_GivenValueModifiedAfterFirstRetrieval_ReturnsModifiedValue)
+    {
+        StringDictionary sd;
+        sd.insert("key", 12);
+        APPLESEED_UNUSED const int first = sd.get<int>("key");
+
+        sd.set("key", 42);
+
+        EXPECT_EQ(42, sd.get<int>("key"));
+    }
+
+    TEST_CASE(GetAsInt_GivenValueReplacedAfterFirstRetrieval_ReturnsReplacedValue)
+    {
+        StringDictionary sd;
+        sd.insert("key", 12);
+        APPLESEED_UNUSED const int first = sd.get<int>("key");
+
+        sd.insert("key", 42);
+
+        EXPECT_EQ(42, sd.get<int>("key"));
+    }
+
+    TEST_CASE(GetAsDouble_GivenItemPreviouslyRetrievedAsString_ReturnsValue)
+    {
+        StringDictionary sd;
+        sd.insert("key", "1.5");
+
+        EXPECT_EQ("1.5", sd.get<std::string>("key"));
+        EXPECT_EQ(1.5, sd.get<double>("key"));
+        EXPECT_EQ("1.5", sd.get<std::string>("key"));
+    }
+
+    TEST_CASE(Get_GivenInternedStringKey_ReturnsValue)
+    {
+        StringDictionary sd;
+        sd.insert("key", 42);
+
+        EXPECT_EQ(42, sd.get<int>(InternedString("key")));
+        EXPECT_TRUE(sd.exist(InternedString("key")));
+    }
+
+    TEST_CASE(Get_GivenManyItems_ReturnsValues)
+    {
+        StringDictionary sd;
+
+        for (int i = 0; i < 100; ++i)
+            sd.insert(("key" + std::to_string(i)).c_str(), i);
+
+        for (int i = 0; i < 100; ++i)
+            EXPECT_EQ(i, sd.get<int>(("key" + std::to_string(i)).c_str()));
+    }
+
+    TEST_CASE(Iteration_GivenItemsInsertedInArbitraryOrder_VisitsItemsInKeyOrder)
+    {
+        StringDictionary sd;
+        sd.insert("c", "3");
+        sd.insert("a", "1");
+        sd.insert("b", "2");
+
+        StringDictionary::const_iterator i = sd.begin();
+        EXPECT_EQ(std::string("a"), i.key()); ++i;
+        EXPECT_EQ(std::string("b"), i.key()); ++i;
+        EXPECT_EQ(std::string("c"), i.key()); ++i;
+        EXPECT_TRUE(i == sd.end());
+    }
+
+    TEST_CASE(Insert_GivenValueOfOtherItem_KeepsOtherItemValueValid)
+    {
+        StringDictionary sd;
+        sd.insert("b", "value");
+        const char* value = sd.get("b");
+
+        sd.insert("a", value);
+
+        EXPECT_EQ(std::string("value"), sd.get("a"));
+        EXPECT_EQ(std::string("value"), value);
+    }
+
     TEST_CASE(Remove_GivenCStringKeyOfExistingItem_RemovesItem)
     {
         StringDictionary sd;
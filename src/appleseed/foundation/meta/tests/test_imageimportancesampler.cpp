@@ -85,6 +85,28 @@ TEST_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
         EXPECT_EQ(prob_xy, pdf);
     }
 
+    TEST_CASE(RebuildRows_GivenDisjointRowRanges_MatchesRebuild)
+    {
+        const size_t Width = 7;
+        const size_t Height = 6;
+
+        HorizontalGradientSampler sampler(Width);
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> expected(Width, Height);
+        expected.rebuild(sampler);
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> importance_sampler(Width, Height);
+        importance_sampler.rebuild_rows(sampler, 4, Height);
+        importance_sampler.rebuild_rows(sampler, 0, 4);
+        importance_sampler.rebuild_rows_cdf();
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_EQ(expected.get_pdf(x, y), importance_sampler.get_pdf(x, y));
+        }
+    }
+
     void generate_image(
         const char*     input_filename,
         const char*     output_image,
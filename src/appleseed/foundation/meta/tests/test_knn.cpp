@@ -28,6 +28,7 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/log/log.h"
 #include "foundation/math/distance.h"
 #include "foundation/math/knn.h"
 #include "foundation/math/permutation.h"
@@ -37,6 +38,8 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -143,6 +146,67 @@ TEST_SUITE(Foundation_Math_Knn_Builder)
         knn::Builder3d builder(tree);
         builder.build<DefaultWallclockTimer>(points, PointCount);
     }
+
+    TEST_CASE(BuildMovePoints_GivenJobQueue_BuildsTreeEquivalentToSerialBuild)
+    {
+        const size_t PointCount = 20000;
+        const size_t QueryCount = 200;
+        const size_t AnswerSize = 10;
+
+        MersenneTwister rng;
+
+        std::vector<Vector3d> serial_points;
+        serial_points.reserve(PointCount);
+        for (size_t i = 0; i < PointCount; ++i)
+            serial_points.push_back(rand_vector1<Vector3d>(rng));
+
+        // Add coincident points to exercise the degenerate split case.
+        for (size_t i = 0; i < 100; ++i)
+            serial_points[i] = Vector3d(0.5);
+
+        std::vector<Vector3d> parallel_points(serial_points);
+
+        knn::Tree3d serial_tree;
+        knn::Builder3d serial_builder(serial_tree);
+        serial_builder.build_move_points<DefaultWallclockTimer>(serial_points);
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4);
+        job_manager.start();
+
+        knn::Tree3d parallel_tree;
+        knn::Builder3d parallel_builder(parallel_tree);
+        parallel_builder.build_move_points<DefaultWallclockTimer>(parallel_points, job_queue);
+
+        ASSERT_EQ(serial_tree.m_nodes.size(), parallel_tree.m_nodes.size());
+        EXPECT_EQ(serial_tree.m_indices, parallel_tree.m_indices);
+
+        knn::Answer<double> serial_answer(AnswerSize);
+        knn::Answer<double> parallel_answer(AnswerSize);
+        knn::Query3d serial_query(serial_tree, serial_answer);
+        knn::Query3d parallel_query(parallel_tree, parallel_answer);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            const Vector3d q = rand_vector1<Vector3d>(rng);
+
+            serial_query.run(q);
+            parallel_query.run(q);
+
+            serial_answer.sort();
+            parallel_answer.sort();
+
+            ASSERT_EQ(serial_answer.size(), parallel_answer.size());
+
+            for (size_t j = 0; j < serial_answer.size(); ++j)
+            {
+                EXPECT_EQ(
+                    serial_tree.remap(serial_answer.get(j).m_index),
+                    parallel_tree.remap(parallel_answer.get(j).m_index));
+            }
+        }
+    }
 }
 
 TEST_SUITE(Foundation_Math_Knn_Answer)
@@ -510,3 +574,98 @@ TEST_SUITE(Foundation_Math_Knn_AnyQuery)
         }
     }
 }
+
+TEST_SUITE(Foundation_Math_Knn_GatherQuery)
+{
+    template <typename T>
+    struct GatherVisitor
+    {
+        std::vector<size_t>&    m_indices;
+
+        explicit GatherVisitor(std::vector<size_t>& indices)
+          : m_indices(indices)
+        {
+        }
+
+        void operator()(const size_t index, const T square_dist)
+        {
+            m_indices.push_back(index);
+        }
+    };
+
+    template <typename T>
+    bool do_results_match_naive_algorithm(
+        const size_t            point_count,
+        const size_t            query_count,
+        const T                 query_max_square_distance)
+    {
+        typedef Vector<T, 3> VectorType;
+
+        MersenneTwister rng;
+
+        std::vector<VectorType> points;
+        points.reserve(point_count);
+        for (size_t i = 0; i < point_count; ++i)
+            points.push_back(rand_vector1<VectorType>(rng));
+
+        knn::Tree<T, 3> tree;
+        knn::Builder<T, 3> builder(tree);
+        builder.template build<DefaultWallclockTimer>(&points[0], points.size());
+        builder.build_point_blocks();
+
+        const knn::GatherQuery<T, 3> query(tree);
+
+        std::vector<size_t> indices;
+        GatherVisitor<T> visitor(indices);
+
+        for (size_t i = 0; i < query_count; ++i)
+        {
+            const VectorType q = rand_vector1<VectorType>(rng);
+
+            indices.clear();
+            query.run(q, query_max_square_distance, visitor);
+
+            for (size_t j = 0; j < indices.size(); ++j)
+                indices[j] = tree.remap(indices[j]);
+            std::sort(indices.begin(), indices.end());
+
+            std::vector<size_t> ref_indices;
+            for (size_t j = 0; j < points.size(); ++j)
+            {
+                if (square_distance(points[j], q) <= query_max_square_distance)
+                    ref_indices.push_back(j);
+            }
+
+            if (indices != ref_indices)
+                return false;
+        }
+
+        return true;
+    }
+
+    TEST_CASE(Run_SinglePrecision_ReturnsIdenticalResultsAsNaiveAlgorithm)
+    {
+        EXPECT_TRUE(do_results_match_naive_algorithm<float>(1003, 200, square(0.1f)));
+    }
+
+    TEST_CASE(Run_DoublePrecision_ReturnsIdenticalResultsAsNaiveAlgorithm)
+    {
+        EXPECT_TRUE(do_results_match_naive_algorithm<double>(1003, 200, square(0.1)));
+    }
+
+    TEST_CASE(Run_GivenEmptyTree_VisitsNoPoint)
+    {
+        knn::Tree3f tree;
+        knn::Builder3f builder(tree);
+        builder.build<DefaultWallclockTimer>(nullptr, 0);
+        builder.build_point_blocks();
+
+        std::vector<size_t> indices;
+        GatherVisitor<float> visitor(indices);
+
+        const knn::GatherQuery3f query(tree);
+        query.run(Vector3f(0.0f), 1.0f, visitor);
+
+        EXPECT_TRUE(indices.empty());
+    }
+}
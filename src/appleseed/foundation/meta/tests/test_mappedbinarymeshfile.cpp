@@ -0,0 +1,331 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/meshio/binarymeshfilereader.h"
+#include "foundation/meshio/binarymeshfilewriter.h"
+#include "foundation/meshio/imeshwalker.h"
+#include "foundation/meshio/mappedbinarymeshfile.h"
+#include "foundation/meshio/meshbuilderbase.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Mesh_MappedBinaryMeshFile)
+{
+    // A unit square made of a single quad, with vertex normals but without texture coordinates.
+    struct QuadMeshWalker
+      : public IMeshWalker
+    {
+        const char* get_name() const override
+        {
+            return "quad";
+        }
+
+        size_t get_vertex_count() const override
+        {
+            return 4;
+        }
+
+        Vector3d get_vertex(const size_t i) const override
+        {
+            static const Vector3d Vertices[4] =
+            {
+                Vector3d(0.0, 0.0, 0.0),
+                Vector3d(1.0, 0.0, 0.0),
+                Vector3d(1.0, 1.0, 0.0),
+                Vector3d(0.0, 1.0, 0.0)
+            };
+
+            return Vertices[i];
+        }
+
+        size_t get_vertex_normal_count() const override
+        {
+            return 1;
+        }
+
+        Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return Vector3d(0.0, 0.0, 2.0);
+        }
+
+        size_t get_tex_coords_count() const override
+        {
+            return 0;
+        }
+
+        Vector2d get_tex_coords(const size_t i) const override
+        {
+            return Vector2d(0.0);
+        }
+
+        size_t get_material_slot_count() const override
+        {
+            return 1;
+        }
+
+        const char* get_material_slot(const size_t i) const override
+        {
+            return "material";
+        }
+
+        size_t get_face_count() const override
+        {
+            return 1;
+        }
+
+        size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return 4;
+        }
+
+        size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            return vertex_index;
+        }
+
+        size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            return 0;
+        }
+
+        size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            return None;
+        }
+
+        size_t get_face_material(const size_t face_index) const override
+        {
+            return 0;
+        }
+    };
+
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        std::vector<std::string>    m_names;
+        std::vector<Vector3d>       m_vertices;
+        std::vector<Vector3d>       m_vertex_normals;
+        size_t                      m_face_count;
+        size_t                      m_faces_with_normals;
+
+        MeshBuilder()
+          : m_face_count(0)
+          , m_faces_with_normals(0)
+        {
+        }
+
+        void begin_mesh(const char* name) override
+        {
+            m_names.emplace_back(name);
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_vertices.push_back(v);
+            return m_vertices.size() - 1;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_vertex_normals.push_back(v);
+            return m_vertex_normals.size() - 1;
+        }
+
+        void begin_face(const size_t vertex_count) override
+        {
+            ++m_face_count;
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            ++m_faces_with_normals;
+        }
+    };
+
+    const char* Filename = "unit tests/outputs/test_mappedbinarymeshfile_quads.binarymesh";
+
+    void write_quads(const size_t count)
+    {
+        BinaryMeshFileWriter writer(Filename, BinaryMeshFileWriter::PageAligned);
+        QuadMeshWalker walker;
+
+        for (size_t i = 0; i < count; ++i)
+            writer.write(walker);
+    }
+
+    TEST_CASE(IsMappable_GivenPageAlignedFile_ReturnsTrue)
+    {
+        write_quads(1);
+
+        EXPECT_TRUE(MappedBinaryMeshFile::is_mappable(Filename));
+    }
+
+    TEST_CASE(IsMappable_GivenCompressedFile_ReturnsFalse)
+    {
+        const char* CompressedFilename = "unit tests/outputs/test_mappedbinarymeshfile_compressed.binarymesh";
+
+        {
+            BinaryMeshFileWriter writer(CompressedFilename);
+            QuadMeshWalker walker;
+            writer.write(walker);
+        }
+
+        EXPECT_FALSE(MappedBinaryMeshFile::is_mappable(CompressedFilename));
+    }
+
+    TEST_CASE(Constructor_GivenPageAlignedFile_MapsTriangulatedMeshes)
+    {
+        write_quads(2);
+
+        const MappedBinaryMeshFile file(Filename);
+
+        ASSERT_EQ(2, file.get_mesh_count());
+
+        for (size_t i = 0; i < file.get_mesh_count(); ++i)
+        {
+            const MappedBinaryMeshFile::Mesh& mesh = file.get_mesh(i);
+
+            EXPECT_EQ("quad", mesh.m_name);
+            ASSERT_EQ(1, mesh.m_material_slots.size());
+            EXPECT_EQ("material", mesh.m_material_slots[0]);
+
+            ASSERT_EQ(4, mesh.m_vertex_count);
+            EXPECT_EQ(Vector3f(1.0f, 1.0f, 0.0f), mesh.m_vertices[2]);
+
+            ASSERT_EQ(1, mesh.m_vertex_normal_count);
+            EXPECT_EQ(Vector3f(0.0f, 0.0f, 1.0f), mesh.m_vertex_normals[0]);
+
+            EXPECT_EQ(0, mesh.m_tex_coords_count);
+
+            ASSERT_EQ(2, mesh.m_triangle_count);
+            for (size_t j = 0; j < mesh.m_triangle_count; ++j)
+            {
+                const std::uint32_t* triangle = mesh.m_triangles + j * MappedBinaryMeshFile::TriangleSize;
+                EXPECT_EQ(0, triangle[3]);
+                EXPECT_EQ(~std::uint32_t(0), triangle[6]);
+                EXPECT_EQ(0, triangle[9]);
+            }
+        }
+    }
+
+    TEST_CASE(Constructor_GivenPageAlignedFile_ReadsBoundingBoxes)
+    {
+        write_quads(2);
+
+        const MappedBinaryMeshFile file(Filename);
+
+        ASSERT_EQ(2, file.get_mesh_count());
+        EXPECT_EQ(AABB3f(Vector3f(0.0f), Vector3f(1.0f, 1.0f, 0.0f)), file.get_mesh(0).m_bbox);
+        EXPECT_EQ(AABB3f(Vector3f(0.0f), Vector3f(1.0f, 1.0f, 0.0f)), file.get_mesh(1).m_bbox);
+    }
+
+    TEST_CASE(Constructor_GivenVersion5File_ComputesBoundingBox)
+    {
+        write_quads(1);
+
+        // Turn the file into a version 5 file: drop the bounding box from the mesh header
+        // and pad the header instead so that the arrays stay at the same offsets.
+        std::vector<char> data;
+        {
+            std::ifstream input(Filename, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        }
+
+        const size_t VersionOffset = 10;
+        const size_t BBoxOffset =
+            VersionOffset + 2 +             // version
+            2 + 4 +                         // mesh name
+            3 * 4 +                         // vertex, vertex normal and texture coordinates counts
+            2 + 2 + 8 +                     // material slots
+            4;                              // triangle count
+        const size_t BBoxSize = 6 * sizeof(float);
+        ASSERT_GT(BBoxOffset + 2 * BBoxSize, data.size());
+
+        const std::uint16_t Version5 = 5;
+        std::memcpy(&data[VersionOffset], &Version5, sizeof(Version5));
+        data.erase(data.begin() + BBoxOffset, data.begin() + BBoxOffset + BBoxSize);
+        data.insert(data.begin() + BBoxOffset, BBoxSize, 0);
+
+        const char* Version5Filename = "unit tests/outputs/test_mappedbinarymeshfile_version5.binarymesh";
+        {
+            std::ofstream output(Version5Filename, std::ios::binary);
+            output.write(data.data(), data.size());
+        }
+
+        EXPECT_TRUE(MappedBinaryMeshFile::is_mappable(Version5Filename));
+
+        const MappedBinaryMeshFile file(Version5Filename);
+
+        ASSERT_EQ(1, file.get_mesh_count());
+        EXPECT_EQ(4, file.get_mesh(0).m_vertex_count);
+        EXPECT_EQ(AABB3f(Vector3f(0.0f), Vector3f(1.0f, 1.0f, 0.0f)), file.get_mesh(0).m_bbox);
+    }
+
+    TEST_CASE(Constructor_GivenPageAlignedFile_AlignsArraysOnPageBoundaries)
+    {
+        write_quads(2);
+
+        const MappedBinaryMeshFile file(Filename);
+        const MappedBinaryMeshFile::Mesh& mesh = file.get_mesh(1);
+
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(mesh.m_vertices) % MappedBinaryMeshFile::PageSize);
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(mesh.m_vertex_normals) % MappedBinaryMeshFile::PageSize);
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(mesh.m_triangles) % MappedBinaryMeshFile::PageSize);
+    }
+
+    TEST_CASE(BinaryMeshFileReader_GivenPageAlignedFile_ReadsTriangles)
+    {
+        write_quads(1);
+
+        BinaryMeshFileReader reader(Filename);
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_names.size());
+        EXPECT_EQ("quad", builder.m_names[0]);
+        EXPECT_EQ(4, builder.m_vertices.size());
+        EXPECT_EQ(1, builder.m_vertex_normals.size());
+        EXPECT_EQ(2, builder.m_face_count);
+        EXPECT_EQ(2, builder.m_faces_with_normals);
+    }
+}
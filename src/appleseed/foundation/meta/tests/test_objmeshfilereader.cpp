@@ -28,6 +28,7 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/log/logger.h"
 #include "foundation/math/vector.h"
 #include "foundation/meshio/meshbuilderbase.h"
 #include "foundation/meshio/objmeshfilereader.h"
@@ -37,6 +38,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -140,6 +142,143 @@ TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
         EXPECT_EQ(1, mesh.m_faces.size());
     }
 
+    // Write a file large enough to be split into several chunks by the parallel parser.
+    void write_large_mesh_file(const char* filename, const bool with_parse_error)
+    {
+        FILE* f = fopen(filename, "wt");
+        assert(f);
+
+        const size_t GroupCount = 16;
+        const size_t GridSize = 64;
+
+        for (size_t g = 0; g < GroupCount; ++g)
+        {
+            fprintf(f, "# group " FMT_SIZE_T "\n\ng group_" FMT_SIZE_T "\n", g, g % 5);
+
+            for (size_t y = 0; y <= GridSize; ++y)
+            {
+                for (size_t x = 0; x <= GridSize; ++x)
+                {
+                    fprintf(f, "v " FMT_SIZE_T ".5 " FMT_SIZE_T ".25 " FMT_SIZE_T "\n", x, y, g);
+                    fprintf(f, "vt %f %f\n", x / double(GridSize), y / double(GridSize));
+                }
+            }
+
+            fprintf(f, "vn 0 0 1\n");
+
+            for (size_t y = 0; y < GridSize; ++y)
+            {
+                if (y % 16 == 0)
+                    fprintf(f, "usemtl material_" FMT_SIZE_T "\n", y % 3);
+
+                for (size_t x = 0; x < GridSize; ++x)
+                {
+                    // Indices of the quad's corners relative to the end of the group.
+                    const long vertex_count = static_cast<long>((GridSize + 1) * (GridSize + 1));
+                    const long v00 = static_cast<long>(y * (GridSize + 1) + x) - vertex_count;
+                    const long v10 = v00 + 1;
+                    const long v01 = v00 + static_cast<long>(GridSize + 1);
+                    const long v11 = v01 + 1;
+
+                    if (x % 2 == 0)
+                        fprintf(f, "f %ld/%ld/-1 %ld/%ld/-1 %ld/%ld/-1 %ld/%ld/-1\n", v00, v00, v10, v10, v11, v11, v01, v01);
+                    else
+                    {
+                        const long base = static_cast<long>(g) * vertex_count + vertex_count + 1;
+                        fprintf(f, "f %ld %ld %ld\n", base + v00, base + v10, base + v11);
+                    }
+                }
+            }
+        }
+
+        if (with_parse_error)
+            fprintf(f, "v 1 2 3 4 5\n");
+
+        fclose(f);
+    }
+
+    bool are_identical(const Mesh& lhs, const Mesh& rhs)
+    {
+        if (lhs.m_name != rhs.m_name ||
+            lhs.m_vertices != rhs.m_vertices ||
+            lhs.m_vertex_normals != rhs.m_vertex_normals ||
+            lhs.m_tex_coords != rhs.m_tex_coords ||
+            lhs.m_faces.size() != rhs.m_faces.size())
+            return false;
+
+        for (size_t i = 0, e = lhs.m_faces.size(); i < e; ++i)
+        {
+            if (lhs.m_faces[i].m_vertices != rhs.m_faces[i].m_vertices)
+                return false;
+        }
+
+        return true;
+    }
+
+    TEST_CASE(ReadLargeMeshFile_WithParallelParsing_MatchesSequentialParsing)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large.obj";
+        write_large_mesh_file(Filename, false);
+
+        OBJMeshFileReader sequential_reader(Filename);
+        MeshBuilder sequential_builder;
+        sequential_reader.read(sequential_builder);
+
+        EXPECT_EQ(16, sequential_builder.m_meshes.size());
+
+        // With a single thread, chunks are parsed and replayed in several batches.
+        const size_t ThreadCounts[] = { 1, 4 };
+
+        for (const size_t thread_count : ThreadCounts)
+        {
+            Logger logger;
+            OBJMeshFileReader parallel_reader(Filename);
+            parallel_reader.enable_parallel_parsing(logger, thread_count);
+            MeshBuilder parallel_builder;
+            parallel_reader.read(parallel_builder);
+
+            ASSERT_EQ(sequential_builder.m_meshes.size(), parallel_builder.m_meshes.size());
+
+            for (size_t i = 0, e = sequential_builder.m_meshes.size(); i < e; ++i)
+                EXPECT_TRUE(are_identical(sequential_builder.m_meshes[i], parallel_builder.m_meshes[i]));
+        }
+    }
+
+    TEST_CASE(ReadLargeMeshFile_WithParallelParsing_ReportsParseErrorLine)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large_with_error.obj";
+        write_large_mesh_file(Filename, true);
+
+        size_t sequential_line = 0;
+        try
+        {
+            OBJMeshFileReader reader(Filename);
+            MeshBuilder builder;
+            reader.read(builder);
+        }
+        catch (const OBJMeshFileReader::ExceptionParseError& e)
+        {
+            sequential_line = e.m_line;
+        }
+
+        size_t parallel_line = 0;
+        try
+        {
+            Logger logger;
+            OBJMeshFileReader reader(Filename);
+            reader.enable_parallel_parsing(logger, 4);
+            MeshBuilder builder;
+            reader.read(builder);
+        }
+        catch (const OBJMeshFileReader::ExceptionParseError& e)
+        {
+            parallel_line = e.m_line;
+        }
+
+        EXPECT_NEQ(0, sequential_line);
+        EXPECT_EQ(sequential_line, parallel_line);
+    }
+
 #if 0
 
     TEST_CASE(OBJFileToCPPFile)
@@ -27,6 +27,7 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/log/logger.h"
 #include "foundation/utility/countof.h"
 #include "foundation/utility/test.h"
 #include "foundation/utility/zip.h"
@@ -36,6 +37,8 @@
 
 // Standard headers.
 #include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <set>
 #include <string>
 #include <vector>
@@ -92,7 +95,8 @@ TEST_SUITE(Foundation_Utility_Zip)
             ASSERT_FALSE(bf::exists(TargetZip));
             ASSERT_FALSE(bf::exists(TargetDirectory));
 
-            zip(TargetZip, InitialDirectory);
+            Logger logger;
+            zip(TargetZip, InitialDirectory, logger);
             unzip(TargetZip, TargetDirectory);
 
             const std::set<std::string> expected_files = recursive_ls(InitialDirectory);
@@ -114,6 +118,48 @@ TEST_SUITE(Foundation_Utility_Zip)
         }
     }
 
+    std::string read_file(const std::string& filepath)
+    {
+        std::ifstream in(filepath.c_str(), std::ios_base::in | std::ios_base::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    TEST_CASE(ZipUnzipRoundtrip_PreservesFileContents)
+    {
+        const std::string InitialDirectory = "unit tests/inputs/test_zip";
+        const std::string TargetZip = "unit tests/outputs/test_zip_contents.zip";
+        const std::string TargetDirectory = "unit tests/outputs/test_zip_contents";
+
+        try
+        {
+            ASSERT_TRUE(bf::exists(InitialDirectory));
+            ASSERT_FALSE(bf::exists(TargetZip));
+            ASSERT_FALSE(bf::exists(TargetDirectory));
+
+            Logger logger;
+            zip(TargetZip, InitialDirectory, logger);
+            unzip(TargetZip, TargetDirectory);
+
+            const std::set<std::string> expected_files = recursive_ls(InitialDirectory);
+
+            for (const std::string& filename : expected_files)
+            {
+                EXPECT_EQ(
+                    read_file((bf::path(InitialDirectory) / filename).string()),
+                    read_file((bf::path(TargetDirectory) / filename).string()));
+            }
+
+            bf::remove(TargetZip);
+            bf::remove_all(TargetDirectory);
+        }
+        catch (const std::exception& e)
+        {
+            bf::remove(TargetZip);
+            bf::remove_all(TargetDirectory);
+            throw e;
+        }
+    }
+
     TEST_CASE(IsZipFile_GivenValidZipFile_ReturnsTrue)
     {
         EXPECT_TRUE(is_zip_file("unit tests/inputs/test_zip_validzipfile.zip"));
@@ -0,0 +1,202 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "memorymappedfile.h"
+
+// appleseed.foundation headers.
+#ifdef _WIN32
+#include "foundation/platform/windows.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+
+// Platform headers.
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace foundation
+{
+
+//
+// MemoryMappedFile class implementation.
+//
+
+struct MemoryMappedFile::Impl
+{
+#ifdef _WIN32
+    HANDLE      m_file;
+    HANDLE      m_mapping;
+#endif
+    const void* m_data;
+    size_t      m_size;
+};
+
+MemoryMappedFile::MemoryMappedFile()
+  : impl(new Impl())
+{
+#ifdef _WIN32
+    impl->m_file = INVALID_HANDLE_VALUE;
+    impl->m_mapping = nullptr;
+#endif
+    impl->m_data = nullptr;
+    impl->m_size = 0;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+    delete impl;
+}
+
+bool MemoryMappedFile::open(const char* path)
+{
+    assert(path);
+
+    close();
+
+#ifdef _WIN32
+
+    impl->m_file =
+        CreateFileA(
+            path,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr);
+
+    if (impl->m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(impl->m_file, &file_size) || file_size.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    impl->m_mapping = CreateFileMappingA(impl->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (impl->m_mapping == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    impl->m_data = MapViewOfFile(impl->m_mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (impl->m_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    impl->m_size = static_cast<size_t>(file_size.QuadPart);
+
+#else
+
+    const int fd = ::open(path, O_RDONLY);
+
+    if (fd == -1)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const size_t file_size = static_cast<size_t>(file_stat.st_size);
+    void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping remains valid after the file descriptor is closed.
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    impl->m_data = data;
+    impl->m_size = file_size;
+
+#endif
+
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+#ifdef _WIN32
+
+    if (impl->m_data != nullptr)
+        UnmapViewOfFile(impl->m_data);
+
+    if (impl->m_mapping != nullptr)
+        CloseHandle(impl->m_mapping);
+
+    if (impl->m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(impl->m_file);
+
+    impl->m_file = INVALID_HANDLE_VALUE;
+    impl->m_mapping = nullptr;
+
+#else
+
+    if (impl->m_data != nullptr)
+        munmap(const_cast<void*>(impl->m_data), impl->m_size);
+
+#endif
+
+    impl->m_data = nullptr;
+    impl->m_size = 0;
+}
+
+bool MemoryMappedFile::is_open() const
+{
+    return impl->m_data != nullptr;
+}
+
+const void* MemoryMappedFile::data() const
+{
+    return impl->m_data;
+}
+
+size_t MemoryMappedFile::size() const
+{
+    return impl->m_size;
+}
+
+}   // namespace foundation
@@ -0,0 +1,77 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A read-only view of a file mapped in memory.
+//
+// The contents of the file are paged in by the operating system on first access,
+// and the start of the mapping is aligned on a page boundary.
+//
+
+class MemoryMappedFile
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    MemoryMappedFile();
+
+    // Destructor, unmaps the file if it is still mapped.
+    ~MemoryMappedFile();
+
+    // Map a file in memory. Return false if the file could not be opened,
+    // is empty or could not be mapped.
+    bool open(const char* path);
+
+    // Unmap the file.
+    void close();
+
+    // Return true if a file is currently mapped.
+    bool is_open() const;
+
+    // Access the contents of the mapped file.
+    const void* data() const;
+    size_t size() const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace foundation
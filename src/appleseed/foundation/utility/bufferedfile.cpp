@@ -425,7 +425,10 @@ bool BufferedFile::seek(
             target_index = std::max<std::int64_t>(current_index + offset, 0);
         }
 
-        if (target_index >= m_file_index &&
+        // In write mode, the I/O buffer only holds the bytes written since the last flush:
+        // seeking within it would cause the bytes past the new position to be dropped.
+        if (m_file_mode == ReadMode &&
+            target_index >= m_file_index &&
             target_index <  m_file_index + static_cast<std::int64_t>(m_buffer_end))
         {
             // Seek within the I/O buffer.
@@ -30,18 +30,27 @@
 #include "zip.h"
 
 // appleseed.foundation headers.
+#include "foundation/log/logger.h"
+#include "foundation/platform/system.h"
 #include "foundation/string/string.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/minizip/unzip.h"
 #include "foundation/utility/minizip/zip.h"
 
+// zlib headers.
+#include "zlib.h"
+
 // Boost headers.
 #include "boost/filesystem.hpp"
 #include "boost/range/iterator_range.hpp"
 
 // Standard headers.
+#include <cstdint>
 #include <ctime>
+#include <exception>
 #include <fstream>
+#include <iterator>
 #include <set>
 #include <vector>
 
@@ -178,7 +187,7 @@ namespace
             throw ZipException("error while closing file in zip", err);
     }
 
-    void write_chunk(zipFile& zip_file, char* buffer, const size_t chunk_size)
+    void write_chunk(zipFile& zip_file, const char* buffer, const size_t chunk_size)
     {
         const int err =
             zipWriteInFileInZip(
@@ -250,6 +259,176 @@ namespace
         in.close();
         zip_close_current_file(zip_file);
     }
+
+    // Files are compressed in parallel, in batches of at most that many bytes.
+    // Larger files are compressed while they are being written to the zip file.
+    const std::uintmax_t MaxBatchSize = 256 * 1024 * 1024;
+
+    struct CompressedFile
+    {
+        std::string             m_filename;
+        std::string             m_filename_in_fs;
+        std::vector<char>       m_data;             // raw deflate stream
+        uLong                   m_crc;
+        uLong                   m_uncompressed_size;
+        std::exception_ptr      m_error;
+    };
+
+    void compress_file(CompressedFile& file)
+    {
+        std::ifstream in(file.m_filename_in_fs.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (in.fail())
+            throw ZipException(("can't open file " + file.m_filename_in_fs).c_str());
+
+        const std::vector<char> input(
+            (std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+
+        const uInt input_size = static_cast<uInt>(input.size());
+        const Bytef* input_data = reinterpret_cast<const Bytef*>(input.data());
+
+        file.m_uncompressed_size = static_cast<uLong>(input.size());
+        file.m_crc = crc32(crc32(0, nullptr, 0), input_data, input_size);
+
+        // Produce the same raw deflate stream as minizip.
+        z_stream stream;
+        stream.zalloc = nullptr;
+        stream.zfree = nullptr;
+        stream.opaque = nullptr;
+
+        int err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        if (err != Z_OK)
+            throw ZipException("zlib error while compressing file: ", err);
+
+        file.m_data.resize(deflateBound(&stream, input_size));
+
+        stream.next_in = const_cast<Bytef*>(input_data);
+        stream.avail_in = input_size;
+        stream.next_out = reinterpret_cast<Bytef*>(file.m_data.data());
+        stream.avail_out = static_cast<uInt>(file.m_data.size());
+
+        err = deflate(&stream, Z_FINISH);
+        file.m_data.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        if (err != Z_STREAM_END)
+            throw ZipException("zlib error while compressing file: ", err);
+    }
+
+    // Compress a file to memory. Errors are stored in the file.
+    class CompressFileJob
+      : public IJob
+    {
+      public:
+        explicit CompressFileJob(CompressedFile& file)
+          : m_file(file)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            try
+            {
+                compress_file(m_file);
+            }
+            catch (...)
+            {
+                m_file.m_error = std::current_exception();
+            }
+        }
+
+      private:
+        CompressedFile& m_file;
+    };
+
+    void write_compressed_file(zipFile& zip_file, const CompressedFile& file)
+    {
+        if (file.m_error)
+            std::rethrow_exception(file.m_error);
+
+        const zip_fileinfo zip_file_info = make_zip_fileinfo(file.m_filename_in_fs);
+
+        int err =
+            zipOpenNewFileInZip2(
+                zip_file,
+                file.m_filename.c_str(),
+                &zip_file_info,
+                nullptr, 0, nullptr, 0, nullptr,
+                Z_DEFLATED,
+                Z_DEFAULT_COMPRESSION,
+                1);     // raw
+
+        if (err != ZIP_OK)
+            throw ZipException(("error while opening " + file.m_filename + " in zipfile").c_str());
+
+        if (!file.m_data.empty())
+            write_chunk(zip_file, file.m_data.data(), file.m_data.size());
+
+        err = zipCloseFileInZipRaw(zip_file, file.m_uncompressed_size, file.m_crc);
+
+        if (err != ZIP_OK)
+            throw ZipException("error while closing file in zip", err);
+    }
+
+    void zip_files(
+        zipFile&                        zip_file,
+        const std::set<std::string>&    files_to_zip,
+        const std::string&              base_directory,
+        Logger&                         logger)
+    {
+        JobQueue job_queue;
+        JobManager job_manager(
+            logger,
+            job_queue,
+            System::get_logical_cpu_core_count(),
+            JobManager::KeepRunningOnEmptyQueue);
+        job_manager.start();
+
+        std::set<std::string>::const_iterator it = files_to_zip.begin();
+
+        while (it != files_to_zip.end())
+        {
+            const std::string filename_in_fs = (bf::path(base_directory) / *it).string();
+
+            // Stream large files directly to the zip file.
+            if (bf::file_size(filename_in_fs) > MaxBatchSize)
+            {
+                zip_current_file(zip_file, *it, base_directory);
+                ++it;
+                continue;
+            }
+
+            // Compress the next batch of files in parallel.
+            std::vector<CompressedFile> batch;
+            std::uintmax_t batch_size = 0;
+
+            while (it != files_to_zip.end())
+            {
+                const std::string filepath = (bf::path(base_directory) / *it).string();
+                const std::uintmax_t file_size = bf::file_size(filepath);
+
+                if (file_size > MaxBatchSize || batch_size + file_size > MaxBatchSize)
+                    break;
+
+                CompressedFile file;
+                file.m_filename = *it;
+                file.m_filename_in_fs = filepath;
+                batch.push_back(file);
+
+                batch_size += file_size;
+                ++it;
+            }
+
+            for (CompressedFile& file : batch)
+                job_queue.schedule(new CompressFileJob(file));
+
+            job_queue.wait_until_completion();
+
+            // Write the batch in order.
+            for (const CompressedFile& file : batch)
+                write_compressed_file(zip_file, file);
+        }
+    }
 }
 
 void unzip(const std::string& zip_filename, const std::string& unzipped_dir)
@@ -280,7 +459,10 @@ void unzip(const std::string& zip_filename, const std::string& unzipped_dir)
     }
 }
 
-void zip(const std::string& zip_filename, const std::string& directory_to_zip)
+void zip(
+    const std::string&  zip_filename,
+    const std::string&  directory_to_zip,
+    Logger&             logger)
 {
     try
     {
@@ -290,8 +472,15 @@ void zip(const std::string& zip_filename, const std::string& directory_to_zip)
         if (zip_file == nullptr)
             throw ZipException(("can't open file " + zip_filename).c_str());
 
-        for (const std::string& filename_to_zip : files_to_zip)
-            zip_current_file(zip_file, filename_to_zip, directory_to_zip);
+        try
+        {
+            zip_files(zip_file, files_to_zip, directory_to_zip, logger);
+        }
+        catch (...)
+        {
+            zipClose(zip_file, nullptr);
+            throw;
+        }
 
         zipClose(zip_file, nullptr);
     }
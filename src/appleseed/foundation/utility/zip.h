@@ -39,6 +39,9 @@
 #include <string>
 #include <vector>
 
+// Forward declarations.
+namespace foundation    { class Logger; }
+
 namespace foundation
 {
 
@@ -66,11 +69,15 @@ void unzip(const std::string& zip_filename, const std::string& unzipped_dir);
 //
 // Archives directory_to_zip to zip_filename zip file.
 //
+// Files are compressed in parallel; job manager messages are sent to logger.
 // Throws ZipException in case of exception.
 // If exception is thrown, zip archive is deleted.
 //
 
-void zip(const std::string& zip_filename, const std::string& directory_to_zip);
+void zip(
+    const std::string&  zip_filename,
+    const std::string&  directory_to_zip,
+    Logger&             logger);
 
 //
 // Checks if file is in zip format by trying to open it.
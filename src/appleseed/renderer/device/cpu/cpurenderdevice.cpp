@@ -40,21 +40,144 @@
 #include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
 #include "foundation/containers/dictionary.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/searchpaths.h"
+#include "foundation/utility/stopwatch.h"
 
 // Standard headers.
 #include <cstddef>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 using namespace foundation;
 
 namespace renderer
 {
 
+namespace
+{
+    //
+    // Optimizes and JIT-compiles a single OSL shader group, then queries the
+    // properties of all the shader group entities that share it.
+    //
+
+    class OptimizeShaderGroupJob
+      : public IJob
+    {
+      public:
+        OptimizeShaderGroupJob(
+            OSLShadingSystem&           shading_system,
+            std::vector<ShaderGroup*>   shader_groups,
+            IAbortSwitch&               abort_switch)
+          : m_shading_system(shading_system)
+          , m_shader_groups(std::move(shader_groups))
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            for (ShaderGroup* shader_group : m_shader_groups)
+            {
+                if (m_abort_switch.is_aborted())
+                    return;
+
+                shader_group->optimize_osl_shader_group(m_shading_system);
+            }
+        }
+
+      private:
+        OSLShadingSystem&               m_shading_system;
+        const std::vector<ShaderGroup*> m_shader_groups;
+        IAbortSwitch&                   m_abort_switch;
+    };
+
+    void collect_shader_groups(
+        const BaseGroup&            base_group,
+        std::vector<ShaderGroup*>&  shader_groups)
+    {
+        for (const Assembly& assembly : base_group.assemblies())
+            collect_shader_groups(assembly, shader_groups);
+
+        for (ShaderGroup& shader_group : base_group.shader_groups())
+        {
+            if (shader_group.is_valid())
+                shader_groups.push_back(&shader_group);
+        }
+    }
+
+    // OSL defers optimization and JIT compilation of a shader group to the first
+    // time it is executed or queried. Do this work up-front, on all rendering
+    // threads at once. Shader group entities may share the same OSL shader group:
+    // each OSL shader group is optimized by a single job.
+    void optimize_osl_shader_groups(
+        const Scene&                scene,
+        OSLShadingSystem&           shading_system,
+        const size_t                thread_count,
+        IAbortSwitch&               abort_switch)
+    {
+        std::vector<ShaderGroup*> shader_groups;
+        collect_shader_groups(scene, shader_groups);
+
+        if (shader_groups.empty())
+            return;
+
+        // Group shader group entities by OSL shader group, preserving scene order.
+        std::vector<std::vector<ShaderGroup*>> shared_shader_groups;
+        std::unordered_map<const void*, size_t> osl_shader_group_indices;
+        for (ShaderGroup* shader_group : shader_groups)
+        {
+            const auto result =
+                osl_shader_group_indices.insert(
+                    std::make_pair(shader_group->osl_shader_group(), shared_shader_groups.size()));
+
+            if (result.second)
+                shared_shader_groups.emplace_back();
+
+            shared_shader_groups[result.first->second].push_back(shader_group);
+        }
+
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        JobQueue job_queue;
+        for (std::vector<ShaderGroup*>& entities : shared_shader_groups)
+            job_queue.schedule(new OptimizeShaderGroupJob(shading_system, std::move(entities), abort_switch));
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            thread_count);
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "optimized %s shader group%s (%s shader group entit%s) in %s.",
+            pretty_uint(shared_shader_groups.size()).c_str(),
+            shared_shader_groups.size() > 1 ? "s" : "",
+            pretty_uint(shader_groups.size()).c_str(),
+            shader_groups.size() > 1 ? "ies" : "y",
+            pretty_time(stopwatch.get_seconds()).c_str());
+    }
+}
+
 CPURenderDevice::CPURenderDevice(
     Project&                project,
     const ParamArray&       params)
@@ -193,8 +316,9 @@ bool CPURenderDevice::initialize(
     else
         RENDERER_LOG_INFO("OSL headers not found.");
 
-    // Re-optimize shader groups that need updating.
-    if (!get_project().get_scene()->create_optimized_osl_shader_groups(
+    // Re-create shader groups that need updating.
+    m_shading_system->purge_shader_group_cache();
+    if (!get_project().get_scene()->create_osl_shader_groups(
             *m_shading_system,
             m_osl_compiler.get(),
             &abort_switch))
@@ -202,14 +326,20 @@ bool CPURenderDevice::initialize(
         return false;
     }
 
+    // Optimize and JIT-compile shader groups in parallel.
+    optimize_osl_shader_groups(
+        *get_project().get_scene(),
+        *m_shading_system,
+        get_rendering_thread_count(get_params()),
+        abort_switch);
+
     return m_components->create();
 }
 
 bool CPURenderDevice::build_or_update_scene()
 {
     // Updating the trace context causes ray tracing acceleration structures to be updated or rebuilt.
-    get_project().update_trace_context();
-    return true;
+    return get_project().update_trace_context();
 }
 
 bool CPURenderDevice::load_checkpoint(Frame& frame, const size_t pass_count)
@@ -53,12 +53,14 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/memory/alignedallocator.h"
+#include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/system.h"
 #include "foundation/platform/timers.h"
 #include "foundation/string/string.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 
 // Standard headers.
 #include <algorithm>
@@ -67,6 +69,7 @@
 #include <cstring>
 #include <set>
 #include <utility>
+#include <vector>
 
 using namespace foundation;
 
@@ -84,6 +87,8 @@ AssemblyTree::AssemblyTree(const Scene& scene)
   , m_use_embree(false)
   , m_dirty(false)
 #endif
+  , m_deferred_geometry_memory_budget(~size_t(0))
+  , m_update_stamp(0)
 {
 }
 
@@ -92,10 +97,10 @@ AssemblyTree::~AssemblyTree()
     RENDERER_LOG_INFO("deleting assembly tree...");
 }
 
-void AssemblyTree::update()
+bool AssemblyTree::update()
 {
     rebuild_assembly_tree();
-    update_tree_hierarchy();
+    return update_tree_hierarchy();
 }
 
 size_t AssemblyTree::get_memory_size() const
@@ -108,6 +113,11 @@ size_t AssemblyTree::get_memory_size() const
         + m_assembly_versions.size() * sizeof(std::pair<UniqueID, VersionID>);
 }
 
+void AssemblyTree::set_deferred_geometry_memory_budget(const size_t budget)
+{
+    m_deferred_geometry_memory_budget = budget;
+}
+
 void AssemblyTree::collect_assembly_instances(
     const AssemblyInstanceContainer&    assembly_instances,
     const TransformSequence&            parent_transform_seq,
@@ -244,12 +254,16 @@ void AssemblyTree::store_items_in_leaves(Statistics& statistics)
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
 }
 
-void AssemblyTree::update_tree_hierarchy()
+bool AssemblyTree::update_tree_hierarchy()
 {
     // Collect all assemblies in the scene.
     AssemblyVector assemblies;
     collect_unique_assemblies(assemblies);
 
+    // Load the geometry of deferred mesh objects before child trees reference it.
+    if (!load_deferred_geometry(assemblies))
+        return false;
+
     // Delete child trees of assemblies that no longer exist.
     delete_unused_child_trees(assemblies);
 
@@ -292,9 +306,14 @@ void AssemblyTree::update_tree_hierarchy()
     // Update child trees.
     update_triangle_trees();
 
+    // Free the geometry of deferred mesh objects that are no longer needed.
+    evict_deferred_geometry();
+
 #ifdef APPLESEED_WITH_EMBREE
     m_dirty = false;
 #endif
+
+    return true;
 }
 
 void AssemblyTree::collect_unique_assemblies(AssemblyVector& assemblies) const
@@ -546,6 +565,153 @@ void AssemblyTree::update_triangle_trees()
     m_triangle_tree_repository.for_each(update_trees);
 }
 
+namespace
+{
+    typedef std::vector<MeshObject*> MeshObjectVector;
+    typedef std::pair<size_t, MeshObject*> StampedMeshObject;
+
+    void collect_loaded_deferred_mesh_objects(
+        const AssemblyContainer&    assemblies,
+        MeshObjectVector&           objects)
+    {
+        const char* mesh_model = MeshObjectFactory().get_model();
+
+        for (const_each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            for (each<ObjectContainer> j = i->objects(); j; ++j)
+            {
+                if (strcmp(j->get_model(), mesh_model) == 0)
+                {
+                    MeshObject& object = static_cast<MeshObject&>(*j);
+                    if (object.has_deferred_geometry() && object.is_geometry_loaded())
+                        objects.push_back(&object);
+                }
+            }
+
+            collect_loaded_deferred_mesh_objects(i->assemblies(), objects);
+        }
+    }
+}
+
+bool AssemblyTree::load_deferred_geometry(const AssemblyVector& assemblies)
+{
+    ++m_update_stamp;
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    const char* mesh_model = MeshObjectFactory().get_model();
+    size_t loaded_object_count = 0;
+    size_t loaded_size = 0;
+
+    for (const_each<AssemblyVector> i = assemblies; i; ++i)
+    {
+        for (const_each<ObjectInstanceContainer> j = (*i)->object_instances(); j; ++j)
+        {
+            Object& object = j->get_object();
+
+            if (strcmp(object.get_model(), mesh_model) != 0)
+                continue;
+
+            MeshObject& mesh_object = static_cast<MeshObject&>(object);
+
+            if (!mesh_object.has_deferred_geometry())
+                continue;
+
+            m_deferred_geometry_stamps[mesh_object.get_uid()] = m_update_stamp;
+
+            if (mesh_object.is_geometry_loaded())
+                continue;
+
+            if (!mesh_object.load_geometry())
+            {
+                RENDERER_LOG_ERROR(
+                    "failed to load geometry of mesh object \"%s\".",
+                    mesh_object.get_name());
+                return false;
+            }
+
+            ++loaded_object_count;
+            loaded_size += mesh_object.get_geometry_memory_size();
+        }
+    }
+
+    stopwatch.measure();
+
+    if (loaded_object_count > 0)
+    {
+        RENDERER_LOG_INFO(
+            "loaded geometry of %s deferred mesh %s (%s) in %s.",
+            pretty_uint(loaded_object_count).c_str(),
+            loaded_object_count > 1 ? "objects" : "object",
+            pretty_size(loaded_size).c_str(),
+            pretty_time(stopwatch.get_seconds()).c_str());
+    }
+
+    return true;
+}
+
+void AssemblyTree::evict_deferred_geometry()
+{
+    // Collect deferred mesh objects whose geometry is in memory.
+    MeshObjectVector objects;
+    collect_loaded_deferred_mesh_objects(m_scene.assemblies(), objects);
+
+    size_t total_size = 0;
+    for (const_each<MeshObjectVector> i = objects; i; ++i)
+        total_size += (*i)->get_geometry_memory_size();
+
+    if (total_size <= m_deferred_geometry_memory_budget)
+        return;
+
+    // Only geometry that was not used by the current update can be evicted:
+    // the budget does not bound the geometry needed by the scene.
+    std::vector<StampedMeshObject> candidates;
+    for (const_each<MeshObjectVector> i = objects; i; ++i)
+    {
+        const size_t stamp = m_deferred_geometry_stamps[(*i)->get_uid()];
+        if (stamp != m_update_stamp)
+            candidates.emplace_back(stamp, *i);
+    }
+
+    // Evict least recently used geometry first.
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const StampedMeshObject& lhs, const StampedMeshObject& rhs)
+        {
+            return lhs.first < rhs.first;
+        });
+
+    size_t evicted_object_count = 0;
+    size_t evicted_size = 0;
+
+    for (const_each<std::vector<StampedMeshObject>> i = candidates; i; ++i)
+    {
+        if (total_size <= m_deferred_geometry_memory_budget)
+            break;
+
+        MeshObject& object = *i->second;
+        const size_t size = object.get_geometry_memory_size();
+
+        object.unload_geometry();
+        m_deferred_geometry_stamps.erase(object.get_uid());
+
+        total_size -= size;
+        evicted_size += size;
+        ++evicted_object_count;
+    }
+
+    if (evicted_object_count > 0)
+    {
+        RENDERER_LOG_INFO(
+            "evicted geometry of %s deferred mesh %s (%s) no longer used by the scene.",
+            pretty_uint(evicted_object_count).c_str(),
+            evicted_object_count > 1 ? "objects" : "object",
+            pretty_size(evicted_size).c_str());
+    }
+}
+
 
 //
 // Utility function to transform a ray to the space of an assembly instance.
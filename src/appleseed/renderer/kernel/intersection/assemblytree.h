@@ -83,11 +83,18 @@ class AssemblyTree
     ~AssemblyTree();
 
     // Update the assembly tree and all the child trees.
-    void update();
+    // Return false if the geometry of a deferred mesh object failed to load.
+    bool update();
 
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
+    // Set the maximum size (in bytes) of the geometry of deferred mesh objects kept in memory
+    // while the scene no longer needs it. Such geometry is evicted, least recently used first,
+    // until the budget is met. The budget does not apply to geometry needed by the scene,
+    // which is never evicted.
+    void set_deferred_geometry_memory_budget(const size_t budget);
+
 #ifdef APPLESEED_WITH_EMBREE
 
     bool use_embree() const;
@@ -125,6 +132,7 @@ class AssemblyTree
     typedef std::vector<foundation::AABB3d> AABBVector;
     typedef std::vector<const Assembly*> AssemblyVector;
     typedef std::map<foundation::UniqueID, foundation::VersionID> AssemblyVersionMap;
+    typedef std::map<foundation::UniqueID, size_t> UpdateStampMap;
 
     const Scene&                    m_scene;
     ItemVector                      m_items;
@@ -145,6 +153,10 @@ class AssemblyTree
 
 #endif
 
+    size_t                          m_deferred_geometry_memory_budget;
+    size_t                          m_update_stamp;
+    UpdateStampMap                  m_deferred_geometry_stamps;     // mesh object UID -> last update in which it was used
+
     void collect_assembly_instances(
         const AssemblyInstanceContainer&        assembly_instances,
         const TransformSequence&                parent_transform_seq,
@@ -153,7 +165,7 @@ class AssemblyTree
     void rebuild_assembly_tree();
     void store_items_in_leaves(foundation::Statistics& statistics);
 
-    void update_tree_hierarchy();
+    bool update_tree_hierarchy();
     void collect_unique_assemblies(AssemblyVector& assemblies) const;
     void delete_unused_child_trees(const AssemblyVector& assemblies);
 
@@ -173,6 +185,9 @@ class AssemblyTree
     void delete_curve_tree(const foundation::UniqueID assembly_id);
 
     void update_triangle_trees();
+
+    bool load_deferred_geometry(const AssemblyVector& assemblies);
+    void evict_deferred_geometry();
 };
 
 
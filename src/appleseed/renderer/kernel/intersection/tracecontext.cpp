@@ -81,9 +81,9 @@ TraceContext::~TraceContext()
     delete m_assembly_tree;
 }
 
-void TraceContext::update()
+bool TraceContext::update()
 {
-    m_assembly_tree->update();
+    return m_assembly_tree->update();
 }
 
 #ifdef APPLESEED_WITH_EMBREE
@@ -95,4 +95,9 @@ void TraceContext::set_use_embree(const bool value)
 
 #endif
 
+void TraceContext::set_deferred_geometry_memory_budget(const size_t budget)
+{
+    m_assembly_tree->set_deferred_geometry_memory_budget(budget);
+}
+
 }   // namespace renderer
@@ -35,6 +35,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace renderer  { class AssemblyTree; }
 namespace renderer  { class Scene; }
@@ -66,12 +69,16 @@ class APPLESEED_DLLSYMBOL TraceContext
     const AssemblyTree& get_assembly_tree() const;
 
     // Synchronize the trace context with the scene.
-    void update();
+    // Return false if the geometry of a deferred mesh object failed to load.
+    bool update();
 
 #ifdef APPLESEED_WITH_EMBREE
     void set_use_embree(const bool value);
 #endif
 
+    // Set the memory budget (in bytes) for the geometry of deferred mesh objects.
+    void set_deferred_geometry_memory_budget(const size_t budget);
+
   private:
     const Scene&    m_scene;
     AssemblyTree*   m_assembly_tree;
@@ -37,8 +37,13 @@
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/scene.h"
 
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
 // Standard headers.
 #include <cassert>
 #include <string>
@@ -78,6 +83,16 @@ Dictionary BackwardLightSampler::get_params_metadata()
                             .insert("label", "Light Tree")
                             .insert("help", "Lights organized in a BVH"))));
 
+    metadata.insert(
+        "light_tree_split_threshold",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "Light Tree Split Threshold")
+            .insert("help", "Amount of adaptive splitting of light clusters close to the shading point (0 disables splitting)"));
+
     metadata.merge(LightSamplerBase::get_params_metadata());
 
     return metadata;
@@ -87,6 +102,8 @@ BackwardLightSampler::BackwardLightSampler(
     const Scene&                        scene,
     const ParamArray&                   params)
   : LightSamplerBase(params)
+  , m_scene(scene)
+  , m_light_tree_needs_refit(false)
 {
     // Read which sampling algorithm should be used.
     m_use_light_tree = params.get_optional<std::string>("algorithm", "cdf") == "lighttree";
@@ -122,7 +139,7 @@ BackwardLightSampler::BackwardLightSampler(
     m_non_physical_light_count = m_non_physical_lights.size();
 
     // Collect all light-emitting shapes.
-    collect_emitting_shapes(
+    collect_emitting_shape_groups(
         scene.assembly_instances(),
         TransformSequence(),
         [&](
@@ -166,7 +183,11 @@ BackwardLightSampler::BackwardLightSampler(
     if (m_use_light_tree)
     {
         // Initialize the LightTree only after the lights are collected.
-        m_light_tree.reset(new LightTree(m_light_tree_lights, m_emitting_shapes));
+        m_light_tree.reset(
+            new LightTree(
+                m_light_tree_lights,
+                m_emitting_shapes,
+                clamp(params.get_optional<float>("light_tree_split_threshold", 0.0f), 0.0f, 1.0f)));
 
         // Build the light tree.
         const std::vector<size_t> tri_index_to_node_index = m_light_tree->build();
@@ -197,20 +218,189 @@ BackwardLightSampler::BackwardLightSampler(
         plural(m_emitting_shapes.size(), "shape").c_str());
 }
 
-void BackwardLightSampler::sample_lightset(
+void BackwardLightSampler::on_frame_begin()
+{
+    if (!m_use_light_tree || !m_light_tree->is_built())
+        return;
+
+    // The tree was just built for the first frame.
+    if (m_light_tree_needs_refit)
+    {
+        std::vector<size_t> leaf_node_indices;
+        size_t light_index = 0;
+        size_t group_index = 0;
+
+        if (update_light_tree_lights(
+                m_scene.assembly_instances(),
+                TransformSequence(),
+                light_index,
+                group_index,
+                leaf_node_indices) &&
+            light_index == m_light_tree_lights.size() &&
+            group_index == m_emitting_shape_groups.size())
+            m_light_tree->refit(leaf_node_indices);
+        else RENDERER_LOG_WARNING("light emitters were added or removed since the light tree was built; light tree not refitted.");
+    }
+
+    m_light_tree_needs_refit = true;
+}
+
+void BackwardLightSampler::collect_emitting_shape_groups(
+    const AssemblyInstanceContainer&    assembly_instances,
+    const TransformSequence&            parent_transform_seq,
+    const ShapeHandlingFunction&        shape_handling)
+{
+    for (const AssemblyInstance& assembly_instance : assembly_instances)
+    {
+        // Retrieve the assembly.
+        const Assembly& assembly = assembly_instance.get_assembly();
+
+        // Compute the cumulated transform sequence of this assembly instance.
+        TransformSequence cumulated_transform_seq =
+            assembly_instance.transform_sequence() * parent_transform_seq;
+        cumulated_transform_seq.prepare();
+
+        // Recurse into child assembly instances.
+        collect_emitting_shape_groups(
+            assembly.assembly_instances(),
+            cumulated_transform_seq,
+            shape_handling);
+
+        // Collect emitting shapes from this assembly instance.
+        EmittingShapeGroup group;
+        group.m_transform = cumulated_transform_seq.get_earliest_transform();
+        group.m_begin = m_emitting_shapes.size();
+        collect_emitting_shapes(
+            assembly,
+            assembly_instance,
+            cumulated_transform_seq,
+            shape_handling);
+        group.m_end = m_emitting_shapes.size();
+        m_emitting_shape_groups.push_back(group);
+    }
+}
+
+bool BackwardLightSampler::update_light_tree_lights(
+    const AssemblyInstanceContainer&    assembly_instances,
+    const TransformSequence&            parent_transform_seq,
+    size_t&                             light_index,
+    size_t&                             group_index,
+    std::vector<size_t>&                leaf_node_indices)
+{
+    // Assembly instances are visited in the same order as when the tree was built.
+    for (const AssemblyInstance& assembly_instance : assembly_instances)
+    {
+        // Retrieve the assembly.
+        const Assembly& assembly = assembly_instance.get_assembly();
+
+        // Compute the cumulated transform sequence of this assembly instance.
+        TransformSequence cumulated_transform_seq =
+            assembly_instance.transform_sequence() * parent_transform_seq;
+        cumulated_transform_seq.prepare();
+
+        // Recurse into child assembly instances.
+        if (!update_light_tree_lights(
+                assembly.assembly_instances(),
+                cumulated_transform_seq,
+                light_index,
+                group_index,
+                leaf_node_indices))
+            return false;
+
+        const Transformd& transform = cumulated_transform_seq.get_earliest_transform();
+
+        // Update the light tree lights of this assembly instance.
+        for (const Light& light : assembly.lights())
+        {
+            if ((light.get_flags() & Light::LightTreeCompatible) == 0)
+                continue;
+
+            if (light_index == m_light_tree_lights.size() ||
+                m_light_tree_lights[light_index].m_light != &light)
+                return false;
+
+            NonPhysicalLightInfo& light_info = m_light_tree_lights[light_index];
+            if (light_info.m_transform_sequence.get_earliest_transform() != transform)
+                leaf_node_indices.push_back(m_light_tree->get_non_physical_light_node_index(light_index));
+            light_info.m_transform_sequence = cumulated_transform_seq;
+
+            ++light_index;
+        }
+
+        // Update the emitting shapes of this assembly instance if it moved.
+        if (group_index == m_emitting_shape_groups.size())
+            return false;
+
+        EmittingShapeGroup& group = m_emitting_shape_groups[group_index++];
+        if (group.m_transform != transform)
+        {
+            if (!update_emitting_shape_group(assembly_instance, cumulated_transform_seq, group))
+                return false;
+
+            for (size_t i = group.m_begin; i < group.m_end; ++i)
+                leaf_node_indices.push_back(m_emitting_shapes[i].m_light_tree_node_index);
+        }
+    }
+
+    return true;
+}
+
+bool BackwardLightSampler::update_emitting_shape_group(
+    const AssemblyInstance&             assembly_instance,
+    const TransformSequence&            transform_sequence,
+    EmittingShapeGroup&                 group)
+{
+    group.m_transform = transform_sequence.get_earliest_transform();
+
+    if (group.m_begin == group.m_end)
+        return true;
+
+    // Shapes are appended to m_emitting_shapes: collect them into an empty vector.
+    EmittingShapeVector emitting_shapes;
+    emitting_shapes.swap(m_emitting_shapes);
+    collect_emitting_shapes(
+        assembly_instance.get_assembly(),
+        assembly_instance,
+        transform_sequence,
+        [](
+            const Material* material,
+            const float     area,
+            const size_t    emitting_shape_index)
+        {
+            return material->get_uncached_edf() != nullptr;
+        });
+    emitting_shapes.swap(m_emitting_shapes);
+
+    if (emitting_shapes.size() != group.m_end - group.m_begin)
+        return false;
+
+    // Overwrite the shapes in place so that the hash table and the light tree still refer to them.
+    for (size_t i = 0, e = emitting_shapes.size(); i < e; ++i)
+    {
+        EmittingShape& shape = m_emitting_shapes[group.m_begin + i];
+        const size_t light_tree_node_index = shape.m_light_tree_node_index;
+        shape = emitting_shapes[i];
+        shape.m_light_tree_node_index = light_tree_node_index;
+    }
+
+    return true;
+}
+
+size_t BackwardLightSampler::sample_lightset(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
     const ShadingPoint&                 shading_point,
-    LightSample&                        light_sample) const
+    LightSample                         light_samples[]) const
 {
     if (m_use_light_tree)
     {
         // Light tree sampling.
-        sample_light_tree(
-            time,
-            s,
-            shading_point,
-            light_sample);
+        return
+            sample_light_tree(
+                time,
+                s,
+                shading_point,
+                light_samples);
     }
     else
     {
@@ -218,7 +408,8 @@ void BackwardLightSampler::sample_lightset(
         sample_emitting_shapes(
             time,
             s,
-            light_sample);
+            light_samples[0]);
+        return 1;
     }
 }
 
@@ -250,51 +441,56 @@ float BackwardLightSampler::evaluate_pdf(
     return shape_probability;
 }
 
-void BackwardLightSampler::sample_light_tree(
+size_t BackwardLightSampler::sample_light_tree(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
     const ShadingPoint&                 shading_point,
-    LightSample&                        light_sample) const
+    LightSample                         light_samples[]) const
 {
     assert(has_lightset());
 
-    LightType light_type;
-    size_t light_index;
-    float light_prob;
-    m_light_tree->sample(
-        shading_point,
-        s[0],
-        light_type,
-        light_index,
-        light_prob);
-
-    if (light_type == NonPhysicalLightType)
-    {
-        // Fetch the light.
-        const NonPhysicalLightInfo& light_info = m_light_tree_lights[light_index];
-        light_sample.m_light = light_info.m_light;
-
-        // Evaluate and store the transform of the light.
-        light_sample.m_light_transform =
-              light_info.m_light->get_transform()
-            * light_info.m_transform_sequence.evaluate(time.m_absolute);
+    LightTree::SampledLight sampled_lights[LightTree::MaxSampleCount];
+    const size_t sample_count =
+        m_light_tree->sample(
+            shading_point,
+            s[0],
+            sampled_lights);
 
-        // Store the probability density of this light.
-        light_sample.m_probability = light_prob;
-    }
-    else
+    for (size_t i = 0; i < sample_count; ++i)
     {
-        assert(light_type == EmittingShapeType);
-        sample_emitting_shape(
-            time,
-            Vector2f(s[1], s[2]),
-            light_index,
-            light_prob,
-            light_sample);
+        const LightTree::SampledLight& sampled_light = sampled_lights[i];
+        LightSample& light_sample = light_samples[i];
+
+        if (sampled_light.m_light_type == NonPhysicalLightType)
+        {
+            // Fetch the light.
+            const NonPhysicalLightInfo& light_info = m_light_tree_lights[sampled_light.m_light_index];
+            light_sample.m_light = light_info.m_light;
+
+            // Evaluate and store the transform of the light.
+            light_sample.m_light_transform =
+                  light_info.m_light->get_transform()
+                * light_info.m_transform_sequence.evaluate(time.m_absolute);
+
+            // Store the probability density of this light.
+            light_sample.m_probability = sampled_light.m_probability;
+        }
+        else
+        {
+            assert(sampled_light.m_light_type == EmittingShapeType);
+            sample_emitting_shape(
+                time,
+                Vector2f(s[1], s[2]),
+                sampled_light.m_light_index,
+                sampled_light.m_probability,
+                light_sample);
+        }
+
+        assert(light_sample.m_light || light_sample.m_shape);
+        assert(light_sample.m_probability > 0.0f);
     }
 
-    assert(light_sample.m_light || light_sample.m_shape);
-    assert(light_sample.m_probability > 0.0f);
+    return sample_count;
 }
 
 }   // namespace renderer
@@ -34,9 +34,12 @@
 #include "renderer/kernel/lighting/lighttree.h"
 #include "renderer/kernel/lighting/lighttypes.h"
 #include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/transform.h"
 
 // Standard headers.
 #include <cstddef>
@@ -78,12 +81,21 @@ class BackwardLightSampler
     // Return true if the light set is not empty.
     bool has_lightset() const;
 
-    // Sample the light set.
-    void sample_lightset(
+    // Maximum number of light samples returned by sample_lightset().
+    static const size_t MaxLightSetSampleCount = LightTree::MaxSampleCount;
+
+    // Refit the light tree to the current position of the lights.
+    // Call this before rendering each frame.
+    void on_frame_begin();
+
+    // Sample the light set. When adaptive light tree splitting is enabled, several
+    // lights may be sampled at once and their contributions must be summed.
+    // Return the number of light samples, at most MaxLightSetSampleCount.
+    size_t sample_lightset(
         const ShadingRay::Time&             time,
         const foundation::Vector3f&         s,
         const ShadingPoint&                 shading_point,
-        LightSample&                        light_sample) const;
+        LightSample                         light_samples[]) const;
 
     // Compute the probability density in area measure of a given light sample.
     // Shading points are located on the light (emitting shape) hit by the
@@ -93,15 +105,53 @@ class BackwardLightSampler
         const ShadingPoint&                 surface_shading_point) const;
 
   private:
+    // Emitting shapes collected from a given assembly instance.
+    struct EmittingShapeGroup
+    {
+        foundation::Transformd              m_transform;        // assembly instance transform at collection time
+        size_t                              m_begin;            // index of the first shape in m_emitting_shapes
+        size_t                              m_end;              // index one past the last shape in m_emitting_shapes
+    };
+
+    typedef std::vector<EmittingShapeGroup> EmittingShapeGroupVector;
+
+    const Scene&                            m_scene;
     bool                                    m_use_light_tree;
     NonPhysicalLightVector                  m_light_tree_lights;
+    EmittingShapeGroupVector                m_emitting_shape_groups;
     std::unique_ptr<LightTree>              m_light_tree;
-
-    void sample_light_tree(
+    bool                                    m_light_tree_needs_refit;
+
+    // Recursively collect emitting shapes from a given set of assembly instances,
+    // and remember which shapes were collected from which assembly instance.
+    void collect_emitting_shape_groups(
+        const AssemblyInstanceContainer&    assembly_instances,
+        const TransformSequence&            parent_transform_seq,
+        const ShapeHandlingFunction&        shape_handling);
+
+    // Update in place the light tree lights and the emitting shapes of the assembly
+    // instances that moved since the previous frame, and append the light tree leaves
+    // that need to be refitted to leaf_node_indices. Return false if lights were added
+    // or removed since the light tree was built.
+    bool update_light_tree_lights(
+        const AssemblyInstanceContainer&    assembly_instances,
+        const TransformSequence&            parent_transform_seq,
+        size_t&                             light_index,
+        size_t&                             group_index,
+        std::vector<size_t>&                leaf_node_indices);
+
+    // Collect again the emitting shapes of a given group after its assembly instance moved.
+    // Return false if the number of shapes changed.
+    bool update_emitting_shape_group(
+        const AssemblyInstance&             assembly_instance,
+        const TransformSequence&            transform_sequence,
+        EmittingShapeGroup&                 group);
+
+    size_t sample_light_tree(
         const ShadingRay::Time&             time,
         const foundation::Vector3f&         s,
         const ShadingPoint&                 shading_point,
-        LightSample&                        light_sample) const;
+        LightSample                         light_samples[]) const;
 };
 
 
@@ -30,6 +30,7 @@
 #include "bdptlightingengine.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/bdpt/bdptmisweight.h"
 #include "renderer/kernel/lighting/forwardlightsampler.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/tracer.h"
@@ -41,13 +42,15 @@
 #include "renderer/modeling/project/project.h"
 
 // appleseed.foundation headers.
-#include "foundation/math/fp.h"
 #include "foundation/math/population.h"
-#include "foundation/memory/arena.h"
+#include "foundation/memory/alignedallocator.h"
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
+#include <vector>
 
 using namespace foundation;
 
@@ -74,12 +77,14 @@ namespace
         const BSDF*             m_bsdf;
         const void*             m_bsdf_data;
         Vector3d                m_dir_to_prev_vertex;
-        const BDPTVertex*       m_prev_vertex;
         Basis3f                 m_shading_basis;
         Spectrum                m_Le;
         ShadingPoint            m_shading_point;
         bool                    m_is_light_vertex;
 
+        // Area densities of this vertex when sampled by its own subpath (forward) and
+        // by the other subpath (reverse), see compute_subpath_densities(). The reverse
+        // density is only valid for vertices at least two vertices away from the end of the subpath.
         float                   m_fwd_pdf;
         float                   m_rev_pdf;
 
@@ -87,7 +92,6 @@ namespace
           : m_beta(0.0f)
           , m_bsdf(nullptr)
           , m_bsdf_data(nullptr)
-          , m_prev_vertex(nullptr)
           , m_Le(0.0f)
           , m_is_light_vertex(false)
           , m_fwd_pdf(0.0f)
@@ -107,6 +111,29 @@ namespace
         }
     };
 
+    typedef std::vector<BDPTVertex, AlignedAllocator<BDPTVertex>> BDPTVertexVector;
+
+    //
+    // A full path made of the first s vertices of a light subpath followed by the first t - 1
+    // vertices of a camera subpath, in reverse order. Vertices are numbered from 1 (the vertex
+    // on the light source) to s + t - 1 (the first vertex of the camera subpath); the camera
+    // itself would be vertex s + t.
+    //
+
+    struct BDPTPath
+    {
+        const BDPTVertex*       m_light_vertices;
+        const BDPTVertex*       m_camera_vertices;
+        size_t                  m_s;
+        size_t                  m_t;
+
+        const BDPTVertex& operator[](const size_t i) const
+        {
+            assert(i >= 1 && i < m_s + m_t);
+            return i <= m_s ? m_light_vertices[i - 1] : m_camera_vertices[m_s + m_t - i - 1];
+        }
+    };
+
     /// todo: supports the case where t == 1 (if pdf for camera can be queried)
     class BDPTLightingEngine
       : public ILightingEngine
@@ -138,7 +165,17 @@ namespace
             m_shutter_open_begin_time = camera->get_shutter_open_begin_time();
             m_shutter_close_end_time = camera->get_shutter_close_end_time();
 
-            m_num_max_vertices = m_params.m_max_bounces + 3;
+            m_num_max_vertices =
+                m_params.m_max_bounces == ~size_t(0)
+                    ? ~size_t(0)
+                    : m_params.m_max_bounces + 3;
+
+            // Subpath vertices are kept from one sample to the next. Reserve room for the longest
+            // subpaths up-front, unless their length is unlimited, in which case the vertex vectors
+            // grow as needed.
+            const size_t reserved_vertices = std::min<size_t>(m_num_max_vertices, MaxReservedVertices);
+            m_light_vertices.reserve(reserved_vertices);
+            m_camera_vertices.reserve(reserved_vertices);
         }
 
         void release() override
@@ -158,16 +195,23 @@ namespace
             ShadingComponents&          radiance,               // output radiance, in W.sr^-1.m^-2
             AOVComponents&              aov_components) override
         {
-            /// todo: use arena to alloc BDPTVertices instead
-            BDPTVertex* camera_vertices = new BDPTVertex[m_num_max_vertices - 1];
-            BDPTVertex* light_vertices = new BDPTVertex[m_num_max_vertices];
+            m_light_vertices.clear();
+            m_camera_vertices.clear();
+
+            trace_light(sampling_context, shading_context, m_light_vertices);
+            trace_camera(sampling_context, shading_context, shading_point, m_camera_vertices);
 
-            size_t num_light_vertices = trace_light(sampling_context, shading_context, light_vertices);
-            size_t num_camera_vertices = trace_camera(sampling_context, shading_context, shading_point, camera_vertices);
+            const size_t num_light_vertices = m_light_vertices.size();
+            const size_t num_camera_vertices = m_camera_vertices.size();
 
             assert(num_camera_vertices <= m_num_max_vertices - 1);
             assert(num_light_vertices <= m_num_max_vertices);
 
+            BDPTVertex* light_vertices = m_light_vertices.data();
+            BDPTVertex* camera_vertices = m_camera_vertices.data();
+
+            compute_subpath_densities(light_vertices, num_light_vertices, camera_vertices, num_camera_vertices);
+
             for (size_t s = 0; s < num_light_vertices + 1; s++)
             {
                 for (size_t t = 2; t < num_camera_vertices + 2; t++)
@@ -176,9 +220,6 @@ namespace
                         connect(shading_context, shading_point, light_vertices, camera_vertices, s, t, radiance);
                 }
             }
-
-            delete[] camera_vertices;
-            delete[] light_vertices;
         }
 
         // todo: use an output parameter instead of returning a spectrum.
@@ -216,145 +257,146 @@ namespace
             return result;
         }
 
-        /// todo: precompute path density using fwd_pdf and rev_pdf.
-        /// in the final code, this function should be removed and the mis weight computation should be very simple.
-        /// example: https://github.com/mmp/pbrt-v3/blob/master/src/integrators/bdpt.cpp#L228
-        float compute_path_density(
+        // Return the area density of vertex i of a path when sampled from the light side of the path.
+        float light_side_density(
+            const BDPTPath&             path,
+            const size_t                i) const
+        {
+            if (i == 1) // the vertex on light source
+            {
+                const BDPTVertex& vertex = path[i];
+                const float pdf_a = vertex.m_is_light_vertex ? m_light_sampler.evaluate_pdf(vertex.m_shading_point) : 0.0f;
+                assert(pdf_a >= 0.0f);
+                return pdf_a;
+            }
+            else if (i == 2) // the vertex after light source
+            {
+                const BDPTVertex& prev_vertex = path[i - 1];
+                const BDPTVertex& vertex = path[i];
+                /// todo: fix this. This assumes diffuse light source.
+                const float pdf_w = static_cast<float>(dot(normalize(vertex.m_position - prev_vertex.m_position), prev_vertex.m_geometric_normal) * RcpPi<float>());
+                const float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
+                assert(pdf_a >= 0.0f);
+                return pdf_a;
+            }
+            else
+            {
+                const BDPTVertex& prev2_vertex = path[i - 2];
+                const BDPTVertex& prev_vertex = path[i - 1];
+                const BDPTVertex& vertex = path[i];
+                if (prev_vertex.m_bsdf == nullptr)
+                    return 0.0f;
+                BSDF::LocalGeometry local_geometry;
+                local_geometry.m_shading_point = &prev_vertex.m_shading_point;
+                local_geometry.m_geometric_normal = Vector3f(prev_vertex.m_geometric_normal);
+                local_geometry.m_shading_basis = prev_vertex.m_shading_basis;
+                const float pdf_w =
+                    prev_vertex.m_bsdf->evaluate_pdf(
+                        prev_vertex.m_bsdf_data,
+                        true,
+                        local_geometry,
+                        static_cast<Vector3f>(normalize(vertex.m_position - prev_vertex.m_position)),
+                        static_cast<Vector3f>(normalize(prev2_vertex.m_position - prev_vertex.m_position)),
+                        ScatteringMode::All);
+                const float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
+                assert(pdf_a >= 0.0f);
+                return pdf_a;
+            }
+        }
+
+        // Return the area density of vertex i of a path when sampled from the camera side of the path.
+        float camera_side_density(
+            const BDPTPath&             path,
+            const size_t                i) const
+        {
+            const size_t n = path.m_s + path.m_t;
+
+            if (i + 1 == n) // the shading point
+                return 1.0f;
+
+            const BDPTVertex& prev_vertex = path[i + 1];
+            const BDPTVertex& vertex = path[i];
+            if (prev_vertex.m_bsdf == nullptr)
+                return 0.0f;
+            BSDF::LocalGeometry local_geometry;
+            local_geometry.m_shading_point = &prev_vertex.m_shading_point;
+            local_geometry.m_geometric_normal = Vector3f(prev_vertex.m_geometric_normal);
+            local_geometry.m_shading_basis = prev_vertex.m_shading_basis;
+            const float pdf_w =
+                prev_vertex.m_bsdf->evaluate_pdf(
+                    prev_vertex.m_bsdf_data,
+                    false,
+                    local_geometry,
+                    static_cast<Vector3f>(normalize(vertex.m_position - prev_vertex.m_position)),
+                    i + 2 == n
+                        ? static_cast<Vector3f>(prev_vertex.m_dir_to_prev_vertex)     // first point after shading point
+                        : static_cast<Vector3f>(normalize(path[i + 2].m_position - prev_vertex.m_position)),
+                    ScatteringMode::All);
+            const float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
+            assert(pdf_a >= 0.0f);
+            return pdf_a;
+        }
+
+        // Compute the forward and reverse densities of the vertices of both subpaths. Only the densities
+        // of the few vertices next to the connection depend on the connection itself; all the others
+        // are computed here once and shared by all the connection strategies.
+        void compute_subpath_densities(
             BDPTVertex*                 light_vertices,
+            const size_t                num_light_vertices,
             BDPTVertex*                 camera_vertices,
-            const size_t                s,
-            const size_t                t,
-            const size_t                p,
-            const size_t                q)
+            const size_t                num_camera_vertices) const
         {
-            assert(p + q == s + t);
-
-            // get i Vertex in the constructed path
-            // i = 1 correspond first vertex of the full path
+            const BDPTPath light_path = { light_vertices, camera_vertices, num_light_vertices, 2 };
 
-            auto get_vertex_start_from_light = [&](const size_t i)
+            for (size_t i = 1; i <= num_light_vertices; ++i)
             {
-                if (i <= s)
-                {
-                    return &light_vertices[i - 1];
-                }
-                else
-                {
-                    return &camera_vertices[s + t - i - 1];
-                }
-            };
+                BDPTVertex& vertex = light_vertices[i - 1];
+                vertex.m_fwd_pdf = light_side_density(light_path, i);
+                vertex.m_rev_pdf = i + 2 <= num_light_vertices ? camera_side_density(light_path, i) : 0.0f;
+            }
 
-            auto get_vertex_start_from_camera = [&](const size_t i)
-            {
-                if (i <= t)
-                {
-                    return &camera_vertices[i - 2];
-                }
-                else
-                {
-                    return &light_vertices[s + t - i];
-                }
-            };
+            const BDPTPath camera_path = { light_vertices, camera_vertices, 0, num_camera_vertices + 1 };
 
-            /// todo: swap all pdf computation to rev_pdf and fwd_pdf
-            float result = 1.0f;
-            // start from light
-            for (size_t i = 1; i <= p; i++)
+            for (size_t j = 0; j < num_camera_vertices; ++j)
             {
-                if (i == 1) // the vertex on light source
-                {
-                    const BDPTVertex& vertex = *get_vertex_start_from_light(i);
-                    float pdf_a = vertex.m_is_light_vertex ? m_light_sampler.evaluate_pdf(vertex.m_shading_point) : 0.0f;
-                    assert(pdf_a >= 0.0f);
-                    result *= pdf_a;
-                }
-                else if (i == 2) // the vertex after light source
-                {
-                    const BDPTVertex& prev_vertex = *get_vertex_start_from_light(i - 1);
-                    const BDPTVertex& vertex = *get_vertex_start_from_light(i);
-                    /// todo: fix this. This assumes diffuse light source.
-                    float pdf_w = static_cast<float>(dot(normalize(vertex.m_position - prev_vertex.m_position), prev_vertex.m_geometric_normal) * RcpPi<float>());
-                    float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
-                    assert(pdf_a >= 0.0f);
-                    result *= pdf_a;
-                }
-                else
-                {
-                    const BDPTVertex& prev2_vertex = *get_vertex_start_from_light(i - 2);
-                    const BDPTVertex& prev_vertex = *get_vertex_start_from_light(i - 1);
-                    const BDPTVertex& vertex = *get_vertex_start_from_light(i);
-                    BSDF::LocalGeometry local_geometry;
-                    local_geometry.m_shading_point = &prev_vertex.m_shading_point;
-                    local_geometry.m_geometric_normal = Vector3f(prev_vertex.m_geometric_normal);
-                    local_geometry.m_shading_basis = prev_vertex.m_shading_basis;
-                    const float pdf_w =
-                        prev_vertex.m_bsdf->evaluate_pdf(
-                            prev_vertex.m_bsdf_data,
-                            true,
-                            local_geometry,
-                            static_cast<Vector3f>(normalize(vertex.m_position - prev_vertex.m_position)),
-                            static_cast<Vector3f>(normalize(prev2_vertex.m_position - prev_vertex.m_position)),
-                            ScatteringMode::All);
-                    float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
-                    assert(pdf_a >= 0.0f);
-                    result *= pdf_a;
-                }
+                const size_t i = num_camera_vertices - j;
+                BDPTVertex& vertex = camera_vertices[j];
+                vertex.m_fwd_pdf = camera_side_density(camera_path, i);
+                vertex.m_rev_pdf = j + 2 < num_camera_vertices ? light_side_density(camera_path, i) : 0.0f;
             }
+        }
 
-            // start from camera
-            for (size_t i = 3; i <= q; i++)
+        // Compute the balance heuristic weight of the strategy that generated a given path.
+        float compute_mis_weight(const BDPTPath& path) const
+        {
+            const size_t s = path.m_s;
+
+            auto light_density = [&](const size_t i)
             {
-                if (i == 3) // first point after shading point
-                {
-                    const BDPTVertex& prev_vertex = *get_vertex_start_from_camera(i - 1);
-                    const BDPTVertex& vertex = *get_vertex_start_from_camera(i);
-                    BSDF::LocalGeometry local_geometry;
-                    local_geometry.m_shading_point = &prev_vertex.m_shading_point;
-                    local_geometry.m_geometric_normal = Vector3f(prev_vertex.m_geometric_normal);
-                    local_geometry.m_shading_basis = prev_vertex.m_shading_basis;
-                    const float pdf_w =
-                        prev_vertex.m_bsdf->evaluate_pdf(
-                            prev_vertex.m_bsdf_data,
-                            false,
-                            local_geometry,
-                            static_cast<Vector3f>(normalize(vertex.m_position - prev_vertex.m_position)),
-                            static_cast<Vector3f>(prev_vertex.m_dir_to_prev_vertex),
-                            ScatteringMode::All);
-                    float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
-                    assert(pdf_a >= 0.0f);
-                    result *= pdf_a;
-                }
-                else
-                {
-                    const BDPTVertex& prev2_vertex = *get_vertex_start_from_camera(i - 2);
-                    const BDPTVertex& prev_vertex = *get_vertex_start_from_camera(i - 1);
-                    const BDPTVertex& vertex = *get_vertex_start_from_camera(i);
-                    BSDF::LocalGeometry local_geometry;
-                    local_geometry.m_shading_point = &prev_vertex.m_shading_point;
-                    local_geometry.m_geometric_normal = Vector3f(prev_vertex.m_geometric_normal);
-                    local_geometry.m_shading_basis = prev_vertex.m_shading_basis;
-                    const float pdf_w =
-                        prev_vertex.m_bsdf->evaluate_pdf(
-                            prev_vertex.m_bsdf_data,
-                            false,
-                            local_geometry,
-                            static_cast<Vector3f>(normalize(vertex.m_position - prev_vertex.m_position)),
-                            static_cast<Vector3f>(normalize(prev2_vertex.m_position - prev_vertex.m_position)),
-                            ScatteringMode::All);
-                    float pdf_a = static_cast<float>(prev_vertex.convert_density(pdf_w, vertex));
-                    assert(pdf_a >= 0.0f);
-                    result *= pdf_a;
-                }
-            }
+                if (i <= s)
+                    return path[i].m_fwd_pdf;
+                if (i >= s + 3)
+                    return path[i].m_rev_pdf;
+                return light_side_density(path, i);
+            };
 
-            return result;
+            auto camera_density = [&](const size_t i)
+            {
+                if (i > s)
+                    return path[i].m_fwd_pdf;
+                if (i + 2 <= s)
+                    return path[i].m_rev_pdf;
+                return camera_side_density(path, i);
+            };
+
+            return compute_bdpt_mis_weight(path.m_s, path.m_t, light_density, camera_density);
         }
 
         void connect(
             const ShadingContext&       shading_context,
             const ShadingPoint&         shading_point,
-            BDPTVertex*                 light_vertices,
-            BDPTVertex*                 camera_vertices,
+            const BDPTVertex*           light_vertices,
+            const BDPTVertex*           camera_vertices,
             const size_t                s,
             const size_t                t,
             ShadingComponents&          radiance)
@@ -453,33 +495,19 @@ namespace
             if (fz(result, 1.0e-4f))
                 return;
 
-            const float numerator = compute_path_density(light_vertices, camera_vertices, s, t, s, t);
-            if (numerator == 0.0f)
+            const BDPTPath path = { light_vertices, camera_vertices, s, t };
+            const float mis_weight = compute_mis_weight(path);
+            if (mis_weight == 0.0f)
                 return;
 
-            /// todo: unhandled case where (numerator <= 0) (specular surface / impossible path).
-            assert(FP<float>::is_finite(numerator));
-            assert(numerator > 0.0f);
-
-            float denominator = 0.0f;
-            // [p = 0, q = s + t], [p = 1, q = s + t - 1] ... [p = s + t - 2, q = 2]
-            for (size_t i = 0; i <= s + t - 2; i++)
-                denominator += compute_path_density(light_vertices, camera_vertices, s, t, i, s + t - i);
-
-            /// todo: unhandled case where (denominator <= 0) (specular surface / impossible path).
-            assert(FP<float>::is_finite(denominator));
-            assert(denominator > 0.0f);
-
-            const float mis_weight = numerator / denominator;
-
             assert(mis_weight <= 1.0f);
             radiance.m_beauty += mis_weight * result;
         }
 
-        size_t trace_light(
+        void trace_light(
             SamplingContext&            sampling_context,
             const ShadingContext&       shading_context,
-            BDPTVertex*                 vertices)
+            BDPTVertexVector&           vertices)
         {
             // Sample the light sources.
             sampling_context.split_in_place(4, 1);
@@ -493,24 +521,28 @@ namespace
                 Vector3f(s[1], s[2], s[3]),
                 light_sample);
 
-            return
-                light_sample.m_shape != nullptr
-                    ? trace_emitting_shape(
-                        sampling_context,
-                        shading_context,
-                        light_sample,
-                        vertices)
-                    : trace_non_physical_light(
-                        sampling_context,
-                        shading_context,
-                        light_sample);
+            if (light_sample.m_shape != nullptr)
+            {
+                trace_emitting_shape(
+                    sampling_context,
+                    shading_context,
+                    light_sample,
+                    vertices);
+            }
+            else
+            {
+                trace_non_physical_light(
+                    sampling_context,
+                    shading_context,
+                    light_sample);
+            }
         }
 
-        size_t trace_emitting_shape(
+        void trace_emitting_shape(
             SamplingContext&            sampling_context,
             const ShadingContext&       shading_context,
             LightSample&                light_sample,
-            BDPTVertex*                 vertices)
+            BDPTVertexVector&           vertices)
         {
             // Make sure the geometric normal of the light sample is in the same hemisphere as the shading normal.
             light_sample.m_geometric_normal =
@@ -574,22 +606,19 @@ namespace
                 VisibilityFlags::LightRay,
                 0);
 
-            BDPTVertex& bdpt_vertex = vertices[0];
+            vertices.emplace_back();
+            BDPTVertex& bdpt_vertex = vertices.back();
             bdpt_vertex.m_beta = initial_flux;
-            bdpt_vertex.m_fwd_pdf = light_sample.m_probability;
             /// CONFUSE:: why geometric normal is flipped?
             bdpt_vertex.m_geometric_normal = -light_shading_point.get_geometric_normal();
             bdpt_vertex.m_is_light_vertex = true;
             bdpt_vertex.m_position = light_shading_point.get_point();
-            bdpt_vertex.m_rev_pdf = 1.0;
             bdpt_vertex.m_shading_point = light_shading_point;
 
             // Build the path tracer.
-            size_t num_light_vertices = 1;
             PathVisitor path_visitor(initial_flux * dot(emission_direction, Vector3f(light_sample.m_shading_normal)) / edf_prob,
                                      shading_context,
-                                     vertices,
-                                     &num_light_vertices);
+                                     vertices);
             VolumeVisitor volume_visitor;
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(
                 path_visitor,
@@ -612,26 +641,23 @@ namespace
                     false);
 
             m_light_path_length.insert(light_path_length);
-            assert(num_light_vertices <= m_num_max_vertices);
-            return num_light_vertices;
+            assert(vertices.size() <= m_num_max_vertices);
         }
 
-        size_t trace_non_physical_light(
+        void trace_non_physical_light(
             SamplingContext&            sampling_context,
             const ShadingContext&       shading_context,
             LightSample&                light_sample)
         {
-            return 0;
         }
 
-        size_t trace_camera(
+        void trace_camera(
             SamplingContext&            sampling_context,
             const ShadingContext&       shading_context,
             const ShadingPoint&         shading_point,
-            BDPTVertex*                 vertices)
+            BDPTVertexVector&           vertices)
         {
-            size_t num_camera_vertices = 0;
-            PathVisitor path_visitor(Spectrum(1.0), shading_context, vertices, &num_camera_vertices);
+            PathVisitor path_visitor(Spectrum(1.0), shading_context, vertices);
             VolumeVisitor volume_visitor;
 
             PathTracer<PathVisitor, VolumeVisitor, false> path_tracer(
@@ -654,8 +680,7 @@ namespace
                     false);
 
             m_camera_path_length.insert(camera_path_length);
-            assert(num_camera_vertices <= m_num_max_vertices - 1);
-            return num_camera_vertices;
+            assert(vertices.size() <= m_num_max_vertices - 1);
         }
 
         StatisticsVector get_statistics() const override
@@ -676,24 +701,27 @@ namespace
         Population<std::uint64_t>   m_light_path_length;
         Population<std::uint64_t>   m_camera_path_length;
 
+        // Maximum number of vertices per subpath for which storage is reserved up-front.
+        enum { MaxReservedVertices = 256 };
+
         size_t                      m_num_max_vertices;
 
+        BDPTVertexVector            m_light_vertices;
+        BDPTVertexVector            m_camera_vertices;
+
         struct PathVisitor
         {
             const ShadingContext&           m_shading_context;
             Spectrum                        m_initial_beta;
-            BDPTVertex*                     m_vertices;
-            size_t*                         m_num_vertices;
+            BDPTVertexVector&               m_vertices;
 
             PathVisitor(
                 const Spectrum&             initial_beta,
                 const ShadingContext&       shading_context,
-                BDPTVertex*                 vertices,
-                size_t*                     num_vertices)
+                BDPTVertexVector&           vertices)
               : m_initial_beta(initial_beta)
               , m_shading_context(shading_context)
               , m_vertices(vertices)
-              , m_num_vertices(num_vertices)
             {
             }
 
@@ -717,17 +745,16 @@ namespace
             void on_hit(const PathVertex& vertex)
             {
                 // create BDPT Vertex
-                BDPTVertex& bdpt_vertex = m_vertices[*m_num_vertices];
+                m_vertices.emplace_back();
+                BDPTVertex& bdpt_vertex = m_vertices.back();
                 bdpt_vertex.m_beta = vertex.m_throughput * m_initial_beta;
                 bdpt_vertex.m_bsdf = vertex.m_bsdf;
                 bdpt_vertex.m_bsdf_data = vertex.m_bsdf_data;
                 bdpt_vertex.m_dir_to_prev_vertex = normalize(vertex.m_outgoing.get_value());
-                bdpt_vertex.m_fwd_pdf = vertex.m_prev_prob;
                 bdpt_vertex.m_geometric_normal = vertex.get_geometric_normal();
                 bdpt_vertex.m_position = vertex.get_point();
                 bdpt_vertex.m_shading_basis = Basis3f(vertex.get_shading_basis());
                 bdpt_vertex.m_shading_point = *vertex.m_shading_point;
-                /// todo: compute rev_pdf here
 
                 if (vertex.m_edf)
                 {
@@ -735,8 +762,6 @@ namespace
                     bdpt_vertex.m_is_light_vertex = true;
                 }
 
-                bdpt_vertex.m_prev_vertex = (*m_num_vertices == 0) ? nullptr : m_vertices - 1;
-                (*m_num_vertices)++;
             }
 
             void on_scatter(PathVertex& vertex)
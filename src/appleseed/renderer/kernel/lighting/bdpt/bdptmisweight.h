@@ -0,0 +1,114 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/fp.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace renderer
+{
+
+//
+// Compute the balance heuristic weight of the bidirectional path tracing strategy that
+// generated a path from s light vertices and t camera vertices, in time linear in the
+// path length.
+//
+// Vertices of the path are numbered from 1 (the vertex on the light source) to s + t - 1
+// (the first vertex of the camera subpath); the camera itself would be vertex s + t.
+// light_density(i) and camera_density(i) return the area density of vertex i when
+// sampled from the light side and from the camera side of the path, respectively.
+//
+// The densities of the other strategies are expressed as products of ratios relative
+// to the density of this strategy.
+//
+// Reference:
+//
+//   Robust Monte Carlo Methods for Light Transport Simulation, Eric Veach, section 10.2
+//   http://graphics.stanford.edu/papers/veach_thesis/
+//
+
+template <typename LightDensity, typename CameraDensity>
+float compute_bdpt_mis_weight(
+    const size_t            s,
+    const size_t            t,
+    const LightDensity&     light_density,
+    const CameraDensity&    camera_density);
+
+
+//
+// Implementation.
+//
+
+template <typename LightDensity, typename CameraDensity>
+float compute_bdpt_mis_weight(
+    const size_t            s,
+    const size_t            t,
+    const LightDensity&     light_density,
+    const CameraDensity&    camera_density)
+{
+    assert(t >= 2);
+
+    const size_t n = s + t;
+
+    float sum = 1.0f;
+
+    // Strategies with fewer light vertices: [p = s - 1, q = t + 1] ... [p = 0, q = s + t].
+    float ratio = 1.0f;
+    for (size_t i = s; i > 0; --i)
+    {
+        const float pdf = light_density(i);
+        if (pdf == 0.0f)
+            return 0.0f;
+        ratio *= camera_density(i) / pdf;
+        sum += ratio;
+    }
+
+    // Strategies with more light vertices: [p = s + 1, q = t - 1] ... [p = s + t - 2, q = 2].
+    ratio = 1.0f;
+    for (size_t i = s + 1; i + 2 <= n; ++i)
+    {
+        const float pdf = camera_density(i);
+        if (pdf == 0.0f)
+            return 0.0f;
+        ratio *= light_density(i) / pdf;
+        sum += ratio;
+    }
+
+    /// todo: unhandled case where (sum is not finite) (specular surface / impossible path).
+    assert(foundation::FP<float>::is_finite(sum));
+
+    return 1.0f / sum;
+}
+
+}   // namespace renderer
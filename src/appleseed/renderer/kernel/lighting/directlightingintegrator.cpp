@@ -56,6 +56,22 @@ using namespace foundation;
 namespace renderer
 {
 
+//
+// DirectLightingIntegrator::ResamplingCandidate class implementation.
+//
+
+struct DirectLightingIntegrator::ResamplingCandidate
+{
+    const EmittingShape*        m_shape;
+    const Light*                m_light;
+    Vector3d                    m_point;                // world space position of the light sample
+    bool                        m_cast_shadows;
+    DirectShadingComponents     m_material_value;
+    Spectrum                    m_light_value;          // MIS-weighted incident radiance, without visibility
+    float                       m_probability;          // probability density of the light sample
+    float                       m_target;               // resampling target function: unshadowed contribution
+};
+
 //
 // DirectLightingIntegrator class implementation.
 //
@@ -67,6 +83,9 @@ namespace renderer
 //   compute_outgoing_radiance_light_sampling_low_variance
 //       add_emitting_shape_sample_contribution
 //       add_non_physical_light_sample_contribution
+//       add_resampled_lightset_sample_contribution
+//           evaluate_emitting_shape_candidate
+//           evaluate_non_physical_light_candidate
 //
 //   compute_outgoing_radiance_combined_sampling_low_variance
 //       compute_outgoing_radiance_material_sampling
@@ -82,7 +101,8 @@ DirectLightingIntegrator::DirectLightingIntegrator(
     const size_t                    material_sample_count,
     const size_t                    light_sample_count,
     const float                     low_light_threshold,
-    const bool                      indirect)
+    const bool                      indirect,
+    const size_t                    resampling_candidate_count)
   : m_shading_context(shading_context)
   , m_light_sampler(light_sampler)
   , m_material_sampler(material_sampler)
@@ -92,6 +112,7 @@ DirectLightingIntegrator::DirectLightingIntegrator(
   , m_light_sample_count(light_sample_count)
   , m_low_light_threshold(low_light_threshold)
   , m_indirect(indirect)
+  , m_resampling_candidate_count(resampling_candidate_count)
 {
 }
 
@@ -156,8 +177,27 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
         }
     }
 
-    // Add contributions from the light set.
-    if (m_light_sampler.has_lightset())
+    // Add contributions from the light set, resampling candidate light samples if enabled.
+    if (m_light_sampler.has_lightset() && m_resampling_candidate_count > 1)
+    {
+        DirectShadingComponents lightset_radiance;
+
+        for (size_t i = 0, e = m_light_sample_count; i < e; ++i)
+        {
+            add_resampled_lightset_sample_contribution(
+                sampling_context,
+                mis_heuristic,
+                outgoing,
+                lightset_radiance,
+                light_path_stream);
+        }
+
+        if (m_light_sample_count > 1)
+            lightset_radiance /= static_cast<float>(m_light_sample_count);
+
+        radiance += lightset_radiance;
+    }
+    else if (m_light_sampler.has_lightset())
     {
         DirectShadingComponents lightset_radiance;
 
@@ -166,32 +206,38 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
         for (size_t i = 0, e = m_light_sample_count; i < e; ++i)
         {
             // Sample the light set.
-            LightSample sample;
-            m_light_sampler.sample_lightset(
-                m_time,
-                sampling_context.next2<Vector3f>(),
-                m_material_sampler.get_shading_point(),
-                sample);
-
-            // Add the contribution of the chosen light.
-            if (sample.m_shape)
-            {
-                add_emitting_shape_sample_contribution(
-                    sampling_context,
-                    sample,
-                    mis_heuristic,
-                    outgoing,
-                    lightset_radiance,
-                    light_path_stream);
-            }
-            else
+            LightSample samples[BackwardLightSampler::MaxLightSetSampleCount];
+            const size_t sample_count =
+                m_light_sampler.sample_lightset(
+                    m_time,
+                    sampling_context.next2<Vector3f>(),
+                    m_material_sampler.get_shading_point(),
+                    samples);
+
+            // Add the contributions of the chosen lights.
+            for (size_t j = 0; j < sample_count; ++j)
             {
-                add_non_physical_light_sample_contribution(
-                    sampling_context,
-                    sample,
-                    outgoing,
-                    lightset_radiance,
-                    light_path_stream);
+                const LightSample& sample = samples[j];
+
+                if (sample.m_shape)
+                {
+                    add_emitting_shape_sample_contribution(
+                        sampling_context,
+                        sample,
+                        mis_heuristic,
+                        outgoing,
+                        lightset_radiance,
+                        light_path_stream);
+                }
+                else
+                {
+                    add_non_physical_light_sample_contribution(
+                        sampling_context,
+                        sample,
+                        outgoing,
+                        lightset_radiance,
+                        light_path_stream);
+                }
             }
         }
 
@@ -552,4 +598,260 @@ void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
     }
 }
 
+void DirectLightingIntegrator::add_resampled_lightset_sample_contribution(
+    SamplingContext&                sampling_context,
+    const MISHeuristic              mis_heuristic,
+    const Dual3d&                   outgoing,
+    DirectShadingComponents&        radiance,
+    LightPathStream*                light_path_stream) const
+{
+    // Streaming weighted reservoir sampling: a single uniform sample decides whether each
+    // candidate replaces the selected one, and is rescaled after each decision.
+    // Splitting in place gives each light sample its own dimensions.
+    sampling_context.split_in_place(1, 1);
+    double s = sampling_context.next2<double>();
+
+    // The reservoir holds the selected candidate; the other slot receives new candidates.
+    ResamplingCandidate candidates[2];
+    size_t selected = 2;
+    size_t candidate_slot = 0;
+    float weight_sum = 0.0f;
+
+    sampling_context.split_in_place(3, m_resampling_candidate_count);
+
+    for (size_t i = 0; i < m_resampling_candidate_count; ++i)
+    {
+        // Sample the light set.
+        LightSample samples[BackwardLightSampler::MaxLightSetSampleCount];
+        const size_t sample_count =
+            m_light_sampler.sample_lightset(
+                m_time,
+                sampling_context.next2<Vector3f>(),
+                m_material_sampler.get_shading_point(),
+                samples);
+
+        // The light samples of a split light tree query are all candidates: the sum of their
+        // resampling weights is an unbiased estimate of the integral of the target function.
+        for (size_t j = 0; j < sample_count; ++j)
+        {
+            ResamplingCandidate& candidate = candidates[candidate_slot];
+
+            const bool valid =
+                samples[j].m_shape
+                    ? evaluate_emitting_shape_candidate(samples[j], mis_heuristic, outgoing, candidate)
+                    : evaluate_non_physical_light_candidate(sampling_context, samples[j], outgoing, candidate);
+
+            if (!valid)
+                continue;
+
+            const float weight = candidate.m_target / candidate.m_probability;
+            weight_sum += weight;
+
+            const double p = weight / weight_sum;
+            if (s < p)
+            {
+                s /= p;
+                selected = candidate_slot;
+                candidate_slot = 1 - candidate_slot;
+            }
+            else s = (s - p) / (1.0 - p);
+        }
+    }
+
+    if (selected == 2)
+        return;
+
+    const ResamplingCandidate& candidate = candidates[selected];
+
+    // Compute the transmission factor between the light sample and the shading point.
+    Spectrum transmission;
+    if (candidate.m_cast_shadows)
+    {
+        m_material_sampler.trace_between(
+            m_shading_context,
+            candidate.m_point,
+            transmission);
+
+        // Discard occluded samples.
+        if (is_zero(transmission))
+            return;
+    }
+    else transmission.set(1.0f);
+
+    // Add the contribution of the selected candidate: f(y) / target(y) * sum(weights) / M.
+    Spectrum light_value = candidate.m_light_value;
+    light_value *= transmission;
+    light_value *= weight_sum / (m_resampling_candidate_count * candidate.m_target);
+    madd(radiance, candidate.m_material_value, light_value);
+
+    // Record light path event.
+    if (light_path_stream)
+    {
+        if (candidate.m_shape)
+        {
+            light_path_stream->sampled_emitting_shape(
+                *candidate.m_shape,
+                candidate.m_point,
+                candidate.m_material_value.m_beauty,
+                light_value);
+        }
+        else
+        {
+            light_path_stream->sampled_non_physical_light(
+                *candidate.m_light,
+                candidate.m_point,
+                candidate.m_material_value.m_beauty,
+                light_value);
+        }
+    }
+}
+
+bool DirectLightingIntegrator::evaluate_emitting_shape_candidate(
+    const LightSample&              sample,
+    const MISHeuristic              mis_heuristic,
+    const Dual3d&                   outgoing,
+    ResamplingCandidate&            candidate) const
+{
+    const Material* material = sample.m_shape->get_material();
+    const Material::RenderData& material_data = material->get_render_data();
+    const EDF* edf = material_data.m_edf;
+
+    // No contribution if we are computing indirect lighting but this light does not cast indirect light.
+    if (m_indirect && !(edf->get_flags() & EDF::CastIndirectLight))
+        return false;
+
+    // Compute the incoming direction in world space.
+    Vector3d incoming = sample.m_point - m_material_sampler.get_point();
+
+    // No contribution if the shading point is behind the light.
+    double cos_on = dot(-incoming, sample.m_shading_normal);
+    if (cos_on <= 0.0)
+        return false;
+
+    // Compute the square distance between the light sample and the shading point.
+    const double square_distance = square_norm(incoming);
+
+    // Don't use this sample if we're closer than the light near start value.
+    if (square_distance < square(edf->get_light_near_start()))
+        return false;
+
+    const double rcp_sample_square_distance = 1.0 / square_distance;
+    const double rcp_sample_distance = std::sqrt(rcp_sample_square_distance);
+
+    // Normalize the incoming direction.
+    cos_on *= rcp_sample_distance;
+    incoming *= rcp_sample_distance;
+
+    // Evaluate the BSDF (or volume).
+    const float material_probability =
+        m_material_sampler.evaluate(
+            Vector3f(outgoing.get_value()),
+            Vector3f(incoming),
+            m_light_sampling_modes,
+            candidate.m_material_value);
+    assert(material_probability >= 0.0f);
+    if (material_probability == 0.0f)
+        return false;
+
+    // Build a shading point on the light source.
+    ShadingPoint light_shading_point;
+    sample.make_shading_point(
+        light_shading_point,
+        sample.m_shading_normal,
+        m_shading_context.get_intersector());
+
+    if (material_data.m_shader_group)
+    {
+        m_shading_context.execute_osl_emission(
+            *material_data.m_shader_group,
+            light_shading_point);
+    }
+
+    // Evaluate the EDF.
+    candidate.m_light_value = Spectrum(Spectrum::Illuminance);
+    edf->evaluate(
+        edf->evaluate_inputs(m_shading_context, light_shading_point),
+        Vector3f(sample.m_geometric_normal),
+        Basis3f(Vector3f(sample.m_shading_normal)),
+        -Vector3f(incoming),
+        candidate.m_light_value);
+
+    // Compute geometric term.
+    const float g = static_cast<float>(cos_on * rcp_sample_square_distance);
+
+    // Apply MIS weighting. The weight only depends on the candidate's own probability density:
+    // resampling then estimates the MIS-weighted integrand without bias.
+    const float mis_weight =
+        mis(
+            mis_heuristic,
+            m_light_sample_count * sample.m_probability,
+            m_material_sample_count * material_probability * g);
+
+    candidate.m_light_value *= mis_weight * g;
+
+    candidate.m_shape = sample.m_shape;
+    candidate.m_light = nullptr;
+    candidate.m_point = sample.m_point;
+    candidate.m_cast_shadows = true;
+    candidate.m_probability = sample.m_probability;
+    candidate.m_target = average_value(candidate.m_material_value.m_beauty * candidate.m_light_value);
+
+    return candidate.m_target > 0.0f;
+}
+
+bool DirectLightingIntegrator::evaluate_non_physical_light_candidate(
+    SamplingContext&                sampling_context,
+    const LightSample&              sample,
+    const Dual3d&                   outgoing,
+    ResamplingCandidate&            candidate) const
+{
+    const Light* light = sample.m_light;
+
+    // No contribution if we are computing indirect lighting but this light does not cast indirect light.
+    if (m_indirect && !(light->get_flags() & Light::CastIndirectLight))
+        return false;
+
+    // Generate a uniform sample in [0,1)^2.
+    SamplingContext child_sampling_context = sampling_context.split(2, 1);
+    const Vector2d s = child_sampling_context.next2<Vector2d>();
+
+    // Evaluate the light.
+    Vector3d emission_position, emission_direction;
+    candidate.m_light_value = Spectrum(Spectrum::Illuminance);
+    float probability;
+    light->sample(
+        m_shading_context,
+        sample.m_light_transform,
+        m_material_sampler.get_point(),
+        s,
+        emission_position,
+        emission_direction,
+        candidate.m_light_value,
+        probability);
+
+    // Evaluate the BSDF (or volume).
+    const float material_probability =
+        m_material_sampler.evaluate(
+            Vector3f(outgoing.get_value()),
+            Vector3f(-emission_direction),
+            m_light_sampling_modes,
+            candidate.m_material_value);
+    assert(material_probability >= 0.0f);
+    if (material_probability == 0.0f)
+        return false;
+
+    candidate.m_light_value *=
+        light->compute_distance_attenuation(
+            m_material_sampler.get_point(), emission_position);
+
+    candidate.m_shape = nullptr;
+    candidate.m_light = light;
+    candidate.m_point = emission_position;
+    candidate.m_cast_shadows = (light->get_flags() & Light::CastShadows) != 0;
+    candidate.m_probability = sample.m_probability * probability;
+    candidate.m_target = average_value(candidate.m_material_value.m_beauty * candidate.m_light_value);
+
+    return candidate.m_target > 0.0f;
+}
+
 }   // namespace renderer
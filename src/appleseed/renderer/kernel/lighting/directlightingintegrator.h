@@ -67,6 +67,16 @@ namespace renderer
 //   The number of shadow rays cast by these functions may be as high as the number of light
 //   samples passed to the constructor plus the number of non-physical lights in the scene.
 //
+// Note about resampled importance sampling:
+//
+//   When a number of resampling candidates greater than one is passed to the constructor,
+//   each light sample of the light set is chosen among that many candidates proportionally
+//   to their unshadowed contribution, and a shadow ray is only traced for the chosen one.
+//   Evaluating a candidate is much cheaper than tracing a shadow ray, so this reduces noise
+//   in scenes with many lights at a moderate cost. Reference:
+//
+//     Justin Talbot, Importance Resampling for Global Illumination, Master's thesis, 2005.
+//
 
 class DirectLightingIntegrator
 {
@@ -81,7 +91,8 @@ class DirectLightingIntegrator
         const size_t                    material_sample_count,        // number of samples in material sampling
         const size_t                    light_sample_count,           // number of samples in light sampling
         const float                     low_light_threshold,          // light contribution threshold to disable shadow rays
-        const bool                      indirect);                    // are we computing indirect lighting?
+        const bool                      indirect,                     // are we computing indirect lighting?
+        const size_t                    resampling_candidate_count = 0);  // number of candidates per light sample, 0 or 1 to disable resampling
 
     // Compute outgoing radiance due to direct lighting via combined BSDF and light sampling.
     void compute_outgoing_radiance_combined_sampling_low_variance(
@@ -117,6 +128,9 @@ class DirectLightingIntegrator
     const size_t                        m_material_sample_count;
     const size_t                        m_light_sample_count;
     const bool                          m_indirect;
+    const size_t                        m_resampling_candidate_count;
+
+    struct ResamplingCandidate;
 
     void take_single_material_sample(
         SamplingContext&                sampling_context,
@@ -138,6 +152,27 @@ class DirectLightingIntegrator
         const foundation::Dual3d&       outgoing,
         DirectShadingComponents&        radiance,
         LightPathStream*                light_path_stream) const;
+
+    // Choose one light sample of the light set among several candidates and add its contribution.
+    void add_resampled_lightset_sample_contribution(
+        SamplingContext&                sampling_context,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        DirectShadingComponents&        radiance,
+        LightPathStream*                light_path_stream) const;
+
+    // Evaluate the unshadowed contribution of a light sample. Return false if it is zero.
+    bool evaluate_emitting_shape_candidate(
+        const LightSample&              sample,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        ResamplingCandidate&            candidate) const;
+
+    bool evaluate_non_physical_light_candidate(
+        SamplingContext&                sampling_context,
+        const LightSample&              sample,
+        const foundation::Dual3d&       outgoing,
+        ResamplingCandidate&            candidate) const;
 };
 
 }   // namespace renderer
@@ -46,25 +46,122 @@
 #include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/stopwatch.h"
 
+// LZ4 headers.
+#include <lz4.h>
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 using namespace foundation;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
 
 APPLESEED_DEFINE_APIARRAY(LightPathArray);
 
+namespace
+{
+    template <typename StoredPath>
+    bool pixel_order(const StoredPath& lhs, const StoredPath& rhs)
+    {
+        return lhs.m_pixel_coords.y < rhs.m_pixel_coords.y ? true :
+               lhs.m_pixel_coords.y > rhs.m_pixel_coords.y ? false :
+               lhs.m_pixel_coords.x < rhs.m_pixel_coords.x;
+    }
+
+    // On-disk variant of LightPathRecorder::Impl::IndexEntry.
+    struct StoredIndexEntry
+    {
+        std::uint64_t  m_start_offset;     // byte offset in the file of the first path
+        std::uint16_t  m_path_count;       // number of paths for that pixel
+    };
+
+    // Size in bytes of a path with a given number of vertices in a Light Paths file.
+    std::uint64_t stored_path_size(const size_t vertex_count)
+    {
+        return
+            2 * sizeof(float) +                                         // sample position
+            sizeof(std::uint16_t) +                                     // vertex count
+            vertex_count * (sizeof(std::uint16_t) + 6 * sizeof(float)); // vertices
+    }
+
+    // Memory buffer with the write interface of BufferedFile.
+    class BufferWriter
+    {
+      public:
+        explicit BufferWriter(std::uint8_t* dest)
+          : m_ptr(dest)
+        {
+        }
+
+        size_t write(const void* inbuf, const size_t size)
+        {
+            std::memcpy(m_ptr, inbuf, size);
+            m_ptr += size;
+            return size;
+        }
+
+      private:
+        std::uint8_t*   m_ptr;
+    };
+
+    template <typename File, typename StoredPath, typename StoredPathVertex>
+    void write_path(
+        File&                                           file,
+        const StoredPath&                               path,
+        const StoredPathVertex*                         vertices,
+        const std::map<const Entity*, std::uint16_t>&   entity_name_to_index)
+    {
+        // Write path info.
+        checked_write(file, path.m_sample_position[0]);
+        checked_write(file, path.m_sample_position[1]);
+
+        // Write number of vertices for this path.
+        const auto vertex_count = path.m_vertex_end_index - path.m_vertex_begin_index;
+        assert(vertex_count < 65536);
+        checked_write(file, static_cast<std::uint16_t>(vertex_count));
+
+        // Write path vertices.
+        for (auto i = path.m_vertex_begin_index; i < path.m_vertex_end_index; ++i)
+        {
+            const auto& vertex = vertices[i];
+
+            // Entity name index.
+            const auto it = entity_name_to_index.find(vertex.m_entity);
+            assert(it != entity_name_to_index.end());
+            checked_write(file, it->second);
+
+            // Write world space position of this vertex.
+            checked_write(file, vertex.m_position[0]);
+            checked_write(file, vertex.m_position[1]);
+            checked_write(file, vertex.m_position[2]);
+
+            // Write radiance at this vertex.
+            checked_write(file, vertex.m_radiance[0]);
+            checked_write(file, vertex.m_radiance[1]);
+            checked_write(file, vertex.m_radiance[2]);
+        }
+    }
+}
+
 struct LightPathRecorder::Impl
 {
+    typedef LightPathStream::StoredPath StoredPath;
+    typedef LightPathStream::StoredPathVertex StoredPathVertex;
+
     const Project&                                m_project;
 
     boost::mutex                                  m_mutex;
@@ -81,10 +178,87 @@ struct LightPathRecorder::Impl
     size_t                                   m_render_height;
     std::vector<IndexEntry>                  m_index;
 
+    // One chunk of light paths in the spill file.
+    struct Chunk
+    {
+        std::int64_t    m_file_offset;          // byte offset in the spill file of the compressed chunk
+        size_t          m_compressed_size;      // size in bytes of the compressed chunk
+        size_t          m_path_count;
+        size_t          m_vertex_count;
+        size_t          m_vertex_base;          // index of the first vertex of this chunk among all spilled vertices
+        size_t          m_x0, m_y0, m_x1, m_y1; // bounding rectangle of the pixels of the paths, inclusive
+    };
+
+    // Streaming mode.
+    bool                                     m_streaming;
+    std::string                              m_spill_file_path;
+    size_t                                   m_chunk_vertex_count;
+    boost::mutex                             m_spill_mutex;
+    BufferedFile                             m_spill_file;
+    std::vector<Chunk>                       m_chunks;
+    bool                                     m_spill_failed;         // the spill file failed to open or to be written to
+    size_t                                   m_spilled_path_count;
+    size_t                                   m_spilled_vertex_count;
+    std::set<const Entity*>                  m_spilled_entities;
+
+    // Most recently loaded chunk.
+    size_t                                   m_loaded_chunk_index;
+    std::vector<StoredPath>                  m_loaded_paths;
+    std::vector<StoredPathVertex>            m_loaded_vertices;
+
+    // Vertices of the light paths returned by the last query, in streaming mode.
+    struct QueriedVertexRange
+    {
+        size_t          m_vertex_begin;         // index of the first vertex among all spilled vertices
+        size_t          m_vertex_end;           // index of one vertex past the last one among all spilled vertices
+        size_t          m_offset;               // index of the first vertex in m_queried_vertices
+    };
+
+    boost::mutex                             m_query_mutex;
+    std::vector<QueriedVertexRange>          m_queried_ranges;
+    std::vector<StoredPathVertex>            m_queried_vertices;
+
     explicit Impl(const Project& project)
       : m_project(project)
+      , m_streaming(false)
+      , m_chunk_vertex_count(DefaultChunkVertexCount)
+      , m_spill_failed(false)
+      , m_spilled_path_count(0)
+      , m_spilled_vertex_count(0)
+      , m_loaded_chunk_index(~size_t(0))
     {
     }
+
+    void clear_spill_file()
+    {
+        if (m_spill_file.is_open())
+            m_spill_file.close();
+
+        clear_release_memory(m_chunks);
+        m_spill_failed = false;
+        m_spilled_path_count = 0;
+        m_spilled_vertex_count = 0;
+        m_spilled_entities.clear();
+
+        m_loaded_chunk_index = ~size_t(0);
+        clear_release_memory(m_loaded_paths);
+        clear_release_memory(m_loaded_vertices);
+
+        clear_release_memory(m_queried_ranges);
+        clear_release_memory(m_queried_vertices);
+    }
+
+    static bool overlaps(
+        const Chunk&    chunk,
+        const size_t    x0,
+        const size_t    y0,
+        const size_t    x1,
+        const size_t    y1)
+    {
+        return
+            chunk.m_x0 <= x1 && chunk.m_x1 >= x0 &&
+            chunk.m_y0 <= y1 && chunk.m_y1 >= y0;
+    }
 };
 
 LightPathRecorder::LightPathRecorder(const Project& project)
@@ -94,20 +268,52 @@ LightPathRecorder::LightPathRecorder(const Project& project)
 
 LightPathRecorder::~LightPathRecorder()
 {
+    if (impl->m_streaming)
+    {
+        impl->clear_spill_file();
+
+        boost::system::error_code ec;
+        bf::remove(bf::path(impl->m_spill_file_path), ec);
+    }
+
     delete impl;
 }
 
+void LightPathRecorder::enable_streaming(
+    const char*         spill_file_path,
+    const size_t        chunk_vertex_count)
+{
+    assert(chunk_vertex_count > 0);
+
+    impl->m_streaming = true;
+    impl->m_spill_file_path = spill_file_path;
+
+    // Keep chunks small enough for their indices to fit in 32 bits and for LZ4 to handle them.
+    impl->m_chunk_vertex_count = std::min<size_t>(chunk_vertex_count, 16 * 1024 * 1024);
+
+    for (auto& stream : impl->m_streams)
+        stream->m_max_vertex_count = impl->m_chunk_vertex_count;
+}
+
+bool LightPathRecorder::is_streaming() const
+{
+    return impl->m_streaming;
+}
+
 void LightPathRecorder::clear()
 {
     for (auto& stream : impl->m_streams)
         stream->clear();
 
     clear_release_memory(impl->m_index);
+
+    if (impl->m_streaming)
+        impl->clear_spill_file();
 }
 
 size_t LightPathRecorder::get_light_path_count() const
 {
-    size_t count = 0;
+    size_t count = impl->m_spilled_path_count;
 
     for (const auto& stream : impl->m_streams)
         count += stream->m_paths.size();
@@ -117,6 +323,9 @@ size_t LightPathRecorder::get_light_path_count() const
 
 size_t LightPathRecorder::get_vertex_count() const
 {
+    if (impl->m_streaming)
+        return impl->m_spilled_vertex_count;
+
     assert(impl->m_streams.size() == 1);
     const LightPathStream* stream = impl->m_streams[0].get();
 
@@ -127,9 +336,12 @@ LightPathStream* LightPathRecorder::create_stream()
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    auto stream = new LightPathStream(impl->m_project);
+    auto stream = new LightPathStream(impl->m_project, *this);
     impl->m_streams.push_back(std::unique_ptr<LightPathStream>(stream));
 
+    if (impl->m_streaming)
+        stream->m_max_vertex_count = impl->m_chunk_vertex_count;
+
     return stream;
 }
 
@@ -143,6 +355,34 @@ void LightPathRecorder::finalize(
     if (impl->m_streams.empty())
         return;
 
+    // In streaming mode, flush what's left in the streams and prepare the spill file for reading.
+    if (impl->m_streaming)
+    {
+        for (auto& stream : impl->m_streams)
+            spill_stream(*stream);
+
+        if (impl->m_spill_file.is_open())
+        {
+            impl->m_spill_file.close();
+            impl->m_spill_file.open(
+                impl->m_spill_file_path.c_str(),
+                BufferedFile::BinaryType,
+                BufferedFile::ReadMode);
+        }
+
+        const size_t light_path_count = impl->m_spilled_path_count;
+
+        RENDERER_LOG_INFO(
+            "streamed %s light path%s in %s chunk%s to %s.",
+            pretty_uint(light_path_count).c_str(),
+            light_path_count > 1 ? "s" : "",
+            pretty_uint(impl->m_chunks.size()).c_str(),
+            impl->m_chunks.size() > 1 ? "s" : "",
+            impl->m_spill_file_path.c_str());
+
+        return;
+    }
+
     // Merge all streams into the first one.
     if (impl->m_streams.size() > 1)
     {
@@ -186,13 +426,7 @@ void LightPathRecorder::finalize(
     sort(
         stream->m_paths.begin(),
         stream->m_paths.end(),
-        [](const LightPathStream::StoredPath& lhs,
-           const LightPathStream::StoredPath& rhs)
-        {
-            return lhs.m_pixel_coords.y < rhs.m_pixel_coords.y ? true :
-                   lhs.m_pixel_coords.y > rhs.m_pixel_coords.y ? false :
-                   lhs.m_pixel_coords.x < rhs.m_pixel_coords.x;
-        });
+        pixel_order<LightPathStream::StoredPath>);
 
     // Build index.
     RENDERER_LOG_INFO("indexing light path%s...", light_path_count > 1 ? "s" : "");
@@ -229,6 +463,12 @@ void LightPathRecorder::query(
     const size_t        y1,
     LightPathArray&     result) const
 {
+    if (impl->m_streaming)
+    {
+        query_spilled(x0, y0, x1, y1, result);
+        return;
+    }
+
     assert(impl->m_streams.size() == 1);
     const LightPathStream* stream = impl->m_streams[0].get();
 
@@ -260,6 +500,12 @@ void LightPathRecorder::get_light_path_vertex(
     const size_t        index,
     LightPathVertex&    result) const
 {
+    if (impl->m_streaming)
+    {
+        get_spilled_light_path_vertex(index, result);
+        return;
+    }
+
     assert(impl->m_streams.size() == 1);
     const LightPathStream* stream = impl->m_streams[0].get();
 
@@ -285,6 +531,9 @@ bool LightPathRecorder::write(const char* filename) const
     //   https://github.com/appleseedhq/appleseed/wiki/Light-Paths-File-Format
     //
 
+    if (impl->m_streaming)
+        return write_spilled(filename);
+
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
@@ -320,13 +569,6 @@ bool LightPathRecorder::write(const char* filename) const
         assert(light_path_count < 4294967296ULL);
         checked_write(file, static_cast<std::uint32_t>(light_path_count));
 
-        // On-disk variant of Impl::IndexEntry.
-        struct StoredIndexEntry
-        {
-            std::uint64_t  m_start_offset;     // byte offset in the file of the first path
-            std::uint16_t  m_path_count;       // number of paths for that pixel
-        };
-
         // Initialize index.
         std::vector<StoredIndexEntry> stored_index(impl->m_render_width * impl->m_render_height);
         for (auto& index_entry : stored_index)
@@ -393,35 +635,517 @@ bool LightPathRecorder::write(const char* filename) const
             assert(index_entry.m_path_count < 65535);
             ++index_entry.m_path_count;
 
-            // Write path info.
-            checked_write(file, path.m_sample_position[0]);
-            checked_write(file, path.m_sample_position[1]);
+            // Write path.
+            write_path(file, path, stream->m_vertices.data(), entity_name_to_index);
+        }
+
+        // Go back and write final index.
+        file.seek(index_location, BufferedFile::SeekFromBeginning);
+        for (const auto& index_entry : stored_index)
+        {
+            checked_write(file, index_entry.m_start_offset);
+            checked_write(file, index_entry.m_path_count);
+        }
+
+        // Close file.
+        file.close();
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "wrote %s path%s to %s in %s.",
+            pretty_uint(light_path_count).c_str(),
+            light_path_count > 1 ? "s" : "",
+            filename,
+            pretty_time(stopwatch.get_seconds()).c_str());
+
+        return true;
+    }
+    catch (const ExceptionIOError& e)
+    {
+        RENDERER_LOG_ERROR("failed to write paths to %s: %s", filename, e.what());
+        return false;
+    }
+}
+
+void LightPathRecorder::spill_stream(LightPathStream& stream)
+{
+    auto& paths = stream.m_paths;
+    auto& vertices = stream.m_vertices;
+
+    if (paths.empty())
+    {
+        clear_keep_memory(vertices);
+        return;
+    }
+
+    // Once spilling failed, discard light paths without serializing them.
+    {
+        boost::mutex::scoped_lock lock(impl->m_spill_mutex);
+
+        if (impl->m_spill_failed)
+        {
+            clear_keep_memory(paths);
+            clear_keep_memory(vertices);
+            return;
+        }
+    }
+
+    // Sort paths by pixel coordinates so that the paths of a given pixel are contiguous.
+    sort(paths.begin(), paths.end(), pixel_order<Impl::StoredPath>);
+
+    Impl::Chunk chunk;
+    chunk.m_path_count = paths.size();
+    chunk.m_vertex_count = vertices.size();
+    chunk.m_x0 = ~size_t(0);
+    chunk.m_y0 = paths.front().m_pixel_coords.y;
+    chunk.m_x1 = 0;
+    chunk.m_y1 = paths.back().m_pixel_coords.y;
+    for (const auto& path : paths)
+    {
+        chunk.m_x0 = std::min<size_t>(chunk.m_x0, path.m_pixel_coords.x);
+        chunk.m_x1 = std::max<size_t>(chunk.m_x1, path.m_pixel_coords.x);
+    }
+
+    // Collect the entities referenced by this chunk.
+    std::set<const Entity*> entities;
+    const Entity* last_entity = nullptr;
+    for (const auto& vertex : vertices)
+    {
+        if (vertex.m_entity != last_entity)
+        {
+            entities.insert(vertex.m_entity);
+            last_entity = vertex.m_entity;
+        }
+    }
+
+    // Serialize and compress the chunk outside of the lock.
+    const size_t paths_size = paths.size() * sizeof(Impl::StoredPath);
+    const size_t vertices_size = vertices.size() * sizeof(Impl::StoredPathVertex);
+    std::vector<std::uint8_t> payload(paths_size + vertices_size);
+    std::memcpy(&payload[0], paths.data(), paths_size);
+    std::memcpy(&payload[paths_size], vertices.data(), vertices_size);
+
+    const int max_compressed_size = LZ4_compressBound(static_cast<int>(payload.size()));
+    std::vector<std::uint8_t> compressed(static_cast<size_t>(max_compressed_size));
+    const int compressed_size =
+        LZ4_compress_default(
+            reinterpret_cast<const char*>(&payload[0]),
+            reinterpret_cast<char*>(&compressed[0]),
+            static_cast<int>(payload.size()),
+            max_compressed_size);
+    assert(compressed_size > 0);
+    chunk.m_compressed_size = static_cast<size_t>(compressed_size);
+
+    clear_keep_memory(paths);
+    clear_keep_memory(vertices);
+
+    // Append the chunk to the spill file.
+    boost::mutex::scoped_lock lock(impl->m_spill_mutex);
+
+    // Another thread may have failed to spill since the check above.
+    if (impl->m_spill_failed)
+        return;
+
+    if (!impl->m_spill_file.is_open())
+    {
+        if (!impl->m_spill_file.open(
+                impl->m_spill_file_path.c_str(),
+                BufferedFile::BinaryType,
+                BufferedFile::WriteMode))
+        {
+            RENDERER_LOG_ERROR(
+                "failed to open %s for writing, discarding light paths.",
+                impl->m_spill_file_path.c_str());
+            impl->m_spill_failed = true;
+            return;
+        }
+    }
+
+    chunk.m_file_offset = impl->m_spill_file.tell();
+
+    if (impl->m_spill_file.write(&compressed[0], chunk.m_compressed_size) != chunk.m_compressed_size)
+    {
+        RENDERER_LOG_ERROR(
+            "failed to write light paths to %s, discarding light paths.",
+            impl->m_spill_file_path.c_str());
+        impl->m_spill_file.close();
+        impl->m_chunks.clear();
+        impl->m_spill_failed = true;
+        impl->m_spilled_path_count = 0;
+        impl->m_spilled_vertex_count = 0;
+        impl->m_spilled_entities.clear();
+        return;
+    }
+
+    chunk.m_vertex_base = impl->m_spilled_vertex_count;
+    impl->m_spilled_path_count += chunk.m_path_count;
+    impl->m_spilled_vertex_count += chunk.m_vertex_count;
+    impl->m_spilled_entities.insert(entities.begin(), entities.end());
+    impl->m_chunks.push_back(chunk);
+}
+
+void LightPathRecorder::load_chunk(const size_t chunk_index) const
+{
+    if (impl->m_loaded_chunk_index == chunk_index)
+        return;
+
+    const auto& chunk = impl->m_chunks[chunk_index];
+
+    impl->m_loaded_chunk_index = chunk_index;
+    clear_keep_memory(impl->m_loaded_paths);
+    clear_keep_memory(impl->m_loaded_vertices);
+
+    // Read the compressed chunk.
+    std::vector<std::uint8_t> compressed(chunk.m_compressed_size);
+    if (!impl->m_spill_file.seek(chunk.m_file_offset, BufferedFile::SeekFromBeginning) ||
+        impl->m_spill_file.read(&compressed[0], compressed.size()) != compressed.size())
+    {
+        RENDERER_LOG_ERROR("failed to read light paths from %s.", impl->m_spill_file_path.c_str());
+        return;
+    }
+
+    // Decompress it.
+    const size_t paths_size = chunk.m_path_count * sizeof(Impl::StoredPath);
+    const size_t vertices_size = chunk.m_vertex_count * sizeof(Impl::StoredPathVertex);
+    std::vector<std::uint8_t> payload(paths_size + vertices_size);
+    const int decompressed_size =
+        LZ4_decompress_safe(
+            reinterpret_cast<const char*>(&compressed[0]),
+            reinterpret_cast<char*>(&payload[0]),
+            static_cast<int>(compressed.size()),
+            static_cast<int>(payload.size()));
+    if (decompressed_size != static_cast<int>(payload.size()))
+    {
+        RENDERER_LOG_ERROR("failed to decompress light paths from %s.", impl->m_spill_file_path.c_str());
+        return;
+    }
+
+    impl->m_loaded_paths.resize(chunk.m_path_count);
+    impl->m_loaded_vertices.resize(chunk.m_vertex_count);
+    std::memcpy(impl->m_loaded_paths.data(), &payload[0], paths_size);
+    std::memcpy(impl->m_loaded_vertices.data(), &payload[paths_size], vertices_size);
+}
+
+void LightPathRecorder::query_spilled(
+    const size_t        x0,
+    const size_t        y0,
+    const size_t        x1,
+    const size_t        y1,
+    LightPathArray&     result) const
+{
+    boost::mutex::scoped_lock lock(impl->m_query_mutex);
+
+    clear_keep_memory(impl->m_queried_ranges);
+    clear_keep_memory(impl->m_queried_vertices);
+
+    const size_t first_path = result.size();
+
+    for (size_t i = 0, e = impl->m_chunks.size(); i < e; ++i)
+    {
+        const auto& chunk = impl->m_chunks[i];
+
+        if (!Impl::overlaps(chunk, x0, y0, x1, y1))
+            continue;
+
+        load_chunk(i);
+
+        // Paths are sorted by pixel coordinates: skip to the first row of the region.
+        auto it =
+            std::lower_bound(
+                impl->m_loaded_paths.cbegin(),
+                impl->m_loaded_paths.cend(),
+                y0,
+                [](const Impl::StoredPath& path, const size_t y)
+                {
+                    return path.m_pixel_coords.y < y;
+                });
+
+        for (; it != impl->m_loaded_paths.cend() && it->m_pixel_coords.y <= y1; ++it)
+        {
+            const auto& source_path = *it;
+
+            if (source_path.m_pixel_coords.x < x0 || source_path.m_pixel_coords.x > x1)
+                continue;
+
+            // Keep the vertices of this path in memory.
+            Impl::QueriedVertexRange range;
+            range.m_vertex_begin = chunk.m_vertex_base + source_path.m_vertex_begin_index;
+            range.m_vertex_end = chunk.m_vertex_base + source_path.m_vertex_end_index;
+            range.m_offset = impl->m_queried_vertices.size();
+            impl->m_queried_ranges.push_back(range);
+            impl->m_queried_vertices.insert(
+                impl->m_queried_vertices.end(),
+                impl->m_loaded_vertices.cbegin() + source_path.m_vertex_begin_index,
+                impl->m_loaded_vertices.cbegin() + source_path.m_vertex_end_index);
+
+            LightPath path;
+            path.m_pixel_coords[0] = source_path.m_pixel_coords[0];
+            path.m_pixel_coords[1] = source_path.m_pixel_coords[1];
+            path.m_sample_position[0] = source_path.m_sample_position[0];
+            path.m_sample_position[1] = source_path.m_sample_position[1];
+            path.m_vertex_begin_index = range.m_vertex_begin;
+            path.m_vertex_end_index = range.m_vertex_end;
+
+            result.push_back(path);
+        }
+    }
+
+    sort(
+        impl->m_queried_ranges.begin(),
+        impl->m_queried_ranges.end(),
+        [](const Impl::QueriedVertexRange& lhs, const Impl::QueriedVertexRange& rhs)
+        {
+            return lhs.m_vertex_begin < rhs.m_vertex_begin;
+        });
+
+    // Return paths from different chunks in the same order as in-memory queries.
+    if (result.size() > first_path)
+    {
+        std::stable_sort(
+            &result[first_path],
+            &result[0] + result.size(),
+            [](const LightPath& lhs, const LightPath& rhs)
+            {
+                return lhs.m_pixel_coords[1] < rhs.m_pixel_coords[1] ? true :
+                       lhs.m_pixel_coords[1] > rhs.m_pixel_coords[1] ? false :
+                       lhs.m_pixel_coords[0] < rhs.m_pixel_coords[0];
+            });
+    }
+}
+
+void LightPathRecorder::get_spilled_light_path_vertex(
+    const size_t        index,
+    LightPathVertex&    result) const
+{
+    assert(index < impl->m_spilled_vertex_count);
+
+    boost::mutex::scoped_lock lock(impl->m_query_mutex);
+
+    const Impl::StoredPathVertex* source_vertex = nullptr;
+
+    // Look for the vertex among the vertices of the last query.
+    const auto& ranges = impl->m_queried_ranges;
+    auto range_it =
+        std::upper_bound(
+            ranges.cbegin(),
+            ranges.cend(),
+            index,
+            [](const size_t i, const Impl::QueriedVertexRange& range)
+            {
+                return i < range.m_vertex_begin;
+            });
+    if (range_it != ranges.cbegin() && index < (--range_it)->m_vertex_end)
+        source_vertex = &impl->m_queried_vertices[range_it->m_offset + index - range_it->m_vertex_begin];
+
+    // Otherwise read back the chunk it belongs to.
+    if (source_vertex == nullptr)
+    {
+        const auto chunk_it =
+            std::upper_bound(
+                impl->m_chunks.cbegin(),
+                impl->m_chunks.cend(),
+                index,
+                [](const size_t i, const Impl::Chunk& chunk)
+                {
+                    return i < chunk.m_vertex_base;
+                });
+        assert(chunk_it != impl->m_chunks.cbegin());
+
+        const auto chunk_index = static_cast<size_t>(chunk_it - impl->m_chunks.cbegin()) - 1;
+        load_chunk(chunk_index);
+
+        const size_t local_index = index - impl->m_chunks[chunk_index].m_vertex_base;
+        if (local_index < impl->m_loaded_vertices.size())
+            source_vertex = &impl->m_loaded_vertices[local_index];
+    }
+
+    if (source_vertex == nullptr)
+    {
+        result.m_entity = nullptr;
+        std::fill(result.m_position, result.m_position + 3, 0.0f);
+        std::fill(result.m_radiance, result.m_radiance + 3, 0.0f);
+        return;
+    }
+
+    result.m_entity = source_vertex->m_entity;
+
+    result.m_position[0] = source_vertex->m_position[0];
+    result.m_position[1] = source_vertex->m_position[1];
+    result.m_position[2] = source_vertex->m_position[2];
+
+    result.m_radiance[0] = source_vertex->m_radiance[0];
+    result.m_radiance[1] = source_vertex->m_radiance[1];
+    result.m_radiance[2] = source_vertex->m_radiance[2];
+}
+
+bool LightPathRecorder::write_spilled(const char* filename) const
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    boost::mutex::scoped_lock lock(impl->m_query_mutex);
 
-            // Write number of vertices for this path.
-            const auto vertex_count = path.m_vertex_end_index - path.m_vertex_begin_index;
-            assert(vertex_count < 65536);
-            checked_write(file, static_cast<std::uint16_t>(vertex_count));
+    const size_t render_width = impl->m_render_width;
+    const size_t render_height = impl->m_render_height;
 
-            // Write path vertices.
-            for (auto i = path.m_vertex_begin_index; i < path.m_vertex_end_index; ++i)
+    // First pass: count paths and bytes per pixel to lay out the file.
+    std::vector<StoredIndexEntry> stored_index(render_width * render_height);
+    for (auto& index_entry : stored_index)
+    {
+        index_entry.m_start_offset = ~std::uint64_t(0);
+        index_entry.m_path_count = 0;
+    }
+
+    std::vector<std::uint64_t> pixel_offsets(render_width * render_height, 0);
+    size_t light_path_count = 0;
+
+    for (size_t i = 0, e = impl->m_chunks.size(); i < e; ++i)
+    {
+        load_chunk(i);
+
+        for (const auto& path : impl->m_loaded_paths)
+        {
+            const auto x = path.m_pixel_coords.x;
+            const auto y = path.m_pixel_coords.y;
+
+            // Skip paths that end outside of the frame.
+            if (x >= render_width || y >= render_height)
+                continue;
+
+            const size_t pixel_index = y * render_width + x;
+            assert(stored_index[pixel_index].m_path_count < 65535);
+            ++stored_index[pixel_index].m_path_count;
+            pixel_offsets[pixel_index] +=
+                stored_path_size(path.m_vertex_end_index - path.m_vertex_begin_index);
+            ++light_path_count;
+        }
+    }
+
+    try
+    {
+        RENDERER_LOG_INFO(
+            "writing path%s to %s...",
+            light_path_count > 1 ? "s" : "",
+            filename);
+
+        // Open file.
+        BufferedFile file;
+        if (!file.open(filename, BufferedFile::BinaryType, BufferedFile::WriteMode))
+        {
+            RENDERER_LOG_ERROR("failed to open %s for writing.", filename);
+            return false;
+        }
+
+        // Signature.
+        static const char Signature[7] = { 'A', 'S', 'P', 'A', 'T', 'H', 'S' };
+        checked_write(file, Signature, sizeof(Signature));
+
+        // Version.
+        const std::uint16_t Version = 1;
+        checked_write(file, Version);
+
+        // Number of paths.
+        assert(light_path_count < 4294967296ULL);
+        checked_write(file, static_cast<std::uint32_t>(light_path_count));
+
+        // Write index dimensions.
+        checked_write(file, static_cast<std::uint16_t>(render_width));
+        checked_write(file, static_cast<std::uint16_t>(render_height));
+
+        // Write index placeholder.
+        const auto index_location = file.tell();
+        for (const auto& index_entry : stored_index)
+        {
+            checked_write(file, index_entry.m_start_offset);
+            checked_write(file, index_entry.m_path_count);
+        }
+
+        // Build (entity name -> name index) dictionary and write entity names.
+        std::map<const Entity*, std::uint16_t> entity_name_to_index;
+        assert(impl->m_spilled_entities.size() < 65536);
+        checked_write(file, static_cast<std::uint16_t>(impl->m_spilled_entities.size()));
+        for (const Entity* entity : impl->m_spilled_entities)
+        {
+            entity_name_to_index.insert(
+                std::make_pair(
+                    entity,
+                    static_cast<std::uint16_t>(entity_name_to_index.size())));
+
+            const std::string name = to_string(entity->get_path());
+            assert(name.size() < 65536);
+            checked_write(file, static_cast<std::uint16_t>(name.size()));
+            checked_write(file, name.c_str(), name.size());
+        }
+
+        // Compute the location of the paths of each pixel; paths are stored in pixel order.
+        const size_t pixel_count = stored_index.size();
+        std::uint64_t offset = static_cast<std::uint64_t>(file.tell());
+        for (size_t i = 0; i < pixel_count; ++i)
+        {
+            const std::uint64_t pixel_size = pixel_offsets[i];
+            pixel_offsets[i] = offset;
+            if (stored_index[i].m_path_count > 0)
+                stored_index[i].m_start_offset = offset;
+            offset += pixel_size;
+        }
+        const std::uint64_t paths_end = offset;
+
+        // Second pass: gather the paths of a range of consecutive pixels into a memory buffer
+        // and write it sequentially. Only the chunks with paths in the rows of the range are
+        // loaded; there is a single range unless the paths exceed the buffer size.
+        const std::uint64_t MaxBufferSize = 64 * 1024 * 1024;    // in bytes
+        std::vector<std::uint8_t> buffer;
+        size_t pixel_begin = 0;
+
+        while (pixel_begin < pixel_count)
+        {
+            // Extend the range as long as its paths fit in the buffer (always keep one pixel).
+            const std::uint64_t range_begin = pixel_offsets[pixel_begin];
+            size_t pixel_end = pixel_begin + 1;
+            while (pixel_end < pixel_count &&
+                   (pixel_end + 1 < pixel_count ? pixel_offsets[pixel_end + 1] : paths_end) - range_begin <= MaxBufferSize)
+                ++pixel_end;
+            const std::uint64_t range_end = pixel_end < pixel_count ? pixel_offsets[pixel_end] : paths_end;
+
+            if (range_end > range_begin)
             {
-                const auto& vertex = stream->m_vertices[i];
-
-                // Entity name index.
-                const auto it = entity_name_to_index.find(vertex.m_entity);
-                assert(it != entity_name_to_index.end());
-                checked_write(file, it->second);
-
-                // Write world space position of this vertex.
-                checked_write(file, vertex.m_position[0]);
-                checked_write(file, vertex.m_position[1]);
-                checked_write(file, vertex.m_position[2]);
-
-                // Write radiance at this vertex.
-                checked_write(file, vertex.m_radiance[0]);
-                checked_write(file, vertex.m_radiance[1]);
-                checked_write(file, vertex.m_radiance[2]);
+                buffer.resize(static_cast<size_t>(range_end - range_begin));
+
+                const size_t row_begin = pixel_begin / render_width;
+                const size_t row_end = (pixel_end - 1) / render_width;
+
+                for (size_t i = 0, e = impl->m_chunks.size(); i < e; ++i)
+                {
+                    if (!Impl::overlaps(impl->m_chunks[i], 0, row_begin, render_width - 1, row_end))
+                        continue;
+
+                    load_chunk(i);
+
+                    for (const auto& path : impl->m_loaded_paths)
+                    {
+                        const auto x = path.m_pixel_coords.x;
+                        const auto y = path.m_pixel_coords.y;
+
+                        if (x >= render_width || y >= render_height)
+                            continue;
+
+                        const size_t pixel_index = y * render_width + x;
+                        if (pixel_index < pixel_begin || pixel_index >= pixel_end)
+                            continue;
+
+                        // Write the path at the next free location of its pixel.
+                        auto& pixel_offset = pixel_offsets[pixel_index];
+                        BufferWriter writer(&buffer[static_cast<size_t>(pixel_offset - range_begin)]);
+                        write_path(writer, path, impl->m_loaded_vertices.data(), entity_name_to_index);
+                        pixel_offset += stored_path_size(path.m_vertex_end_index - path.m_vertex_begin_index);
+                    }
+                }
+
+                checked_write(file, &buffer[0], buffer.size());
             }
+
+            pixel_begin = pixel_end;
         }
 
         // Go back and write final index.
@@ -77,6 +77,11 @@ struct LightPathVertex
 //   - query and retrieve light paths
 //   - write light paths to disk using an efficient binary format
 //
+// In streaming mode, streams periodically hand their light paths over to the recorder
+// which appends them as LZ4-compressed chunks to a spill file. Each chunk holds light
+// paths sorted by pixel together with their vertices, and is indexed by the bounding
+// rectangle of its pixels such that queries only read back the chunks they need.
+//
 
 class APPLESEED_DLLSYMBOL LightPathRecorder
   : public foundation::NonCopyable
@@ -88,10 +93,22 @@ class APPLESEED_DLLSYMBOL LightPathRecorder
     // Destructor.
     ~LightPathRecorder();
 
+    // Default maximum number of vertices a stream holds in memory in streaming mode.
+    static const size_t DefaultChunkVertexCount = 1024 * 1024;
+
     //
     // Recording API.
     //
 
+    // Enable streaming mode, in which light paths are flushed to `spill_file_path`
+    // while rendering instead of being kept in memory. Must be called before rendering.
+    void enable_streaming(
+        const char*         spill_file_path,
+        const size_t        chunk_vertex_count = DefaultChunkVertexCount);
+
+    // Return true if streaming mode is enabled.
+    bool is_streaming() const;
+
     // Clear all streams (but don't discard the streams themselves).
     void clear();
 
@@ -100,6 +117,7 @@ class APPLESEED_DLLSYMBOL LightPathRecorder
     LightPathStream* create_stream();
 
     // Merge all streams into one and build the index.
+    // In streaming mode, flush all streams to the spill file instead.
     void finalize(
         const size_t        render_width,
         const size_t        render_height);
@@ -108,14 +126,17 @@ class APPLESEED_DLLSYMBOL LightPathRecorder
     // Query API.
     //
 
-    // Return the number of stored light paths.
+    // Return the number of stored light paths. In streaming mode, this includes
+    // light paths ending outside of the frame which queries never return.
     size_t get_light_path_count() const;
 
     // Return the total number of stored vertices in all light paths. `finalize()` must have been called.
     size_t get_vertex_count() const;
 
-    // Retrieve all light paths falling into a region of the render.
+    // Retrieve all light paths falling into a region of the render, sorted by pixel.
     // All bounds are inclusive. `finalize()` must have been called.
+    // In streaming mode, the vertices of the light paths returned by the last query
+    // are kept in memory so that they can be retrieved without touching the disk.
     void query(
         const size_t        x0,
         const size_t        y0,
@@ -133,9 +154,31 @@ class APPLESEED_DLLSYMBOL LightPathRecorder
     bool write(const char* filename) const;
 
   private:
+    friend class LightPathStream;
+
     struct Impl;
     Impl* impl;
 
+    // Append the light paths of a stream to the spill file and clear the stream.
+    // Thread-safe.
+    void spill_stream(LightPathStream& stream);
+
+    // Load a chunk of the spill file into the chunk cache, unless it's already there.
+    void load_chunk(const size_t chunk_index) const;
+
+    void query_spilled(
+        const size_t        x0,
+        const size_t        y0,
+        const size_t        x1,
+        const size_t        y1,
+        LightPathArray&     result) const;
+
+    void get_spilled_light_path_vertex(
+        const size_t        index,
+        LightPathVertex&    result) const;
+
+    bool write_spilled(const char* filename) const;
+
     // Merge `source` into `dest` and clear `source`.
     // Being a static method of `LightPathRecorder` grants it access to the internals of `LightPathStream`.
     static void merge_streams(
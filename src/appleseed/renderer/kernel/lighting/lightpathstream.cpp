@@ -30,6 +30,7 @@
 #include "lightpathstream.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/lightpathrecorder.h"
 #include "renderer/kernel/lighting/lighttypes.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/rendering/pixelcontext.h"
@@ -57,8 +58,12 @@ using namespace foundation;
 namespace renderer
 {
 
-LightPathStream::LightPathStream(const Project& project)
-  : m_scene(*project.get_scene())   // at this time the scene's render data are not available
+LightPathStream::LightPathStream(
+    const Project&          project,
+    LightPathRecorder&      recorder)
+  : m_recorder(recorder)
+  , m_max_vertex_count(~size_t(0))
+  , m_scene(*project.get_scene())   // at this time the scene's render data are not available
 {
 }
 
@@ -227,6 +232,10 @@ void LightPathStream::end_path()
     clear_keep_memory(m_hit_emitter_data);
     clear_keep_memory(m_sampled_emitter_data);
     clear_keep_memory(m_sampled_env_data);
+
+    // In streaming mode, hand the light paths over to the recorder once enough have accumulated.
+    if (m_vertices.size() >= m_max_vertex_count)
+        m_recorder.spill_stream(*this);
 }
 
 void LightPathStream::create_path_from_hit_emitter(const size_t emitter_event_index)
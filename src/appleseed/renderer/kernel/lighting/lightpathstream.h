@@ -46,6 +46,7 @@ namespace renderer  { class EmittingShape; }
 namespace renderer  { class Entity; }
 namespace renderer  { class EnvironmentEDF; }
 namespace renderer  { class Light; }
+namespace renderer  { class LightPathRecorder; }
 namespace renderer  { class ObjectInstance; }
 namespace renderer  { class PathVertex; }
 namespace renderer  { class PixelContext; }
@@ -159,6 +160,10 @@ class LightPathStream
         foundation::Color3f         m_radiance;                 // radiance arriving at this vertex, in W.sr^-1.m^-2
     };
 
+    // Recorder that created this stream.
+    LightPathRecorder&              m_recorder;
+    size_t                          m_max_vertex_count;         // in streaming mode, hand paths over to the recorder past this many vertices
+
     // Scene.
     const Scene&                    m_scene;
     float                           m_scene_diameter;
@@ -181,7 +186,9 @@ class LightPathStream
     std::vector<StoredPathVertex>   m_vertices;
 
     // Constructor.
-    explicit LightPathStream(const Project& project);
+    LightPathStream(
+        const Project&              project,
+        LightPathRecorder&          recorder);
 
     void create_path_from_hit_emitter(const size_t emitter_event_index);
     void create_path_from_sampled_emitter(const size_t emitter_event_index);
@@ -30,6 +30,7 @@
 #include "lightsamplerbase.h"
 
 // appleseed.renderer headers
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/modeling/edf/edf.h"
@@ -180,8 +181,18 @@ void LightSamplerBase::collect_emitting_shapes(
 
         if (strcmp(object.get_model(), MeshObjectFactory().get_model()) == 0)
         {
+            // Emitting triangles are collected before acceleration structures are built:
+            // load the geometry of the mesh now if its loading was deferred.
+            MeshObject& mesh = static_cast<MeshObject&>(object);
+            if (!mesh.load_geometry())
+            {
+                RENDERER_LOG_ERROR(
+                    "failed to load geometry of mesh object \"%s\", ignoring its emitting triangles.",
+                    mesh.get_name());
+                continue;
+            }
+
             // Retrieve the tessellation of the mesh.
-            const MeshObject& mesh = static_cast<const MeshObject&>(object);
             const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
 
             // Skip object instances without light-emitting materials.
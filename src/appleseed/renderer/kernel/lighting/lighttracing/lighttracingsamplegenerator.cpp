@@ -42,6 +42,7 @@
 #include "renderer/kernel/rendering/globalsampleaccumulationbuffer.h"
 #include "renderer/kernel/rendering/sample.h"
 #include "renderer/kernel/rendering/samplegeneratorbase.h"
+#include "renderer/kernel/rendering/tilesplatbuffer.h"
 #include "renderer/kernel/shading/oslshadergroupexec.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -76,15 +77,18 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/memory/arena.h"
+#include "foundation/memory/memory.h"
 #include "foundation/string/string.h"
 #include "foundation/utility/job/iabortswitch.h"
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -108,6 +112,18 @@ namespace
     //   Robust Monte Carlo Methods For Light Transport Simulation
     //   http://graphics.stanford.edu/papers/veach_thesis/thesis.pdf
     //
+    // Light tracing samples land anywhere on the image. To keep rendering threads from
+    // contending on the shared accumulation buffer, each sample generator:
+    //
+    //   - defers the visibility rays connecting path vertices to the camera, and traces
+    //     them in batches sorted by pixel such that consecutive rays are coherent;
+    //
+    //   - sorts the samples of each job by tile and merges the samples landing on the same
+    //     pixel before storing them into the accumulation buffer in bulk.
+    //
+
+    // Number of pending camera connections above which their visibility rays are traced.
+    const size_t CameraConnectionBatchSize = 256;
 
     class LightTracingSampleGenerator
       : public SampleGeneratorBase
@@ -186,6 +202,11 @@ namespace
                 nullptr,
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations)
+          , m_splat_buffer(
+                frame.image().properties().m_canvas_width,
+                frame.image().properties().m_canvas_height,
+                frame.image().properties().m_tile_width,
+                frame.image().properties().m_tile_height)
           , m_light_sample_count(0)
           , m_path_count(0)
         {
@@ -258,6 +279,27 @@ namespace
         }
 
       private:
+        // A camera connection whose visibility remains to be determined.
+        struct CameraConnection
+        {
+            Vector3d                        m_origin;
+            Vector3d                        m_target;
+            ShadingRay::Time                m_time;
+            ShadingRay::DepthType           m_depth;
+            Vector2i                        m_pixel_coords;
+            Spectrum                        m_radiance;     // contribution of the connection if unoccluded
+
+            bool operator<(const CameraConnection& rhs) const
+            {
+                return
+                    m_pixel_coords.y != rhs.m_pixel_coords.y
+                        ? m_pixel_coords.y < rhs.m_pixel_coords.y
+                        : m_pixel_coords.x < rhs.m_pixel_coords.x;
+            }
+        };
+
+        typedef std::vector<CameraConnection> CameraConnectionVector;
+
         struct VolumeVisitor
         {
             bool accept_scattering(
@@ -283,8 +325,7 @@ namespace
             const size_t                    m_canvas_height;
             const ShadingContext&           m_shading_context;
             SamplingContext&                m_sampling_context;
-            SampleVector&                   m_samples;
-            size_t                          m_sample_count;         // the number of samples added to m_samples
+            CameraConnectionVector&         m_camera_connections;
             const Spectrum                  m_initial_flux;         // initial particle flux (in W)
 
             PathVisitor(
@@ -293,7 +334,7 @@ namespace
                 const Frame&                frame,
                 const ShadingContext&       shading_context,
                 SamplingContext&            sampling_context,
-                SampleVector&               samples,
+                CameraConnectionVector&     camera_connections,
                 const Spectrum&             initial_flux)
               : m_params(params)
               , m_camera(*scene.get_render_data().m_active_camera)
@@ -301,8 +342,7 @@ namespace
               , m_canvas_height(frame.image().properties().m_canvas_height)
               , m_shading_context(shading_context)
               , m_sampling_context(sampling_context)
-              , m_samples(samples)
-              , m_sample_count(0)
+              , m_camera_connections(camera_connections)
               , m_initial_flux(initial_flux)
             {
             }
@@ -313,11 +353,6 @@ namespace
             {
             }
 
-            size_t get_sample_count() const
-            {
-                return m_sample_count;
-            }
-
             bool accept_scattering(
                 const ScatteringMode::Mode  prev_mode,
                 const ScatteringMode::Mode  next_mode) const
@@ -357,30 +392,21 @@ namespace
                 if (cos_alpha <= 0.0)
                     return;
 
-                // Compute the transmission factor between the light vertex and the camera.
+                // Adjust cos(alpha) to account for the fact that the camera outgoing direction was not unit-length.
+                const double distance = norm(camera_outgoing);
+                cos_alpha /= distance;
+
+                // Store the contribution of this vertex, pending visibility.
                 // Prevent self-intersections by letting the ray originate from the camera.
-                Spectrum radiance;
-                m_shading_context.get_tracer().trace_between_simple(
-                    m_shading_context,
+                Spectrum radiance = light_particle_flux;
+                radiance *= static_cast<float>(cos_alpha * importance);
+                add_camera_connection(
                     light_sample.m_point - camera_outgoing,
                     light_sample.m_point,
                     time,
-                    VisibilityFlags::CameraRay,
                     0,
+                    sample_position,
                     radiance);
-
-                // Ignore occluded vertices.
-                if (is_zero(radiance))
-                    return;
-
-                // Adjust cos(alpha) to account for the fact that the camera outgoing direction was not unit-length.
-                const double distance = norm(camera_outgoing);
-                cos_alpha /= distance;
-
-                // Store the contribution of this vertex.
-                radiance *= light_particle_flux;
-                radiance *= static_cast<float>(cos_alpha * importance);
-                emit_sample(sample_position, radiance);
             }
 
             void visit_non_physical_light_vertex(
@@ -401,25 +427,16 @@ namespace
                         importance))
                     return;
 
-                // Compute the transmission factor between the light vertex and the camera.
-                Spectrum radiance;
-                m_shading_context.get_tracer().trace_between_simple(
-                    m_shading_context,
+                // Store the contribution of this vertex, pending visibility.
+                Spectrum radiance = light_particle_flux;
+                radiance *= importance;
+                add_camera_connection(
                     light_vertex - camera_outgoing,
                     light_vertex,
                     time,
-                    VisibilityFlags::CameraRay,
                     0,
+                    sample_position,
                     radiance);
-
-                // Ignore occluded vertices.
-                if (is_zero(radiance))
-                    return;
-
-                // Store the contribution of this vertex.
-                radiance *= light_particle_flux;
-                radiance *= importance;
-                emit_sample(sample_position, radiance);
             }
 
             void on_miss(const PathVertex& vertex)
@@ -451,23 +468,8 @@ namespace
                 if (dot(camera_outgoing, shading_normal) >= 0.0)
                     return;
 
-                // Compute the transmission factor between the path vertex and the camera.
-                // Prevent self-intersections by letting the ray originate from the camera.
-                Spectrum transmission;
-                m_shading_context.get_tracer().trace_between_simple(
-                    m_shading_context,
-                    vertex.get_point() - camera_outgoing,
-                    vertex.get_point(),
-                    vertex.get_time(),
-                    VisibilityFlags::CameraRay,
-                    static_cast<ShadingRay::DepthType>(vertex.m_path_length), // ray depth = (path length - 1) + 1
-                    transmission);
-
-                // Ignore occluded vertices.
-                if (is_zero(transmission))
-                    return;
-
                 // Normalize the camera outgoing direction.
+                const Vector3d camera_position = vertex.get_point() - camera_outgoing;
                 const double distance = norm(camera_outgoing);
                 camera_outgoing /= distance;
 
@@ -496,35 +498,44 @@ namespace
                 if (bsdf_prob == 0.0f)
                     return;
 
-                // Store the contribution of this vertex.
+                // Store the contribution of this vertex, pending visibility.
+                // Prevent self-intersections by letting the ray originate from the camera.
                 Spectrum radiance = m_initial_flux;
                 radiance *= vertex.m_throughput;
                 radiance *= bsdf_value.m_beauty;
-                radiance *= transmission;
                 radiance *= importance;
-                emit_sample(sample_position, radiance);
+                add_camera_connection(
+                    camera_position,
+                    vertex.get_point(),
+                    vertex.get_time(),
+                    static_cast<ShadingRay::DepthType>(vertex.m_path_length),  // ray depth = (path length - 1) + 1
+                    sample_position,
+                    radiance);
             }
 
             void on_scatter(PathVertex& vertex)
             {
             }
 
-            void emit_sample(
+            void add_camera_connection(
+                const Vector3d&             origin,
+                const Vector3d&             target,
+                const ShadingRay::Time&     time,
+                const ShadingRay::DepthType depth,
                 const Vector2d&             position_ndc,
                 const Spectrum&             radiance)
             {
                 assert(min_value(radiance) >= 0.0f);
 
-                const Color3f linear_rgb = radiance.illuminance_to_rgb(g_std_lighting_conditions);
-
-                Sample sample;
-                sample.m_pixel_coords.x = static_cast<int>(position_ndc.x * m_canvas_width);
-                sample.m_pixel_coords.y = static_cast<int>(position_ndc.y * m_canvas_height);
-                sample.m_color.rgb() = linear_rgb;
-                sample.m_color.a = 1.0f;
-                m_samples.push_back(sample);
-
-                ++m_sample_count;
+                CameraConnection connection;
+                connection.m_origin = origin;
+                connection.m_target = target;
+                connection.m_time = time;
+                connection.m_depth = depth;
+                connection.m_pixel_coords.x = static_cast<int>(position_ndc.x * m_canvas_width);
+                connection.m_pixel_coords.y = static_cast<int>(position_ndc.y * m_canvas_height);
+                connection.m_radiance = radiance;
+                m_camera_connections.push_back(connection);
             }
         };
 
@@ -551,6 +562,9 @@ namespace
 
         SamplingContext::RNGType        m_rng;
 
+        CameraConnectionVector          m_camera_connections;
+        TileSplatBuffer                 m_splat_buffer;
+
         std::uint64_t                   m_light_sample_count;
 
         std::uint64_t                   m_path_count;
@@ -572,31 +586,85 @@ namespace
                 m_params.m_sampling_mode,
                 instance);
 
-            size_t stored_sample_count = 0;
-
             // Trace one path from one of the lights.
             if (m_light_sampler.has_lights())
-                stored_sample_count += generate_light_sample(sampling_context, samples);
+                generate_light_sample(sampling_context);
 
             // Trace one path from the environment.
             if (m_params.m_enable_ibl)
             {
                 const EnvironmentEDF* env_edf = m_scene.get_environment()->get_environment_edf();
                 if (env_edf != nullptr)
-                {
-                    stored_sample_count +=
-                        generate_environment_sample(sampling_context, env_edf, samples);
-                }
+                    generate_environment_sample(sampling_context, env_edf);
             }
 
             ++m_light_sample_count;
 
+            // Resolve the visibility of pending camera connections in batches.
+            return
+                m_camera_connections.size() >= CameraConnectionBatchSize
+                    ? trace_camera_connections(samples)
+                    : 0;
+        }
+
+        size_t flush_samples(SampleVector& samples) override
+        {
+            return trace_camera_connections(samples);
+        }
+
+        void store_samples(
+            const SampleVector&         samples,
+            SampleAccumulationBuffer&   buffer,
+            IAbortSwitch&               abort_switch) override
+        {
+            m_splat_buffer.build(samples.size(), &samples[0]);
+
+            static_cast<GlobalSampleAccumulationBuffer&>(buffer)
+                .store_splats(m_splat_buffer, abort_switch);
+        }
+
+        size_t trace_camera_connections(SampleVector& samples)
+        {
+            // Sort connections by pixel such that consecutive visibility rays are coherent.
+            std::sort(m_camera_connections.begin(), m_camera_connections.end());
+
+            size_t stored_sample_count = 0;
+
+            for (const CameraConnection& connection : m_camera_connections)
+            {
+                // Compute the transmission factor between the path vertex and the camera.
+                Spectrum transmission;
+                m_shading_context.get_tracer().trace_between_simple(
+                    m_shading_context,
+                    connection.m_origin,
+                    connection.m_target,
+                    connection.m_time,
+                    VisibilityFlags::CameraRay,
+                    connection.m_depth,
+                    transmission);
+
+                // Ignore occluded vertices.
+                if (is_zero(transmission))
+                    continue;
+
+                Spectrum radiance = connection.m_radiance;
+                radiance *= transmission;
+
+                Sample sample;
+                sample.m_pixel_coords = connection.m_pixel_coords;
+                sample.m_color.rgb() = radiance.illuminance_to_rgb(g_std_lighting_conditions);
+                sample.m_color.a = 1.0f;
+                samples.push_back(sample);
+
+                ++stored_sample_count;
+            }
+
+            clear_keep_memory(m_camera_connections);
+
             return stored_sample_count;
         }
 
-        size_t generate_light_sample(
-            SamplingContext&            sampling_context,
-            SampleVector&               samples)
+        void generate_light_sample(SamplingContext& sampling_context)
         {
             // Sample the light sources.
             sampling_context.split_in_place(4, 1);
@@ -610,16 +678,15 @@ namespace
                 Vector3f(s[1], s[2], s[3]),
                 light_sample);
 
-            return
-                light_sample.m_shape
-                    ? generate_emitting_shape_sample(sampling_context, light_sample, samples)
-                    : generate_non_physical_light_sample(sampling_context, light_sample, samples);
+            if (light_sample.m_shape)
+                generate_emitting_shape_sample(sampling_context, light_sample);
+            else
+                generate_non_physical_light_sample(sampling_context, light_sample);
         }
 
-        size_t generate_emitting_shape_sample(
+        void generate_emitting_shape_sample(
             SamplingContext&            sampling_context,
-            LightSample&                light_sample,
-            SampleVector&               samples)
+            LightSample&                light_sample)
         {
             // Make sure the geometric normal of the light sample is in the same hemisphere as the shading normal.
             light_sample.m_geometric_normal =
@@ -693,7 +760,7 @@ namespace
                 m_frame,
                 m_shading_context,
                 sampling_context,
-                samples,
+                m_camera_connections,
                 initial_flux);
             VolumeVisitor volume_visitor;
             PathTracerType path_tracer(
@@ -728,15 +795,11 @@ namespace
             // Update path statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
-
-            // Return the number of samples generated when tracing this light path.
-            return path_visitor.get_sample_count();
         }
 
-        size_t generate_non_physical_light_sample(
+        void generate_non_physical_light_sample(
             SamplingContext&            sampling_context,
-            const LightSample&          light_sample,
-            SampleVector&               samples)
+            const LightSample&          light_sample)
         {
             // Sample the light.
             sampling_context.split_in_place(2, 1);
@@ -777,7 +840,7 @@ namespace
                 m_frame,
                 m_shading_context,
                 sampling_context,
-                samples,
+                m_camera_connections,
                 initial_flux);
             VolumeVisitor volume_visitor;
             PathTracerType path_tracer(
@@ -810,15 +873,11 @@ namespace
             // Update path statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
-
-            // Return the number of samples generated when tracing this light path.
-            return path_visitor.get_sample_count();
         }
 
-        size_t generate_environment_sample(
+        void generate_environment_sample(
             SamplingContext&            sampling_context,
-            const EnvironmentEDF*       env_edf,
-            SampleVector&               samples)
+            const EnvironmentEDF*       env_edf)
         {
             // Sample the environment.
             sampling_context.split_in_place(2, 1);
@@ -871,7 +930,7 @@ namespace
                 m_frame,
                 m_shading_context,
                 sampling_context,
-                samples,
+                m_camera_connections,
                 initial_flux);
             VolumeVisitor volume_visitor;
             PathTracerType path_tracer(
@@ -896,9 +955,6 @@ namespace
             // Update path statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
-
-            // Return the number of samples generated when tracing this light path.
-            return path_visitor.get_sample_count();
         }
     };
 }
@@ -45,6 +45,8 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/timers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/vpythonfile.h"
 
 // Standard headers.
@@ -63,9 +65,11 @@ namespace renderer
 
 LightTree::LightTree(
     const std::vector<NonPhysicalLightInfo>&      non_physical_lights,
-    const std::vector<EmittingShape>&             emitting_shapes)
+    const std::vector<EmittingShape>&             emitting_shapes,
+    const float                                   split_threshold)
   : m_non_physical_lights(non_physical_lights)
   , m_emitting_shapes(emitting_shapes)
+  , m_split_threshold(split_threshold)
   , m_tree_depth(0)
   , m_is_built(false)
 {
@@ -78,25 +82,13 @@ std::vector<size_t> LightTree::build()
     // Collect non-physical light sources.
     for (size_t i = 0, e = m_non_physical_lights.size(); i < e; ++i)
     {
-        const Light* light = m_non_physical_lights[i].m_light;
+        Item item;
+        item.m_light_index = i;
+        item.m_light_type = NonPhysicalLightType;
+        item.m_bbox = compute_item_bbox(item);
 
-        // Retrieve the exact position of the light.
-        const Vector3d position = light->get_transform()
-                                    .get_local_to_parent()
-                                    .extract_translation();
-
-        // Non physical light has no real size - hence some arbitrary small
-        // value is assigned.
-        const double BboxSize = 0.001f;
-        const AABB3d bbox = AABB3d(Vector3d(position[0] - BboxSize,
-                                            position[1] - BboxSize,
-                                            position[2] - BboxSize),
-                                   Vector3d(position[0] + BboxSize,
-                                            position[1] + BboxSize,
-                                            position[2] + BboxSize));
-        light_bboxes.push_back(bbox);
-
-        m_items.emplace_back(bbox, i, NonPhysicalLightType);
+        light_bboxes.push_back(item.m_bbox);
+        m_items.push_back(item);
     }
 
     // Collect emitting shapes.
@@ -138,6 +130,7 @@ std::vector<size_t> LightTree::build()
         // Set total node importance and level for each node of the LightTree.
         IndexLUT tri_index_to_node_index;
         tri_index_to_node_index.resize(m_emitting_shapes.size());
+        m_light_index_to_node_index.resize(m_non_physical_lights.size());
         recursive_node_update(0, 0, 0, tri_index_to_node_index);
 
         // Print light tree statistics.
@@ -157,11 +150,164 @@ std::vector<size_t> LightTree::build()
     return IndexLUT();
 }
 
+void LightTree::refit()
+{
+    if (!m_is_built)
+        return;
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    AABB3d root_bbox;
+    recursive_node_refit(0, root_bbox);
+
+    stopwatch.measure();
+
+    RENDERER_LOG_DEBUG(
+        "refitted light tree with %s %s in %s.",
+        pretty_uint(m_nodes.size()).c_str(),
+        plural(m_nodes.size(), "node").c_str(),
+        pretty_time(stopwatch.get_seconds()).c_str());
+}
+
+void LightTree::refit(const std::vector<size_t>& leaf_node_indices)
+{
+    if (!m_is_built || leaf_node_indices.empty())
+        return;
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Update the leaves and flag their ancestors.
+    std::vector<bool> needs_refit(m_nodes.size(), false);
+    for (const size_t leaf_index : leaf_node_indices)
+    {
+        LightTreeNode<AABB3d>& leaf = m_nodes[leaf_index];
+        assert(leaf.is_leaf());
+
+        Item& item = m_items[leaf.get_item_index()];
+        item.m_bbox = compute_item_bbox(item);
+        leaf.set_importance(compute_item_importance(item));
+
+        for (size_t node_index = leaf_index; !m_nodes[node_index].is_root(); )
+        {
+            node_index = m_nodes[node_index].get_parent();
+            if (needs_refit[node_index])
+                break;
+            needs_refit[node_index] = true;
+        }
+    }
+
+    // Children are always stored after their parent: visit nodes in reverse order
+    // so that the children of a node are up-to-date by the time it is updated.
+    size_t refitted_node_count = 0;
+    for (size_t node_index = m_nodes.size(); node_index-- > 0; )
+    {
+        if (!needs_refit[node_index])
+            continue;
+
+        LightTreeNode<AABB3d>& node = m_nodes[node_index];
+        const size_t child1 = node.get_child_node_index();
+        const size_t child2 = child1 + 1;
+
+        node.set_left_bbox(compute_node_bbox(child1));
+        node.set_right_bbox(compute_node_bbox(child2));
+        node.set_importance(m_nodes[child1].get_importance() + m_nodes[child2].get_importance());
+
+        ++refitted_node_count;
+    }
+
+    stopwatch.measure();
+
+    RENDERER_LOG_DEBUG(
+        "refitted %s light tree %s out of %s in %s.",
+        pretty_uint(refitted_node_count + leaf_node_indices.size()).c_str(),
+        plural(refitted_node_count + leaf_node_indices.size(), "node").c_str(),
+        pretty_uint(m_nodes.size()).c_str(),
+        pretty_time(stopwatch.get_seconds()).c_str());
+}
+
 bool LightTree::is_built() const
 {
     return m_is_built;
 }
 
+size_t LightTree::get_non_physical_light_node_index(const size_t light_index) const
+{
+    assert(light_index < m_light_index_to_node_index.size());
+    return m_light_index_to_node_index[light_index];
+}
+
+AABB3d LightTree::compute_node_bbox(const size_t node_index) const
+{
+    const LightTreeNode<AABB3d>& node = m_nodes[node_index];
+
+    if (node.is_leaf())
+        return m_items[node.get_item_index()].m_bbox;
+
+    AABB3d bbox = node.get_left_bbox();
+    bbox.insert(node.get_right_bbox());
+    return bbox;
+}
+
+AABB3d LightTree::compute_item_bbox(const Item& item) const
+{
+    if (item.m_light_type == NonPhysicalLightType)
+    {
+        const NonPhysicalLightInfo& light_info = m_non_physical_lights[item.m_light_index];
+
+        // Retrieve the exact position of the light, taking into account the
+        // transform of the assembly instance it was collected from.
+        const Vector3d position =
+            (light_info.m_light->get_transform() * light_info.m_transform_sequence.get_earliest_transform())
+                .get_local_to_parent()
+                .extract_translation();
+
+        // Non physical light has no real size - hence some arbitrary small
+        // value is assigned.
+        const double BboxSize = 0.001f;
+        return AABB3d(position - Vector3d(BboxSize), position + Vector3d(BboxSize));
+    }
+    else
+    {
+        assert(item.m_light_type == EmittingShapeType);
+        return m_emitting_shapes[item.m_light_index].get_bbox();
+    }
+}
+
+float LightTree::compute_item_importance(const Item& item) const
+{
+    if (item.m_light_type == NonPhysicalLightType)
+    {
+        const Light* light = m_non_physical_lights[item.m_light_index].m_light;
+
+        // Retrieve the non-physical light importance.
+        Spectrum spectrum;
+        light->get_inputs().find("intensity").source()->evaluate_uniform(spectrum);
+        return average_value(spectrum);
+    }
+    else
+    {
+        assert(item.m_light_type == EmittingShapeType);
+
+        const EmittingShape& shape = m_emitting_shapes[item.m_light_index];
+
+        // Retrieve the emitting shape importance.
+        const EDF* edf = shape.get_material()->get_uncached_edf();
+        assert(edf != nullptr);
+
+        const float max_contribution = edf->get_uncached_max_contribution();
+
+        // max_contribution is reported as std::numeric_limits<float>::max() when
+        // we can't compute the max_contribution easily (ex: textured lights)
+        // In such cases, we can use a default importance value of 1.0 to avoid
+        // infinite importance values in the light tree nodes.
+        if (max_contribution == std::numeric_limits<float>::max())
+            return 1.0f;
+        else return max_contribution * edf->get_uncached_importance_multiplier();
+    }
+}
+
 float LightTree::recursive_node_update(
     const size_t    parent_index,
     const size_t    node_index,
@@ -184,41 +330,14 @@ float LightTree::recursive_node_update(
     {
         // Retrieve the light source associated to this leaf.
         const size_t item_index = m_nodes[node_index].get_item_index();
-        const size_t light_index = m_items[item_index].m_light_index;
+        const Item& item = m_items[item_index];
 
-        if (m_items[item_index].m_light_type == NonPhysicalLightType)
-        {
-            const Light* light = m_non_physical_lights[light_index].m_light;
-
-            // Retrieve the non-physical light importance.
-            Spectrum spectrum;
-            light->get_inputs().find("intensity").source()->evaluate_uniform(spectrum);
-            importance = average_value(spectrum);
-        }
-        else
-        {
-            assert(m_items[item_index].m_light_type == EmittingShapeType);
+        importance = compute_item_importance(item);
 
-            const EmittingShape& shape = m_emitting_shapes[light_index];
-
-            // Retrieve the emitting shape importance.
-            const EDF* edf = shape.get_material()->get_uncached_edf();
-            assert(edf != nullptr);
-
-            const float max_contribution = edf->get_uncached_max_contribution();
-
-            // max_contribution is reported as std::numeric_limits<float>::max() when
-            // we can't compute the max_contribution easily (ex: textured lights)
-            // In such cases, we can use a default importance value of 1.0 to avoid
-            // infinite importance values in the light tree nodes.
-            if (max_contribution == std::numeric_limits<float>::max())
-                importance = 1.0f;
-            else
-                importance = max_contribution * edf->get_uncached_importance_multiplier();
-
-            // Save the index of the light tree node containing the EMT in the look up table.
-            tri_index_to_node_index[light_index] = node_index;
-        }
+        // Save the index of the light tree node containing the EMT in the look up table.
+        if (item.m_light_type == EmittingShapeType)
+            tri_index_to_node_index[item.m_light_index] = node_index;
+        else m_light_index_to_node_index[item.m_light_index] = node_index;
 
         // Keep track of the tree depth.
         if (m_tree_depth < node_level)
@@ -235,49 +354,131 @@ float LightTree::recursive_node_update(
     return importance;
 }
 
-void LightTree::sample(
+float LightTree::recursive_node_refit(
+    const size_t    node_index,
+    AABB3d&         bbox)
+{
+    LightTreeNode<AABB3d>& node = m_nodes[node_index];
+
+    float importance;
+
+    if (!node.is_leaf())
+    {
+        AABB3d bbox1, bbox2;
+        const float importance1 = recursive_node_refit(node.get_child_node_index(), bbox1);
+        const float importance2 = recursive_node_refit(node.get_child_node_index() + 1, bbox2);
+
+        node.set_left_bbox(bbox1);
+        node.set_right_bbox(bbox2);
+
+        bbox = bbox1;
+        bbox.insert(bbox2);
+        importance = importance1 + importance2;
+    }
+    else
+    {
+        Item& item = m_items[node.get_item_index()];
+        item.m_bbox = compute_item_bbox(item);
+
+        bbox = item.m_bbox;
+        importance = compute_item_importance(item);
+    }
+
+    node.set_importance(importance);
+
+    return importance;
+}
+
+size_t LightTree::sample(
     const ShadingPoint&     shading_point,
-    float                   s,
-    LightType&              light_type,
-    size_t&                 light_index,
-    float&                  light_probability) const
+    const float             s,
+    SampledLight            sampled_lights[]) const
 {
     assert(is_built());
 
-    light_probability = 1.0f;
-    size_t node_index = 0;
-
-    while (!m_nodes[node_index].is_leaf())
+    // A pending traversal of a subtree, created when a node is split.
+    struct Traversal
     {
-        const auto& node = m_nodes[node_index];
+        size_t  m_node_index;
+        size_t  m_split_count;
+        float   m_s;
+        float   m_probability;
+    };
 
-        float p1, p2;
-        child_node_probabilites(node, shading_point, p1, p2);
+    // Each split pushes at most one traversal along any path.
+    Traversal stack[MaxSplitDepth + 1];
+    size_t stack_size = 0;
+    size_t sample_count = 0;
 
-        if (s < p1)
-        {
-            light_probability *= p1;
-            s /= p1;
-            node_index = node.get_child_node_index();
-        }
-        else
+    stack[stack_size++] = Traversal { 0, 0, s, 1.0f };
+
+    while (stack_size > 0)
+    {
+        Traversal t = stack[--stack_size];
+
+        while (!m_nodes[t.m_node_index].is_leaf())
         {
-            light_probability *= p2;
-            s = (s - p1) / p2;
-            node_index = node.get_child_node_index() + 1;
+            const auto& node = m_nodes[t.m_node_index];
+
+            if (t.m_split_count < MaxSplitDepth && should_split(node, shading_point))
+            {
+                // Sample both children: defer the right one, continue with the left one.
+                ++t.m_split_count;
+                assert(stack_size <= MaxSplitDepth);
+                stack[stack_size++] =
+                    Traversal { node.get_child_node_index() + 1, t.m_split_count, t.m_s, t.m_probability };
+                t.m_node_index = node.get_child_node_index();
+                continue;
+            }
+
+            float p1, p2;
+            child_node_probabilites(node, shading_point, p1, p2);
+
+            if (t.m_s < p1)
+            {
+                t.m_probability *= p1;
+                t.m_s /= p1;
+                t.m_node_index = node.get_child_node_index();
+            }
+            else
+            {
+                t.m_probability *= p2;
+                t.m_s = (t.m_s - p1) / p2;
+                t.m_node_index = node.get_child_node_index() + 1;
+            }
         }
+
+        const size_t item_index = m_nodes[t.m_node_index].get_item_index();
+        const Item& item = m_items[item_index];
+
+        assert(sample_count < MaxSampleCount);
+        SampledLight& sampled_light = sampled_lights[sample_count++];
+        sampled_light.m_light_type = item.m_light_type;
+        sampled_light.m_light_index = item.m_light_index;
+        sampled_light.m_probability = t.m_probability;
     }
 
-    const size_t item_index = m_nodes[node_index].get_item_index();
-    const Item& item = m_items[item_index];
-    light_type = item.m_light_type;
-    light_index = item.m_light_index;
+    return sample_count;
 }
 
 float LightTree::evaluate_node_pdf(
     const ShadingPoint&     shading_point,
     size_t                  node_index) const
 {
+    // Splitting decisions only depend on the node and the shading point: a node is split
+    // if it is among the MaxSplitDepth topmost ancestors that should be split. Count them
+    // so that the walk towards the root knows which ancestors were actually split.
+    size_t split_candidate_count = 0;
+    if (m_split_threshold > 0.0f)
+    {
+        for (size_t i = node_index; !m_nodes[i].is_root(); )
+        {
+            i = m_nodes[i].get_parent();
+            if (should_split(m_nodes[i], shading_point))
+                ++split_candidate_count;
+        }
+    }
+
     size_t parent_index = m_nodes[node_index].get_parent();
     float pdf = 1.0f;
 
@@ -285,10 +486,19 @@ float LightTree::evaluate_node_pdf(
     {
         const LightTreeNode<AABB3d>& node = m_nodes[parent_index];
 
-        float p1, p2;
-        child_node_probabilites(node, shading_point, p1, p2);
+        // Split nodes sample both children with probability 1.
+        const bool split =
+            split_candidate_count > 0 &&
+            should_split(node, shading_point) &&
+            --split_candidate_count < MaxSplitDepth;
+
+        if (!split)
+        {
+            float p1, p2;
+            child_node_probabilites(node, shading_point, p1, p2);
 
-        pdf *= node.get_child_node_index() == node_index ? p1 : p2;
+            pdf *= node.get_child_node_index() == node_index ? p1 : p2;
+        }
 
         // Save the child index to be sure which probability should be taken
         // into consideration.
@@ -299,6 +509,27 @@ float LightTree::evaluate_node_pdf(
     return pdf;
 }
 
+bool LightTree::should_split(
+    const LightTreeNode<AABB3d>&    node,
+    const ShadingPoint&             shading_point) const
+{
+    if (m_split_threshold <= 0.0f)
+        return false;
+
+    assert(!node.is_leaf());
+
+    // The importance of a cluster is estimated from its bounding sphere. The estimate is
+    // poor when the sphere subtends a large solid angle: split the cluster when the ratio
+    // between its radius and its distance to the shading point exceeds a threshold, i.e.
+    // when t * r^2 > (1 - t) * d^2.
+    AABB3d bbox = node.get_left_bbox();
+    bbox.insert(node.get_right_bbox());
+    const double r2 = bbox.square_radius();
+    const double d2 = square_distance(shading_point.get_point(), bbox.center());
+
+    return m_split_threshold * r2 > (1.0f - m_split_threshold) * d2;
+}
+
 namespace
 {
     // [1] Section 2.2.
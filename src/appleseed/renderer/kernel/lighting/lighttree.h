@@ -40,6 +40,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace renderer  { class ShadingPoint; }
@@ -59,22 +60,51 @@ class LightTree
             >
 {
   public:
+    // Maximum number of times the traversal can be split along any path from the root
+    // to a leaf, and maximum number of lights returned by a single call to sample().
+    static const size_t MaxSplitDepth = 3;
+    static const size_t MaxSampleCount = 1 << MaxSplitDepth;
+
+    // A light selected by sample().
+    struct SampledLight
+    {
+        LightType               m_light_type;
+        size_t                  m_light_index;
+        float                   m_probability;
+    };
+
     // Constructor.
     // Build the tree based on the lights collected by the BackwardLightSampler.
+    // split_threshold in [0, 1] controls adaptive splitting: 0 disables splitting,
+    // higher values split clusters that are increasingly far from the shading point.
     LightTree(
         const std::vector<NonPhysicalLightInfo>&      non_physical_lights,
-        const std::vector<EmittingShape>&             emitting_shapes);
+        const std::vector<EmittingShape>&             emitting_shapes,
+        const float                                   split_threshold = 0.0f);
 
     std::vector<size_t> build();
 
+    // Update node bounding boxes and importances to match the current state of the
+    // lights without changing the topology of the tree. This is much cheaper than a
+    // rebuild and suitable for lights animated between frames.
+    void refit();
+
+    // Same as refit() but only update the given leaf nodes and their ancestors.
+    void refit(const std::vector<size_t>& leaf_node_indices);
+
     bool is_built() const;
 
-    void sample(
+    // Return the index of the leaf node holding a given non-physical light.
+    size_t get_non_physical_light_node_index(const size_t light_index) const;
+
+    // Select lights for a given shading point. Clusters whose importance bound is too
+    // loose for this shading point are split and both of their children are sampled.
+    // The contributions of all selected lights must be summed. Return the number of
+    // selected lights, at most MaxSampleCount.
+    size_t sample(
         const ShadingPoint&             shading_point,
         const float                     s,
-        LightType&                      light_type,
-        size_t&                         light_index,
-        float&                          light_probability) const;
+        SampledLight                    sampled_lights[]) const;
 
     // Compute the light probability of a particular tree node. Start from the
     // node and go backwards towards the root node.
@@ -113,7 +143,9 @@ class LightTree
 
     const NonPhysicalLightVector&                   m_non_physical_lights;
     const EmittingShapeVector&                      m_emitting_shapes;
+    const float                                     m_split_threshold;
     ItemVector                                      m_items;
+    IndexLUT                                        m_light_index_to_node_index;
     size_t                                          m_tree_depth;
     bool                                            m_is_built;
 
@@ -126,6 +158,21 @@ class LightTree
         const size_t                                node_level,
         IndexLUT&                                   tri_index_to_node_index);
 
+    // Recompute the bounding box and the importance of a node from its children.
+    float recursive_node_refit(
+        const size_t                                node_index,
+        foundation::AABB3d&                         bbox);
+
+    foundation::AABB3d compute_node_bbox(const size_t node_index) const;
+    foundation::AABB3d compute_item_bbox(const Item& item) const;
+    float compute_item_importance(const Item& item) const;
+
+    // Return true if the importance bound of an interior node is too loose for
+    // the shading point, in which case both children should be sampled.
+    bool should_split(
+        const LightTreeNode<foundation::AABB3d>&    node,
+        const ShadingPoint&                         shading_point) const;
+
     float compute_node_probability(
         const LightTreeNode<foundation::AABB3d>&    node,
         const foundation::AABB3d&                   bbox,
@@ -30,6 +30,7 @@
 #include "materialsamplers.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/directshadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -187,6 +188,96 @@ float BSDFSampler::evaluate(
 }
 
 
+//
+// GuidedBSDFSampler class implementation.
+//
+
+GuidedBSDFSampler::GuidedBSDFSampler(
+    const BSDF&                 bsdf,
+    const void*                 bsdf_data,
+    const int                   bsdf_sampling_modes,
+    const ShadingPoint&         shading_point,
+    const DTree&                dtree,
+    const float                 bsdf_sampling_fraction)
+  : BSDFSampler(bsdf, bsdf_data, bsdf_sampling_modes, shading_point)
+  , m_dtree(dtree)
+  , m_bsdf_sampling_fraction(bsdf_sampling_fraction)
+{
+}
+
+bool GuidedBSDFSampler::sample(
+    SamplingContext&            sampling_context,
+    const Dual3d&               outgoing,
+    Dual3f&                     incoming,
+    DirectShadingComponents&    value,
+    float&                      pdf) const
+{
+    // Choose between sampling the BSDF and sampling the guiding distribution.
+    sampling_context.split_in_place(1, 1);
+    if (sampling_context.next2<float>() < m_bsdf_sampling_fraction)
+    {
+        if (!BSDFSampler::sample(sampling_context, outgoing, incoming, value, pdf))
+            return false;
+
+        // Specular directions cannot be reached by sampling the guiding distribution.
+        if (pdf == BSDF::DiracDelta)
+        {
+            value /= m_bsdf_sampling_fraction;
+            return true;
+        }
+
+        pdf =
+            m_bsdf_sampling_fraction * pdf +
+            (1.0f - m_bsdf_sampling_fraction) * m_dtree.evaluate_pdf(incoming.get_value());
+
+        return true;
+    }
+
+    sampling_context.split_in_place(2, 1);
+    float guiding_prob;
+    const Vector3f direction = m_dtree.sample(sampling_context.next2<Vector2f>(), guiding_prob);
+
+    const float bsdf_prob =
+        BSDFSampler::evaluate(
+            Vector3f(outgoing.get_value()),
+            direction,
+            m_bsdf_sampling_modes,
+            value);
+
+    if (bsdf_prob == 0.0f)
+        return false;
+
+    incoming = Dual3f(direction);
+    pdf =
+        m_bsdf_sampling_fraction * bsdf_prob +
+        (1.0f - m_bsdf_sampling_fraction) * guiding_prob;
+
+    return true;
+}
+
+float GuidedBSDFSampler::evaluate(
+    const Vector3f&             outgoing,
+    const Vector3f&             incoming,
+    const int                   light_sampling_modes,
+    DirectShadingComponents&    value) const
+{
+    const float bsdf_prob =
+        BSDFSampler::evaluate(
+            outgoing,
+            incoming,
+            light_sampling_modes,
+            value);
+
+    // The BSDF value is undefined when its probability density is zero.
+    if (bsdf_prob == 0.0f)
+        return 0.0f;
+
+    return
+        m_bsdf_sampling_fraction * bsdf_prob +
+        (1.0f - m_bsdf_sampling_fraction) * m_dtree.evaluate_pdf(incoming);
+}
+
+
 //
 // VolumeSampler class implementation.
 //
@@ -39,6 +39,7 @@
 
 // Forward declarations.
 namespace renderer  { class DirectShadingComponents; }
+namespace renderer  { class DTree; }
 namespace renderer  { class ShadingContext; }
 namespace renderer  { class ShadingPoint; }
 
@@ -135,7 +136,7 @@ class BSDFSampler
         const int                       light_sampling_modes,
         DirectShadingComponents&        value) const override;
 
-  private:
+  protected:
     const BSDF&                         m_bsdf;
     const void*                         m_bsdf_data;
     const int                           m_bsdf_sampling_modes;
@@ -143,6 +144,43 @@ class BSDFSampler
     BSDF::LocalGeometry                 m_local_geometry;
 };
 
+//
+// A BSDF sampler that samples a one-sample MIS combination of the BSDF and of a
+// path guiding distribution, and returns the probability density of that combination.
+// It must match the sampling strategy of the path tracer at vertices where path guiding
+// is enabled for multiple importance sampling weights to be correct.
+//
+
+class GuidedBSDFSampler
+  : public BSDFSampler
+{
+  public:
+    GuidedBSDFSampler(
+        const BSDF&                     bsdf,
+        const void*                     bsdf_data,
+        const int                       bsdf_sampling_modes,
+        const ShadingPoint&             shading_point,
+        const DTree&                    dtree,
+        const float                     bsdf_sampling_fraction);
+
+    bool sample(
+        SamplingContext&                sampling_context,
+        const foundation::Dual3d&       outgoing,
+        foundation::Dual3f&             incoming,
+        DirectShadingComponents&        value,
+        float&                          pdf) const override;
+
+    float evaluate(
+        const foundation::Vector3f&     outgoing,
+        const foundation::Vector3f&     incoming,
+        const int                       light_sampling_modes,
+        DirectShadingComponents&        value) const override;
+
+  private:
+    const DTree&                        m_dtree;
+    const float                         m_bsdf_sampling_fraction;
+};
+
 class VolumeSampler
   : public IMaterialSampler
 {
@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
@@ -99,6 +100,12 @@ namespace renderer
 //       void visit_ray(PathVertex& vertex, const ShadingRay& volume_ray);
 //   };
 //
+// When path guiding is enabled, directions at diffuse and glossy vertices are sampled
+// from a one-sample MIS combination of the BSDF and of the guiding distribution found
+// in the SD-tree at the vertex. The guiding distribution is then stored in the vertex
+// before on_scatter() is called so that the path visitor can use the same combination
+// for multiple importance sampling.
+//
 
 template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
 class PathTracer
@@ -133,6 +140,11 @@ class PathTracer
 
     const ShadingPoint& get_path_vertex(const size_t i) const;
 
+    // Enable path guiding. The SD-tree must outlive the path tracer.
+    void set_path_guiding(
+        const STree*                sd_tree,
+        const float                 bsdf_sampling_fraction);    // probability of sampling the BSDF rather than the guiding distribution
+
   private:
     PathVisitor&                    m_path_visitor;
     VolumeVisitor&                  m_volume_visitor;
@@ -145,6 +157,8 @@ class PathTracer
     const bool                      m_clamp_roughness;
     const size_t                    m_max_iterations;
     const double                    m_near_start;
+    const STree*                    m_sd_tree;
+    float                           m_bsdf_sampling_fraction;
     size_t                          m_diffuse_bounces;
     size_t                          m_glossy_bounces;
     size_t                          m_specular_bounces;
@@ -172,6 +186,13 @@ class PathTracer
         BSDFSample&                 sample,
         ShadingRay&                 ray);
 
+    // Sample a one-sample MIS combination of the BSDF and of the guiding distribution of a given path vertex.
+    void sample_guided(
+        SamplingContext&            sampling_context,
+        PathVertex&                 vertex,
+        const BSDF::LocalGeometry&  local_geometry,
+        BSDFSample&                 sample) const;
+
     // This method performs raymarching across the volume.
     // Returns whether the path should be continued.
     bool march(
@@ -211,6 +232,8 @@ inline PathTracer<PathVisitor, VolumeVisitor, Adjoint>::PathTracer(
   , m_clamp_roughness(clamp_roughness)
   , m_max_iterations(max_iterations)
   , m_near_start(near_start)
+  , m_sd_tree(nullptr)
+  , m_bsdf_sampling_fraction(1.0f)
 {
 }
 
@@ -252,6 +275,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
     vertex.m_prev_mode = ScatteringMode::Specular;
     vertex.m_prev_prob = BSDF::DiracDelta;
     vertex.m_aov_mode = ScatteringMode::None;
+    vertex.m_guiding_dtree = nullptr;
 
     // This variable tracks the beginning of the path segment inside the current medium.
     // While it is properly initialized when entering a medium, we also initialize it
@@ -697,6 +721,17 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     BSDFSample&                 sample,
     ShadingRay&                 next_ray)
 {
+    // Look up the guiding distribution if path guiding is enabled at this vertex.
+    vertex.m_guiding_dtree = nullptr;
+    if (m_sd_tree != nullptr &&
+        vertex.m_bssrdf == nullptr &&
+        (vertex.m_bsdf->get_modes() & vertex.m_scattering_modes & (ScatteringMode::Diffuse | ScatteringMode::Glossy)) != 0)
+    {
+        const DTree& dtree = m_sd_tree->get_sampling_dtree(foundation::Vector3f(vertex.get_point()));
+        if (dtree.get_total() > 0.0f)
+            vertex.m_guiding_dtree = &dtree;
+    }
+
     // Let the path visitor handle the scattering event.
     m_path_visitor.on_scatter(vertex);
 
@@ -707,15 +742,20 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     // Above-surface scattering.
     if (vertex.m_bssrdf == nullptr)
     {
-        vertex.m_bsdf->sample(
-            sampling_context,
-            vertex.m_bsdf_data,
-            Adjoint,
-            true,       // multiply by |cos(incoming, normal)|
-            local_geometry,
-            foundation::Dual3f(vertex.m_outgoing),
-            vertex.m_scattering_modes,
-            sample);
+        if (vertex.m_guiding_dtree != nullptr)
+            sample_guided(sampling_context, vertex, local_geometry, sample);
+        else
+        {
+            vertex.m_bsdf->sample(
+                sampling_context,
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                local_geometry,
+                foundation::Dual3f(vertex.m_outgoing),
+                vertex.m_scattering_modes,
+                sample);
+        }
 
         next_ray.m_min_roughness = m_clamp_roughness ? sample.m_min_roughness : 0.0f;
 
@@ -778,6 +818,123 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     return true;
 }
 
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
+void PathTracer<PathVisitor, VolumeVisitor, Adjoint>::sample_guided(
+    SamplingContext&            sampling_context,
+    PathVertex&                 vertex,
+    const BSDF::LocalGeometry&  local_geometry,
+    BSDFSample&                 sample) const
+{
+    const DTree& dtree = *vertex.m_guiding_dtree;
+    const foundation::Dual3f outgoing(vertex.m_outgoing);
+
+    // Choose between sampling the BSDF and sampling the guiding distribution.
+    sampling_context.split_in_place(1, 1);
+    const bool sample_bsdf = sampling_context.next2<float>() < m_bsdf_sampling_fraction;
+
+    if (sample_bsdf)
+    {
+        vertex.m_bsdf->sample(
+            sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            local_geometry,
+            outgoing,
+            vertex.m_scattering_modes,
+            sample);
+
+        if (sample.get_mode() == ScatteringMode::None)
+            return;
+
+        // Specular directions cannot be reached by sampling the guiding distribution.
+        if (sample.get_mode() == ScatteringMode::Specular)
+        {
+            sample.m_value /= m_bsdf_sampling_fraction;
+            return;
+        }
+
+        sample.set_to_scattering(
+            sample.get_mode(),
+            m_bsdf_sampling_fraction * sample.get_probability() +
+            (1.0f - m_bsdf_sampling_fraction) * dtree.evaluate_pdf(sample.m_incoming.get_value()));
+
+        return;
+    }
+
+    // The scattered direction comes from the guiding distribution, which says nothing about
+    // the roughness of the BSDF lobe: leave the roughness clamping level of the path unchanged.
+    sample.m_min_roughness = vertex.get_ray().m_min_roughness;
+
+    // Keep a copy of the sampling context in case the albedo of the first bounce is needed,
+    // so that both strategies consume the same dimensions of the path's sampling context.
+    SamplingContext albedo_sampling_context(sampling_context);
+
+    // Sample the guiding distribution.
+    sampling_context.split_in_place(2, 1);
+    float guiding_prob;
+    const foundation::Vector3f incoming = dtree.sample(sampling_context.next2<foundation::Vector2f>(), guiding_prob);
+
+    // Evaluate the BSDF in the sampled direction.
+    const float bsdf_prob =
+        vertex.m_bsdf->evaluate(
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            local_geometry,
+            outgoing.get_value(),
+            incoming,
+            vertex.m_scattering_modes,
+            sample.m_value);
+
+    if (bsdf_prob == 0.0f)
+    {
+        sample.set_to_absorption();
+        return;
+    }
+
+    // Classify the scattering event according to the BSDF component most likely to produce it.
+    const int modes = vertex.m_bsdf->get_modes() & vertex.m_scattering_modes;
+    ScatteringMode::Mode mode =
+        ScatteringMode::has_diffuse(modes) ? ScatteringMode::Diffuse : ScatteringMode::Glossy;
+    if (ScatteringMode::has_diffuse_and_glossy(modes))
+    {
+        const float glossy_prob =
+            vertex.m_bsdf->evaluate_pdf(
+                vertex.m_bsdf_data,
+                Adjoint,
+                local_geometry,
+                outgoing.get_value(),
+                incoming,
+                ScatteringMode::Glossy);
+        if (glossy_prob > 0.5f * bsdf_prob)
+            mode = ScatteringMode::Glossy;
+    }
+
+    sample.m_incoming = foundation::Dual3f(incoming);
+    sample.compute_diffuse_differentials(outgoing);
+    sample.set_to_scattering(
+        mode,
+        m_bsdf_sampling_fraction * bsdf_prob +
+        (1.0f - m_bsdf_sampling_fraction) * guiding_prob);
+
+    // The albedo of the first diffuse bounce is only computed by BSDF sampling.
+    if (vertex.m_path_length == 1 && mode == ScatteringMode::Diffuse)
+    {
+        BSDFSample albedo_sample;
+        vertex.m_bsdf->sample(
+            albedo_sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            local_geometry,
+            outgoing,
+            vertex.m_scattering_modes,
+            albedo_sample);
+        sample.m_aov_components.m_albedo = albedo_sample.m_aov_components.m_albedo;
+    }
+}
+
 template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
 bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
     SamplingContext&            sampling_context,
@@ -999,4 +1156,15 @@ inline const ShadingPoint& PathTracer<PathVisitor, VolumeVisitor, Adjoint>::get_
     return reinterpret_cast<const ShadingPoint*>(m_shading_point_arena.get_storage())[i];
 }
 
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
+inline void PathTracer<PathVisitor, VolumeVisitor, Adjoint>::set_path_guiding(
+    const STree*                sd_tree,
+    const float                 bsdf_sampling_fraction)
+{
+    assert(bsdf_sampling_fraction > 0.0f && bsdf_sampling_fraction <= 1.0f);
+
+    m_sd_tree = sd_tree;
+    m_bsdf_sampling_fraction = bsdf_sampling_fraction;
+}
+
 }   // namespace renderer
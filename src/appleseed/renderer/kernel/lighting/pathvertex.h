@@ -49,6 +49,7 @@
 // Forward declarations.
 namespace renderer  { class BSDF; }
 namespace renderer  { class BSSRDF; }
+namespace renderer  { class DTree; }
 namespace renderer  { class EDF; }
 namespace renderer  { class Material; }
 namespace renderer  { class ShadingContext; }
@@ -83,6 +84,7 @@ class PathVertex
     const BSSRDF*               m_bssrdf;
     const void*                 m_bssrdf_data;
     const void*                 m_volume_data;
+    const DTree*                m_guiding_dtree;    // path guiding distribution, only set when guiding is enabled at this vertex
 
     // Properties of the scattering event leading to this vertex.
     ScatteringMode::Mode        m_prev_mode;
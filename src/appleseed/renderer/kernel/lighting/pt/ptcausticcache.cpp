@@ -0,0 +1,233 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "ptcausticcache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/shading/directshadingcomponents.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/hash/hash.h"
+#include "foundation/math/basis.h"
+#include "foundation/math/densityestimation.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+namespace
+{
+    // Derive the photon tracing parameters from the path tracer's parameters.
+    ParamArray make_caustic_photon_params(const ParamArray& params)
+    {
+        ParamArray caustic_params(params);
+        caustic_params
+            .insert("photon_type", "poly")
+            .insert("dl_mode", "rt")                // don't store photons at the first bounce
+            .insert("enable_caustics", true)
+            .insert("caustic_photons_only", true)
+            .insert("enable_importons", false)
+            .insert("max_photons_per_estimate", 0)  // gather all photons within the lookup radius
+            .insert("light_photons_per_pass", params.get_optional<std::size_t>("caustic_cache_light_photons", 1000000))
+            .insert("env_photons_per_pass", params.get_optional<std::size_t>("caustic_cache_env_photons", 1000000))
+            .insert("initial_photon_lookup_radius", params.get_optional<float>("caustic_cache_lookup_radius", 0.1f))
+            .insert("alpha", params.get_optional<float>("caustic_cache_alpha", 0.7f))
+            .insert("photon_map_type", params.get_optional<std::string>("caustic_cache_photon_map_type", "hashgrid"));
+        return caustic_params;
+    }
+}
+
+
+//
+// PTCausticCache class implementation.
+//
+
+PTCausticCache::PTCausticCache(
+    const Scene&                        scene,
+    const ForwardLightSampler&          light_sampler,
+    const TraceContext&                 trace_context,
+    TextureStore&                       texture_store,
+    OIIOTextureSystem&                  oiio_texture_system,
+    OSLShadingSystem&                   shading_system,
+    const ParamArray&                   params)
+  : m_scene(scene)
+  , m_params(make_caustic_photon_params(params))
+  , m_photon_tracer(
+        scene,
+        light_sampler,
+        trace_context,
+        texture_store,
+        oiio_texture_system,
+        shading_system,
+        m_params)
+{
+    // Compute the initial lookup radius.
+    const GAABB3 scene_bbox = scene.compute_bbox();
+    const float scene_diameter = static_cast<float>(scene_bbox.diameter());
+    m_initial_lookup_radius = scene_diameter * (m_params.m_initial_photon_lookup_radius_percents / 100.0f);
+    m_lookup_radius = m_initial_lookup_radius;
+}
+
+void PTCausticCache::rebuild(
+    const Frame&                        frame,
+    const std::size_t                   pass_number,
+    JobQueue&                           job_queue,
+    IAbortSwitch&                       abort_switch)
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    m_photon_map.reset();
+    m_photons.clear_keep_memory();
+
+    // Trace a new set of caustic photons.
+    const std::uint32_t pass_hash = mix_uint32(frame.get_noise_seed(), static_cast<std::uint32_t>(pass_number));
+    m_photon_tracer.trace_photons(
+        m_photons,
+        nullptr,                                // no importon map
+        0.0f,
+        pass_hash,
+        job_queue,
+        abort_switch);
+
+    // Stop there if rendering was aborted.
+    if (abort_switch.is_aborted())
+        return;
+
+    const std::size_t photon_count = m_photons.size();
+
+    // Build a new photon map.
+    m_photon_map.reset(
+        new SPPMPhotonMap(
+            m_photons,
+            m_params,
+            m_lookup_radius,
+            job_queue));
+
+    stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "built caustic photon map with %s photon%s in %s, lookup radius is %f (%s of initial radius).",
+        pretty_uint(photon_count).c_str(),
+        photon_count > 1 ? "s" : "",
+        pretty_time(stopwatch.get_seconds()).c_str(),
+        m_lookup_radius,
+        pretty_percent(m_lookup_radius, m_initial_lookup_radius, 3).c_str());
+}
+
+void PTCausticCache::shrink_lookup_radius(const std::size_t pass_number)
+{
+    const float k = (pass_number + m_params.m_alpha) / (pass_number + 1);
+    assert(k <= 1.0f);
+    m_lookup_radius *= std::sqrt(k);
+}
+
+void PTCausticCache::estimate(
+    const PathVertex&                   vertex,
+    Spectrum&                           radiance) const
+{
+    radiance.set(0.0f);
+
+    if (empty() || m_lookup_radius <= 0.0f)
+        return;
+
+    assert(vertex.m_bsdf != nullptr);
+
+    const Vector3f point(vertex.get_point());
+    const Vector3f normal(vertex.get_geometric_normal());
+    const Vector3f outgoing(vertex.m_outgoing.get_value());
+    const float max_square_dist = square(m_lookup_radius);
+    const float rcp_max_square_dist = 1.0f / max_square_dist;
+
+    BSDF::LocalGeometry local_geometry;
+    local_geometry.m_shading_point = vertex.m_shading_point;
+    local_geometry.m_geometric_normal = normal;
+    local_geometry.m_shading_basis = Basis3f(vertex.get_shading_basis());
+
+    auto visitor = [&](const std::size_t i, const float square_dist)
+    {
+        const SPPMPolyPhoton& photon = m_photons.m_poly_photons[m_photon_map->remap(i)];
+
+        // Reject photons from the opposite hemisphere as they won't contribute.
+        if (dot(normal, photon.m_incoming) <= 0.0f)
+            return;
+
+        // Reject photons on a surface with too different an orientation.
+        const float NormalThreshold = 1.0e-3f;
+        if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
+            return;
+
+        // Evaluate the diffuse components of the BSDF for this photon.
+        DirectShadingComponents bsdf_value;
+        const float bsdf_prob =
+            vertex.m_bsdf->evaluate(
+                vertex.m_bsdf_data,
+                false,                                      // not adjoint
+                true,                                       // multiply by |cos(incoming, normal)|
+                local_geometry,
+                outgoing,                                   // toward the camera
+                normalize(photon.m_incoming),               // toward the light
+                ScatteringMode::Diffuse,
+                bsdf_value);
+        if (bsdf_prob == 0.0f)
+            return;
+
+        // Convert flux to reflected radiance, the density estimation is completed below.
+        bsdf_value.m_beauty /= std::abs(dot(photon.m_incoming, photon.m_geometric_normal));
+        bsdf_value.m_beauty *= photon.m_flux;
+        bsdf_value.m_beauty *= epanechnikov2d(square_dist * rcp_max_square_dist);
+
+        radiance += bsdf_value.m_beauty;
+    };
+
+    m_photon_map->gather(point, max_square_dist, visitor);
+
+    radiance *= rcp_max_square_dist;
+}
+
+}   // namespace renderer
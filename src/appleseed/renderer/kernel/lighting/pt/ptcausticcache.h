@@ -0,0 +1,132 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+#include "renderer/kernel/lighting/sppm/sppmphotontracer.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class ForwardLightSampler; }
+namespace renderer      { class Frame; }
+namespace renderer      { class OIIOTextureSystem; }
+namespace renderer      { class OSLShadingSystem; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class PathVertex; }
+namespace renderer      { class Scene; }
+namespace renderer      { class TextureStore; }
+namespace renderer      { class TraceContext; }
+
+namespace renderer
+{
+
+//
+// A photon map holding caustic photons only, i.e. photons that reached a non-specular
+// surface after one or more specular bounces, used by the path tracer to estimate
+// caustics at the first diffuse vertex of camera paths.
+//
+// The photon map is rebuilt before each rendering pass with a new set of photons and
+// a lookup radius shrinking from pass to pass, as in progressive photon mapping.
+//
+
+class PTCausticCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    PTCausticCache(
+        const Scene&                        scene,
+        const ForwardLightSampler&          light_sampler,
+        const TraceContext&                 trace_context,
+        TextureStore&                       texture_store,
+        OIIOTextureSystem&                  oiio_texture_system,
+        OSLShadingSystem&                   shading_system,
+        const ParamArray&                   params);
+
+    // Trace a new set of caustic photons and rebuild the photon map.
+    void rebuild(
+        const Frame&                        frame,
+        const std::size_t                   pass_number,
+        foundation::JobQueue&               job_queue,
+        foundation::IAbortSwitch&           abort_switch);
+
+    // Shrink the lookup radius in preparation for the next pass.
+    void shrink_lookup_radius(const std::size_t pass_number);
+
+    // Return true if the photon map contains no photon.
+    bool empty() const;
+
+    // Estimate the caustic radiance diffusely reflected at a given path vertex, toward
+    // the previous vertex. The caller is responsible for applying the path throughput.
+    void estimate(
+        const PathVertex&                   vertex,
+        Spectrum&                           radiance) const;
+
+    // Return the current lookup radius.
+    float get_lookup_radius() const;
+
+  private:
+    const Scene&                            m_scene;
+    const SPPMParameters                    m_params;
+    SPPMPhotonTracer                        m_photon_tracer;
+    SPPMPhotonVector                        m_photons;
+    std::unique_ptr<SPPMPhotonMap>          m_photon_map;
+    float                                   m_initial_lookup_radius;
+    float                                   m_lookup_radius;
+};
+
+
+//
+// PTCausticCache class implementation.
+//
+
+inline bool PTCausticCache::empty() const
+{
+    return !m_photon_map || m_photon_map->empty();
+}
+
+inline float PTCausticCache::get_lookup_radius() const
+{
+    return m_lookup_radius;
+}
+
+}   // namespace renderer
@@ -38,9 +38,13 @@
 #include "renderer/kernel/lighting/imagebasedlighting.h"
 #include "renderer/kernel/lighting/lightpathrecorder.h"
 #include "renderer/kernel/lighting/lightpathstream.h"
+#include "renderer/kernel/lighting/materialsamplers.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/lighting/pt/ptcausticcache.h"
+#include "renderer/kernel/lighting/pt/ptpasscallback.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/lighting/volumelightingintegrator.h"
 #include "renderer/kernel/shading/shadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -90,6 +94,15 @@ namespace
     //
     //   http://citeseer.ist.psu.edu/344088.html
     //
+    // Path guiding reference:
+    //
+    //   Practical Path Guiding for Efficient Light-Transport Simulation
+    //   https://tom94.net/data/publications/mueller17practical/mueller17practical.pdf
+    //
+    // When the caustic cache is enabled, caustics are estimated from photons at the first
+    // diffuse vertex of camera paths, and light reaching that vertex through specular
+    // chains is no longer collected by the path tracer.
+    //
 
     class PTLightingEngine
       : public ILightingEngine
@@ -98,9 +111,11 @@ namespace
         PTLightingEngine(
             const BackwardLightSampler&     light_sampler,
             LightPathRecorder&              light_path_recorder,
+            PTPassCallback*                 pass_callback,
             const ParamArray&               params)
           : m_params(params)
           , m_light_sampler(light_sampler)
+          , m_pass_callback(pass_callback)
           , m_light_path_stream(
               m_params.m_record_light_paths
                   ? light_path_recorder.create_stream()
@@ -131,11 +146,14 @@ namespace
                 "  next event estimation         %s\n"
                 "  dl light samples              %s\n"
                 "  dl light threshold            %s\n"
+                "  dl resampling candidates      %s\n"
                 "  ibl env samples               %s\n"
                 "  max ray intensity             %s\n"
                 "  volume distance samples       %s\n"
                 "  equiangular sampling          %s\n"
-                "  clamp roughness               %s",
+                "  clamp roughness               %s\n"
+                "  path guiding                  %s\n"
+                "  caustic cache                 %s",
                 m_params.m_enable_dl ? "on" : "off",
                 m_params.m_enable_ibl ? "on" : "off",
                 m_params.m_enable_caustics ? "on" : "off",
@@ -148,11 +166,14 @@ namespace
                 m_params.m_next_event_estimation ? "on" : "off",
                 pretty_scalar(m_params.m_dl_light_sample_count).c_str(),
                 pretty_scalar(m_params.m_dl_low_light_threshold, 3).c_str(),
+                m_params.m_dl_resampling_candidate_count > 1 ? pretty_uint(m_params.m_dl_resampling_candidate_count).c_str() : "off",
                 pretty_scalar(m_params.m_ibl_env_sample_count).c_str(),
                 m_params.m_has_max_ray_intensity ? pretty_scalar(m_params.m_max_ray_intensity).c_str() : "unlimited",
                 pretty_int(m_params.m_distance_sample_count).c_str(),
                 m_params.m_enable_equiangular_sampling ? "on" : "off",
-                m_params.m_clamp_roughness ? "on" : "off");
+                m_params.m_clamp_roughness ? "on" : "off",
+                m_pass_callback && m_pass_callback->is_path_guiding_enabled() ? "on" : "off",
+                m_pass_callback && m_pass_callback->has_caustic_cache() ? "on" : "off");
         }
 
         void compute_lighting(
@@ -210,7 +231,9 @@ namespace
                 shading_point.get_scene(),
                 radiance,
                 aov_components,
-                m_light_path_stream);
+                m_light_path_stream,
+                m_pass_callback ? m_pass_callback->get_training_sd_tree() : nullptr,
+                m_pass_callback ? m_pass_callback->get_caustic_cache() : nullptr);
 
             VolumeVisitor volume_visitor(
                 m_params,
@@ -233,12 +256,22 @@ namespace
                 m_params.m_clamp_roughness,
                 shading_context.get_max_iterations());
 
+            if (m_pass_callback)
+            {
+                const STree* sd_tree = m_pass_callback->get_sampling_sd_tree();
+                if (sd_tree)
+                    path_tracer.set_path_guiding(sd_tree, m_params.m_guiding_bsdf_sampling_fraction);
+            }
+
             const size_t path_length =
                 path_tracer.trace(
                     sampling_context,
                     shading_context,
                     shading_point);
 
+            // Record incident radiance estimates along the path to train path guiding.
+            path_visitor.record_guiding_samples();
+
             // Update statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
@@ -273,6 +306,7 @@ namespace
 
             const float     m_dl_light_sample_count;        // number of light samples used to estimate direct illumination
             const float     m_dl_low_light_threshold;       // light contribution threshold to disable shadow rays
+            const size_t    m_dl_resampling_candidate_count;    // number of candidates resampled for each light sample
             const float     m_ibl_env_sample_count;         // number of environment samples used to estimate IBL
             float           m_rcp_dl_light_sample_count;
             float           m_rcp_ibl_env_sample_count;
@@ -285,6 +319,8 @@ namespace
 
             const bool      m_record_light_paths;
 
+            const float     m_guiding_bsdf_sampling_fraction;   // probability of sampling the BSDF rather than the path guiding distribution
+
             explicit Parameters(const ParamArray& params)
               : m_enable_dl(params.get_optional<bool>("enable_dl", true))
               , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
@@ -299,12 +335,15 @@ namespace
               , m_next_event_estimation(params.get_optional<bool>("next_event_estimation", true))
               , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0f))
               , m_dl_low_light_threshold(params.get_optional<float>("dl_low_light_threshold", 0.0f))
+              , m_dl_resampling_candidate_count(params.get_optional<size_t>("dl_resampling_candidates", 0))
               , m_ibl_env_sample_count(params.get_optional<float>("ibl_env_samples", 1.0f))
               , m_has_max_ray_intensity(params.strings().exist("max_ray_intensity"))
               , m_max_ray_intensity(params.get_optional<float>("max_ray_intensity", 0.0f))
               , m_distance_sample_count(params.get_optional<size_t>("volume_distance_samples", 2))
               , m_enable_equiangular_sampling(!params.get_optional<bool>("optimize_for_lights_outside_volumes", false))
               , m_record_light_paths(params.get_optional<bool>("record_light_paths", false))
+              , m_guiding_bsdf_sampling_fraction(
+                    clamp(params.get_optional<float>("path_guiding_bsdf_sampling_fraction", 0.5f), 0.01f, 1.0f))
             {
                 // Precompute the reciprocal of the number of light samples.
                 m_rcp_dl_light_sample_count =
@@ -332,6 +371,7 @@ namespace
 
         const Parameters                m_params;
         const BackwardLightSampler&     m_light_sampler;
+        PTPassCallback*                 m_pass_callback;
         LightPathStream*                m_light_path_stream;
 
         std::uint64_t                   m_path_count;
@@ -376,7 +416,38 @@ namespace
                 return true;
             }
 
+            void record_guiding_samples()
+            {
+                for (size_t i = 0; i < m_guiding_vertex_count; ++i)
+                {
+                    const GuidingVertex& guiding_vertex = m_guiding_vertices[i];
+
+                    // The radiance gathered after a bounce is the incident radiance weighted by the path throughput.
+                    const float throughput = average_value(guiding_vertex.m_throughput);
+                    const float radiance =
+                        throughput > 0.0f
+                            ? (average_value(m_path_radiance.m_beauty) - guiding_vertex.m_radiance) / throughput
+                            : 0.0f;
+
+                    m_sd_tree->record(
+                        guiding_vertex.m_point,
+                        guiding_vertex.m_direction,
+                        radiance / guiding_vertex.m_prob);
+                }
+            }
+
           protected:
+            struct GuidingVertex
+            {
+                Vector3f                        m_point;
+                Vector3f                        m_direction;
+                float                           m_prob;             // probability density of the direction
+                Spectrum                        m_throughput;       // path throughput after the bounce
+                float                           m_radiance;         // path radiance before the bounce
+            };
+
+            static const size_t MaxGuidingVertices = 16;
+
             const Parameters&                   m_params;
             const BackwardLightSampler&         m_light_sampler;
             SamplingContext&                    m_sampling_context;
@@ -386,6 +457,13 @@ namespace
             AOVComponents&                      m_aov_components;
             LightPathStream*                    m_light_path_stream;
             bool                                m_omit_emitted_light;
+            STree*                              m_sd_tree;
+            GuidingVertex                       m_guiding_vertices[MaxGuidingVertices];
+            size_t                              m_guiding_vertex_count;
+            size_t                              m_guiding_path_length;
+            const PTCausticCache*               m_caustic_cache;
+            size_t                              m_caustic_gather_path_length;   // 0 if caustics were not gathered yet
+            bool                                m_in_caustic_chain;
 
             PathVisitorBase(
                 const Parameters&               params,
@@ -395,7 +473,9 @@ namespace
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
                 AOVComponents&                  aov_components,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                STree*                          sd_tree,
+                const PTCausticCache*           caustic_cache)
               : m_params(params)
               , m_light_sampler(light_sampler)
               , m_sampling_context(sampling_context)
@@ -405,7 +485,75 @@ namespace
               , m_aov_components(aov_components)
               , m_light_path_stream(light_path_stream)
               , m_omit_emitted_light(false)
+              , m_sd_tree(sd_tree)
+              , m_guiding_vertex_count(0)
+              , m_guiding_path_length(0)
+              , m_caustic_cache(caustic_cache)
+              , m_caustic_gather_path_length(0)
+              , m_in_caustic_chain(false)
+            {
+            }
+
+            // Estimate caustics from the caustic cache at the first diffuse vertex of the path.
+            void gather_caustics(const PathVertex& vertex)
+            {
+                if (m_caustic_cache == nullptr ||
+                    m_caustic_gather_path_length != 0 ||
+                    vertex.m_bsdf == nullptr ||
+                    !ScatteringMode::has_diffuse(vertex.m_scattering_modes))
+                    return;
+
+                m_caustic_gather_path_length = vertex.m_path_length;
+
+                DirectShadingComponents caustic_radiance;
+                m_caustic_cache->estimate(vertex, caustic_radiance.m_diffuse);
+                caustic_radiance.m_diffuse *= vertex.m_throughput;
+                caustic_radiance.m_beauty = caustic_radiance.m_diffuse;
+
+                m_path_radiance.add(
+                    vertex.m_path_length,
+                    vertex.m_aov_mode,
+                    caustic_radiance);
+            }
+
+            // Return true if the light reaching a given vertex was already gathered from the caustic cache,
+            // i.e. if this vertex follows a diffuse bounce off the gather vertex and specular bounces only.
+            // Must be called exactly once per surface vertex, in path order.
+            bool is_caustic_light_cached(const PathVertex& vertex)
+            {
+                if (m_caustic_gather_path_length == 0)
+                    return false;
+
+                if (vertex.m_path_length == m_caustic_gather_path_length + 1)
+                {
+                    // Light reaching the gather vertex directly is not a caustic.
+                    m_in_caustic_chain = vertex.m_prev_mode == ScatteringMode::Diffuse;
+                    return false;
+                }
+
+                if (vertex.m_prev_mode != ScatteringMode::Specular)
+                    m_in_caustic_chain = false;
+
+                return m_in_caustic_chain;
+            }
+
+            // Remember the bounce leading to a given vertex to later record the radiance coming from it.
+            void add_guiding_vertex(const PathVertex& vertex)
             {
+                if (m_sd_tree == nullptr ||
+                    (vertex.m_prev_mode != ScatteringMode::Diffuse && vertex.m_prev_mode != ScatteringMode::Glossy) ||
+                    vertex.m_path_length == m_guiding_path_length ||
+                    m_guiding_vertex_count == MaxGuidingVertices)
+                    return;
+
+                m_guiding_path_length = vertex.m_path_length;
+
+                GuidingVertex& guiding_vertex = m_guiding_vertices[m_guiding_vertex_count++];
+                guiding_vertex.m_point = Vector3f(vertex.m_parent_shading_point->get_point());
+                guiding_vertex.m_direction = Vector3f(vertex.get_ray().m_dir);
+                guiding_vertex.m_prob = vertex.m_prev_prob;
+                guiding_vertex.m_throughput = vertex.m_throughput;
+                guiding_vertex.m_radiance = average_value(m_path_radiance.m_beauty);
             }
         };
 
@@ -425,7 +573,9 @@ namespace
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
                 AOVComponents&                  aov_components,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                STree*                          sd_tree,
+                const PTCausticCache*           caustic_cache)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -434,7 +584,9 @@ namespace
                     scene,
                     path_radiance,
                     aov_components,
-                    light_path_stream)
+                    light_path_stream,
+                    sd_tree,
+                    caustic_cache)
             {
             }
 
@@ -442,6 +594,12 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::None);
 
+                add_guiding_vertex(vertex);
+
+                // Environment light reaching the path through a cached caustic chain.
+                if (is_caustic_light_cached(vertex))
+                    return;
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == nullptr)
                     return;
@@ -469,8 +627,11 @@ namespace
 
             void on_hit(const PathVertex& vertex)
             {
+                add_guiding_vertex(vertex);
+
                 // Emitted light contribution.
-                if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
+                if (!is_caustic_light_cached(vertex) &&
+                    (!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
                     vertex.m_cos_on > 0.0 &&
                     (vertex.m_path_length > 2 || m_params.m_enable_dl) &&
@@ -511,6 +672,8 @@ namespace
                         vertex.m_prev_mode == ScatteringMode::Volume)
                         vertex.m_scattering_modes &= ~(ScatteringMode::Glossy | ScatteringMode::Specular);
                 }
+
+                gather_caustics(vertex);
             }
         };
 
@@ -530,7 +693,9 @@ namespace
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
                 AOVComponents&                  aov_components,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                STree*                          sd_tree,
+                const PTCausticCache*           caustic_cache)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -539,7 +704,9 @@ namespace
                     scene,
                     path_radiance,
                     aov_components,
-                    light_path_stream)
+                    light_path_stream,
+                    sd_tree,
+                    caustic_cache)
               , m_is_indirect_lighting(false)
             {
             }
@@ -548,6 +715,12 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::None);
 
+                add_guiding_vertex(vertex);
+
+                // Environment light reaching the path through a cached caustic chain.
+                if (is_caustic_light_cached(vertex))
+                    return;
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == nullptr)
                     return;
@@ -598,8 +771,11 @@ namespace
 
             void on_hit(const PathVertex& vertex)
             {
+                add_guiding_vertex(vertex);
+
                 // Emitted light contribution.
-                if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
+                if (!is_caustic_light_cached(vertex) &&
+                    (!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
                     vertex.m_cos_on > 0.0 &&
                     (vertex.m_path_length > 2 || m_params.m_enable_dl) &&
@@ -654,6 +830,8 @@ namespace
                 if (vertex.m_scattering_modes == ScatteringMode::None)
                     return;
 
+                gather_caustics(vertex);
+
                 DirectShadingComponents vertex_radiance;
 
                 if (vertex.m_bssrdf == nullptr)
@@ -676,35 +854,28 @@ namespace
                     }
                 }
 
-                // Direct lighting contribution.
-                if (m_params.m_enable_dl || vertex.m_path_length > 1)
+                if (vertex.m_bsdf)
                 {
-                    if (vertex.m_bsdf)
+                    if (vertex.m_guiding_dtree)
                     {
-                        add_direct_lighting_contribution_bsdf(
-                            *vertex.m_shading_point,
-                            vertex.m_outgoing,
+                        // Path guiding is enabled at this vertex: MIS weights must account for it.
+                        const GuidedBSDFSampler bsdf_sampler(
                             *vertex.m_bsdf,
                             vertex.m_bsdf_data,
-                            vertex.m_scattering_modes,
-                            vertex_radiance,
-                            m_light_path_stream);
+                            vertex.m_scattering_modes,      // bsdf_sampling_modes (unused)
+                            *vertex.m_shading_point,
+                            *vertex.m_guiding_dtree,
+                            m_params.m_guiding_bsdf_sampling_fraction);
+                        add_lighting_contributions_bsdf(vertex, bsdf_sampler, vertex_radiance);
                     }
-                }
-
-                // Image-based lighting contribution.
-                if (m_params.m_enable_ibl && m_env_edf)
-                {
-                    if (vertex.m_bsdf)
+                    else
                     {
-                        add_image_based_lighting_contribution_bsdf(
-                            *vertex.m_shading_point,
-                            vertex.m_outgoing,
+                        const BSDFSampler bsdf_sampler(
                             *vertex.m_bsdf,
                             vertex.m_bsdf_data,
-                            vertex.m_scattering_modes,
-                            vertex_radiance,
-                            m_light_path_stream);
+                            vertex.m_scattering_modes,      // bsdf_sampling_modes (unused)
+                            *vertex.m_shading_point);
+                        add_lighting_contributions_bsdf(vertex, bsdf_sampler, vertex_radiance);
                     }
                 }
 
@@ -725,6 +896,36 @@ namespace
           private:
             bool m_is_indirect_lighting;
 
+            void add_lighting_contributions_bsdf(
+                const PathVertex&           vertex,
+                const BSDFSampler&          bsdf_sampler,
+                DirectShadingComponents&    vertex_radiance)
+            {
+                // Direct lighting contribution.
+                if (m_params.m_enable_dl || vertex.m_path_length > 1)
+                {
+                    add_direct_lighting_contribution_bsdf(
+                        *vertex.m_shading_point,
+                        vertex.m_outgoing,
+                        bsdf_sampler,
+                        vertex.m_scattering_modes,
+                        vertex_radiance,
+                        m_light_path_stream);
+                }
+
+                // Image-based lighting contribution.
+                if (m_params.m_enable_ibl && m_env_edf)
+                {
+                    add_image_based_lighting_contribution_bsdf(
+                        *vertex.m_shading_point,
+                        vertex.m_outgoing,
+                        bsdf_sampler,
+                        vertex.m_scattering_modes,
+                        vertex_radiance,
+                        m_light_path_stream);
+                }
+            }
+
             void add_emitted_light_contribution(
                 const PathVertex&           vertex,
                 Spectrum&                   vertex_radiance)
@@ -751,8 +952,7 @@ namespace
             void add_direct_lighting_contribution_bsdf(
                 const ShadingPoint&         shading_point,
                 const Dual3d&               outgoing,
-                const BSDF&                 bsdf,
-                const void*                 bsdf_data,
+                const BSDFSampler&          bsdf_sampler,
                 const int                   scattering_modes,
                 DirectShadingComponents&    vertex_radiance,
                 LightPathStream*            light_path_stream)
@@ -767,12 +967,6 @@ namespace
                 if (light_sample_count == 0)
                     return;
 
-                const BSDFSampler bsdf_sampler(
-                    bsdf,
-                    bsdf_data,
-                    scattering_modes,       // bsdf_sampling_modes (unused)
-                    shading_point);
-
                 // This path will be extended via BSDF sampling: sample the lights only.
                 const DirectLightingIntegrator integrator(
                     m_shading_context,
@@ -783,7 +977,8 @@ namespace
                     1,                      // material_sample_count
                     light_sample_count,
                     m_params.m_dl_low_light_threshold,
-                    m_is_indirect_lighting);
+                    m_is_indirect_lighting,
+                    m_params.m_dl_resampling_candidate_count);
                 integrator.compute_outgoing_radiance_light_sampling_low_variance(
                     m_sampling_context,
                     MISPower2,
@@ -802,8 +997,7 @@ namespace
             void add_image_based_lighting_contribution_bsdf(
                 const ShadingPoint&         shading_point,
                 const Dual3d&               outgoing,
-                const BSDF&                 bsdf,
-                const void*                 bsdf_data,
+                const BSDFSampler&          bsdf_sampler,
                 const int                   scattering_modes,
                 DirectShadingComponents&    vertex_radiance,
                 LightPathStream*            light_path_stream)
@@ -815,12 +1009,6 @@ namespace
                         m_sampling_context,
                         m_params.m_ibl_env_sample_count);
 
-                const BSDFSampler bsdf_sampler(
-                    bsdf,
-                    bsdf_data,
-                    scattering_modes,       // bsdf_sampling_modes (unused)
-                    shading_point);
-
                 // This path will be extended via BSDF sampling: sample the environment only.
                 compute_ibl_environment_sampling(
                     m_sampling_context,
@@ -1166,6 +1354,14 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Low Light Threshold")
             .insert("help", "Light contribution threshold to disable shadow rays"));
 
+    metadata.dictionaries().insert(
+        "dl_resampling_candidates",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Resampling Candidates")
+            .insert("help", "Number of candidate light samples among which each light sample is chosen according to its unshadowed contribution (0 or 1 to disable)"));
+
     metadata.dictionaries().insert(
         "ibl_env_samples",
         Dictionary()
@@ -1218,15 +1414,109 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Record Light Paths")
             .insert("help", "Record light paths in memory to later allow visualizing them or saving them to disk"));
 
+    metadata.dictionaries().insert(
+        "enable_path_guiding",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Path Guiding")
+            .insert("help", "Learn the distribution of incident light during the first rendering passes and use it to guide paths"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_training_passes",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "4")
+            .insert("min", "1")
+            .insert("label", "Path Guiding Training Passes")
+            .insert("help", "Number of rendering passes during which the distribution of incident light is learned"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_spatial_threshold",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "12000")
+            .insert("min", "1")
+            .insert("label", "Path Guiding Spatial Threshold")
+            .insert("help", "Number of samples recorded in a region of space during a training pass above which that region is subdivided"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_bsdf_sampling_fraction",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.5")
+            .insert("min", "0.01")
+            .insert("max", "1.0")
+            .insert("label", "Path Guiding BSDF Sampling Fraction")
+            .insert("help", "Probability of sampling the BSDF rather than the learned distribution of incident light"));
+
+    metadata.dictionaries().insert(
+        "enable_caustic_cache",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Caustic Cache")
+            .insert("help", "Estimate caustics from a photon map rebuilt before each rendering pass instead of tracing them from the camera"));
+
+    metadata.dictionaries().insert(
+        "caustic_cache_light_photons",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1000000")
+            .insert("min", "0")
+            .insert("label", "Caustic Cache Light Photons")
+            .insert("help", "Number of photons emitted from lights per rendering pass"));
+
+    metadata.dictionaries().insert(
+        "caustic_cache_env_photons",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1000000")
+            .insert("min", "0")
+            .insert("label", "Caustic Cache Environment Photons")
+            .insert("help", "Number of photons emitted from the environment per rendering pass"));
+
+    metadata.dictionaries().insert(
+        "caustic_cache_lookup_radius",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.1")
+            .insert("unit", "percent")
+            .insert("min", "0.0")
+            .insert("max", "100.0")
+            .insert("label", "Caustic Cache Lookup Radius")
+            .insert("help", "Initial photon lookup radius (in percents of the scene diameter)"));
+
+    metadata.dictionaries().insert(
+        "caustic_cache_alpha",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.7")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "Caustic Cache Alpha")
+            .insert("help", "Rate at which the photon lookup radius shrinks from pass to pass"));
+
+    metadata.dictionaries().insert(
+        "caustic_cache_photon_map_type",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "kdtree|hashgrid")
+            .insert("default", "hashgrid")
+            .insert("label", "Caustic Cache Photon Map Type")
+            .insert("help", "Spatial data structure used to store and look up caustic photons"));
+
     return metadata;
 }
 
 PTLightingEngineFactory::PTLightingEngineFactory(
     const BackwardLightSampler&     light_sampler,
     LightPathRecorder&              light_path_recorder,
+    PTPassCallback*                 pass_callback,
     const ParamArray&               params)
   : m_light_sampler(light_sampler)
   , m_light_path_recorder(light_path_recorder)
+  , m_pass_callback(pass_callback)
   , m_params(params)
 {
 }
@@ -1242,6 +1532,7 @@ ILightingEngine* PTLightingEngineFactory::create()
         new PTLightingEngine(
             m_light_sampler,
             m_light_path_recorder,
+            m_pass_callback,
             m_params);
 }
 
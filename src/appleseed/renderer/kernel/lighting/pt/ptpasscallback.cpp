@@ -0,0 +1,158 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "ptpasscallback.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+namespace
+{
+    // Fraction of the total energy above which a quadrant of a directional tree is subdivided.
+    const float DirectionalSubdivisionThreshold = 0.01f;
+
+    // Maximum depth of the directional trees.
+    const std::size_t MaxDirectionalDepth = 20;
+}
+
+
+//
+// PTPassCallback class implementation.
+//
+
+PTPassCallback::PTPassCallback(
+    const Scene&                        scene,
+    const ForwardLightSampler*          light_sampler,
+    const TraceContext&                 trace_context,
+    TextureStore&                       texture_store,
+    OIIOTextureSystem&                  oiio_texture_system,
+    OSLShadingSystem&                   shading_system,
+    const ParamArray&                   params)
+  : m_scene(scene)
+  , m_enable_path_guiding(params.get_optional<bool>("enable_path_guiding", false))
+  , m_training_pass_count(params.get_optional<std::size_t>("path_guiding_training_passes", 4))
+  , m_spatial_threshold(params.get_optional<std::size_t>("path_guiding_spatial_threshold", 12000))
+  , m_pass_number(0)
+{
+    if (params.get_optional<bool>("enable_caustic_cache", false))
+    {
+        assert(light_sampler != nullptr);
+
+        m_caustic_cache.reset(
+            new PTCausticCache(
+                scene,
+                *light_sampler,
+                trace_context,
+                texture_store,
+                oiio_texture_system,
+                shading_system,
+                params));
+    }
+}
+
+void PTPassCallback::release()
+{
+    delete this;
+}
+
+void PTPassCallback::on_pass_begin(
+    const Frame&                        frame,
+    JobQueue&                           job_queue,
+    IAbortSwitch&                       abort_switch)
+{
+    if (m_enable_path_guiding)
+    {
+        // The scene bounding box is only known once rendering has started.
+        if (!m_sd_tree)
+            m_sd_tree.reset(new STree(AABB3f(m_scene.get_render_data().m_bbox)));
+
+        if (m_pass_number < m_training_pass_count)
+        {
+            RENDERER_LOG_INFO(
+                "pass #%s is a path guiding training pass.",
+                pretty_uint(m_pass_number + 1).c_str());
+        }
+    }
+
+    // Trace a new set of caustic photons for this pass.
+    if (m_caustic_cache)
+        m_caustic_cache->rebuild(frame, m_pass_number, job_queue, abort_switch);
+}
+
+void PTPassCallback::on_pass_end(
+    const Frame&                        frame,
+    JobQueue&                           job_queue,
+    IAbortSwitch&                       abort_switch)
+{
+    if (m_sd_tree && m_pass_number < m_training_pass_count && !abort_switch.is_aborted())
+    {
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        m_sd_tree->refine(
+            m_spatial_threshold,
+            DirectionalSubdivisionThreshold,
+            MaxDirectionalDepth,
+            job_queue);
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "refined path guiding sd-tree in %s: %s spatial %s, %s directional %s.",
+            pretty_time(stopwatch.get_seconds()).c_str(),
+            pretty_uint(m_sd_tree->get_leaf_count()).c_str(),
+            m_sd_tree->get_leaf_count() > 1 ? "leaves" : "leaf",
+            pretty_uint(m_sd_tree->get_dtree_node_count()).c_str(),
+            m_sd_tree->get_dtree_node_count() > 1 ? "nodes" : "node");
+    }
+
+    // Gather caustic photons within a smaller radius in the next pass.
+    if (m_caustic_cache)
+        m_caustic_cache->shrink_lookup_radius(m_pass_number);
+
+    ++m_pass_number;
+}
+
+}   // namespace renderer
@@ -0,0 +1,149 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/pt/ptcausticcache.h"
+#include "renderer/kernel/lighting/sdtree.h"
+#include "renderer/kernel/rendering/ipasscallback.h"
+#include "renderer/utility/paramarray.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class ForwardLightSampler; }
+namespace renderer      { class Frame; }
+namespace renderer      { class OIIOTextureSystem; }
+namespace renderer      { class OSLShadingSystem; }
+namespace renderer      { class Scene; }
+namespace renderer      { class TextureStore; }
+namespace renderer      { class TraceContext; }
+
+namespace renderer
+{
+
+//
+// This class is responsible for preparing the path tracer's auxiliary data between passes:
+//
+//   - Training the path guiding SD-tree: the first passes record incident radiance into
+//     the tree, which is refined at the end of each of these passes. Later passes only
+//     sample the last learned distributions.
+//
+//   - Rebuilding the caustic photon cache at the beginning of each pass.
+//
+
+class PTPassCallback
+  : public IPassCallback
+{
+  public:
+    // Constructor. `light_sampler` is only required if the caustic cache is enabled.
+    PTPassCallback(
+        const Scene&                        scene,
+        const ForwardLightSampler*          light_sampler,
+        const TraceContext&                 trace_context,
+        TextureStore&                       texture_store,
+        OIIOTextureSystem&                  oiio_texture_system,
+        OSLShadingSystem&                   shading_system,
+        const ParamArray&                   params);
+
+    // Delete this instance.
+    void release() override;
+
+    // This method is called at the beginning of a pass.
+    void on_pass_begin(
+        const Frame&                        frame,
+        foundation::JobQueue&               job_queue,
+        foundation::IAbortSwitch&           abort_switch) override;
+
+    // This method is called at the end of a pass.
+    void on_pass_end(
+        const Frame&                        frame,
+        foundation::JobQueue&               job_queue,
+        foundation::IAbortSwitch&           abort_switch) override;
+
+    // Return the SD-tree to sample, or nullptr if no distribution was learned yet.
+    const STree* get_sampling_sd_tree() const;
+
+    // Return the SD-tree to record incident radiance into, or nullptr if training is over.
+    STree* get_training_sd_tree() const;
+
+    // Return true if path guiding is enabled.
+    bool is_path_guiding_enabled() const;
+
+    // Return true if the caustic cache is enabled.
+    bool has_caustic_cache() const;
+
+    // Return the caustic cache, or nullptr if it is disabled or empty.
+    const PTCausticCache* get_caustic_cache() const;
+
+  private:
+    const Scene&                            m_scene;
+    const bool                              m_enable_path_guiding;
+    const std::size_t                       m_training_pass_count;
+    const std::size_t                       m_spatial_threshold;
+    std::unique_ptr<STree>                  m_sd_tree;
+    std::unique_ptr<PTCausticCache>         m_caustic_cache;
+    std::size_t                             m_pass_number;
+};
+
+
+//
+// PTPassCallback class implementation.
+//
+
+inline const STree* PTPassCallback::get_sampling_sd_tree() const
+{
+    return m_pass_number > 0 ? m_sd_tree.get() : nullptr;
+}
+
+inline STree* PTPassCallback::get_training_sd_tree() const
+{
+    return m_pass_number < m_training_pass_count ? m_sd_tree.get() : nullptr;
+}
+
+inline bool PTPassCallback::is_path_guiding_enabled() const
+{
+    return m_enable_path_guiding;
+}
+
+inline bool PTPassCallback::has_caustic_cache() const
+{
+    return m_caustic_cache != nullptr;
+}
+
+inline const PTCausticCache* PTPassCallback::get_caustic_cache() const
+{
+    return m_caustic_cache && !m_caustic_cache->empty() ? m_caustic_cache.get() : nullptr;
+}
+
+}   // namespace renderer
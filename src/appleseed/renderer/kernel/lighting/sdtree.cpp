@@ -0,0 +1,427 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/fp.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobqueue.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+namespace
+{
+    // Largest float strictly smaller than 1.
+    const float OneMinusEpsilon = 0.99999994f;
+
+    // Map a unit-length direction to the unit square using the equal-area cylindrical mapping.
+    Vector2f direction_to_square(const Vector3f& direction)
+    {
+        const float cos_theta = clamp(direction[2], -1.0f, 1.0f);
+
+        float phi = std::atan2(direction[1], direction[0]);
+        if (phi < 0.0f)
+            phi += TwoPi<float>();
+
+        return
+            Vector2f(
+                saturate(0.5f * (cos_theta + 1.0f)),
+                saturate(phi * RcpTwoPi<float>()));
+    }
+
+    // Inverse of direction_to_square().
+    Vector3f square_to_direction(const Vector2f& p)
+    {
+        const float cos_theta = 2.0f * p[0] - 1.0f;
+        const float sin_theta = std::sqrt(std::max(1.0f - cos_theta * cos_theta, 0.0f));
+        const float phi = TwoPi<float>() * p[1];
+
+        return
+            Vector3f(
+                sin_theta * std::cos(phi),
+                sin_theta * std::sin(phi),
+                cos_theta);
+    }
+
+    // Return the quadrant containing a point of the unit square and
+    // remap the point to the unit square of that quadrant.
+    size_t select_quadrant(Vector2f& p)
+    {
+        const size_t x = p[0] < 0.5f ? 0 : 1;
+        const size_t y = p[1] < 0.5f ? 0 : 1;
+
+        p[0] = 2.0f * p[0] - static_cast<float>(x);
+        p[1] = 2.0f * p[1] - static_cast<float>(y);
+
+        return x + 2 * y;
+    }
+
+    // Choose one of two events with probability proportional to their weights
+    // and remap the sample to [0,1). Return 0 for the first event, 1 for the second.
+    size_t choose_and_remap(
+        const float a,
+        const float b,
+        float&      s)
+    {
+        const float p = a / (a + b);
+
+        if (s < p)
+        {
+            s = std::min(s / p, OneMinusEpsilon);
+            return 0;
+        }
+        else
+        {
+            s = std::min((s - p) / (1.0f - p), OneMinusEpsilon);
+            return 1;
+        }
+    }
+}
+
+
+//
+// DTree class implementation.
+//
+
+DTree::DTree()
+  : m_nodes(1)
+{
+}
+
+void DTree::record(
+    const Vector3f&     direction,
+    const float         value)
+{
+    if (!(value > 0.0f) || !FP<float>::is_finite(value))
+        return;
+
+    Vector2f p = direction_to_square(direction);
+    size_t node_index = 0;
+
+    while (true)
+    {
+        Node& node = m_nodes[node_index];
+        const size_t quadrant = select_quadrant(p);
+
+        atomic_add(&node.m_sum[quadrant], value);
+
+        if (node.m_child[quadrant] == 0)
+            break;
+
+        node_index = node.m_child[quadrant];
+    }
+}
+
+float DTree::evaluate_pdf(const Vector3f& direction) const
+{
+    Vector2f p = direction_to_square(direction);
+    size_t node_index = 0;
+    float pdf = RcpFourPi<float>();
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+        const float total = node.m_sum[0] + node.m_sum[1] + node.m_sum[2] + node.m_sum[3];
+
+        if (total <= 0.0f)
+            return 0.0f;
+
+        const size_t quadrant = select_quadrant(p);
+        pdf *= 4.0f * node.m_sum[quadrant] / total;
+
+        if (node.m_child[quadrant] == 0)
+            return pdf;
+
+        node_index = node.m_child[quadrant];
+    }
+}
+
+Vector3f DTree::sample(
+    const Vector2f&     s,
+    float&              pdf) const
+{
+    assert(get_total() > 0.0f);
+
+    Vector2f u(std::min(s[0], OneMinusEpsilon), std::min(s[1], OneMinusEpsilon));
+    Vector2f origin(0.0f);
+    float size = 1.0f;
+    size_t node_index = 0;
+    pdf = RcpFourPi<float>();
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+        const float total = node.m_sum[0] + node.m_sum[1] + node.m_sum[2] + node.m_sum[3];
+
+        // Choose the left or right half, then the bottom or top quadrant of that half.
+        const size_t x = choose_and_remap(node.m_sum[0] + node.m_sum[2], node.m_sum[1] + node.m_sum[3], u[0]);
+        const size_t y = choose_and_remap(node.m_sum[x], node.m_sum[x + 2], u[1]);
+        const size_t quadrant = x + 2 * y;
+
+        pdf *= 4.0f * node.m_sum[quadrant] / total;
+
+        size *= 0.5f;
+        origin[0] += size * static_cast<float>(x);
+        origin[1] += size * static_cast<float>(y);
+
+        if (node.m_child[quadrant] == 0)
+            break;
+
+        node_index = node.m_child[quadrant];
+    }
+
+    return square_to_direction(origin + size * u);
+}
+
+void DTree::refine(
+    const DTree&        distribution,
+    const float         subdivision_threshold,
+    const size_t        max_depth)
+{
+    const float total = distribution.get_total();
+
+    std::vector<Node> nodes(1);
+
+    if (total > 0.0f)
+    {
+        const std::uint32_t NoSource = ~std::uint32_t(0);
+
+        struct Entry
+        {
+            std::uint32_t   m_node;
+            std::uint32_t   m_source;       // matching node in the distribution, NoSource if none
+            float           m_energy;
+            size_t          m_depth;
+        };
+
+        std::vector<Entry> stack;
+        stack.push_back(Entry{ 0, 0, total, 1 });
+
+        while (!stack.empty())
+        {
+            const Entry entry = stack.back();
+            stack.pop_back();
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                // Quadrants without a counterpart in the distribution get an equal share of their parent's energy.
+                const Node* source = entry.m_source != NoSource ? &distribution.m_nodes[entry.m_source] : nullptr;
+                const float energy = source ? source->m_sum[i] : 0.25f * entry.m_energy;
+
+                if (entry.m_depth < max_depth && energy > subdivision_threshold * total)
+                {
+                    const std::uint32_t child = static_cast<std::uint32_t>(nodes.size());
+                    nodes.emplace_back();
+                    nodes[entry.m_node].m_child[i] = child;
+
+                    const std::uint32_t source_child =
+                        source && source->m_child[i] != 0 ? source->m_child[i] : NoSource;
+
+                    stack.push_back(Entry{ child, source_child, energy, entry.m_depth + 1 });
+                }
+            }
+        }
+    }
+    else
+    {
+        // Nothing was learned: keep the structure of the distribution.
+        nodes = distribution.m_nodes;
+
+        for (Node& node : nodes)
+        {
+            for (size_t i = 0; i < 4; ++i)
+                node.m_sum[i] = 0.0f;
+        }
+    }
+
+    m_nodes.swap(nodes);
+}
+
+
+//
+// STree class implementation.
+//
+
+namespace
+{
+    class DTreeRefinementJob
+      : public IJob
+    {
+      public:
+        DTreeRefinementJob(
+            std::vector<STree::Leaf>&   leaves,
+            const size_t                begin,
+            const size_t                end,
+            const float                 subdivision_threshold,
+            const size_t                max_depth)
+          : m_leaves(leaves)
+          , m_begin(begin)
+          , m_end(end)
+          , m_subdivision_threshold(subdivision_threshold)
+          , m_max_depth(max_depth)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            for (size_t i = m_begin; i < m_end; ++i)
+            {
+                STree::Leaf& leaf = m_leaves[i];
+                leaf.m_building.refine(leaf.m_sampling, m_subdivision_threshold, m_max_depth);
+                leaf.m_sample_count = 0;
+            }
+        }
+
+      private:
+        std::vector<STree::Leaf>&       m_leaves;
+        const size_t                    m_begin;
+        const size_t                    m_end;
+        const float                     m_subdivision_threshold;
+        const size_t                    m_max_depth;
+    };
+}
+
+STree::STree(const AABB3f& bbox)
+{
+    // Enclose the bounding box in a slightly larger cube so that alternating splits produce cubic cells.
+    float size = bbox.is_valid() ? max_value(bbox.extent()) * 1.001f : 0.0f;
+    if (!(size > 0.0f))
+        size = 1.0f;
+
+    m_origin = (bbox.is_valid() ? bbox.center() : Vector3f(0.0f)) - Vector3f(0.5f * size);
+    m_rcp_size = 1.0f / size;
+
+    Node root;
+    root.m_child[0] = root.m_child[1] = 0;
+    root.m_leaf_index = 0;
+    root.m_axis = 0;
+    m_nodes.push_back(root);
+
+    m_leaves.emplace_back();
+}
+
+void STree::record(
+    const Vector3f&     point,
+    const Vector3f&     direction,
+    const float         value)
+{
+    Leaf& leaf = find_leaf(point);
+
+    atomic_inc(&leaf.m_sample_count);
+    leaf.m_building.record(direction, value);
+}
+
+void STree::refine(
+    const size_t        spatial_threshold,
+    const float         directional_threshold,
+    const size_t        max_directional_depth,
+    JobQueue&           job_queue)
+{
+    // The distributions recorded during this iteration are used for sampling during the next one.
+    for (Leaf& leaf : m_leaves)
+        leaf.m_sampling = leaf.m_building;
+
+    // Split the leaves that received too many samples. Only visit the nodes that existed before.
+    const std::uint32_t node_count = static_cast<std::uint32_t>(m_nodes.size());
+    for (std::uint32_t i = 0; i < node_count; ++i)
+    {
+        if (m_nodes[i].m_child[0] == 0)
+            split(i, spatial_threshold);
+    }
+
+    // Refine the directional trees in parallel.
+    const size_t LeavesPerJob = 64;
+    for (size_t begin = 0; begin < m_leaves.size(); begin += LeavesPerJob)
+    {
+        job_queue.schedule(
+            new DTreeRefinementJob(
+                m_leaves,
+                begin,
+                std::min(begin + LeavesPerJob, m_leaves.size()),
+                directional_threshold,
+                max_directional_depth));
+    }
+
+    job_queue.wait_until_completion();
+}
+
+size_t STree::get_dtree_node_count() const
+{
+    size_t count = 0;
+
+    for (const Leaf& leaf : m_leaves)
+        count += leaf.m_building.get_node_count();
+
+    return count;
+}
+
+void STree::split(
+    const std::uint32_t node_index,
+    const size_t        spatial_threshold)
+{
+    const std::uint32_t leaf_index = m_nodes[node_index].m_leaf_index;
+
+    if (m_leaves[leaf_index].m_sample_count <= spatial_threshold)
+        return;
+
+    // Both children inherit the distributions of the parent and half of its samples.
+    m_leaves[leaf_index].m_sample_count /= 2;
+    const Leaf leaf = m_leaves[leaf_index];
+    const std::uint32_t new_leaf_index = static_cast<std::uint32_t>(m_leaves.size());
+    m_leaves.push_back(leaf);
+
+    Node child;
+    child.m_child[0] = child.m_child[1] = 0;
+    child.m_axis = (m_nodes[node_index].m_axis + 1) % 3;
+
+    const std::uint32_t first_child = static_cast<std::uint32_t>(m_nodes.size());
+    child.m_leaf_index = leaf_index;
+    m_nodes.push_back(child);
+    child.m_leaf_index = new_leaf_index;
+    m_nodes.push_back(child);
+
+    m_nodes[node_index].m_child[0] = first_child;
+    m_nodes[node_index].m_child[1] = first_child + 1;
+
+    split(first_child, spatial_threshold);
+    split(first_child + 1, spatial_threshold);
+}
+
+}   // namespace renderer
@@ -0,0 +1,255 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class JobQueue; }
+
+namespace renderer
+{
+
+//
+// Spatio-directional tree (SD-tree) used to guide paths toward the directions
+// carrying most of the incident radiance.
+//
+// A binary tree subdivides space, and each of its leaves holds a quadtree over
+// the sphere of directions. Directions are mapped to the unit square with the
+// equal-area cylindrical mapping so that the quadtree density is proportional
+// to the density with respect to solid angle.
+//
+// Radiance estimates are recorded concurrently into the "building" quadtrees
+// while the previous iteration's "sampling" quadtrees are used read-only. The
+// tree must only be refined while no rendering is in progress.
+//
+// Reference:
+//
+//   Practical Path Guiding for Efficient Light-Transport Simulation
+//   Thomas Müller, Markus Gross, Jan Novák
+//   https://tom94.net/data/publications/mueller17practical/mueller17practical.pdf
+//
+
+class DTree
+{
+  public:
+    // Constructor, builds a single node with no energy.
+    DTree();
+
+    // Record an estimate of the incident radiance from a given direction, divided by the
+    // probability density with which that direction was sampled. Thread-safe.
+    void record(
+        const foundation::Vector3f&     direction,          // world space direction, unit-length
+        const float                     value);
+
+    // Return the total energy stored in the tree.
+    float get_total() const;
+
+    // Return the number of nodes in the tree.
+    size_t get_node_count() const;
+
+    // Return the probability density of a given direction with respect to solid angle.
+    float evaluate_pdf(const foundation::Vector3f& direction) const;
+
+    // Sample a direction proportionally to the stored energy. Must not be called if get_total() is 0.
+    foundation::Vector3f sample(
+        const foundation::Vector2f&     s,
+        float&                          pdf) const;
+
+    // Rebuild the structure of this tree from the energy distribution of another tree,
+    // subdividing the quadrants holding more than a given fraction of the total energy.
+    // The energy of this tree is reset.
+    void refine(
+        const DTree&                    distribution,
+        const float                     subdivision_threshold,
+        const size_t                    max_depth);
+
+  private:
+    struct Node
+    {
+        float           m_sum[4];           // energy of each quadrant
+        std::uint32_t   m_child[4];         // child index of each quadrant, 0 for leaves
+
+        Node();
+    };
+
+    std::vector<Node>   m_nodes;
+};
+
+class STree
+{
+  public:
+    struct Leaf
+    {
+        DTree           m_building;         // distribution being recorded during the current iteration
+        DTree           m_sampling;         // distribution learned during the previous iteration
+        std::uint32_t   m_sample_count;     // number of samples recorded during the current iteration
+
+        Leaf();
+    };
+
+    // Constructor, builds a single leaf over a cube enclosing a given bounding box.
+    explicit STree(const foundation::AABB3f& bbox);
+
+    // Return the leaf containing a given point.
+    Leaf& find_leaf(const foundation::Vector3f& point);
+    const Leaf& find_leaf(const foundation::Vector3f& point) const;
+
+    // Return the sampling distribution at a given point.
+    const DTree& get_sampling_dtree(const foundation::Vector3f& point) const;
+
+    // Record an estimate of the incident radiance at a given point from a given direction,
+    // divided by the probability density with which that direction was sampled. Thread-safe.
+    void record(
+        const foundation::Vector3f&     point,
+        const foundation::Vector3f&     direction,          // world space direction, unit-length
+        const float                     value);
+
+    // End the current iteration: make the recorded distributions the sampling distributions,
+    // split the leaves that received more than a given number of samples and refine the
+    // structure of the directional trees. Not thread-safe.
+    void refine(
+        const size_t                    spatial_threshold,
+        const float                     directional_threshold,
+        const size_t                    max_directional_depth,
+        foundation::JobQueue&           job_queue);
+
+    // Return the number of nodes and leaves of the spatial tree.
+    size_t get_node_count() const;
+    size_t get_leaf_count() const;
+
+    // Return the total number of nodes of all directional trees.
+    size_t get_dtree_node_count() const;
+
+  private:
+    struct Node
+    {
+        std::uint32_t   m_child[2];         // child indices, 0 for leaves
+        std::uint32_t   m_leaf_index;       // index of the leaf if this node is a leaf
+        std::uint32_t   m_axis;             // splitting axis
+    };
+
+    foundation::Vector3f    m_origin;
+    float                   m_rcp_size;
+    std::vector<Node>       m_nodes;
+    std::vector<Leaf>       m_leaves;
+
+    void split(
+        const std::uint32_t             node_index,
+        const size_t                    spatial_threshold);
+};
+
+
+//
+// DTree class implementation.
+//
+
+inline DTree::Node::Node()
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m_sum[i] = 0.0f;
+        m_child[i] = 0;
+    }
+}
+
+inline float DTree::get_total() const
+{
+    const Node& root = m_nodes[0];
+    return root.m_sum[0] + root.m_sum[1] + root.m_sum[2] + root.m_sum[3];
+}
+
+inline size_t DTree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+
+//
+// STree class implementation.
+//
+
+inline STree::Leaf::Leaf()
+  : m_sample_count(0)
+{
+}
+
+inline STree::Leaf& STree::find_leaf(const foundation::Vector3f& point)
+{
+    return const_cast<Leaf&>(const_cast<const STree*>(this)->find_leaf(point));
+}
+
+inline const STree::Leaf& STree::find_leaf(const foundation::Vector3f& point) const
+{
+    foundation::Vector3f p = (point - m_origin) * m_rcp_size;
+
+    const Node* node = &m_nodes[0];
+
+    while (node->m_child[0] != 0)
+    {
+        float& x = p[node->m_axis];
+
+        if (x < 0.5f)
+        {
+            x = 2.0f * x;
+            node = &m_nodes[node->m_child[0]];
+        }
+        else
+        {
+            x = 2.0f * x - 1.0f;
+            node = &m_nodes[node->m_child[1]];
+        }
+    }
+
+    return m_leaves[node->m_leaf_index];
+}
+
+inline const DTree& STree::get_sampling_dtree(const foundation::Vector3f& point) const
+{
+    return find_leaf(point).m_sampling;
+}
+
+inline size_t STree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+inline size_t STree::get_leaf_count() const
+{
+    return m_leaves.size();
+}
+
+}   // namespace renderer
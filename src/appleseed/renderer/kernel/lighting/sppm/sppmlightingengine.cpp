@@ -55,6 +55,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/containers/dictionary.h"
+#include "foundation/math/densityestimation.h"
 #include "foundation/math/knn.h"
 #include "foundation/math/population.h"
 #include "foundation/math/scalar.h"
@@ -80,25 +81,35 @@ namespace renderer
 namespace
 {
     //
-    // 2D density estimation kernels.
-    //
-    // References:
-    //
-    //   http://en.wikipedia.org/wiki/Kernel_(statistics)
-    //
-    //   http://graphics.cs.kuleuven.be/publications/phdSuykens/suykens_8.pdf p. 154
+    // Photon map lookup, counted and timed for per-pass statistics.
     //
 
-    template <typename T>
-    inline T box2d(const T r2)
+    inline void find_photons(
+        const SPPMPhotonMap&            photon_map,
+        const Vector3f&                 point,
+        const float                     max_square_dist,
+        knn::Answer<float>&             answer,
+        SPPMLightingEngineWorkingSet&   working_set)
     {
-        return foundation::RcpPi<T>();
+        const std::uint64_t start = working_set.m_photon_lookup_timer.read_start();
+        photon_map.find_nearest(point, max_square_dist, answer);
+        working_set.m_photon_lookup_ticks += working_set.m_photon_lookup_timer.read_end() - start;
+        ++working_set.m_photon_lookup_count;
     }
 
-    template <typename T>
-    inline T epanechnikov2d(const T r2)
+    // The time of a gather lookup includes the time spent in the visitor.
+    template <typename Visitor>
+    inline void gather_photons(
+        const SPPMPhotonMap&            photon_map,
+        const Vector3f&                 point,
+        const float                     max_square_dist,
+        Visitor&                        visitor,
+        SPPMLightingEngineWorkingSet&   working_set)
     {
-        return foundation::RcpHalfPi<T>() * (T(1.0) - r2);
+        const std::uint64_t start = working_set.m_photon_lookup_timer.read_start();
+        photon_map.gather(point, max_square_dist, visitor);
+        working_set.m_photon_lookup_ticks += working_set.m_photon_lookup_timer.read_end() - start;
+        ++working_set.m_photon_lookup_count;
     }
 
 
@@ -469,46 +480,61 @@ namespace
                 const Vector3f point(vertex.get_point());
                 const float radius = m_pass_callback.get_photon_lookup_radius();
 
-                // Find the nearby photons around the path vertex.
-                const knn::Query3f query(photon_map, m_answer);
-                query.run(point, radius * radius);
-                const std::size_t photon_count = m_answer.size();
+                Spectrum indirect_radiance(Spectrum::Illuminance);
+                indirect_radiance.set(0.0f);
 
-                // Compute the square radius of the lookup disk.
-                float max_square_dist;
-                if (photon_count < m_params.m_max_photons_per_estimate)
-                    max_square_dist = radius * radius;
-                else
-                {
-                    max_square_dist = 0.0f;
-                    for (std::size_t i = 0; i < photon_count; ++i)
-                    {
-                        const float square_dist = m_answer.get(i).m_square_dist;
-                        if (max_square_dist < square_dist)
-                            max_square_dist = square_dist;
-                    }
-                }
-                const float rcp_max_square_dist = 1.0f / max_square_dist;
+                float rcp_max_square_dist;
 
-                // Accumulate photons contributions.
-                Spectrum indirect_radiance(Spectrum::Illuminance);
-                if (m_params.m_photon_type == SPPMParameters::Monochromatic)
+                if (m_params.m_max_photons_per_estimate == 0)
                 {
-                    indirect_radiance.set(0.0f);
-                    accumulate_mono_photons(
+                    // Gather all the photons within the lookup disk and accumulate their contributions in the same pass.
+                    rcp_max_square_dist = 1.0f / (radius * radius);
+                    gather_photon_contributions(
                         vertex,
-                        photon_count,
+                        point,
+                        radius * radius,
                         rcp_max_square_dist,
                         indirect_radiance);
                 }
                 else
                 {
-                    indirect_radiance.set(0.0f);
-                    accumulate_poly_photons(
-                        vertex,
-                        photon_count,
-                        rcp_max_square_dist,
-                        indirect_radiance);
+                    // Find the nearby photons around the path vertex.
+                    find_photons(photon_map, point, radius * radius, m_answer, m_working_set);
+                    const std::size_t photon_count = m_answer.size();
+
+                    // Compute the square radius of the lookup disk.
+                    float max_square_dist;
+                    if (photon_count < m_params.m_max_photons_per_estimate)
+                        max_square_dist = radius * radius;
+                    else
+                    {
+                        max_square_dist = 0.0f;
+                        for (std::size_t i = 0; i < photon_count; ++i)
+                        {
+                            const float square_dist = m_answer.get(i).m_square_dist;
+                            if (max_square_dist < square_dist)
+                                max_square_dist = square_dist;
+                        }
+                    }
+                    rcp_max_square_dist = 1.0f / max_square_dist;
+
+                    // Accumulate photons contributions.
+                    if (m_params.m_photon_type == SPPMParameters::Monochromatic)
+                    {
+                        accumulate_mono_photons(
+                            vertex,
+                            photon_count,
+                            rcp_max_square_dist,
+                            indirect_radiance);
+                    }
+                    else
+                    {
+                        accumulate_poly_photons(
+                            vertex,
+                            photon_count,
+                            rcp_max_square_dist,
+                            indirect_radiance);
+                    }
                 }
 
                 // Estimate photon density.
@@ -519,6 +545,48 @@ namespace
                 vertex_radiance.m_beauty += indirect_radiance;
             }
 
+            void gather_photon_contributions(
+                const PathVertex&               vertex,
+                const Vector3f&                 point,
+                const float                     max_square_dist,
+                const float                     rcp_max_square_dist,
+                Spectrum&                       radiance)
+            {
+                const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
+                const Vector3f normal(vertex.get_geometric_normal());
+
+                if (m_params.m_photon_type == SPPMParameters::Monochromatic)
+                {
+                    auto visitor = [&](const std::size_t i, const float square_dist)
+                    {
+                        accumulate_mono_photon(
+                            vertex,
+                            normal,
+                            m_pass_callback.get_mono_photon(photon_map.remap(i)),
+                            square_dist,
+                            rcp_max_square_dist,
+                            radiance);
+                    };
+
+                    gather_photons(photon_map, point, max_square_dist, visitor, m_working_set);
+                }
+                else
+                {
+                    auto visitor = [&](const std::size_t i, const float square_dist)
+                    {
+                        accumulate_poly_photon(
+                            vertex,
+                            normal,
+                            m_pass_callback.get_poly_photon(photon_map.remap(i)),
+                            square_dist,
+                            rcp_max_square_dist,
+                            radiance);
+                    };
+
+                    gather_photons(photon_map, point, max_square_dist, visitor, m_working_set);
+                }
+            }
+
             void accumulate_mono_photons(
                 const PathVertex&               vertex,
                 const std::size_t               photon_count,
@@ -536,61 +604,13 @@ namespace
                         m_pass_callback.get_mono_photon(
                             photon_map.remap(entry.m_index));
 
-                    // Reject photons from the opposite hemisphere as they won't contribute.
-                    if (dot(normal, photon.m_incoming) <= 0.0f)
-                        continue;
-
-                    // Reject photons on a surface with too different an orientation.
-                    const float NormalThreshold = 1.0e-3f;
-                    if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
-                        continue;
-
-#if 0
-                    // Reject photons on the wrong side of the surface.
-                    if (dot(vertex.m_outgoing, Vector3d(photon.m_geometric_normal)) <= 0.0)
-                        continue;
-#endif
-
-#if 0
-                    // Reject photons too far away along the surface's normal.
-                    const Vector3f& photon_position = photon_map.get_point(photon.m_index);
-                    const Vector3f point_to_photon = photon_position - point;
-                    const float vdist = std::abs(dot(normal, point_to_photon));
-                    if (vdist > 0.1f * radius)
-                        continue;
-#endif
-
-                    // Evaluate the BSDF for this photon.
-                    BSDF::LocalGeometry local_geometry;
-                    local_geometry.m_shading_point = vertex.m_shading_point;
-                    local_geometry.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
-                    local_geometry.m_shading_basis = Basis3f(vertex.get_shading_basis());
-                    DirectShadingComponents bsdf_value;
-                    const float bsdf_prob =
-                        vertex.m_bsdf->evaluate(
-                            vertex.m_bsdf_data,
-                            false,                                      // not adjoint
-                            true,                                       // multiply by |cos(incoming, normal)|
-                            local_geometry,
-                            Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
-                            normalize(photon.m_incoming),               // toward the light
-                            ScatteringMode::Diffuse,
-                            bsdf_value);
-                    if (bsdf_prob == 0.0f)
-                        continue;
-
-                    // The photons store flux but we are computing reflected radiance.
-                    // The first step of the flux -> radiance conversion is done here.
-                    // The conversion will be completed when doing density estimation.
-                    float bsdf_mono_value = bsdf_value.m_beauty[photon.m_flux.m_wavelength];
-                    bsdf_mono_value /= std::abs(dot(photon.m_incoming, photon.m_geometric_normal));
-                    bsdf_mono_value *= photon.m_flux.m_amplitude;
-
-                    // Apply kernel weight.
-                    bsdf_mono_value *= epanechnikov2d(entry.m_square_dist * rcp_max_square_dist);
-
-                    // Accumulate reflected flux.
-                    radiance[photon.m_flux.m_wavelength] += bsdf_mono_value;
+                    accumulate_mono_photon(
+                        vertex,
+                        normal,
+                        photon,
+                        entry.m_square_dist,
+                        rcp_max_square_dist,
+                        radiance);
                 }
             }
 
@@ -611,62 +631,114 @@ namespace
                         m_pass_callback.get_poly_photon(
                             photon_map.remap(entry.m_index));
 
-                    // Reject photons from the opposite hemisphere as they won't contribute.
-                    if (dot(normal, photon.m_incoming) <= 0.0f)
-                        continue;
-
-                    // Reject photons on a surface with too different an orientation.
-                    const float NormalThreshold = 1.0e-3f;
-                    if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
-                        continue;
-
-#if 0
-                    // Reject photons on the wrong side of the surface.
-                    if (dot(vertex.m_outgoing, Vector3d(photon.m_geometric_normal)) <= 0.0)
-                        continue;
-#endif
-
-#if 0
-                    // Reject photons too far away along the surface's normal.
-                    const Vector3f& photon_position = photon_map.get_point(photon.m_index);
-                    const Vector3f point_to_photon = photon_position - point;
-                    const float vdist = std::abs(dot(normal, point_to_photon));
-                    if (vdist > 0.1f * radius)
-                        continue;
-#endif
-
-                    // Evaluate the BSDF for this photon.
-                    BSDF::LocalGeometry local_geometry;
-                    local_geometry.m_shading_point = vertex.m_shading_point;
-                    local_geometry.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
-                    local_geometry.m_shading_basis = Basis3f(vertex.get_shading_basis());
-                    DirectShadingComponents bsdf_value;
-                    const float bsdf_prob =
-                        vertex.m_bsdf->evaluate(
-                            vertex.m_bsdf_data,
-                            false,                                      // not adjoint
-                            true,                                       // multiply by |cos(incoming, normal)|
-                            local_geometry,
-                            Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
-                            normalize(photon.m_incoming),               // toward the light
-                            ScatteringMode::Diffuse,
-                            bsdf_value);
-                    if (bsdf_prob == 0.0f)
-                        continue;
-
-                    // The photons store flux but we are computing reflected radiance.
-                    // The first step of the flux -> radiance conversion is done here.
-                    // The conversion will be completed when doing density estimation.
-                    bsdf_value.m_beauty /= std::abs(dot(photon.m_incoming, photon.m_geometric_normal));
-                    bsdf_value.m_beauty *= photon.m_flux;
-
-                    // Apply kernel weight.
-                    bsdf_value.m_beauty *= epanechnikov2d(entry.m_square_dist * rcp_max_square_dist);
-
-                    // Accumulate reflected flux.
-                    radiance += bsdf_value.m_beauty;
+                    accumulate_poly_photon(
+                        vertex,
+                        normal,
+                        photon,
+                        entry.m_square_dist,
+                        rcp_max_square_dist,
+                        radiance);
                 }
             }
+
+            void accumulate_mono_photon(
+                const PathVertex&               vertex,
+                const Vector3f&                 normal,
+                const SPPMMonoPhoton&           photon,
+                const float                     square_dist,
+                const float                     rcp_max_square_dist,
+                Spectrum&                       radiance)
+            {
+                // Reject photons from the opposite hemisphere as they won't contribute.
+                if (dot(normal, photon.m_incoming) <= 0.0f)
+                    return;
+
+                // Reject photons on a surface with too different an orientation.
+                const float NormalThreshold = 1.0e-3f;
+                if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
+                    return;
+
+                // Evaluate the BSDF for this photon.
+                BSDF::LocalGeometry local_geometry;
+                local_geometry.m_shading_point = vertex.m_shading_point;
+                local_geometry.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
+                local_geometry.m_shading_basis = Basis3f(vertex.get_shading_basis());
+                DirectShadingComponents bsdf_value;
+                const float bsdf_prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,                                      // not adjoint
+                        true,                                       // multiply by |cos(incoming, normal)|
+                        local_geometry,
+                        Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
+                        normalize(photon.m_incoming),               // toward the light
+                        ScatteringMode::Diffuse,
+                        bsdf_value);
+                if (bsdf_prob == 0.0f)
+                    return;
+
+                // The photons store flux but we are computing reflected radiance.
+                // The first step of the flux -> radiance conversion is done here.
+                // The conversion will be completed when doing density estimation.
+                float bsdf_mono_value = bsdf_value.m_beauty[photon.m_flux.m_wavelength];
+                bsdf_mono_value /= std::abs(dot(photon.m_incoming, photon.m_geometric_normal));
+                bsdf_mono_value *= photon.m_flux.m_amplitude;
+
+                // Apply kernel weight.
+                bsdf_mono_value *= epanechnikov2d(square_dist * rcp_max_square_dist);
+
+                // Accumulate reflected flux.
+                radiance[photon.m_flux.m_wavelength] += bsdf_mono_value;
+            }
+
+            void accumulate_poly_photon(
+                const PathVertex&               vertex,
+                const Vector3f&                 normal,
+                const SPPMPolyPhoton&           photon,
+                const float                     square_dist,
+                const float                     rcp_max_square_dist,
+                Spectrum&                       radiance)
+            {
+                // Reject photons from the opposite hemisphere as they won't contribute.
+                if (dot(normal, photon.m_incoming) <= 0.0f)
+                    return;
+
+                // Reject photons on a surface with too different an orientation.
+                const float NormalThreshold = 1.0e-3f;
+                if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
+                    return;
+
+                // Evaluate the BSDF for this photon.
+                BSDF::LocalGeometry local_geometry;
+                local_geometry.m_shading_point = vertex.m_shading_point;
+                local_geometry.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
+                local_geometry.m_shading_basis = Basis3f(vertex.get_shading_basis());
+                DirectShadingComponents bsdf_value;
+                const float bsdf_prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,                                      // not adjoint
+                        true,                                       // multiply by |cos(incoming, normal)|
+                        local_geometry,
+                        Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
+                        normalize(photon.m_incoming),               // toward the light
+                        ScatteringMode::Diffuse,
+                        bsdf_value);
+                if (bsdf_prob == 0.0f)
+                    return;
+
+                // The photons store flux but we are computing reflected radiance.
+                // The first step of the flux -> radiance conversion is done here.
+                // The conversion will be completed when doing density estimation.
+                bsdf_value.m_beauty /= std::abs(dot(photon.m_incoming, photon.m_geometric_normal));
+                bsdf_value.m_beauty *= photon.m_flux;
+
+                // Apply kernel weight.
+                bsdf_value.m_beauty *= epanechnikov2d(square_dist * rcp_max_square_dist);
+
+                // Accumulate reflected flux.
+                radiance += bsdf_value.m_beauty;
+            }
         };
 
         // todo: move out of this class.
@@ -692,32 +764,56 @@ namespace
             Spectrum&               radiance)
         {
             const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
-            const knn::Query3f query(photon_map, m_answer);
-
-            query.run(
-                Vector3f(shading_point.get_point()),
-                square(m_params.m_view_photons_radius));
+            const Vector3f point(shading_point.get_point());
+            const float max_square_dist = square(m_params.m_view_photons_radius);
 
             radiance.set(0.0f);
 
-            const std::size_t photon_count = m_answer.size();
-
-            if (m_params.m_photon_type == SPPMParameters::Monochromatic)
+            if (m_params.m_max_photons_per_estimate == 0)
             {
-                for (std::size_t i = 0; i < photon_count; ++i)
+                if (m_params.m_photon_type == SPPMParameters::Monochromatic)
+                {
+                    auto visitor = [&](const std::size_t i, const float square_dist)
+                    {
+                        const SpectrumLine& flux = m_pass_callback.get_mono_photon(photon_map.remap(i)).m_flux;
+                        radiance[flux.m_wavelength] += flux.m_amplitude;
+                    };
+
+                    gather_photons(photon_map, point, max_square_dist, visitor, m_working_set);
+                }
+                else
                 {
-                    const knn::Answer<float>::Entry& photon = m_answer.get(i);
-                    const SpectrumLine& flux =
-                        m_pass_callback.get_mono_photon(photon_map.remap(photon.m_index)).m_flux;
-                    radiance[flux.m_wavelength] += flux.m_amplitude;
+                    auto visitor = [&](const std::size_t i, const float square_dist)
+                    {
+                        radiance += m_pass_callback.get_poly_photon(photon_map.remap(i)).m_flux;
+                    };
+
+                    gather_photons(photon_map, point, max_square_dist, visitor, m_working_set);
                 }
             }
             else
             {
-                for (std::size_t i = 0; i < photon_count; ++i)
+                find_photons(photon_map, point, max_square_dist, m_answer, m_working_set);
+
+                const std::size_t photon_count = m_answer.size();
+
+                if (m_params.m_photon_type == SPPMParameters::Monochromatic)
                 {
-                    const knn::Answer<float>::Entry& photon = m_answer.get(i);
-                    radiance += m_pass_callback.get_poly_photon(photon_map.remap(photon.m_index)).m_flux;
+                    for (std::size_t i = 0; i < photon_count; ++i)
+                    {
+                        const knn::Answer<float>::Entry& photon = m_answer.get(i);
+                        const SpectrumLine& flux =
+                            m_pass_callback.get_mono_photon(photon_map.remap(photon.m_index)).m_flux;
+                        radiance[flux.m_wavelength] += flux.m_amplitude;
+                    }
+                }
+                else
+                {
+                    for (std::size_t i = 0; i < photon_count; ++i)
+                    {
+                        const knn::Answer<float>::Entry& photon = m_answer.get(i);
+                        radiance += m_pass_callback.get_poly_photon(photon_map.remap(photon.m_index)).m_flux;
+                    }
                 }
             }
 
@@ -894,14 +990,36 @@ Dictionary SPPMLightingEngineFactory::get_params_metadata()
             .insert("label", "Initial Photon Lookup Radius")
             .insert("help", "Initial photon lookup radius (in percents of the scene diameter)"));
 
+    metadata.dictionaries().insert(
+        "photon_map_type",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "kdtree|hashgrid")
+            .insert("default", "kdtree")
+            .insert("label", "Photon Map")
+            .insert("help", "Data structure used to look up photons")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "kdtree",
+                        Dictionary()
+                            .insert("label", "K-d Tree")
+                            .insert("help", "Find the nearest photons with a k-d tree"))
+                    .insert(
+                        "hashgrid",
+                        Dictionary()
+                            .insert("label", "Hash Grid")
+                            .insert("help", "Find the photons within the lookup radius with a hashed grid"))));
+
     metadata.dictionaries().insert(
         "max_photons_per_estimate",
         Dictionary()
             .insert("type", "int")
             .insert("default", "100")
-            .insert("min", "1")
+            .insert("min", "0")
             .insert("label", "Max Photons per Estimate")
-            .insert("help", "Maximum number of photons used to estimate radiance"));
+            .insert("help", "Maximum number of photons used to estimate radiance (0 for all the photons within the lookup radius)"));
 
     metadata.dictionaries().insert(
         "alpha",
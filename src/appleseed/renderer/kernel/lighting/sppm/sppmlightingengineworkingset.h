@@ -32,9 +32,12 @@
 #include "renderer/kernel/lighting/sppm/sppmimporton.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/x86timer.h"
 #include "foundation/utility/bitmask.h"
 
 // Standard headers.
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace renderer
@@ -49,6 +52,9 @@ class SPPMLightingEngineWorkingSet
   public:
     std::unique_ptr<foundation::BitMask2>   m_importon_mask;    // record for which pixels an importon has been created and stored
     SPPMImportonVector                      m_importons;        // importons created
+    std::size_t                             m_photon_lookup_count = 0;  // number of photon map lookups in this pass
+    std::uint64_t                           m_photon_lookup_ticks = 0;  // time spent in photon map lookups in this pass, in timer ticks
+    foundation::X86Timer                    m_photon_lookup_timer;      // cheap cycle counter used to time photon map lookups
 };
 
 }   // namespace renderer
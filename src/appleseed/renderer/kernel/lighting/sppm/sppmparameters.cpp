@@ -76,6 +76,23 @@ namespace
                 : SPPMParameters::Polychromatic;
     }
 
+    SPPMParameters::PhotonMapType get_photon_map_type(
+        const ParamArray&   params,
+        const char*         name,
+        const char*         default_value)
+    {
+        const std::string value =
+            params.get_optional<std::string>(
+                name,
+                default_value,
+                make_vector("kdtree", "hashgrid"));
+
+        return
+            value == "kdtree"
+                ? SPPMParameters::KdTree
+                : SPPMParameters::HashGrid;
+    }
+
     SPPMParameters::Mode get_mode(
         const ParamArray&   params,
         const char*         name,
@@ -102,6 +119,7 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   , m_dl_mode(get_mode(params, "dl_mode", "rt"))
   , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
   , m_enable_caustics(params.get_optional<bool>("enable_caustics", true))
+  , m_caustic_photons_only(params.get_optional<bool>("caustic_photons_only", false))
   , m_light_photon_count(params.get_optional<size_t>("light_photons_per_pass", 1000000))
   , m_env_photon_count(params.get_optional<size_t>("env_photons_per_pass", 1000000))
   , m_photon_packet_size(params.get_optional<size_t>("photon_packet_size", 100000))
@@ -118,6 +136,7 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   , m_initial_photon_lookup_radius_percents(params.get_optional<float>("initial_photon_lookup_radius", 0.1f))
   , m_alpha(params.get_optional<float>("alpha", 0.7f))
   , m_max_photons_per_estimate(params.get_optional<size_t>("max_photons_per_estimate", 100))
+  , m_photon_map_type(get_photon_map_type(params, "photon_map_type", "kdtree"))
   , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0f))
   , m_dl_low_light_threshold(params.get_optional<float>("dl_low_light_threshold", 0.0f))
   , m_view_photons(params.get_optional<bool>("view_photons", false))
@@ -165,6 +184,7 @@ void SPPMParameters::print() const
         "  initial photon lookup radius  %s%%\n"
         "  alpha                         %s\n"
         "  max photons per estimate      %s\n"
+        "  photon map                    %s\n"
         "  dl light samples              %s\n"
         "  dl light threshold            %s",
         m_path_tracing_max_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_path_tracing_max_bounces).c_str(),
@@ -172,7 +192,8 @@ void SPPMParameters::print() const
         m_path_tracing_rr_min_path_length == ~size_t(0) ? "unlimited" : pretty_uint(m_path_tracing_rr_min_path_length).c_str(),
         pretty_scalar(m_initial_photon_lookup_radius_percents, 3).c_str(),
         pretty_scalar(m_alpha, 1).c_str(),
-        pretty_uint(m_max_photons_per_estimate).c_str(),
+        m_max_photons_per_estimate == 0 ? "unlimited" : pretty_uint(m_max_photons_per_estimate).c_str(),
+        m_photon_map_type == KdTree ? "k-d tree" : "hash grid",
         pretty_scalar(m_dl_light_sample_count).c_str(),
         pretty_scalar(m_dl_low_light_threshold, 3).c_str());
 }
@@ -45,6 +45,7 @@ struct SPPMParameters
 {
     enum PhotonType { Monochromatic, Polychromatic };
     enum Mode { RayTraced, SPPM, Off };
+    enum PhotonMapType { KdTree, HashGrid };
 
     const Spectrum::Mode        m_spectrum_mode;
     const SamplingContext::Mode m_sampling_mode;
@@ -55,6 +56,7 @@ struct SPPMParameters
     const Mode                  m_dl_mode;                                  // direct lighting mode
     const bool                  m_enable_ibl;                               // is image-based lighting enabled?
     const bool                  m_enable_caustics;                          // are caustics enabled?
+    const bool                  m_caustic_photons_only;                     // only store photons at the end of light-specular+-diffuse paths?
 
     const std::size_t           m_light_photon_count;                       // number of photons emitted from the lights
     const std::size_t           m_env_photon_count;                         // number of photons emitted from the environment
@@ -75,7 +77,8 @@ struct SPPMParameters
 
     const float                 m_initial_photon_lookup_radius_percents;    // initial photon lookup radius as a percentage of the scene diameter
     const float                 m_alpha;                                    // radius shrinking control
-    const std::size_t           m_max_photons_per_estimate;                 // maximum number of photons per density estimation
+    const std::size_t           m_max_photons_per_estimate;                 // maximum number of photons per density estimation, 0 for unlimited
+    const PhotonMapType         m_photon_map_type;                          // data structure used to look up photons
     const float                 m_dl_light_sample_count;                    // number of light samples used to estimate direct illumination in ray traced mode
     const float                 m_dl_low_light_threshold;                   // light contribution threshold to disable shadow rays
     float                       m_rcp_dl_light_sample_count;
@@ -157,7 +157,12 @@ void SPPMPassCallback::on_pass_begin(
             return;
 
         // Build a new photon map.
-        m_photon_map.reset(new SPPMPhotonMap(m_photons));
+        m_photon_map.reset(
+            new SPPMPhotonMap(
+                m_photons,
+                m_params,
+                m_photon_lookup_radius,
+                job_queue));
 
         if (m_initial_photon_lookup_radius > 0.0f)
         {
@@ -217,6 +222,30 @@ void SPPMPassCallback::on_pass_end(
         }
     }
 
+    // Report photon map statistics.
+    if (m_photon_map)
+    {
+        std::size_t lookup_count = 0;
+        double lookup_time = 0.0;
+        for (std::unique_ptr<SPPMLightingEngineWorkingSet>& working_set : m_working_sets)
+        {
+            lookup_count += working_set->m_photon_lookup_count;
+            lookup_time +=
+                static_cast<double>(working_set->m_photon_lookup_ticks) /
+                working_set->m_photon_lookup_timer.frequency();
+            working_set->m_photon_lookup_count = 0;
+            working_set->m_photon_lookup_ticks = 0;
+        }
+
+        RENDERER_LOG_INFO(
+            "sppm photon map built in %s, %s %s in %s (%s per lookup, cumulated over all threads).",
+            pretty_time(m_photon_map->get_build_time()).c_str(),
+            pretty_uint(lookup_count).c_str(),
+            lookup_count > 1 ? "lookups" : "lookup",
+            pretty_time(lookup_time).c_str(),
+            pretty_time(lookup_count > 0 ? lookup_time / lookup_count : 0.0, 6).c_str());
+    }
+
     m_stopwatch.measure();
 
     RENDERER_LOG_INFO(
@@ -33,6 +33,10 @@
 // appleseed.foundation headers.
 #include "foundation/memory/memory.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
 using namespace foundation;
 
 namespace renderer
@@ -109,12 +113,29 @@ void SPPMPhotonVector::push_back(
     m_poly_photons.push_back(photon);
 }
 
-void SPPMPhotonVector::append(const SPPMPhotonVector& rhs)
+void SPPMPhotonVector::resize(
+    const size_t            position_count,
+    const size_t            mono_photon_count,
+    const size_t            poly_photon_count)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
-    m_positions.insert(m_positions.end(), rhs.m_positions.begin(), rhs.m_positions.end());
-    m_mono_photons.insert(m_mono_photons.end(), rhs.m_mono_photons.begin(), rhs.m_mono_photons.end());
-    m_poly_photons.insert(m_poly_photons.end(), rhs.m_poly_photons.begin(), rhs.m_poly_photons.end());
+    m_positions.resize(position_count);
+    m_mono_photons.resize(mono_photon_count);
+    m_poly_photons.resize(poly_photon_count);
+}
+
+void SPPMPhotonVector::copy_from(
+    const SPPMPhotonVector& rhs,
+    const size_t            position_offset,
+    const size_t            mono_photon_offset,
+    const size_t            poly_photon_offset)
+{
+    assert(position_offset + rhs.m_positions.size() <= m_positions.size());
+    assert(mono_photon_offset + rhs.m_mono_photons.size() <= m_mono_photons.size());
+    assert(poly_photon_offset + rhs.m_poly_photons.size() <= m_poly_photons.size());
+
+    std::copy(rhs.m_positions.begin(), rhs.m_positions.end(), m_positions.begin() + position_offset);
+    std::copy(rhs.m_mono_photons.begin(), rhs.m_mono_photons.end(), m_mono_photons.begin() + mono_photon_offset);
+    std::copy(rhs.m_poly_photons.begin(), rhs.m_poly_photons.end(), m_poly_photons.begin() + poly_photon_offset);
 }
 
 }   // namespace renderer
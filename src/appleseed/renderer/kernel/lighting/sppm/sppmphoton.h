@@ -34,7 +34,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
-#include "foundation/platform/thread.h"
 
 // Standard headers.
 #include <cstddef>
@@ -86,7 +85,6 @@ class SPPMPhotonVector
     std::vector<foundation::Vector3f>   m_positions;
     std::vector<SPPMMonoPhoton>         m_mono_photons;
     std::vector<SPPMPolyPhoton>         m_poly_photons;
-    boost::mutex                        m_mutex;
 
     bool empty() const;
     size_t size() const;
@@ -109,8 +107,18 @@ class SPPMPhotonVector
         const foundation::Vector3f&     position,
         const SPPMPolyPhoton&           photon);
 
-    // The only thread-safe method of this class.
-    void append(const SPPMPhotonVector& rhs);
+    void resize(
+        const size_t                    position_count,
+        const size_t                    mono_photon_count,
+        const size_t                    poly_photon_count);
+
+    // Copy all the photons of another vector into this one, starting at given offsets.
+    // Concurrent calls are safe as long as they write to disjoint ranges of this vector.
+    void copy_from(
+        const SPPMPhotonVector&         rhs,
+        const size_t                    position_offset,
+        const size_t                    mono_photon_offset,
+        const size_t                    poly_photon_offset);
 };
 
 }   // namespace renderer
@@ -35,11 +35,16 @@
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/platform/defaulttimers.h"
 #include "foundation/string/string.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <string>
 
@@ -48,24 +53,66 @@ using namespace foundation;
 namespace renderer
 {
 
-SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
+SPPMPhotonMap::SPPMPhotonMap(
+    SPPMPhotonVector&                       photons,
+    const SPPMParameters&                   params,
+    const float                             lookup_radius,
+    JobQueue&                               job_queue)
+  : m_type(params.m_photon_map_type)
+  , m_build_time(0.0)
+  , m_rcp_cell_size(0.0f)
+  , m_bucket_mask(0)
 {
+    // The hashed grid requires a finite lookup radius.
+    if (lookup_radius <= 0.0f)
+        m_type = SPPMParameters::KdTree;
+
     const size_t photon_count = photons.size();
 
     if (photon_count > 0)
     {
         RENDERER_LOG_INFO(
-            "building sppm photon map from %s %s...",
+            "building sppm photon map (%s) from %s %s...",
+            m_type == SPPMParameters::KdTree ? "k-d tree" : "hash grid",
             pretty_uint(photon_count).c_str(),
             photon_count > 1 ? "photons" : "photon");
 
-        knn::Builder3f builder(*this);
-        builder.build_move_points<DefaultWallclockTimer>(photons.m_positions);
-
         Statistics statistics;
-        statistics.insert_time("build time", builder.get_build_time());
-        statistics.insert_size("size", photons.get_memory_size());  // size without the photon positions since they were moved out
-        statistics.merge(knn::TreeStatistics<knn::Tree3f>(*this));
+
+        if (m_type == SPPMParameters::KdTree)
+        {
+            knn::Builder3f builder(m_tree);
+            builder.build_move_points<DefaultWallclockTimer>(photons.m_positions, job_queue);
+            m_build_time = builder.get_build_time();
+
+            // Photons are gathered with knn::GatherQuery when their number is unlimited.
+            if (params.m_max_photons_per_estimate == 0)
+                builder.build_point_blocks();
+
+            statistics.insert_time("build time", m_build_time);
+            statistics.insert_size("size", photons.get_memory_size());  // size without the photon positions since they were moved out
+            statistics.merge(knn::TreeStatistics<knn::Tree3f>(m_tree));
+        }
+        else
+        {
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+
+            build_hash_grid(photons.m_positions, lookup_radius);
+            clear_release_memory(photons.m_positions);
+
+            stopwatch.measure();
+            m_build_time = stopwatch.get_seconds();
+
+            statistics.insert_time("build time", m_build_time);
+            statistics.insert_size("size", photons.get_memory_size());  // size without the photon positions since they were moved out
+            statistics.insert("buckets", m_bucket_offsets.size() - 1);
+            statistics.insert_size(
+                "grid size",
+                m_points.capacity() * sizeof(Vector3f) +
+                m_indices.capacity() * sizeof(std::uint32_t) +
+                m_bucket_offsets.capacity() * sizeof(std::uint32_t));
+        }
 
         RENDERER_LOG_DEBUG("%s",
             StatisticsVector::make(
@@ -79,4 +126,94 @@ SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
     }
 }
 
+void SPPMPhotonMap::find_nearest(
+    const Vector3f&                         point,
+    const float                             max_square_dist,
+    knn::Answer<float>&                     answer) const
+{
+    if (m_type == SPPMParameters::KdTree)
+    {
+        const knn::Query3f query(m_tree, answer);
+        query.run(point, max_square_dist);
+    }
+    else find_nearest_in_hash_grid(point, max_square_dist, answer);
+}
+
+void SPPMPhotonMap::build_hash_grid(
+    const std::vector<Vector3f>&            points,
+    const float                             cell_size)
+{
+    const size_t point_count = points.size();
+
+    m_rcp_cell_size = 1.0f / cell_size;
+
+    // Use about one bucket for every two photons since many photons share a cell.
+    const size_t bucket_count = next_pow2<size_t>(std::max<size_t>(point_count / 2, 1));
+    m_bucket_mask = static_cast<std::uint32_t>(bucket_count - 1);
+
+    // Count the photons in each bucket.
+    std::vector<std::uint32_t> point_buckets(point_count);
+    m_bucket_offsets.assign(bucket_count + 1, 0);
+    for (size_t i = 0; i < point_count; ++i)
+    {
+        const std::uint32_t bucket = get_bucket(get_cell(points[i]));
+        point_buckets[i] = bucket;
+        ++m_bucket_offsets[bucket + 1];
+    }
+
+    // Compute the offset of the first photon of each bucket.
+    for (size_t i = 0; i < bucket_count; ++i)
+        m_bucket_offsets[i + 1] += m_bucket_offsets[i];
+
+    // Sort the photons by bucket.
+    std::vector<std::uint32_t> insert_offsets(m_bucket_offsets.begin(), m_bucket_offsets.end() - 1);
+    m_points.resize(point_count);
+    m_indices.resize(point_count);
+    for (size_t i = 0; i < point_count; ++i)
+    {
+        const std::uint32_t j = insert_offsets[point_buckets[i]]++;
+        m_points[j] = points[i];
+        m_indices[j] = static_cast<std::uint32_t>(i);
+    }
+}
+
+void SPPMPhotonMap::find_nearest_in_hash_grid(
+    const Vector3f&                         point,
+    const float                             max_square_dist,
+    knn::Answer<float>&                     answer) const
+{
+    answer.clear();
+
+    const size_t max_answer_size = answer.max_size();
+    float square_radius = max_square_dist;
+
+    auto visitor = [&answer, max_answer_size, &square_radius](const size_t i, const float square_dist)
+    {
+        if (answer.size() == max_answer_size)
+        {
+            // The answer is a heap: only accept photons closer than the farthest one.
+            if (square_dist >= square_radius)
+                return;
+
+            answer.heap_insert(i, square_dist);
+            square_radius = answer.top().m_square_dist;
+        }
+        else
+        {
+            if (square_dist > square_radius)
+                return;
+
+            answer.array_insert(i, square_dist);
+
+            if (answer.size() == max_answer_size)
+            {
+                answer.make_heap();
+                square_radius = answer.top().m_square_dist;
+            }
+        }
+    };
+
+    visit_hash_grid(point, max_square_dist, visitor);
+}
+
 }   // namespace renderer
@@ -29,21 +29,229 @@
 
 #pragma once
 
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/knn.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 // Forward declarations.
-namespace renderer  { class SPPMPhotonVector; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class SPPMPhotonVector; }
 
 namespace renderer
 {
 
+//
+// The photon map stores the photon positions either in a k-d tree, which supports
+// k-nearest neighbor queries, or in a hashed grid whose cells are as large as the
+// lookup radius, so that a fixed-radius query visits at most 3x3x3 cells.
+//
+// When the number of photons per estimate is unlimited, photons are gathered
+// without being sorted: the k-d tree then also stores the photon positions in
+// SIMD-friendly blocks, see foundation::knn::GatherQuery.
+//
+
 class SPPMPhotonMap
-  : public foundation::knn::Tree3f
+  : public foundation::NonCopyable
 {
   public:
     // Constructor, *moves* the photon positions into the map.
-    explicit SPPMPhotonMap(SPPMPhotonVector& photons);
+    SPPMPhotonMap(
+        SPPMPhotonVector&                       photons,
+        const SPPMParameters&                   params,
+        const float                             lookup_radius,
+        foundation::JobQueue&                   job_queue);
+
+    // Return true if the map is empty.
+    bool empty() const;
+
+    // Map an index returned by find_nearest() or gather() to an index into the photon vector.
+    size_t remap(const size_t i) const;
+
+    // Find the photons nearest to a given point, within a given distance
+    // and up to the capacity of the answer.
+    void find_nearest(
+        const foundation::Vector3f&             point,
+        const float                             max_square_dist,
+        foundation::knn::Answer<float>&         answer) const;
+
+    // Call visitor(index, square_dist) for each photon within a given distance, in no
+    // particular order. The map must have been built for unlimited photons per estimate.
+    template <typename Visitor>
+    void gather(
+        const foundation::Vector3f&             point,
+        const float                             max_square_dist,
+        Visitor&                                visitor) const;
+
+    // Return the construction time of the map.
+    double get_build_time() const;
+
+  private:
+    SPPMParameters::PhotonMapType               m_type;
+    double                                      m_build_time;
+
+    // K-d tree.
+    foundation::knn::Tree3f                     m_tree;
+
+    // Hashed grid. Points are sorted by bucket, the points of bucket i
+    // are [m_bucket_offsets[i], m_bucket_offsets[i + 1]).
+    float                                       m_rcp_cell_size;
+    std::uint32_t                               m_bucket_mask;
+    std::vector<foundation::Vector3f>           m_points;
+    std::vector<std::uint32_t>                  m_indices;
+    std::vector<std::uint32_t>                  m_bucket_offsets;
+
+    void build_hash_grid(
+        const std::vector<foundation::Vector3f>& points,
+        const float                             cell_size);
+
+    foundation::Vector3i get_cell(const foundation::Vector3f& point) const;
+    std::uint32_t get_bucket(const foundation::Vector3i& cell) const;
+
+    template <typename Visitor>
+    void visit_hash_grid(
+        const foundation::Vector3f&             point,
+        const float                             max_square_dist,
+        Visitor&                                visitor) const;
+
+    void find_nearest_in_hash_grid(
+        const foundation::Vector3f&             point,
+        const float                             max_square_dist,
+        foundation::knn::Answer<float>&         answer) const;
 };
 
+
+//
+// SPPMPhotonMap class implementation.
+//
+
+inline bool SPPMPhotonMap::empty() const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.empty() : m_points.empty();
+}
+
+inline size_t SPPMPhotonMap::remap(const size_t i) const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.remap(i) : m_indices[i];
+}
+
+template <typename Visitor>
+inline void SPPMPhotonMap::gather(
+    const foundation::Vector3f&                 point,
+    const float                                 max_square_dist,
+    Visitor&                                    visitor) const
+{
+    if (m_type == SPPMParameters::KdTree)
+    {
+        if (!m_tree.empty())
+        {
+            const foundation::knn::GatherQuery3f query(m_tree);
+            query.run(point, max_square_dist, visitor);
+        }
+    }
+    else visit_hash_grid(point, max_square_dist, visitor);
+}
+
+inline double SPPMPhotonMap::get_build_time() const
+{
+    return m_build_time;
+}
+
+inline foundation::Vector3i SPPMPhotonMap::get_cell(const foundation::Vector3f& point) const
+{
+    return
+        foundation::Vector3i(
+            static_cast<int>(std::floor(point.x * m_rcp_cell_size)),
+            static_cast<int>(std::floor(point.y * m_rcp_cell_size)),
+            static_cast<int>(std::floor(point.z * m_rcp_cell_size)));
+}
+
+inline std::uint32_t SPPMPhotonMap::get_bucket(const foundation::Vector3i& cell) const
+{
+    // Reference:
+    //
+    //   Optimized Spatial Hashing for Collision Detection of Deformable Objects
+    //   http://www.beosil.com/download/CollisionDetectionHashing_VMV03.pdf
+    //
+
+    const std::uint32_t h =
+        (static_cast<std::uint32_t>(cell.x) * 73856093u) ^
+        (static_cast<std::uint32_t>(cell.y) * 19349663u) ^
+        (static_cast<std::uint32_t>(cell.z) * 83492791u);
+
+    return h & m_bucket_mask;
+}
+
+template <typename Visitor>
+void SPPMPhotonMap::visit_hash_grid(
+    const foundation::Vector3f&                 point,
+    const float                                 max_square_dist,
+    Visitor&                                    visitor) const
+{
+    if (m_points.empty())
+        return;
+
+    const float radius = std::sqrt(max_square_dist);
+    const foundation::Vector3i min_cell = get_cell(point - foundation::Vector3f(radius));
+    const foundation::Vector3i max_cell = get_cell(point + foundation::Vector3f(radius));
+
+    // Several cells may hash to the same bucket. When few cells are visited, which is the case
+    // when the query radius does not exceed the lookup radius, each bucket is only visited once.
+    // Otherwise, photons are only accepted if they lie in the cell being visited.
+    const size_t MaxVisitedBuckets = 27;
+    std::uint32_t visited_buckets[MaxVisitedBuckets];
+    size_t visited_bucket_count = 0;
+    const size_t cell_count =
+        static_cast<size_t>(max_cell.x - min_cell.x + 1) *
+        static_cast<size_t>(max_cell.y - min_cell.y + 1) *
+        static_cast<size_t>(max_cell.z - min_cell.z + 1);
+    const bool check_cells = cell_count > MaxVisitedBuckets;
+
+    foundation::Vector3i cell;
+    for (cell.z = min_cell.z; cell.z <= max_cell.z; ++cell.z)
+    {
+        for (cell.y = min_cell.y; cell.y <= max_cell.y; ++cell.y)
+        {
+            for (cell.x = min_cell.x; cell.x <= max_cell.x; ++cell.x)
+            {
+                const std::uint32_t bucket = get_bucket(cell);
+
+                if (!check_cells)
+                {
+                    if (std::find(visited_buckets, visited_buckets + visited_bucket_count, bucket) !=
+                            visited_buckets + visited_bucket_count)
+                        continue;
+
+                    visited_buckets[visited_bucket_count++] = bucket;
+                }
+
+                const std::uint32_t point_end = m_bucket_offsets[bucket + 1];
+
+                for (std::uint32_t i = m_bucket_offsets[bucket]; i < point_end; ++i)
+                {
+                    const float square_dist = foundation::square_distance(m_points[i], point);
+
+                    if (square_dist > max_square_dist)
+                        continue;
+
+                    if (check_cells && get_cell(m_points[i]) != cell)
+                        continue;
+
+                    visitor(i, square_dist);
+                }
+            }
+        }
+    }
+}
+
 }   // namespace renderer
@@ -82,6 +82,7 @@
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <deque>
 
 using namespace foundation;
 
@@ -141,6 +142,10 @@ namespace
             if (!m_store_indirect)
                 return false;
 
+            // Only follow specular chains if we are only interested in caustic photons.
+            if (m_params.m_caustic_photons_only)
+                return next_mode == ScatteringMode::Specular;
+
             if (!m_store_caustics)
             {
                 // Don't follow paths leading to caustics.
@@ -158,6 +163,10 @@ namespace
 
         void on_hit(const PathVertex& vertex)
         {
+            // Caustic photons are stored after at least one specular bounce.
+            if (m_params.m_caustic_photons_only && vertex.m_path_length == 1)
+                return;
+
             if (vertex.m_path_length > 1 || m_store_direct)
             {
                 // Don't store photons on surfaces without a BSDF.
@@ -259,7 +268,7 @@ namespace
             OIIOTextureSystem&              oiio_texture_system,
             OSLShadingSystem&               shading_system,
             const SPPMParameters&           params,
-            SPPMPhotonVector&               global_photons,
+            SPPMPhotonVector&               photons,
             const size_t                    photon_begin,
             const size_t                    photon_end,
             const std::uint32_t             pass_hash,
@@ -281,7 +290,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_photons(photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -326,8 +335,6 @@ namespace
                 SamplingContext child_sampling_context(sampling_context);
                 trace_light_photon(shading_context, child_sampling_context, light_sample_s);
             }
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -343,12 +350,11 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const std::uint32_t         m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_begin_time;
         float                       m_shutter_close_end_time;
 
@@ -461,7 +467,7 @@ namespace
                 m_params.m_dl_mode == SPPMParameters::SPPM, // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
+                m_photons);
             VolumeVisitor volume_visitor;
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
@@ -526,7 +532,7 @@ namespace
                 m_params.m_dl_mode == SPPMParameters::SPPM, // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
+                m_photons);
             VolumeVisitor volume_visitor;
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
@@ -564,7 +570,7 @@ namespace
             OIIOTextureSystem&          oiio_texture_system,
             OSLShadingSystem&           shading_system,
             const SPPMParameters&       params,
-            SPPMPhotonVector&           global_photons,
+            SPPMPhotonVector&           photons,
             const size_t                photon_begin,
             const size_t                photon_end,
             const std::uint32_t         pass_hash,
@@ -586,7 +592,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_photons(photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -636,8 +642,6 @@ namespace
                 SamplingContext child_sampling_context(sampling_context);
                 trace_env_photon(shading_context, child_sampling_context, env_edf_s);
             }
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -653,12 +657,11 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const std::uint32_t         m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_begin_time;
         float                       m_shutter_close_end_time;
 
@@ -742,7 +745,7 @@ namespace
                 true,
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
+                m_photons);
             VolumeVisitor volume_visitor;
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(   // true = adjoint
                 path_visitor,
@@ -760,6 +763,46 @@ namespace
             path_tracer.trace(sampling_context, shading_context, ray);
         }
     };
+
+
+    //
+    // Photon gathering job.
+    //
+
+    class PhotonGatheringJob
+      : public IJob
+    {
+      public:
+        PhotonGatheringJob(
+            const SPPMPhotonVector&     source,
+            SPPMPhotonVector&           destination,
+            const size_t                position_offset,
+            const size_t                mono_photon_offset,
+            const size_t                poly_photon_offset)
+          : m_source(source)
+          , m_destination(destination)
+          , m_position_offset(position_offset)
+          , m_mono_photon_offset(mono_photon_offset)
+          , m_poly_photon_offset(poly_photon_offset)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_destination.copy_from(
+                m_source,
+                m_position_offset,
+                m_mono_photon_offset,
+                m_poly_photon_offset);
+        }
+
+      private:
+        const SPPMPhotonVector&     m_source;
+        SPPMPhotonVector&           m_destination;
+        const size_t                m_position_offset;
+        const size_t                m_mono_photon_offset;
+        const size_t                m_poly_photon_offset;
+    };
 }
 
 
@@ -864,7 +907,8 @@ void SPPMPhotonTracer::trace_photons(
         Transformd::identity(),
         photon_targets);
 
-    // Schedule photon tracing jobs.
+    // Schedule photon tracing jobs. Each job stores its photons into its own vector.
+    std::deque<SPPMPhotonVector> job_photons;
     size_t job_count = 0;
     size_t emitted_photon_count = 0;
     if (m_light_sampler.has_lights())
@@ -874,7 +918,7 @@ void SPPMPhotonTracer::trace_photons(
             importon_map,
             importon_lookup_radius,
             pass_hash,
-            photons,
+            job_photons,
             job_queue,
             job_count,
             emitted_photon_count,
@@ -887,7 +931,7 @@ void SPPMPhotonTracer::trace_photons(
             importon_map,
             importon_lookup_radius,
             pass_hash,
-            photons,
+            job_photons,
             job_queue,
             job_count,
             emitted_photon_count,
@@ -896,6 +940,11 @@ void SPPMPhotonTracer::trace_photons(
 
     // Wait until the photon tracing jobs have completed.
     job_queue.wait_until_completion();
+    const double tracing_time = stopwatch.measure().get_seconds();
+
+    // Concatenate the photons of all jobs.
+    gather_photons(job_photons, photons, job_queue);
+    const double gathering_time = stopwatch.measure().get_seconds() - tracing_time;
 
     // Update photon tracing statistics.
     m_total_emitted_photon_count += emitted_photon_count;
@@ -904,7 +953,8 @@ void SPPMPhotonTracer::trace_photons(
     // Print photon tracing statistics.
     Statistics statistics;
     statistics.insert("tracing jobs", job_count);
-    statistics.insert_time("tracing time", stopwatch.measure().get_seconds());
+    statistics.insert_time("tracing time", tracing_time);
+    statistics.insert_time("gathering time", gathering_time);
     statistics.insert("emitted", emitted_photon_count);
     statistics.insert(
         "stored",
@@ -921,16 +971,62 @@ void SPPMPhotonTracer::trace_photons(
             statistics).to_string().c_str());
 }
 
+void SPPMPhotonTracer::gather_photons(
+    std::deque<SPPMPhotonVector>& job_photons,
+    SPPMPhotonVector&             photons,
+    JobQueue&                     job_queue) const
+{
+    size_t position_count = photons.m_positions.size();
+    size_t mono_photon_count = photons.m_mono_photons.size();
+    size_t poly_photon_count = photons.m_poly_photons.size();
+
+    for (const SPPMPhotonVector& p : job_photons)
+    {
+        position_count += p.m_positions.size();
+        mono_photon_count += p.m_mono_photons.size();
+        poly_photon_count += p.m_poly_photons.size();
+    }
+
+    size_t position_offset = photons.m_positions.size();
+    size_t mono_photon_offset = photons.m_mono_photons.size();
+    size_t poly_photon_offset = photons.m_poly_photons.size();
+
+    photons.resize(position_count, mono_photon_count, poly_photon_count);
+
+    // Copy the photons of each job into its own range of the final vector.
+    for (const SPPMPhotonVector& p : job_photons)
+    {
+        if (p.empty())
+            continue;
+
+        job_queue.schedule(
+            new PhotonGatheringJob(
+                p,
+                photons,
+                position_offset,
+                mono_photon_offset,
+                poly_photon_offset));
+
+        position_offset += p.m_positions.size();
+        mono_photon_offset += p.m_mono_photons.size();
+        poly_photon_offset += p.m_poly_photons.size();
+    }
+
+    job_queue.wait_until_completion();
+
+    job_photons.clear();
+}
+
 void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
-    const LightTargetArray& photon_targets,
-    const SPPMImportonMap*  importon_map,
-    const float             importon_lookup_radius,
-    const std::uint32_t     pass_hash,
-    SPPMPhotonVector&       photons,
-    JobQueue&               job_queue,
-    size_t&                 job_count,
-    size_t&                 emitted_photon_count,
-    IAbortSwitch&           abort_switch)
+    const LightTargetArray&       photon_targets,
+    const SPPMImportonMap*        importon_map,
+    const float                   importon_lookup_radius,
+    const std::uint32_t           pass_hash,
+    std::deque<SPPMPhotonVector>& job_photons,
+    JobQueue&                     job_queue,
+    size_t&                       job_count,
+    size_t&                       emitted_photon_count,
+    IAbortSwitch&                 abort_switch)
 {
     RENDERER_LOG_INFO(
         "tracing %s sppm light %s...",
@@ -942,6 +1038,8 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
         const size_t photon_begin = i;
         const size_t photon_end = std::min(i + m_params.m_photon_packet_size, m_params.m_light_photon_count);
 
+        job_photons.emplace_back();
+
         job_queue.schedule(
             new LightPhotonTracingJob(
                 m_scene,
@@ -954,7 +1052,7 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                job_photons.back(),
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -966,15 +1064,15 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
 }
 
 void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
-    const LightTargetArray& photon_targets,
-    const SPPMImportonMap*  importon_map,
-    const float             importon_lookup_radius,
-    const std::uint32_t     pass_hash,
-    SPPMPhotonVector&       photons,
-    JobQueue&               job_queue,
-    size_t&                 job_count,
-    size_t&                 emitted_photon_count,
-    IAbortSwitch&           abort_switch)
+    const LightTargetArray&       photon_targets,
+    const SPPMImportonMap*        importon_map,
+    const float                   importon_lookup_radius,
+    const std::uint32_t           pass_hash,
+    std::deque<SPPMPhotonVector>& job_photons,
+    JobQueue&                     job_queue,
+    size_t&                       job_count,
+    size_t&                       emitted_photon_count,
+    IAbortSwitch&                 abort_switch)
 {
     RENDERER_LOG_INFO(
         "tracing %s sppm environment %s...",
@@ -986,6 +1084,8 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
         const size_t photon_begin = i;
         const size_t photon_end = std::min(i + m_params.m_photon_packet_size, m_params.m_env_photon_count);
 
+        job_photons.emplace_back();
+
         job_queue.schedule(
             new EnvironmentPhotonTracingJob(
                 m_scene,
@@ -997,7 +1097,7 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                job_photons.back(),
                 photon_begin,
                 photon_end,
                 pass_hash,
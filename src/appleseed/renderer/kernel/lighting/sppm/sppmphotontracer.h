@@ -38,6 +38,7 @@
 // Standard headers.
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -87,27 +88,32 @@ class SPPMPhotonTracer
     OIIOTextureSystem&              m_oiio_texture_system;
     OSLShadingSystem&               m_shading_system;
 
+    void gather_photons(
+        std::deque<SPPMPhotonVector>& job_photons,
+        SPPMPhotonVector&             photons,
+        foundation::JobQueue&         job_queue) const;
+
     void schedule_light_photon_tracing_jobs(
-        const LightTargetArray&     photon_targets,
-        const SPPMImportonMap*      importon_map,
-        const float                 importon_lookup_radius,
-        const std::uint32_t         pass_hash,
-        SPPMPhotonVector&           photons,
-        foundation::JobQueue&       job_queue,
-        size_t&                     job_count,
-        size_t&                     emitted_photon_count,
-        foundation::IAbortSwitch&   abort_switch);
+        const LightTargetArray&       photon_targets,
+        const SPPMImportonMap*        importon_map,
+        const float                   importon_lookup_radius,
+        const std::uint32_t           pass_hash,
+        std::deque<SPPMPhotonVector>& job_photons,
+        foundation::JobQueue&         job_queue,
+        size_t&                       job_count,
+        size_t&                       emitted_photon_count,
+        foundation::IAbortSwitch&     abort_switch);
 
     void schedule_environment_photon_tracing_jobs(
-        const LightTargetArray&     photon_targets,
-        const SPPMImportonMap*      importon_map,
-        const float                 importon_lookup_radius,
-        const std::uint32_t         pass_hash,
-        SPPMPhotonVector&           photons,
-        foundation::JobQueue&       job_queue,
-        size_t&                     job_count,
-        size_t&                     emitted_photon_count,
-        foundation::IAbortSwitch&   abort_switch);
+        const LightTargetArray&       photon_targets,
+        const SPPMImportonMap*        importon_map,
+        const float                   importon_lookup_radius,
+        const std::uint32_t           pass_hash,
+        std::deque<SPPMPhotonVector>& job_photons,
+        foundation::JobQueue&         job_queue,
+        size_t&                       job_count,
+        size_t&                       emitted_photon_count,
+        foundation::IAbortSwitch&     abort_switch);
 };
 
 }   // namespace renderer
@@ -419,33 +419,39 @@ void VolumeLightingIntegrator::compute_radiance_combined_sampling(
         for (size_t i = 0; i < m_distance_sample_count; ++i)
         {
             // Sample the light set.
-            LightSample light_sample;
-            m_light_sampler.sample_lightset(
-                m_time,
-                child_sampling_context.next2<Vector3f>(),
-                m_shading_point,
-                light_sample);
-
-            for (size_t j = 0; j < m_light_sample_count; ++j)
+            LightSample light_samples[BackwardLightSampler::MaxLightSetSampleCount];
+            const size_t light_sample_count =
+                m_light_sampler.sample_lightset(
+                    m_time,
+                    child_sampling_context.next2<Vector3f>(),
+                    m_shading_point,
+                    light_samples);
+
+            for (size_t k = 0; k < light_sample_count; ++k)
             {
-                add_single_distance_sample_contribution(
-                    &light_sample,
-                    extinction_coef,
-                    sampling_context,
-                    mis_heuristic,
-                    radiance,
-                    false);
-            }
-
-            if (!ScatteringMode::has_volume(m_scattering_modes))
-            {
-                add_single_distance_sample_contribution(
-                    &light_sample,
-                    extinction_coef,
-                    sampling_context,
-                    mis_heuristic,
-                    radiance,
-                    true);
+                const LightSample& light_sample = light_samples[k];
+
+                for (size_t j = 0; j < m_light_sample_count; ++j)
+                {
+                    add_single_distance_sample_contribution(
+                        &light_sample,
+                        extinction_coef,
+                        sampling_context,
+                        mis_heuristic,
+                        radiance,
+                        false);
+                }
+
+                if (!ScatteringMode::has_volume(m_scattering_modes))
+                {
+                    add_single_distance_sample_contribution(
+                        &light_sample,
+                        extinction_coef,
+                        sampling_context,
+                        mis_heuristic,
+                        radiance,
+                        true);
+                }
             }
         }
     }
@@ -557,20 +563,36 @@ void VolumeLightingIntegrator::take_single_direction_sample(
     else if (light_sample == nullptr || light_sample->m_shape != nullptr)
     {
         sampling_context.split_in_place(3, 1);
-        LightSample light_sample;
-        m_light_sampler.sample_lightset(
-            m_time,
-            sampling_context.next2<Vector3f>(),
-            m_shading_point,
-            light_sample);
-
-        integrator.add_emitting_shape_sample_contribution(
-            sampling_context,
-            light_sample,
-            mis_heuristic,
-            Dual3d(m_volume_ray.m_dir),
-            radiance,
-            nullptr);
+        LightSample light_samples[BackwardLightSampler::MaxLightSetSampleCount];
+        const size_t light_sample_count =
+            m_light_sampler.sample_lightset(
+                m_time,
+                sampling_context.next2<Vector3f>(),
+                m_shading_point,
+                light_samples);
+
+        for (size_t i = 0; i < light_sample_count; ++i)
+        {
+            if (light_samples[i].m_shape != nullptr)
+            {
+                integrator.add_emitting_shape_sample_contribution(
+                    sampling_context,
+                    light_samples[i],
+                    mis_heuristic,
+                    Dual3d(m_volume_ray.m_dir),
+                    radiance,
+                    nullptr);
+            }
+            else
+            {
+                integrator.add_non_physical_light_sample_contribution(
+                    sampling_context,
+                    light_samples[i],
+                    Dual3d(m_volume_ray.m_dir),
+                    radiance,
+                    nullptr);
+            }
+        }
     }
     else
     {
@@ -59,8 +59,10 @@
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <vector>
 
 using namespace foundation;
 
@@ -144,43 +146,59 @@ namespace
                 0,                          // number of samples -- unknown
                 instance);                  // initial instance number
 
-            for (size_t i = 0, e = m_sample_count; i < e; ++i)
+            for (size_t begin = 0; begin < m_sample_count; begin += SampleBatchSize)
             {
-                // Generate a uniform sample in [0,1)^2.
-                const Vector2f s =
-                    m_sample_count > 1 || m_params.m_force_aa
-                        ? sampling_context.next2<Vector2f>()
-                        : Vector2f(0.5f);
-
-                // Sample the pixel filter.
-                const auto& filter_table = frame.get_filter_sampling_table();
-                const Vector2d pf(
-                    static_cast<double>(filter_table.sample(s[0]) + 0.5f),
-                    static_cast<double>(filter_table.sample(s[1]) + 0.5f));
-
-                // Compute the sample position in NDC.
-                const Vector2d sample_position = frame.get_sample_position(pi.x + pf.x, pi.y + pf.y);
-
-                // Create a pixel context that identifies the pixel and sample currently being rendered.
-                const PixelContext pixel_context(pi, sample_position);
-
-                // Render the sample.
-                ShadingResult shading_result(aov_count);
-                SamplingContext child_sampling_context(sampling_context);
-                m_sample_renderer->render_sample(
-                    child_sampling_context,
-                    pixel_context,
-                    sample_position,
+                const size_t end = std::min(begin + SampleBatchSize, m_sample_count);
+                const size_t batch_size = end - begin;
+
+                m_batch_sampling_contexts.clear();
+                m_batch_pixel_contexts.clear();
+                m_batch_sample_positions.clear();
+                m_batch_shading_results.clear();
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    // Generate a uniform sample in [0,1)^2.
+                    const Vector2f s =
+                        m_sample_count > 1 || m_params.m_force_aa
+                            ? sampling_context.next2<Vector2f>()
+                            : Vector2f(0.5f);
+
+                    // Sample the pixel filter.
+                    const auto& filter_table = frame.get_filter_sampling_table();
+                    const Vector2d pf(
+                        static_cast<double>(filter_table.sample(s[0]) + 0.5f),
+                        static_cast<double>(filter_table.sample(s[1]) + 0.5f));
+
+                    // Compute the sample position in NDC.
+                    const Vector2d sample_position = frame.get_sample_position(pi.x + pf.x, pi.y + pf.y);
+
+                    // Create a pixel context that identifies the pixel and sample currently being rendered.
+                    m_batch_pixel_contexts.emplace_back(pi, sample_position);
+                    m_batch_sample_positions.push_back(sample_position);
+                    m_batch_shading_results.emplace_back(aov_count);
+                    m_batch_sampling_contexts.push_back(sampling_context);
+                }
+
+                // Render the samples.
+                m_sample_renderer->render_samples(
+                    batch_size,
+                    &m_batch_sampling_contexts[0],
+                    &m_batch_pixel_contexts[0],
+                    &m_batch_sample_positions[0],
                     aov_accumulators,
-                    shading_result);
-
-                // Update sampling statistics.
-                m_total_sampling_dim.insert(child_sampling_context.get_total_dimension());
-
-                // Merge the sample into the framebuffer.
-                if (shading_result.is_valid())
-                    framebuffer.add(Vector2u(pt), shading_result);
-                else signal_invalid_sample();
+                    &m_batch_shading_results[0]);
+
+                for (size_t i = 0; i < batch_size; ++i)
+                {
+                    // Update sampling statistics.
+                    m_total_sampling_dim.insert(m_batch_sampling_contexts[i].get_total_dimension());
+
+                    // Merge the sample into the framebuffer.
+                    if (m_batch_shading_results[i].is_valid())
+                        framebuffer.add(Vector2u(pt), m_batch_shading_results[i]);
+                    else signal_invalid_sample();
+                }
             }
 
             on_pixel_end(frame, pi, pt, tile_bbox, aov_accumulators);
@@ -218,10 +236,18 @@ namespace
             }
         };
 
+        // Number of samples handed to the sample renderer at once.
+        enum { SampleBatchSize = 16 };
+
         const Parameters                    m_params;
         auto_release_ptr<ISampleRenderer>   m_sample_renderer;
         const size_t                        m_sample_count;
         Population<std::uint64_t>           m_total_sampling_dim;
+
+        std::vector<SamplingContext>        m_batch_sampling_contexts;
+        std::vector<PixelContext>           m_batch_pixel_contexts;
+        std::vector<Vector2d>               m_batch_sample_positions;
+        std::vector<ShadingResult>          m_batch_shading_results;
     };
 }
 
@@ -104,6 +104,7 @@ namespace
         {
             SampleGeneratorBase::reset();
             m_rng = SamplingContext::RNGType();
+            clear_batch();
         }
 
         StatisticsVector get_statistics() const override
@@ -122,13 +123,18 @@ namespace
         struct Parameters
         {
             const SamplingContext::Mode     m_sampling_mode;
+            const bool                      m_batch_shading;
 
             explicit Parameters(const ParamArray& params)
               : m_sampling_mode(get_sampling_context_mode(params))
+              , m_batch_shading(params.get_optional<bool>("batch_shading", false))
             {
             }
         };
 
+        // Number of samples handed to the sample renderer at once in batch shading mode.
+        enum { SampleBatchSize = 64 };
+
         const Parameters                    m_params;
         const size_t                        m_canvas_width;
         const size_t                        m_canvas_height;
@@ -148,6 +154,11 @@ namespace
 
         AOVAccumulatorContainer             m_aov_accumulators;
 
+        std::vector<SamplingContext>        m_batch_sampling_contexts;
+        std::vector<PixelContext>           m_batch_pixel_contexts;
+        std::vector<Vector2d>               m_batch_sample_positions;
+        std::vector<ShadingResult>          m_batch_shading_results;
+
         size_t generate_samples(
             const size_t                    sequence_index,
             SampleVector&                   samples) override
@@ -191,6 +202,20 @@ namespace
                 Vector2i(m_window_origin_x + x, m_window_origin_y + y),
                 sample_position);
 
+            // In batch shading mode, hold the sample back until the batch is full.
+            if (m_params.m_batch_shading)
+            {
+                m_batch_sampling_contexts.push_back(sampling_context);
+                m_batch_pixel_contexts.push_back(pixel_context);
+                m_batch_sample_positions.push_back(sample_position);
+                m_batch_shading_results.emplace_back();
+
+                return
+                    m_batch_sampling_contexts.size() == SampleBatchSize
+                        ? flush_samples(samples)
+                        : 0;
+            }
+
             // Render the sample.
             ShadingResult shading_result;
             m_sample_renderer->render_sample(
@@ -203,6 +228,49 @@ namespace
             // Update sampling statistics.
             m_total_sampling_dim.insert(sampling_context.get_total_dimension());
 
+            return store_sample(pixel_context, shading_result, samples);
+        }
+
+        size_t flush_samples(SampleVector& samples) override
+        {
+            const size_t sample_count = m_batch_sampling_contexts.size();
+
+            if (sample_count == 0)
+                return 0;
+
+            // Render the samples.
+            m_sample_renderer->render_samples(
+                sample_count,
+                &m_batch_sampling_contexts[0],
+                &m_batch_pixel_contexts[0],
+                &m_batch_sample_positions[0],
+                m_aov_accumulators,
+                &m_batch_shading_results[0]);
+
+            size_t stored = 0;
+
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                // Update sampling statistics.
+                m_total_sampling_dim.insert(m_batch_sampling_contexts[i].get_total_dimension());
+
+                stored +=
+                    store_sample(
+                        m_batch_pixel_contexts[i],
+                        m_batch_shading_results[i],
+                        samples);
+            }
+
+            clear_batch();
+
+            return stored;
+        }
+
+        size_t store_sample(
+            const PixelContext&             pixel_context,
+            const ShadingResult&            shading_result,
+            SampleVector&                   samples)
+        {
             // Report then ignore invalid samples.
             if (!shading_result.is_valid())
             {
@@ -218,6 +286,14 @@ namespace
 
             return 1;
         }
+
+        void clear_batch()
+        {
+            m_batch_sampling_contexts.clear();
+            m_batch_pixel_contexts.clear();
+            m_batch_sample_positions.clear();
+            m_batch_shading_results.clear();
+        }
     };
 }
 
@@ -38,6 +38,7 @@
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/lighting/ilightingengine.h"
 #include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
 #include "renderer/kernel/shading/oslshadergroupexec.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -49,6 +50,7 @@
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/scene.h"
 
 // appleseed.foundation headers.
@@ -61,14 +63,12 @@
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <string>
 
-// Forward declarations.
-namespace renderer  { class PixelContext; }
-
 using namespace foundation;
 
 namespace renderer
@@ -130,6 +130,9 @@ namespace
                 m_lighting_engine,
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations)
+          , m_batched_sample_count(0)
+          , m_unsorted_shading_switch_count(0)
+          , m_sorted_shading_switch_count(0)
         {
             // 1/4 of a pixel, like in RenderMan RIS.
             const CanvasProperties& c = frame.image().properties();
@@ -153,10 +156,12 @@ namespace
                 "generic sample renderer settings:\n"
                 "  transparency threshold        %f\n"
                 "  max iterations                %s\n"
-                "  report self intersections     %s",
+                "  report self intersections     %s\n"
+                "  batch shading                 %s",
                 m_params.m_transparency_threshold,
                 pretty_uint(m_params.m_max_iterations).c_str(),
-                m_params.m_report_self_intersections ? "on" : "off");
+                m_params.m_report_self_intersections ? "on" : "off",
+                m_params.m_batch_shading ? "on" : "off");
 
             m_lighting_engine->print_settings();
         }
@@ -182,6 +187,176 @@ namespace
                 Dual2d(image_point, m_image_point_dx, m_image_point_dy),
                 primary_ray);
 
+            // Trace and shade the primary ray.
+            shade_primary_ray(
+                sampling_context,
+                pixel_context,
+                primary_ray,
+                nullptr,
+                aov_accumulators,
+                shading_result);
+
+#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCE
+
+            const std::uint64_t delta_hit_count = m_texture_cache.get_hit_count() - last_texture_cache_hit_count;
+            const std::uint64_t delta_miss_count = m_texture_cache.get_miss_count() - last_texture_cache_miss_count;
+
+            if (delta_hit_count + delta_miss_count == 0)
+            {
+                // In black: no access to the texture cache.
+                shading_result.m_main = Color4f(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+            else if (delta_hit_count > delta_miss_count)
+            {
+                // In green: a majority of cache hits.
+                shading_result.m_main = Color4f(0.0f, 1.0f, 0.0f, 1.0f);
+            }
+            else
+            {
+                // In red: a majority of cache misses.
+                shading_result.m_main = Color4f(1.0f, 0.0f, 0.0f, 1.0f);
+            }
+
+#endif
+        }
+
+        void render_samples(
+            const size_t                sample_count,
+            SamplingContext*            sampling_contexts,
+            const PixelContext*         pixel_contexts,
+            const Vector2d*             image_points,
+            AOVAccumulatorContainer&    aov_accumulators,
+            ShadingResult*              shading_results) override
+        {
+            if (!m_params.m_batch_shading)
+            {
+                for (size_t i = 0; i < sample_count; ++i)
+                {
+                    render_sample(
+                        sampling_contexts[i],
+                        pixel_contexts[i],
+                        image_points[i],
+                        aov_accumulators,
+                        shading_results[i]);
+                }
+
+                return;
+            }
+
+            for (size_t begin = 0; begin < sample_count; begin += BatchSize)
+            {
+                const size_t end = std::min(begin + BatchSize, sample_count);
+                const size_t count = end - begin;
+
+                // Construct and trace the primary rays of the batch.
+                for (size_t i = 0; i < count; ++i)
+                {
+                    m_scene.get_render_data().m_active_camera->spawn_ray(
+                        sampling_contexts[begin + i],
+                        Dual2d(image_points[begin + i], m_image_point_dx, m_image_point_dy),
+                        m_batch_rays[i]);
+
+                    m_batch_shading_points[i].clear();
+                    m_intersector.trace(m_batch_rays[i], m_batch_shading_points[i]);
+                }
+
+                // Sort the samples by shader group, BSDF and material so that consecutive
+                // shading calls run through the same shaders, BSDFs and textures.
+                size_t order[BatchSize];
+                sort_by_shading_key(count, order);
+
+                // Shade the samples in sorted order and continue their paths.
+                for (size_t k = 0; k < count; ++k)
+                {
+                    const size_t i = order[k];
+                    shade_primary_ray(
+                        sampling_contexts[begin + i],
+                        pixel_contexts[begin + i],
+                        m_batch_rays[i],
+                        &m_batch_shading_points[i],
+                        aov_accumulators,
+                        shading_results[begin + i]);
+                }
+            }
+        }
+
+        StatisticsVector get_statistics() const override
+        {
+            StatisticsVector stats;
+            stats.merge(m_texture_cache.get_statistics());
+            stats.merge(m_intersector.get_statistics());
+            stats.merge(m_lighting_engine->get_statistics());
+
+            if (m_params.m_batch_shading)
+            {
+                // A shading switch is a pair of consecutively shaded first hits with different shading keys.
+                Statistics batch_stats;
+                batch_stats.insert("batched samples", m_batched_sample_count);
+                batch_stats.insert("switches in ray order", m_unsorted_shading_switch_count);
+                batch_stats.insert("switches when sorted", m_sorted_shading_switch_count);
+                stats.insert("batch shading statistics", batch_stats);
+            }
+
+            return stats;
+        }
+
+      private:
+        // Number of primary rays traced, then shaded in sorted order, by render_samples().
+        enum { BatchSize = 64 };
+
+        struct Parameters
+        {
+            const float     m_transparency_threshold;
+            const size_t    m_max_iterations;
+            const bool      m_report_self_intersections;
+            const bool      m_batch_shading;
+
+            explicit Parameters(const ParamArray& params)
+              : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
+              , m_max_iterations(params.get_optional<size_t>("max_iterations", 100))
+              , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
+              , m_batch_shading(params.get_optional<bool>("batch_shading", false))
+            {
+            }
+        };
+
+        const Parameters            m_params;
+        const Scene&                m_scene;
+        const float                 m_opacity_threshold;
+        TextureCache                m_texture_cache;
+        ILightingEngine*            m_lighting_engine;
+        ShadingEngine&              m_shading_engine;
+        OIIOTextureSystem&          m_oiio_texture_system;
+        const size_t                m_thread_index;
+
+        Arena                       m_arena;
+        OSLShaderGroupExec          m_shadergroup_exec;
+        const Intersector           m_intersector;
+        Tracer                      m_tracer;
+        const ShadingContext        m_shading_context;
+
+        Vector2d                    m_image_point_dx;
+        Vector2d                    m_image_point_dy;
+
+        // Storage for the primary rays and first intersections of a batch of samples.
+        ShadingRay                  m_batch_rays[BatchSize];
+        ShadingPoint                m_batch_shading_points[BatchSize];
+
+        std::uint64_t               m_batched_sample_count;
+        std::uint64_t               m_unsorted_shading_switch_count;
+        std::uint64_t               m_sorted_shading_switch_count;
+
+        // Trace a primary ray, and the rays continuing it through transparent surfaces,
+        // and shade the intersections. If `first_hit` is provided, it is used in place
+        // of the first intersection of `primary_ray`.
+        void shade_primary_ray(
+            SamplingContext&            sampling_context,
+            const PixelContext&         pixel_context,
+            ShadingRay&                 primary_ray,
+            const ShadingPoint*         first_hit,
+            AOVAccumulatorContainer&    aov_accumulators,
+            ShadingResult&              shading_result)
+        {
             ShadingPoint shading_points[2];
             size_t shading_point_index = 0;
             const ShadingPoint* shading_point_ptr = nullptr;
@@ -203,16 +378,24 @@ namespace
 
                 m_arena.clear();
 
-                // Trace the ray.
-                shading_points[shading_point_index].clear();
-                m_intersector.trace(
-                    primary_ray,
-                    shading_points[shading_point_index],
-                    shading_point_ptr);
-
-                // Update the pointers to the shading points.
-                shading_point_ptr = &shading_points[shading_point_index];
-                shading_point_index = 1 - shading_point_index;
+                if (iterations == 1 && first_hit != nullptr)
+                {
+                    // The first intersection was already found by the caller.
+                    shading_point_ptr = first_hit;
+                }
+                else
+                {
+                    // Trace the ray.
+                    shading_points[shading_point_index].clear();
+                    m_intersector.trace(
+                        primary_ray,
+                        shading_points[shading_point_index],
+                        shading_point_ptr);
+
+                    // Update the pointers to the shading points.
+                    shading_point_ptr = &shading_points[shading_point_index];
+                    shading_point_index = 1 - shading_point_index;
+                }
 
                 if (iterations == 1)
                 {
@@ -269,72 +452,82 @@ namespace
 
             // Inform the AOV accumulators that we are done rendering a sample.
             aov_accumulators.on_sample_end(pixel_context);
+        }
 
-#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCE
-
-            const std::uint64_t delta_hit_count = m_texture_cache.get_hit_count() - last_texture_cache_hit_count;
-            const std::uint64_t delta_miss_count = m_texture_cache.get_miss_count() - last_texture_cache_miss_count;
-
-            if (delta_hit_count + delta_miss_count == 0)
-            {
-                // In black: no access to the texture cache.
-                shading_result.m_main = Color4f(0.0f, 0.0f, 0.0f, 1.0f);
-            }
-            else if (delta_hit_count > delta_miss_count)
-            {
-                // In green: a majority of cache hits.
-                shading_result.m_main = Color4f(0.0f, 1.0f, 0.0f, 1.0f);
-            }
-            else
+        // Compute an ordering of the first `count` shading points of the batch such that
+        // points sharing the same OSL shader group, then the same BSDF (and therefore the
+        // same textures), then the same material are consecutive. Misses come last.
+        void sort_by_shading_key(const size_t count, size_t order[])
+        {
+            struct ShadingKey
             {
-                // In red: a majority of cache misses.
-                shading_result.m_main = Color4f(1.0f, 0.0f, 0.0f, 1.0f);
-            }
+                std::uintptr_t  m_shader_group;
+                std::uintptr_t  m_bsdf;
+                std::uintptr_t  m_material;
 
-#endif
-        }
+                bool operator<(const ShadingKey& rhs) const
+                {
+                    if (m_shader_group != rhs.m_shader_group)
+                        return m_shader_group < rhs.m_shader_group;
+                    if (m_bsdf != rhs.m_bsdf)
+                        return m_bsdf < rhs.m_bsdf;
+                    return m_material < rhs.m_material;
+                }
 
-        StatisticsVector get_statistics() const override
-        {
-            StatisticsVector stats;
-            stats.merge(m_texture_cache.get_statistics());
-            stats.merge(m_intersector.get_statistics());
-            stats.merge(m_lighting_engine->get_statistics());
-            return stats;
-        }
+                bool operator!=(const ShadingKey& rhs) const
+                {
+                    return
+                        m_shader_group != rhs.m_shader_group ||
+                        m_bsdf != rhs.m_bsdf ||
+                        m_material != rhs.m_material;
+                }
+            };
 
-      private:
-        struct Parameters
-        {
-            const float     m_transparency_threshold;
-            const size_t    m_max_iterations;
-            const bool      m_report_self_intersections;
+            ShadingKey keys[BatchSize];
 
-            explicit Parameters(const ParamArray& params)
-              : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
-              , m_max_iterations(params.get_optional<size_t>("max_iterations", 100))
-              , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
+            for (size_t i = 0; i < count; ++i)
             {
-            }
-        };
+                const ShadingPoint& shading_point = m_batch_shading_points[i];
+                const Material* material =
+                    shading_point.hit_surface() ? shading_point.get_material() : nullptr;
 
-        const Parameters            m_params;
-        const Scene&                m_scene;
-        const float                 m_opacity_threshold;
-        TextureCache                m_texture_cache;
-        ILightingEngine*            m_lighting_engine;
-        ShadingEngine&              m_shading_engine;
-        OIIOTextureSystem&          m_oiio_texture_system;
-        const size_t                m_thread_index;
+                ShadingKey& key = keys[i];
 
-        Arena                       m_arena;
-        OSLShaderGroupExec          m_shadergroup_exec;
-        const Intersector           m_intersector;
-        Tracer                      m_tracer;
-        const ShadingContext        m_shading_context;
+                if (material != nullptr)
+                {
+                    const Material::RenderData& render_data = material->get_render_data();
+                    key.m_shader_group = reinterpret_cast<std::uintptr_t>(render_data.m_shader_group);
+                    key.m_bsdf = reinterpret_cast<std::uintptr_t>(render_data.m_bsdf);
+                    key.m_material = reinterpret_cast<std::uintptr_t>(material);
+                }
+                else
+                {
+                    key.m_shader_group = ~std::uintptr_t(0);
+                    key.m_bsdf = ~std::uintptr_t(0);
+                    key.m_material = shading_point.hit_surface() ? 0 : ~std::uintptr_t(0);
+                }
 
-        Vector2d                    m_image_point_dx;
-        Vector2d                    m_image_point_dy;
+                order[i] = i;
+            }
+
+            std::stable_sort(
+                order,
+                order + count,
+                [&keys](const size_t lhs, const size_t rhs)
+                {
+                    return keys[lhs] < keys[rhs];
+                });
+
+            // Record how much sorting improved shading coherence.
+            m_batched_sample_count += count;
+            for (size_t i = 1; i < count; ++i)
+            {
+                if (keys[i] != keys[i - 1])
+                    ++m_unsorted_shading_switch_count;
+                if (keys[order[i]] != keys[order[i - 1]])
+                    ++m_sorted_shading_switch_count;
+            }
+        }
     };
 }
 
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/tilesplatbuffer.h"
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
@@ -94,6 +95,30 @@ void GlobalSampleAccumulationBuffer::store_samples(
     }
 }
 
+void GlobalSampleAccumulationBuffer::store_splats(
+    const TileSplatBuffer&  splats,
+    IAbortSwitch&           abort_switch)
+{
+    // Request non-exclusive access.
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
+    while (true)
+    {
+        if (abort_switch.is_aborted())
+            return;
+        if (lock.try_lock_for(boost::chrono::milliseconds(5)))
+            break;
+    }
+
+    for (size_t i = 0, e = splats.size(); i < e; ++i)
+    {
+        if ((i & 4095) == 0 && abort_switch.is_aborted())
+            return;
+
+        const TileSplatBuffer::Splat& splat = splats[i];
+        m_fb.atomic_add(splat.m_pixel_coords, &splat.m_color[0], splat.m_weight);
+    }
+}
+
 void GlobalSampleAccumulationBuffer::develop_to_frame(
     Frame&          frame,
     IAbortSwitch&   abort_switch)
@@ -46,6 +46,7 @@ namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Tile; }
 namespace renderer      { class Frame; }
 namespace renderer      { class Sample; }
+namespace renderer      { class TileSplatBuffer; }
 
 namespace renderer
 {
@@ -68,6 +69,11 @@ class GlobalSampleAccumulationBuffer
         const Sample                samples[],
         foundation::IAbortSwitch&   abort_switch) override;
 
+    // Store a set of samples previously sorted and merged into splats. Thread-safe.
+    void store_splats(
+        const TileSplatBuffer&      splats,
+        foundation::IAbortSwitch&   abort_switch);
+
     // Develop the buffer to a frame. Thread-safe.
     void develop_to_frame(
         Frame&                      frame,
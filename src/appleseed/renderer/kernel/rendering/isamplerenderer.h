@@ -68,6 +68,16 @@ class ISampleRenderer
         AOVAccumulatorContainer&        aov_accumulators,
         ShadingResult&                  shading_result) = 0;
 
+    // Render a batch of independent samples. This is equivalent to calling render_sample()
+    // on each sample in turn, but allows the renderer to process the batch coherently.
+    virtual void render_samples(
+        const size_t                    sample_count,
+        SamplingContext*                sampling_contexts,
+        const PixelContext*             pixel_contexts,
+        const foundation::Vector2d*     image_points,
+        AOVAccumulatorContainer&        aov_accumulators,
+        ShadingResult*                  shading_results) = 0;
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
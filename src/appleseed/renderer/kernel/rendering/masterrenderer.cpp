@@ -294,7 +294,10 @@ struct MasterRenderer::Impl
             RendererControllerAbortSwitch abort_switch(renderer_controller);
 
             // Expand procedural assemblies before scene entities inputs are bound.
-            if (!m_project.get_scene()->expand_procedural_assemblies(m_project, &abort_switch))
+            if (!m_project.get_scene()->expand_procedural_assemblies(
+                    m_project,
+                    &abort_switch,
+                    get_rendering_thread_count(m_params)))
                 return RenderingResult::Failed; // todo: depends on whether the abort switch was triggered or not
 
             // Bind scene entities inputs.
@@ -356,7 +359,8 @@ struct MasterRenderer::Impl
         // Let scene entities perform their pre-render actions. Don't proceed if that failed.
         // This is done before creating renderer components because renderer components need
         // to access the scene's render data such as the scene's bounding box.
-        OnRenderBeginRecorder recorder;
+        // Independent entities are initialized in parallel.
+        OnRenderBeginRecorder recorder(get_rendering_thread_count(m_params));
         if (!m_project.get_scene()->on_render_begin(m_project, nullptr, recorder, &abort_switch) ||
             abort_switch.is_aborted())
         {
@@ -375,6 +379,10 @@ struct MasterRenderer::Impl
              RENDERER_LOG_INFO("using Intel Embree ray tracing kernel.");
         else RENDERER_LOG_INFO("using built-in ray tracing kernel.");
 
+        // Bound the memory used by the geometry of deferred mesh objects that the scene no longer needs.
+        m_project.set_deferred_geometry_memory_budget(
+            m_params.get_optional<size_t>("deferred_geometry_memory_budget", 1024 * 1024 * 1024));
+
         // Updating the device scene causes ray tracing acceleration structures to be updated or rebuilt.
         if (!m_render_device->build_or_update_scene())
         {
@@ -442,7 +450,8 @@ struct MasterRenderer::Impl
             m_project.get_light_path_recorder().clear();
 
             // Perform pre-frame actions. Don't proceed if that failed.
-            OnFrameBeginRecorder recorder;
+            // Independent entities are prepared in parallel.
+            OnFrameBeginRecorder recorder(get_rendering_thread_count(m_params));
             if (!m_render_device->on_frame_begin(recorder, &abort_switch) ||
                 !m_project.on_frame_begin(m_project, nullptr, recorder, &abort_switch) ||
                 abort_switch.is_aborted())
@@ -34,6 +34,7 @@
 #include "renderer/kernel/lighting/bdpt/bdptlightingengine.h"
 #include "renderer/kernel/lighting/lighttracing/lighttracingsamplegenerator.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
+#include "renderer/kernel/lighting/pt/ptpasscallback.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
 #include "renderer/kernel/lighting/sppm/sppmpasscallback.h"
@@ -169,6 +170,10 @@ bool RendererComponents::on_frame_begin(
     if (!m_shading_engine.on_frame_begin(m_project, recorder, abort_switch))
         return false;
 
+    // Lights may have moved since the previous frame.
+    if (m_backward_light_sampler)
+        m_backward_light_sampler->on_frame_begin();
+
     return true;
 }
 
@@ -187,11 +192,40 @@ bool RendererComponents::create_lighting_engine_factory()
                 m_scene,
                 get_child_and_inherit_globals(m_params, "light_sampler")));
 
+        const ParamArray pt_params = get_child_and_inherit_globals(m_params, "pt");   // todo: change to "pt_lighting_engine"?
+
+        // The caustic cache emits photons from the lights.
+        const bool enable_caustic_cache = pt_params.get_optional<bool>("enable_caustic_cache", false);
+        if (enable_caustic_cache)
+        {
+            m_forward_light_sampler.reset(
+                new ForwardLightSampler(
+                    m_scene,
+                    get_child_and_inherit_globals(m_params, "light_sampler")));
+        }
+
+        // Path guiding is trained and the caustic cache is rebuilt between rendering passes.
+        PTPassCallback* pt_pass_callback = nullptr;
+        if (enable_caustic_cache || pt_params.get_optional<bool>("enable_path_guiding", false))
+        {
+            pt_pass_callback =
+                new PTPassCallback(
+                    m_scene,
+                    m_forward_light_sampler.get(),
+                    m_trace_context,
+                    m_texture_store,
+                    m_oiio_texture_system,
+                    m_osl_shading_system,
+                    pt_params);
+            m_pass_callback.reset(pt_pass_callback);
+        }
+
         m_lighting_engine_factory.reset(
             new PTLightingEngineFactory(
                 *m_backward_light_sampler,
                 m_project.get_light_path_recorder(),
-                get_child_and_inherit_globals(m_params, "pt")));    // todo: change to "pt_lighting_engine"?
+                pt_pass_callback,
+                pt_params));
 
         return true;
     }
@@ -567,6 +601,9 @@ bool RendererComponents::create_frame_renderer()
             return false;
         }
 
+        if (dynamic_cast<PTPassCallback*>(m_pass_callback.get()) != nullptr)
+            RENDERER_LOG_WARNING("path guiding and the caustic cache are not supported by the progressive frame renderer and will be ignored.");
+
         m_frame_renderer.reset(
             ProgressiveFrameRendererFactory::create(
                 m_project,
@@ -99,46 +99,46 @@ RendererServices::RendererServices(
   , m_texture_store(nullptr)
 {
     // Set up attribute getters.
-    m_global_attr_getters[OIIO::ustring("object:object_instance_id")] = &RendererServices::get_attr_object_instance_id;
-    m_global_attr_getters[OIIO::ustring("object:object_instance_index")] = &RendererServices::get_attr_object_instance_index;
-    m_global_attr_getters[OIIO::ustring("object:assembly_instance_id")] = &RendererServices::get_attr_assembly_instance_id;
-    m_global_attr_getters[OIIO::ustring("object:assembly_name")] = &RendererServices::get_attr_assembly_name;
-    m_global_attr_getters[OIIO::ustring("object:assembly_instance_name")] = &RendererServices::get_attr_assembly_instance_name;
-    m_global_attr_getters[OIIO::ustring("object:object_instance_name")] = &RendererServices::get_attr_object_instance_name;
-    m_global_attr_getters[OIIO::ustring("object:object_name")] = &RendererServices::get_attr_object_name;
-
-    m_global_attr_getters[OIIO::ustring("camera:resolution")] = &RendererServices::get_attr_camera_resolution;
-    m_global_attr_getters[OIIO::ustring("camera:projection")] = &RendererServices::get_attr_camera_projection;
-    m_global_attr_getters[OIIO::ustring("camera:pixelaspect")] = &RendererServices::get_attr_camera_pixelaspect;
-    m_global_attr_getters[OIIO::ustring("camera:screen_window")] = &RendererServices::get_attr_camera_screen_window;
-    m_global_attr_getters[OIIO::ustring("camera:fov")] = &RendererServices::get_attr_camera_fov;
-    m_global_attr_getters[OIIO::ustring("camera:clip")] = &RendererServices::get_attr_camera_clip;
-    m_global_attr_getters[OIIO::ustring("camera:clip_near")] = &RendererServices::get_attr_camera_clip_near;
-    m_global_attr_getters[OIIO::ustring("camera:clip_far")] = &RendererServices::get_attr_camera_clip_far;
-    m_global_attr_getters[OIIO::ustring("camera:shutter")] = &RendererServices::get_attr_camera_shutter;
-    m_global_attr_getters[OIIO::ustring("camera:shutter_open")] = &RendererServices::get_attr_camera_shutter_open;
-    m_global_attr_getters[OIIO::ustring("camera:shutter_close")] = &RendererServices::get_attr_camera_shutter_close;
-
-    m_global_attr_getters[OIIO::ustring("path:ray_depth")] = &RendererServices::get_attr_ray_depth;
-    m_global_attr_getters[OIIO::ustring("path:ray_length")] = &RendererServices::get_attr_ray_length;
-    m_global_attr_getters[OIIO::ustring("path:ray_ior")] = &RendererServices::get_attr_ray_ior;
-    m_global_attr_getters[OIIO::ustring("path:ray_has_differentials")] = &RendererServices::get_attr_ray_has_differentials;
-
-    m_global_attr_getters[OIIO::ustring("surface_shader:diffuse")] = &RendererServices::get_attr_surface_shader_diffuse;
-    m_global_attr_getters[OIIO::ustring("surface_shader:glossy")] = &RendererServices::get_attr_surface_shader_glossy;
-    m_global_attr_getters[OIIO::ustring("surface_shader:emission")] = &RendererServices::get_attr_surface_shader_emission;
-
-    m_global_attr_getters[OIIO::ustring("appleseed:version_major")] = &RendererServices::get_attr_appleseed_version_major;
-    m_global_attr_getters[OIIO::ustring("appleseed:version_minor")] = &RendererServices::get_attr_appleseed_version_minor;
-    m_global_attr_getters[OIIO::ustring("appleseed:version_patch")] = &RendererServices::get_attr_appleseed_version_patch;
-    m_global_attr_getters[OIIO::ustring("appleseed:version")] = &RendererServices::get_attr_appleseed_version;
+    m_global_attr_getters.insert(OIIO::ustring("object:object_instance_id"), &RendererServices::get_attr_object_instance_id);
+    m_global_attr_getters.insert(OIIO::ustring("object:object_instance_index"), &RendererServices::get_attr_object_instance_index);
+    m_global_attr_getters.insert(OIIO::ustring("object:assembly_instance_id"), &RendererServices::get_attr_assembly_instance_id);
+    m_global_attr_getters.insert(OIIO::ustring("object:assembly_name"), &RendererServices::get_attr_assembly_name);
+    m_global_attr_getters.insert(OIIO::ustring("object:assembly_instance_name"), &RendererServices::get_attr_assembly_instance_name);
+    m_global_attr_getters.insert(OIIO::ustring("object:object_instance_name"), &RendererServices::get_attr_object_instance_name);
+    m_global_attr_getters.insert(OIIO::ustring("object:object_name"), &RendererServices::get_attr_object_name);
+
+    m_global_attr_getters.insert(OIIO::ustring("camera:resolution"), &RendererServices::get_attr_camera_resolution);
+    m_global_attr_getters.insert(OIIO::ustring("camera:projection"), &RendererServices::get_attr_camera_projection);
+    m_global_attr_getters.insert(OIIO::ustring("camera:pixelaspect"), &RendererServices::get_attr_camera_pixelaspect);
+    m_global_attr_getters.insert(OIIO::ustring("camera:screen_window"), &RendererServices::get_attr_camera_screen_window);
+    m_global_attr_getters.insert(OIIO::ustring("camera:fov"), &RendererServices::get_attr_camera_fov);
+    m_global_attr_getters.insert(OIIO::ustring("camera:clip"), &RendererServices::get_attr_camera_clip);
+    m_global_attr_getters.insert(OIIO::ustring("camera:clip_near"), &RendererServices::get_attr_camera_clip_near);
+    m_global_attr_getters.insert(OIIO::ustring("camera:clip_far"), &RendererServices::get_attr_camera_clip_far);
+    m_global_attr_getters.insert(OIIO::ustring("camera:shutter"), &RendererServices::get_attr_camera_shutter);
+    m_global_attr_getters.insert(OIIO::ustring("camera:shutter_open"), &RendererServices::get_attr_camera_shutter_open);
+    m_global_attr_getters.insert(OIIO::ustring("camera:shutter_close"), &RendererServices::get_attr_camera_shutter_close);
+
+    m_global_attr_getters.insert(OIIO::ustring("path:ray_depth"), &RendererServices::get_attr_ray_depth);
+    m_global_attr_getters.insert(OIIO::ustring("path:ray_length"), &RendererServices::get_attr_ray_length);
+    m_global_attr_getters.insert(OIIO::ustring("path:ray_ior"), &RendererServices::get_attr_ray_ior);
+    m_global_attr_getters.insert(OIIO::ustring("path:ray_has_differentials"), &RendererServices::get_attr_ray_has_differentials);
+
+    m_global_attr_getters.insert(OIIO::ustring("surface_shader:diffuse"), &RendererServices::get_attr_surface_shader_diffuse);
+    m_global_attr_getters.insert(OIIO::ustring("surface_shader:glossy"), &RendererServices::get_attr_surface_shader_glossy);
+    m_global_attr_getters.insert(OIIO::ustring("surface_shader:emission"), &RendererServices::get_attr_surface_shader_emission);
+
+    m_global_attr_getters.insert(OIIO::ustring("appleseed:version_major"), &RendererServices::get_attr_appleseed_version_major);
+    m_global_attr_getters.insert(OIIO::ustring("appleseed:version_minor"), &RendererServices::get_attr_appleseed_version_minor);
+    m_global_attr_getters.insert(OIIO::ustring("appleseed:version_patch"), &RendererServices::get_attr_appleseed_version_patch);
+    m_global_attr_getters.insert(OIIO::ustring("appleseed:version"), &RendererServices::get_attr_appleseed_version);
 
     // Set up user data getters.
-    m_global_user_data_getters[OIIO::ustring("Tn")] = &RendererServices::get_user_data_tn;
-    m_global_user_data_getters[OIIO::ustring("Bn")] = &RendererServices::get_user_data_bn;
-    m_global_user_data_getters[OIIO::ustring("dNdu")] = &RendererServices::get_user_data_dndu;
-    m_global_user_data_getters[OIIO::ustring("dNdv")] = &RendererServices::get_user_data_dndv;
-    m_global_user_data_getters[OIIO::ustring("vertex_color")] = &RendererServices::get_user_data_vertex_color;
+    m_global_user_data_getters.insert(OIIO::ustring("Tn"), &RendererServices::get_user_data_tn);
+    m_global_user_data_getters.insert(OIIO::ustring("Bn"), &RendererServices::get_user_data_bn);
+    m_global_user_data_getters.insert(OIIO::ustring("dNdu"), &RendererServices::get_user_data_dndu);
+    m_global_user_data_getters.insert(OIIO::ustring("dNdv"), &RendererServices::get_user_data_dndv);
+    m_global_user_data_getters.insert(OIIO::ustring("vertex_color"), &RendererServices::get_user_data_vertex_color);
 }
 
 void RendererServices::initialize(TextureStore& texture_store)
@@ -569,12 +569,8 @@ bool RendererServices::get_attribute(
         return false;
 
     // Try global attributes.
-    AttrGetterMapType::const_iterator i = m_global_attr_getters.find(name);
-    if (i != m_global_attr_getters.end())
-    {
-        AttrGetterFun getter = i->second;
-        return (this->*(getter))(sg, derivatives, object, type, name, val);
-    }
+    if (const AttrGetterFun* getter = m_global_attr_getters.get(name))
+        return (this->**getter)(sg, derivatives, object, type, name, val);
 
     // Try user data from the current object.
     if (object.empty())
@@ -602,12 +598,8 @@ bool RendererServices::get_userdata(
     OSL::ShaderGlobals*         sg,
     void*                       val)
 {
-    UserDataGetterMapType::const_iterator i = m_global_user_data_getters.find(name);
-    if (i != m_global_user_data_getters.end())
-    {
-        UserDataGetterFun getter = i->second;
-        return (this->*(getter))(derivatives, name, type, sg, val);
-    }
+    if (const UserDataGetterFun* getter = m_global_user_data_getters.get(name))
+        return (this->**getter)(derivatives, name, type, sg, val);
 
     return false;
 }
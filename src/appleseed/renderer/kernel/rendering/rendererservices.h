@@ -29,6 +29,9 @@
 
 #pragma once
 
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/ustringtable.h"
+
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/vector.h"
@@ -47,7 +50,6 @@
 
 // Standard headers.
 #include <string>
-#include <unordered_map>
 
 // Forward declarations.
 namespace renderer  { class Camera; }
@@ -265,7 +267,7 @@ class RendererServices
         OIIO::ustring               name,
         void*                       val) const;
 
-    typedef std::unordered_map<OIIO::ustring, AttrGetterFun, OIIO::ustringHash> AttrGetterMapType;
+    typedef UStringTable<AttrGetterFun> AttrGetterMapType;
 
     typedef bool (RendererServices::*UserDataGetterFun)(
         bool                        derivatives,
@@ -274,7 +276,7 @@ class RendererServices
         OSL::ShaderGlobals*         sg,
         void*                       val) const;
 
-    typedef std::unordered_map<OIIO::ustring, UserDataGetterFun, OIIO::ustringHash> UserDataGetterMapType;
+    typedef UStringTable<UserDataGetterFun> UserDataGetterMapType;
 
     OIIO::TextureSystem&            m_texture_sys;
     AttrGetterMapType               m_global_attr_getters;
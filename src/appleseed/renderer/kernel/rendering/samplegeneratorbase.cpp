@@ -97,8 +97,23 @@ void SampleGeneratorBase::generate_samples(
         }
     }
 
+    stored += flush_samples(m_samples);
+
     if (stored > 0)
-        buffer.store_samples(stored, &m_samples[0], abort_switch);
+        store_samples(m_samples, buffer, abort_switch);
+}
+
+size_t SampleGeneratorBase::flush_samples(SampleVector& samples)
+{
+    return 0;
+}
+
+void SampleGeneratorBase::store_samples(
+    const SampleVector&         samples,
+    SampleAccumulationBuffer&   buffer,
+    IAbortSwitch&               abort_switch)
+{
+    buffer.store_samples(samples.size(), &samples[0], abort_switch);
 }
 
 void SampleGeneratorBase::signal_invalid_sample()
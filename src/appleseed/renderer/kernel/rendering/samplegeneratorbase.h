@@ -75,6 +75,17 @@ class SampleGeneratorBase
         const size_t                sequence_index,
         SampleVector&               samples) = 0;
 
+    // Store any samples held back by generate_samples() in 'samples'.
+    // Return the number of samples that were stored.
+    virtual size_t flush_samples(
+        SampleVector&               samples);
+
+    // Store the samples generated by a call to generate_samples() into a buffer.
+    virtual void store_samples(
+        const SampleVector&         samples,
+        SampleAccumulationBuffer&   buffer,
+        foundation::IAbortSwitch&   abort_switch);
+
     void signal_invalid_sample();
 
   private:
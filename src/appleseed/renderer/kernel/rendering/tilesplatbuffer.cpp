@@ -0,0 +1,126 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "tilesplatbuffer.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/memory/memory.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// TileSplatBuffer class implementation.
+//
+
+TileSplatBuffer::TileSplatBuffer(
+    const size_t            canvas_width,
+    const size_t            canvas_height,
+    const size_t            tile_width,
+    const size_t            tile_height)
+  : m_canvas_width(canvas_width)
+  , m_canvas_height(canvas_height)
+  , m_tile_width(tile_width)
+  , m_tile_height(tile_height)
+  , m_tile_count_x((canvas_width + tile_width - 1) / tile_width)
+{
+    assert(tile_width > 0);
+    assert(tile_height > 0);
+}
+
+void TileSplatBuffer::build(
+    const size_t            sample_count,
+    const Sample            samples[])
+{
+    clear();
+
+    // Compute the sort key of every sample inside the canvas.
+    const std::uint64_t tile_pixel_count = m_tile_width * m_tile_height;
+    m_entries.reserve(sample_count);
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const Vector2i& pi = samples[i].m_pixel_coords;
+
+        if (pi.x < 0 || pi.y < 0 ||
+            static_cast<size_t>(pi.x) >= m_canvas_width ||
+            static_cast<size_t>(pi.y) >= m_canvas_height)
+            continue;
+
+        const size_t tx = pi.x / m_tile_width;
+        const size_t ty = pi.y / m_tile_height;
+        const size_t x = pi.x - tx * m_tile_width;
+        const size_t y = pi.y - ty * m_tile_height;
+
+        Entry entry;
+        entry.m_key = (ty * m_tile_count_x + tx) * tile_pixel_count + y * m_tile_width + x;
+        entry.m_sample_index = static_cast<std::uint32_t>(i);
+        m_entries.push_back(entry);
+    }
+
+    // Group samples by tile, and by pixel within each tile.
+    std::sort(m_entries.begin(), m_entries.end());
+
+    // Merge samples landing on the same pixel.
+    for (size_t i = 0, e = m_entries.size(); i < e; )
+    {
+        const std::uint64_t key = m_entries[i].m_key;
+        const Sample& first = samples[m_entries[i].m_sample_index];
+
+        Splat splat;
+        splat.m_pixel_coords = Vector2u(first.m_pixel_coords);
+        splat.m_color = first.m_color.rgb();
+        splat.m_weight = 1.0f;
+
+        for (++i; i < e && m_entries[i].m_key == key; ++i)
+        {
+            splat.m_color += samples[m_entries[i].m_sample_index].m_color.rgb();
+            splat.m_weight += 1.0f;
+        }
+
+        m_splats.push_back(splat);
+    }
+}
+
+void TileSplatBuffer::clear()
+{
+    clear_keep_memory(m_entries);
+    clear_keep_memory(m_splats);
+}
+
+}   // namespace renderer
@@ -0,0 +1,134 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/color.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// A buffer that sorts samples by image tile and merges the samples that land on the same
+// pixel, such that a rendering thread can store them into a shared accumulation buffer in
+// bulk, one tile after the other and with a single update per pixel.
+//
+// Each rendering thread is expected to own its own TileSplatBuffer.
+//
+
+class TileSplatBuffer
+  : public foundation::NonCopyable
+{
+  public:
+    struct Splat
+    {
+        foundation::Vector2u    m_pixel_coords;
+        foundation::Color3f     m_color;                // sum of the colors of the merged samples
+        float                   m_weight;               // number of merged samples
+    };
+
+    // Constructor.
+    TileSplatBuffer(
+        const size_t            canvas_width,
+        const size_t            canvas_height,
+        const size_t            tile_width,
+        const size_t            tile_height);
+
+    // Replace the content of the buffer by a set of samples. Samples outside the canvas are ignored.
+    void build(
+        const size_t            sample_count,
+        const Sample            samples[]);
+
+    // Remove all splats from the buffer, but keep memory allocated.
+    void clear();
+
+    // Return the number of splats in the buffer.
+    size_t size() const;
+
+    // Return true if the buffer contains no splat.
+    bool empty() const;
+
+    // Access a given splat. Splats are sorted by tile, then by pixel within each tile.
+    const Splat& operator[](const size_t i) const;
+
+  private:
+    struct Entry
+    {
+        std::uint64_t           m_key;                  // tile index, then pixel index within the tile
+        std::uint32_t           m_sample_index;
+
+        bool operator<(const Entry& rhs) const;
+    };
+
+    const size_t                m_canvas_width;
+    const size_t                m_canvas_height;
+    const size_t                m_tile_width;
+    const size_t                m_tile_height;
+    const size_t                m_tile_count_x;
+    std::vector<Entry>          m_entries;
+    std::vector<Splat>          m_splats;
+};
+
+
+//
+// TileSplatBuffer class implementation.
+//
+
+inline size_t TileSplatBuffer::size() const
+{
+    return m_splats.size();
+}
+
+inline bool TileSplatBuffer::empty() const
+{
+    return m_splats.empty();
+}
+
+inline const TileSplatBuffer::Splat& TileSplatBuffer::operator[](const size_t i) const
+{
+    return m_splats[i];
+}
+
+inline bool TileSplatBuffer::Entry::operator<(const Entry& rhs) const
+{
+    return m_key < rhs.m_key;
+}
+
+}   // namespace renderer
@@ -0,0 +1,206 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/ustring.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A map from a fixed set of OIIO::ustring keys to values.
+//
+// Keys are placed in an open-addressing table indexed by the precomputed hash of the
+// ustrings. The table is grown until no two keys share a slot, if possible, so that
+// looking up a key costs a single masked load and a pointer comparison.
+//
+// Insertions rebuild the table and are meant to happen once, at construction time.
+//
+
+template <typename T>
+class UStringTable
+{
+  public:
+    // Constructor.
+    UStringTable();
+
+    // Insert a key/value pair, or replace the value of an existing key.
+    void insert(const OIIO::ustring& key, const T& value);
+
+    // Return the value associated with a given key, or nullptr if the key is not present.
+    const T* get(const OIIO::ustring& key) const;
+
+    // Return the number of keys.
+    size_t size() const;
+
+    // Return true if no two keys share a slot.
+    bool is_perfect() const;
+
+  private:
+    typedef std::pair<OIIO::ustring, T> Entry;
+
+    // Try to make the table collision-free up to this many slots per key.
+    enum { MaxSlotsPerKey = 64 };
+
+    std::vector<Entry>  m_entries;
+    std::vector<Entry>  m_slots;
+    size_t              m_mask;
+    bool                m_perfect;
+
+    void rebuild();
+    bool fill_slots(const size_t slot_count, const bool allow_collisions);
+};
+
+
+//
+// UStringTable class implementation.
+//
+
+template <typename T>
+UStringTable<T>::UStringTable()
+  : m_slots(1)
+  , m_mask(0)
+  , m_perfect(true)
+{
+}
+
+template <typename T>
+void UStringTable<T>::insert(const OIIO::ustring& key, const T& value)
+{
+    assert(!key.empty());
+
+    for (Entry& entry : m_entries)
+    {
+        if (entry.first == key)
+        {
+            entry.second = value;
+            rebuild();
+            return;
+        }
+    }
+
+    m_entries.emplace_back(key, value);
+    rebuild();
+}
+
+template <typename T>
+inline const T* UStringTable<T>::get(const OIIO::ustring& key) const
+{
+    // Empty slots hold empty keys: an empty key would match them.
+    if (key.empty())
+        return nullptr;
+
+    size_t index = key.hash() & m_mask;
+
+    while (true)
+    {
+        const Entry& slot = m_slots[index];
+
+        if (slot.first == key)
+            return &slot.second;
+
+        if (m_perfect || slot.first.empty())
+            return nullptr;
+
+        index = (index + 1) & m_mask;
+    }
+}
+
+template <typename T>
+inline size_t UStringTable<T>::size() const
+{
+    return m_entries.size();
+}
+
+template <typename T>
+inline bool UStringTable<T>::is_perfect() const
+{
+    return m_perfect;
+}
+
+template <typename T>
+void UStringTable<T>::rebuild()
+{
+    // Leave at least one empty slot so that unsuccessful probes terminate.
+    const size_t min_slot_count =
+        foundation::next_pow2<size_t>(m_entries.size() + 1);
+    const size_t max_slot_count =
+        foundation::next_pow2<size_t>(m_entries.size() * MaxSlotsPerKey);
+
+    for (size_t slot_count = min_slot_count; slot_count <= max_slot_count; slot_count *= 2)
+    {
+        if (fill_slots(slot_count, false))
+        {
+            m_perfect = true;
+            return;
+        }
+    }
+
+    fill_slots(min_slot_count * 2, true);
+    m_perfect = false;
+}
+
+template <typename T>
+bool UStringTable<T>::fill_slots(const size_t slot_count, const bool allow_collisions)
+{
+    m_slots.assign(slot_count, Entry());
+    m_mask = slot_count - 1;
+
+    for (const Entry& entry : m_entries)
+    {
+        size_t index = entry.first.hash() & m_mask;
+
+        while (!m_slots[index].first.empty())
+        {
+            if (!allow_collisions)
+                return false;
+
+            index = (index + 1) & m_mask;
+        }
+
+        m_slots[index] = entry;
+    }
+
+    return true;
+}
+
+}   // namespace renderer
@@ -59,6 +59,9 @@ OSLShaderGroupExec::OSLShaderGroupExec(OSLShadingSystem& shading_system, Arena&
 
 OSLShaderGroupExec::~OSLShaderGroupExec()
 {
+    for (const auto& entry : m_uniform_closures)
+        m_osl_shading_system.release_context(entry.second.m_context);
+
     if (m_osl_shading_context)
         m_osl_shading_system.release_context(m_osl_shading_context);
 
@@ -212,12 +215,51 @@ void OSLShaderGroupExec::do_execute(
         ray_flags,
         m_osl_shading_system.renderer());
 
+    if (shader_group.is_uniform())
+    {
+        execute_uniform(
+            shader_group,
+            shading_point.get_osl_shader_globals());
+        return;
+    }
+
     m_osl_shading_system.execute(
         m_osl_shading_context,
         *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group()),
         shading_point.get_osl_shader_globals());
 }
 
+void OSLShaderGroupExec::execute_uniform(
+    const ShaderGroup&              shader_group,
+    OSL::ShaderGlobals&             shader_globals) const
+{
+    assert(shader_group.is_uniform());
+
+    // Uniform shader groups can still query the ray type and the facing.
+    const UniformClosuresKey key(
+        &shader_group,
+        shader_globals.raytype * 2 + (shader_globals.backfacing ? 1 : 0));
+
+    UniformClosuresMap::const_iterator i = m_uniform_closures.find(key);
+
+    if (i == m_uniform_closures.end())
+    {
+        UniformClosures closures;
+        closures.m_context = m_osl_shading_system.get_context(m_osl_thread_info);
+
+        m_osl_shading_system.execute(
+            closures.m_context,
+            *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group()),
+            shader_globals);
+
+        closures.m_closure = shader_globals.Ci;
+
+        i = m_uniform_closures.insert(std::make_pair(key, closures)).first;
+    }
+
+    shader_globals.Ci = i->second.m_closure;
+}
+
 void OSLShaderGroupExec::choose_bsdf_closure_shading_basis(
     const ShadingPoint&             shading_point,
     const Vector2f&                 s) const
@@ -43,6 +43,12 @@
 #include "OSL/oslversion.h"
 #include "foundation/platform/_endoslheaders.h"
 
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
+// Standard headers.
+#include <utility>
+
 // Forward declarations.
 namespace foundation    { class Arena; }
 namespace renderer      { class OSLShadingSystem; }
@@ -81,6 +87,19 @@ class OSLShaderGroupExec
     char*                               m_osl_mem_pool_start;
     mutable size_t                      m_osl_mem_used;
 
+    // Closure trees of uniform shader groups, computed once per ray type and facing.
+    // Each tree lives in its own OSL context which is never executed again.
+    struct UniformClosures
+    {
+        OSL::ShadingContext*            m_context;
+        OSL::ClosureColor*              m_closure;
+    };
+
+    typedef std::pair<const ShaderGroup*, int> UniformClosuresKey;
+    typedef boost::unordered_map<UniformClosuresKey, UniformClosures> UniformClosuresMap;
+
+    mutable UniformClosuresMap          m_uniform_closures;
+
     void execute_shading(
         const ShaderGroup&              shader_group,
         const ShadingPoint&             shading_point) const;
@@ -121,6 +140,11 @@ class OSLShaderGroupExec
         const ShadingPoint&             shading_point,
         const VisibilityFlags::Type     ray_flags) const;
 
+    // Set the closure tree of a uniform shader group into already initialized shader globals.
+    void execute_uniform(
+        const ShaderGroup&              shader_group,
+        OSL::ShaderGlobals&             shader_globals) const;
+
     void choose_bsdf_closure_shading_basis(
         const ShadingPoint&             shading_point,
         const foundation::Vector2f&     s) const;
@@ -34,6 +34,19 @@
 #include "renderer/kernel/rendering/rendererservices.h"
 #include "renderer/kernel/texturing/oiiotexturesystem.h"
 
+// appleseed.foundation headers.
+#include "foundation/string/string.h"
+#include "foundation/utility/searchpaths.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <vector>
+
+using namespace foundation;
+namespace bf = boost::filesystem;
+
 namespace renderer
 {
 
@@ -54,6 +67,59 @@ void OSLShadingSystem::release()
     delete this;
 }
 
+OSL::ShaderGroupRef OSLShadingSystem::find_shader_group(const std::string& key) const
+{
+    const ShaderGroupCache::const_iterator i = m_shader_group_cache.find(key);
+    return i != m_shader_group_cache.end() ? i->second.lock() : OSL::ShaderGroupRef();
+}
+
+void OSLShadingSystem::insert_shader_group(
+    const std::string&          key,
+    const OSL::ShaderGroupRef&  shader_group)
+{
+    m_shader_group_cache[key] = shader_group;
+}
+
+void OSLShadingSystem::purge_shader_group_cache()
+{
+    for (ShaderGroupCache::iterator i = m_shader_group_cache.begin(); i != m_shader_group_cache.end(); )
+    {
+        if (i->second.expired())
+            i = m_shader_group_cache.erase(i);
+        else
+            ++i;
+    }
+}
+
+std::string OSLShadingSystem::find_shader_file(const char* shader_name)
+{
+    std::string filename = shader_name;
+    if (bf::path(filename).extension() != ".oso")
+        filename += ".oso";
+
+    // Like OSL, look in the current directory first, then in the shader search paths.
+    if (bf::exists(filename))
+        return filename;
+
+    std::string search_paths;
+    getattribute("searchpath:shader", search_paths);
+
+    std::vector<std::string> dirs;
+    split(search_paths, std::string(1, SearchPaths::osl_path_separator()), dirs);
+
+    for (const std::string& dir : dirs)
+    {
+        if (dir.empty())
+            continue;
+
+        const bf::path path = bf::path(dir) / filename;
+        if (bf::exists(path))
+            return path.string();
+    }
+
+    return std::string();
+}
+
 
 //
 // OSLShadingSystemFactory class implementation.
@@ -34,6 +34,13 @@
 #include "OSL/oslversion.h"
 #include "foundation/platform/_endoslheaders.h"
 
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
+// Standard headers.
+#include <memory>
+#include <string>
+
 // Forward declarations.
 namespace renderer { class OIIOErrorHandler; }
 namespace renderer { class OIIOTextureSystem; }
@@ -52,9 +59,35 @@ class OSLShadingSystem
   public:
     void release();
 
+    // Return the shader group previously registered under a given content key,
+    // or a null reference if there is none or if it has since been released.
+    OSL::ShaderGroupRef find_shader_group(const std::string& key) const;
+
+    // Register a shader group under a content key so that shader groups with
+    // identical shaders, parameters and connections can share a single OSL
+    // shader group, and thus a single optimization and JIT compilation.
+    void insert_shader_group(
+        const std::string&          key,
+        const OSL::ShaderGroupRef&  shader_group);
+
+    // Forget the shader groups that were released since the last call.
+    // Meant to be called once per render, before shader groups are set up.
+    void purge_shader_group_cache();
+
+    // Return the path of the compiled shader (.oso file) that would be loaded for
+    // a given shader name, or an empty string if no such file can be found.
+    std::string find_shader_file(const char* shader_name);
+
   private:
     friend class OSLShadingSystemFactory;
 
+    typedef boost::unordered_map<
+        std::string,
+        std::weak_ptr<OSL::ShaderGroup>
+    > ShaderGroupCache;
+
+    ShaderGroupCache m_shader_group_cache;
+
     OSLShadingSystem(
         RendererServices*   renderer = nullptr,
         OIIOTextureSystem*  texturesystem = nullptr,
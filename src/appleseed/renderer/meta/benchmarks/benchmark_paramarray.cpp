@@ -0,0 +1,90 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/math/transform.h"
+#include "foundation/memory/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+
+BENCHMARK_SUITE(Renderer_Utility_ParamArray)
+{
+    struct Fixture
+    {
+        ParamArray          m_params;
+        StringDictionary    m_material_mappings;
+        float               m_dummy;
+
+        Fixture()
+          : m_dummy(0.0f)
+        {
+            m_params.insert("flip_normals", "false");
+            m_params.insert("medium_priority", "0");
+            m_params.insert("shadow_terminator_correction", "0.1");
+            m_params.insert("sss_set_id", "");
+            m_params.insert("visibility", ParamArray().insert("camera", "true").insert("shadow", "true"));
+
+            m_material_mappings.insert("default", "material");
+        }
+    };
+
+    // Entity construction.
+    BENCHMARK_CASE_F(CreateObjectInstance, Fixture)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(
+            ObjectInstanceFactory::create(
+                "object_instance",
+                m_params,
+                "object",
+                Transformd::identity(),
+                m_material_mappings,
+                m_material_mappings));
+    }
+
+    // Parameter retrievals performed by entities at the beginning of every (re)started render.
+    BENCHMARK_CASE_F(GetOptional_RepeatedRetrievals, Fixture)
+    {
+        m_dummy += m_params.get_optional<float>("shadow_terminator_correction", 0.0f);
+        m_dummy += m_params.get_optional<bool>("flip_normals", false) ? 1.0f : 0.0f;
+        m_dummy += m_params.get_optional<int>("medium_priority", 0);
+        m_dummy += static_cast<float>(m_params.get_optional<std::string>("sss_set_id", "").size());
+        m_dummy += m_params.get_optional<float>("missing", 1.0f);
+    }
+}
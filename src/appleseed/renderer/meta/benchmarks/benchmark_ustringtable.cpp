@@ -0,0 +1,127 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/ustringtable.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/ustring.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <cstddef>
+#include <unordered_map>
+
+using namespace foundation;
+using namespace renderer;
+
+BENCHMARK_SUITE(Renderer_Kernel_Rendering_UStringTable)
+{
+    // The attribute names known to RendererServices.
+    const char* AttributeNames[] =
+    {
+        "object:object_instance_id",
+        "object:object_instance_index",
+        "object:assembly_instance_id",
+        "object:assembly_name",
+        "object:assembly_instance_name",
+        "object:object_instance_name",
+        "object:object_name",
+        "camera:resolution",
+        "camera:projection",
+        "camera:pixelaspect",
+        "camera:screen_window",
+        "camera:fov",
+        "camera:clip",
+        "camera:clip_near",
+        "camera:clip_far",
+        "camera:shutter",
+        "camera:shutter_open",
+        "camera:shutter_close",
+        "path:ray_depth",
+        "path:ray_length",
+        "path:ray_ior",
+        "path:ray_has_differentials",
+        "surface_shader:diffuse",
+        "surface_shader:glossy",
+        "surface_shader:emission",
+        "appleseed:version_major",
+        "appleseed:version_minor",
+        "appleseed:version_patch",
+        "appleseed:version"
+    };
+
+    const size_t AttributeCount = sizeof(AttributeNames) / sizeof(AttributeNames[0]);
+
+    struct Fixture
+    {
+        std::unordered_map<OIIO::ustring, int, OIIO::ustringHash>   m_map;
+        UStringTable<int>                                           m_table;
+        OIIO::ustring                                               m_queries[AttributeCount + 1];
+        int                                                         m_dummy;
+
+        Fixture()
+          : m_dummy(0)
+        {
+            for (size_t i = 0; i < AttributeCount; ++i)
+            {
+                const OIIO::ustring name(AttributeNames[i]);
+                m_map[name] = static_cast<int>(i);
+                m_table.insert(name, static_cast<int>(i));
+                m_queries[i] = name;
+            }
+
+            // Also query a name that is not present, as user data lookups do.
+            m_queries[AttributeCount] = OIIO::ustring("vertex_color");
+        }
+    };
+
+    BENCHMARK_CASE_F(UnorderedMap_Find, Fixture)
+    {
+        for (size_t i = 0; i < AttributeCount + 1; ++i)
+        {
+            const auto it = m_map.find(m_queries[i]);
+            if (it != m_map.end())
+                m_dummy += it->second;
+        }
+    }
+
+    BENCHMARK_CASE_F(UStringTable_Get, Fixture)
+    {
+        for (size_t i = 0; i < AttributeCount + 1; ++i)
+        {
+            if (const int* value = m_table.get(m_queries[i]))
+                m_dummy += *value;
+        }
+    }
+}
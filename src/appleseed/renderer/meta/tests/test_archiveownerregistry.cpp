@@ -0,0 +1,160 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/scene/archiveownerregistry.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/memory/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Scene_ArchiveOwnerRegistry)
+{
+    TEST_CASE(GetEntry_GivenSameFilePathTwice_ReturnsSameEntry)
+    {
+        ArchiveOwnerRegistry registry;
+
+        const std::shared_ptr<ArchiveOwnerRegistry::Entry> entry1 = registry.get_entry("archive.appleseed");
+        entry1->m_has_owner = true;
+
+        const std::shared_ptr<ArchiveOwnerRegistry::Entry> entry2 = registry.get_entry("archive.appleseed");
+
+        EXPECT_EQ(entry1.get(), entry2.get());
+        EXPECT_TRUE(entry2->m_has_owner);
+    }
+
+    TEST_CASE(GetEntry_GivenDifferentFilePaths_ReturnsDifferentEntries)
+    {
+        ArchiveOwnerRegistry registry;
+
+        const std::shared_ptr<ArchiveOwnerRegistry::Entry> entry1 = registry.get_entry("archive1.appleseed");
+        entry1->m_has_owner = true;
+
+        const std::shared_ptr<ArchiveOwnerRegistry::Entry> entry2 = registry.get_entry("archive2.appleseed");
+
+        EXPECT_NEQ(entry1.get(), entry2.get());
+        EXPECT_FALSE(entry2->m_has_owner);
+    }
+
+    //
+    // The test scene has the following assembly hierarchy:
+    //
+    //   scene
+    //     owner
+    //     parent
+    //       child
+    //
+
+    struct TestScene
+    {
+        auto_release_ptr<Scene>         m_scene;
+        Assembly*                       m_owner;
+        Assembly*                       m_parent;
+        Assembly*                       m_child;
+        ArchiveOwnerRegistry::Entry     m_entry;
+
+        TestScene()
+          : m_scene(SceneFactory::create())
+        {
+            auto_release_ptr<Assembly> owner(AssemblyFactory().create("owner", ParamArray()));
+            auto_release_ptr<Assembly> parent(AssemblyFactory().create("parent", ParamArray()));
+            auto_release_ptr<Assembly> child(AssemblyFactory().create("child", ParamArray()));
+
+            m_owner = owner.get();
+            m_parent = parent.get();
+            m_child = child.get();
+
+            m_parent->assemblies().insert(child);
+            m_scene->assemblies().insert(owner);
+            m_scene->assemblies().insert(parent);
+        }
+
+        void set_owner(const Assembly& owner)
+        {
+            m_entry.m_has_owner = true;
+            m_entry.m_owner_uid = owner.get_uid();
+            m_entry.m_owner_name = owner.get_name();
+        }
+    };
+
+    TEST_CASE_F(FindArchiveOwner_GivenEntryWithoutOwner_ReturnsNull, TestScene)
+    {
+        EXPECT_EQ(0, find_archive_owner(*m_child, m_entry));
+    }
+
+    TEST_CASE_F(FindArchiveOwner_GivenOwnerInParent_ReturnsOwner, TestScene)
+    {
+        set_owner(*m_owner);
+
+        EXPECT_EQ(m_owner, find_archive_owner(*m_parent, m_entry));
+    }
+
+    TEST_CASE_F(FindArchiveOwner_GivenOwnerInGrandparent_ReturnsOwner, TestScene)
+    {
+        set_owner(*m_owner);
+
+        EXPECT_EQ(m_owner, find_archive_owner(*m_child, m_entry));
+    }
+
+    TEST_CASE_F(FindArchiveOwner_GivenOwnerIsParent_ReturnsNull, TestScene)
+    {
+        set_owner(*m_parent);
+
+        EXPECT_EQ(0, find_archive_owner(*m_child, m_entry));
+    }
+
+    TEST_CASE_F(FindArchiveOwner_GivenOwnerHiddenByAssemblyOfSameName_ReturnsNull, TestScene)
+    {
+        set_owner(*m_owner);
+
+        // An assembly named like the owner in the parent of `child` hides the owner.
+        m_parent->assemblies().insert(AssemblyFactory().create("owner", ParamArray()));
+
+        EXPECT_EQ(0, find_archive_owner(*m_child, m_entry));
+    }
+
+    TEST_CASE_F(FindArchiveOwner_GivenOwnerReplacedByAssemblyOfSameName_ReturnsNull, TestScene)
+    {
+        set_owner(*m_owner);
+
+        m_scene->assemblies().remove(m_owner);
+        m_scene->assemblies().insert(AssemblyFactory().create("owner", ParamArray()));
+
+        EXPECT_EQ(0, find_archive_owner(*m_child, m_entry));
+    }
+}
@@ -0,0 +1,119 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/modeling/object/asyncmeshobjectreader.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Object_AsyncMeshObjectReader)
+{
+    void release_objects(MeshObjectArray& objects)
+    {
+        for (size_t i = 0, e = objects.size(); i < e; ++i)
+            objects[i]->release();
+    }
+
+    TEST_CASE(TakeObjects_GivenSuccessfulRead_ReturnsMeshObjects)
+    {
+        AsyncMeshObjectReader reader(2);
+        const size_t index =
+            reader.enqueue(
+                SearchPaths(),
+                "object",
+                ParamArray().insert("filename", "unit tests/inputs/test_objmeshfilereader_quad.obj"));
+        reader.wait();
+
+        MeshObjectArray objects;
+        const bool success = reader.take_objects(index, objects);
+
+        ASSERT_TRUE(success);
+        ASSERT_EQ(1, objects.size());
+        EXPECT_EQ(std::string("object.quad"), objects[0]->get_name());
+        EXPECT_EQ(2, objects[0]->get_triangle_count());
+
+        release_objects(objects);
+    }
+
+    TEST_CASE(TakeObjects_GivenFailedRead_ReturnsFalse)
+    {
+        AsyncMeshObjectReader reader(2);
+        const size_t index =
+            reader.enqueue(
+                SearchPaths(),
+                "object",
+                ParamArray().insert("filename", "unit tests/inputs/this file does not exist.obj"));
+        reader.wait();
+
+        MeshObjectArray objects;
+        const bool success = reader.take_objects(index, objects);
+
+        EXPECT_FALSE(success);
+        EXPECT_TRUE(objects.empty());
+    }
+
+    TEST_CASE(Enqueue_GivenMultipleReads_ReturnsConsecutiveIndices)
+    {
+        AsyncMeshObjectReader reader(4);
+
+        for (size_t i = 0; i < 8; ++i)
+        {
+            const size_t index =
+                reader.enqueue(
+                    SearchPaths(),
+                    ("object" + std::to_string(i)).c_str(),
+                    ParamArray().insert("filename", "unit tests/inputs/test_objmeshfilereader_cube.obj"));
+
+            EXPECT_EQ(i, index);
+        }
+
+        reader.wait();
+
+        EXPECT_EQ(8, reader.size());
+
+        // Unclaimed mesh objects are deleted with the reader.
+        MeshObjectArray objects;
+        EXPECT_TRUE(reader.take_objects(3, objects));
+        EXPECT_FALSE(objects.empty());
+
+        release_objects(objects);
+    }
+}
@@ -28,15 +28,41 @@
 //
 
 // appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
 #include "renderer/kernel/lighting/backwardlightsampler.h"
+#include "renderer/kernel/lighting/lightsample.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/camera/pinholecamera.h"
+#include "renderer/modeling/edf/diffuseedf.h"
+#include "renderer/modeling/material/genericmaterial.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
 
 // appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/image/color.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
 #include "foundation/memory/autoreleaseptr.h"
+#include "foundation/meshio/binarymeshfilewriter.h"
+#include "foundation/meshio/imeshwalker.h"
+#include "foundation/utility/searchpaths.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 using namespace renderer;
 
@@ -50,4 +76,254 @@ TEST_SUITE(Renderer_Kernel_Lighting_BackwardLightSampler)
 
         EXPECT_FALSE(backward_light_sampler.has_lights());
     }
+
+    struct EmittingTriangleScene
+      : public TestSceneBase
+    {
+        EmittingTriangleScene()
+        {
+            create_color_entity("white", Color3f(1.0f));
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            assembly->edfs().insert(
+                DiffuseEDFFactory().create(
+                    "edf",
+                    ParamArray().insert("radiance", "white")));
+
+            assembly->materials().insert(
+                GenericMaterialFactory().create(
+                    "material",
+                    ParamArray().insert("edf", "edf")));
+
+            auto_release_ptr<MeshObject> mesh_object(
+                MeshObjectFactory().create("triangle", ParamArray()));
+            mesh_object->push_vertex(GVector3(0.0f, 0.0f, 0.0f));
+            mesh_object->push_vertex(GVector3(1.0f, 0.0f, 0.0f));
+            mesh_object->push_vertex(GVector3(0.0f, 1.0f, 0.0f));
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0));
+            mesh_object->push_material_slot("default");
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            StringDictionary material_mappings;
+            material_mappings.insert("default", "material");
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "triangle_inst",
+                    ParamArray(),
+                    "triangle",
+                    Transformd::identity(),
+                    material_mappings,
+                    material_mappings));
+
+            m_scene.assemblies().insert(assembly);
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+        }
+    };
+
+    TEST_CASE_F(OnFrameBegin_GivenLightTreeAndMovedEmitter_SamplesEmitterAtNewPosition, StaticTestSceneContext<EmittingTriangleScene>)
+    {
+        BackwardLightSampler backward_light_sampler(
+            m_scene,
+            ParamArray().insert("algorithm", "lighttree"));
+
+        // First frame.
+        backward_light_sampler.on_frame_begin();
+
+        // Move the emitter before the second frame.
+        AssemblyInstance* assembly_instance = m_scene.assembly_instances().get_by_name("assembly_inst");
+        assembly_instance->transform_sequence().set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(10.0, 0.0, 0.0))));
+        backward_light_sampler.on_frame_begin();
+
+        ShadingPoint shading_point;
+        LightSample light_samples[BackwardLightSampler::MaxLightSetSampleCount];
+        const size_t light_sample_count =
+            backward_light_sampler.sample_lightset(
+                ShadingRay::Time(),
+                Vector3f(0.5f, 0.5f, 0.5f),
+                shading_point,
+                light_samples);
+
+        ASSERT_EQ(1, light_sample_count);
+        EXPECT_TRUE(light_samples[0].m_point.x >= 10.0);
+        EXPECT_TRUE(light_samples[0].m_point.x <= 11.0);
+    }
+
+    // A single triangle in the z = 0 plane, with a single material slot.
+    struct TriangleMeshWalker
+      : public IMeshWalker
+    {
+        const char* get_name() const override
+        {
+            return "triangle";
+        }
+
+        size_t get_vertex_count() const override
+        {
+            return 3;
+        }
+
+        Vector3d get_vertex(const size_t i) const override
+        {
+            return Vector3d(static_cast<double>(i == 1), static_cast<double>(i == 2), 0.0);
+        }
+
+        size_t get_vertex_normal_count() const override
+        {
+            return 0;
+        }
+
+        Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return Vector3d(0.0);
+        }
+
+        size_t get_tex_coords_count() const override
+        {
+            return 0;
+        }
+
+        Vector2d get_tex_coords(const size_t i) const override
+        {
+            return Vector2d(0.0);
+        }
+
+        size_t get_material_slot_count() const override
+        {
+            return 1;
+        }
+
+        const char* get_material_slot(const size_t i) const override
+        {
+            return "default";
+        }
+
+        size_t get_face_count() const override
+        {
+            return 1;
+        }
+
+        size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return 3;
+        }
+
+        size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            return vertex_index;
+        }
+
+        size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            return ~size_t(0);
+        }
+
+        size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            return ~size_t(0);
+        }
+
+        size_t get_face_material(const size_t face_index) const override
+        {
+            return 0;
+        }
+    };
+
+    const char* DeferredMeshFilename = "unit tests/outputs/test_backwardlightsampler_triangle.binarymesh";
+
+    struct DeferredEmittingTriangleScene
+      : public TestSceneBase
+    {
+        DeferredEmittingTriangleScene()
+        {
+            {
+                BinaryMeshFileWriter writer(DeferredMeshFilename, BinaryMeshFileWriter::PageAligned);
+                writer.write(TriangleMeshWalker());
+            }
+
+            create_color_entity("white", Color3f(1.0f));
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            assembly->edfs().insert(
+                DiffuseEDFFactory().create(
+                    "edf",
+                    ParamArray().insert("radiance", "white")));
+
+            assembly->materials().insert(
+                GenericMaterialFactory().create(
+                    "material",
+                    ParamArray().insert("edf", "edf")));
+
+            // Only the bounding box and the material slots of the mesh are read here.
+            MeshObjectArray objects;
+            MeshObjectReader::read(
+                SearchPaths(),
+                "triangle",
+                ParamArray().insert("filename", DeferredMeshFilename),
+                objects,
+                MeshObjectReader::DeferGeometryLoading);
+            for (size_t i = 0; i < objects.size(); ++i)
+                assembly->objects().insert(auto_release_ptr<Object>(objects[i]));
+
+            StringDictionary material_mappings;
+            material_mappings.insert("default", "material");
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "triangle_inst",
+                    ParamArray(),
+                    "triangle.triangle",
+                    Transformd::identity(),
+                    material_mappings,
+                    material_mappings));
+
+            m_scene.assemblies().insert(assembly);
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+        }
+    };
+
+    TEST_CASE_F(SampleLightset_GivenDeferredEmittingMesh_SamplesEmitter, StaticTestSceneContext<DeferredEmittingTriangleScene>)
+    {
+        const MeshObject* mesh_object =
+            static_cast<const MeshObject*>(
+                m_scene.assemblies().get_by_name("assembly")->objects().get_by_name("triangle.triangle"));
+        ASSERT_TRUE(mesh_object->has_deferred_geometry());
+
+        BackwardLightSampler backward_light_sampler(m_scene);
+
+        ASSERT_TRUE(backward_light_sampler.has_hittable_lights());
+
+        ShadingPoint shading_point;
+        LightSample light_samples[BackwardLightSampler::MaxLightSetSampleCount];
+        const size_t light_sample_count =
+            backward_light_sampler.sample_lightset(
+                ShadingRay::Time(),
+                Vector3f(0.5f, 0.5f, 0.5f),
+                shading_point,
+                light_samples);
+
+        ASSERT_EQ(1, light_sample_count);
+        EXPECT_TRUE(light_samples[0].m_point.x >= 0.0);
+        EXPECT_TRUE(light_samples[0].m_point.x <= 1.0);
+        EXPECT_TRUE(light_samples[0].m_point.y >= 0.0);
+        EXPECT_TRUE(light_samples[0].m_point.y <= 1.0);
+        EXPECT_EQ(0.0, light_samples[0].m_point.z);
+    }
 }
@@ -0,0 +1,150 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/bdpt/bdptmisweight.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_BDPT_MISWeight)
+{
+    // Area densities of the vertices of a path, indexed from 1 to n - 1.
+    struct Densities
+    {
+        std::vector<float>  m_light;
+        std::vector<float>  m_camera;
+
+        Densities(MersenneTwister& rng, const size_t n)
+          : m_light(n)
+          , m_camera(n)
+        {
+            for (size_t i = 1; i < n; ++i)
+            {
+                m_light[i] = rand_float1(rng, 0.01f, 10.0f);
+                m_camera[i] = rand_float1(rng, 0.01f, 10.0f);
+            }
+
+            // The density of the shading point when sampled from the camera.
+            m_camera[n - 1] = 1.0f;
+        }
+    };
+
+    // Density of the path when sampled with p light vertices, as the former implementation computed it.
+    float compute_path_density(const Densities& densities, const size_t n, const size_t p)
+    {
+        float result = 1.0f;
+
+        for (size_t i = 1; i <= p; ++i)
+            result *= densities.m_light[i];
+
+        for (size_t i = p + 1; i < n; ++i)
+            result *= densities.m_camera[i];
+
+        return result;
+    }
+
+    // Balance heuristic weight, as the former implementation computed it: quadratic in path length.
+    float compute_reference_mis_weight(const Densities& densities, const size_t s, const size_t t)
+    {
+        const size_t n = s + t;
+
+        float denominator = 0.0f;
+        for (size_t p = 0; p <= n - 2; ++p)
+            denominator += compute_path_density(densities, n, p);
+
+        return compute_path_density(densities, n, s) / denominator;
+    }
+
+    float compute_mis_weight(const Densities& densities, const size_t s, const size_t t)
+    {
+        return
+            compute_bdpt_mis_weight(
+                s,
+                t,
+                [&densities](const size_t i) { return densities.m_light[i]; },
+                [&densities](const size_t i) { return densities.m_camera[i]; });
+    }
+
+    TEST_CASE(ComputeBDPTMISWeight_MatchesQuadraticSumOfPathDensities)
+    {
+        MersenneTwister rng;
+
+        for (size_t n = 2; n <= 12; ++n)
+        {
+            for (size_t iteration = 0; iteration < 100; ++iteration)
+            {
+                const Densities densities(rng, n);
+
+                for (size_t s = 0; s + 2 <= n; ++s)
+                {
+                    const float expected = compute_reference_mis_weight(densities, s, n - s);
+                    const float weight = compute_mis_weight(densities, s, n - s);
+
+                    EXPECT_FEQ_EPS(expected, weight, 1.0e-4f);
+                }
+            }
+        }
+    }
+
+    TEST_CASE(ComputeBDPTMISWeight_WeightsOfAllStrategiesSumToOne)
+    {
+        MersenneTwister rng;
+
+        const size_t n = 8;
+        const Densities densities(rng, n);
+
+        float sum = 0.0f;
+        for (size_t s = 0; s + 2 <= n; ++s)
+            sum += compute_mis_weight(densities, s, n - s);
+
+        EXPECT_FEQ_EPS(1.0f, sum, 1.0e-4f);
+    }
+
+    TEST_CASE(ComputeBDPTMISWeight_GivenZeroLightDensityOfLightVertex_ReturnsZero)
+    {
+        MersenneTwister rng;
+
+        const size_t n = 6;
+        Densities densities(rng, n);
+        densities.m_light[2] = 0.0f;
+
+        EXPECT_EQ(0.0f, compute_mis_weight(densities, 3, n - 3));
+        EXPECT_EQ(0.0f, compute_reference_mis_weight(densities, 3, n - 3));
+    }
+}
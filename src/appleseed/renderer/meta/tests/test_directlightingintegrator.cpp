@@ -0,0 +1,292 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/lighting/backwardlightsampler.h"
+#include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/materialsamplers.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/rendererservices.h"
+#include "renderer/kernel/shading/directshadingcomponents.h"
+#include "renderer/kernel/shading/oslshadergroupexec.h"
+#include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/oiiotexturesystem.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/edf/diffuseedf.h"
+#include "renderer/modeling/material/genericmaterial.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/image/color.h"
+#include "foundation/math/dual.h"
+#include "foundation/math/mis.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/memory/arena.h"
+#include "foundation/memory/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/texture.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_DirectLightingIntegrator)
+{
+    struct EmittingTriangleScene
+      : public TestSceneBase
+    {
+        EmittingTriangleScene()
+        {
+            create_color_entity("white", Color3f(1.0f));
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            assembly->edfs().insert(
+                DiffuseEDFFactory().create(
+                    "edf",
+                    ParamArray().insert("radiance", "white")));
+
+            assembly->materials().insert(
+                GenericMaterialFactory().create(
+                    "material",
+                    ParamArray().insert("edf", "edf")));
+
+            // A triangle in the z = 0 plane, emitting toward +Z.
+            auto_release_ptr<MeshObject> mesh_object(
+                MeshObjectFactory().create("triangle", ParamArray()));
+            mesh_object->push_vertex(GVector3(0.0f, 0.0f, 0.0f));
+            mesh_object->push_vertex(GVector3(1.0f, 0.0f, 0.0f));
+            mesh_object->push_vertex(GVector3(0.0f, 1.0f, 0.0f));
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0));
+            mesh_object->push_material_slot("default");
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            StringDictionary material_mappings;
+            material_mappings.insert("default", "material");
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "triangle_inst",
+                    ParamArray(),
+                    "triangle",
+                    Transformd::identity(),
+                    material_mappings));
+
+            m_scene.assemblies().insert(assembly);
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+        }
+    };
+
+    struct Fixture
+      : public StaticTestSceneContext<EmittingTriangleScene>
+    {
+        TraceContext                            m_trace_context;
+        TextureStore                            m_texture_store;
+        TextureCache                            m_texture_cache;
+        Intersector                             m_intersector;
+        std::shared_ptr<OIIOTextureSystem>      m_texture_system;
+        RendererServices                        m_renderer_services;
+        std::shared_ptr<OSLShadingSystem>       m_shading_system;
+        Arena                                   m_arena;
+        OSLShaderGroupExec                      m_shading_group_exec;
+        Tracer                                  m_tracer;
+        ShadingContext                          m_shading_context;
+
+        Fixture()
+          : m_trace_context(m_scene)
+          , m_texture_store(m_scene)
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+          , m_texture_system(
+                OIIOTextureSystemFactory::create(),
+                [](OIIOTextureSystem* object) { object->release(); })
+          , m_renderer_services(
+                m_project,
+                reinterpret_cast<OIIO::TextureSystem&>(*m_texture_system))
+          , m_shading_system(
+                OSLShadingSystemFactory::create(&m_renderer_services, m_texture_system.get()),
+                [](OSLShadingSystem* object) { object->release(); })
+          , m_shading_group_exec(*m_shading_system, m_arena)
+          , m_tracer(m_scene, m_intersector, m_shading_group_exec)
+          , m_shading_context(
+                m_intersector,
+                m_tracer,
+                m_texture_cache,
+                *m_texture_system,
+                m_shading_group_exec,
+                m_arena,
+                0)  // thread index
+        {
+            m_trace_context.update();
+        }
+    };
+
+    // A material sampler with a constant response, located above the emitting triangle,
+    // that records the positions toward which shadow rays are traced instead of tracing them.
+    class RecordingMaterialSampler
+      : public IMaterialSampler
+    {
+      public:
+        mutable std::vector<Vector3d> m_shadow_ray_targets;
+
+        RecordingMaterialSampler()
+          : m_point(0.25, 0.25, 1.0)
+        {
+        }
+
+        const Vector3d& get_point() const override
+        {
+            return m_point;
+        }
+
+        const ShadingPoint& get_shading_point() const override
+        {
+            return m_shading_point;
+        }
+
+        bool contributes_to_light_sampling() const override
+        {
+            return true;
+        }
+
+        const ShadingPoint& trace_full(
+            const ShadingContext&       shading_context,
+            const Vector3f&             direction,
+            Spectrum&                   transmission) const override
+        {
+            transmission.set(1.0f);
+            return m_shading_point;
+        }
+
+        void trace_simple(
+            const ShadingContext&       shading_context,
+            const Vector3f&             direction,
+            Spectrum&                   transmission) const override
+        {
+            transmission.set(1.0f);
+        }
+
+        void trace_between(
+            const ShadingContext&       shading_context,
+            const Vector3d&             target_position,
+            Spectrum&                   transmission) const override
+        {
+            m_shadow_ray_targets.push_back(target_position);
+            transmission.set(1.0f);
+        }
+
+        bool sample(
+            SamplingContext&            sampling_context,
+            const Dual3d&               outgoing,
+            Dual3f&                     incoming,
+            DirectShadingComponents&    value,
+            float&                      pdf) const override
+        {
+            return false;
+        }
+
+        float evaluate(
+            const Vector3f&             outgoing,
+            const Vector3f&             incoming,
+            const int                   light_sampling_modes,
+            DirectShadingComponents&    value) const override
+        {
+            value.set(1.0f);
+            return 1.0f;
+        }
+
+      private:
+        const Vector3d  m_point;
+        ShadingPoint    m_shading_point;
+    };
+
+    TEST_CASE_F(ComputeOutgoingRadianceLightSamplingLowVariance_GivenResampling_TakesDifferentSuccessiveLightSamples, Fixture)
+    {
+        const BackwardLightSampler light_sampler(m_scene);
+        const RecordingMaterialSampler material_sampler;
+        const ShadingRay::Time time;
+
+        const DirectLightingIntegrator integrator(
+            m_shading_context,
+            light_sampler,
+            material_sampler,
+            time,
+            ScatteringMode::All,
+            1,                              // material sample count
+            2,                              // light sample count
+            0.0f,                           // low light threshold
+            false,                          // indirect
+            4);                             // resampling candidate count
+
+        SamplingContext::RNGType rng;
+        SamplingContext sampling_context(rng, SamplingContext::QMCMode);
+
+        DirectShadingComponents radiance;
+        integrator.compute_outgoing_radiance_light_sampling_low_variance(
+            sampling_context,
+            MISPower2,
+            Dual3d(Vector3d(0.0, 0.0, 1.0)),
+            radiance,
+            nullptr);
+
+        ASSERT_EQ(2, material_sampler.m_shadow_ray_targets.size());
+        EXPECT_NEQ(material_sampler.m_shadow_ray_targets[0], material_sampler.m_shadow_ray_targets[1]);
+    }
+}
@@ -0,0 +1,253 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/meshio/binarymeshfilewriter.h"
+#include "foundation/meshio/imeshwalker.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Object_MeshObjectReader)
+{
+    // A unit square made of two triangles, with a single material slot.
+    struct QuadMeshWalker
+      : public IMeshWalker
+    {
+        const char* get_name() const override
+        {
+            return "quad";
+        }
+
+        size_t get_vertex_count() const override
+        {
+            return 4;
+        }
+
+        Vector3d get_vertex(const size_t i) const override
+        {
+            return Vector3d(static_cast<double>(i == 1 || i == 2), static_cast<double>(i >= 2), 0.0);
+        }
+
+        size_t get_vertex_normal_count() const override
+        {
+            return 0;
+        }
+
+        Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return Vector3d(0.0);
+        }
+
+        size_t get_tex_coords_count() const override
+        {
+            return 0;
+        }
+
+        Vector2d get_tex_coords(const size_t i) const override
+        {
+            return Vector2d(0.0);
+        }
+
+        size_t get_material_slot_count() const override
+        {
+            return 1;
+        }
+
+        const char* get_material_slot(const size_t i) const override
+        {
+            return "material";
+        }
+
+        size_t get_face_count() const override
+        {
+            return 2;
+        }
+
+        size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return 3;
+        }
+
+        size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            static const size_t Vertices[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+            return Vertices[face_index][vertex_index];
+        }
+
+        size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            return ~size_t(0);
+        }
+
+        size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            return ~size_t(0);
+        }
+
+        size_t get_face_material(const size_t face_index) const override
+        {
+            return 0;
+        }
+    };
+
+    const char* Filename = "unit tests/outputs/test_meshobjectreader_quad.binarymesh";
+
+    struct Fixture
+    {
+        MeshObjectArray m_objects;
+
+        Fixture()
+        {
+            BinaryMeshFileWriter writer(Filename, BinaryMeshFileWriter::PageAligned);
+            writer.write(QuadMeshWalker());
+        }
+
+        ~Fixture()
+        {
+            for (size_t i = 0, e = m_objects.size(); i < e; ++i)
+                m_objects[i]->release();
+        }
+
+        bool read_deferred()
+        {
+            return
+                MeshObjectReader::read(
+                    SearchPaths(),
+                    "object",
+                    ParamArray().insert("filename", Filename),
+                    m_objects,
+                    MeshObjectReader::DeferGeometryLoading);
+        }
+    };
+
+    TEST_CASE(CanDeferGeometryLoading_GivenPageAlignedFile_ReturnsTrue)
+    {
+        {
+            BinaryMeshFileWriter writer(Filename, BinaryMeshFileWriter::PageAligned);
+            writer.write(QuadMeshWalker());
+        }
+
+        EXPECT_TRUE(
+            MeshObjectReader::can_defer_geometry_loading(
+                SearchPaths(),
+                ParamArray().insert("filename", Filename)));
+    }
+
+    TEST_CASE(CanDeferGeometryLoading_GivenOBJFile_ReturnsFalse)
+    {
+        EXPECT_FALSE(
+            MeshObjectReader::can_defer_geometry_loading(
+                SearchPaths(),
+                ParamArray().insert("filename", "unit tests/inputs/test_objmeshfilereader_quad.obj")));
+    }
+
+    TEST_CASE_F(Read_WithDeferGeometryLoading_OnlyReadsBoundingBoxAndMaterialSlots, Fixture)
+    {
+        ASSERT_TRUE(read_deferred());
+        ASSERT_EQ(1, m_objects.size());
+
+        const MeshObject& object = *m_objects[0];
+
+        EXPECT_EQ(std::string("object.quad"), object.get_name());
+        EXPECT_TRUE(object.has_deferred_geometry());
+        EXPECT_FALSE(object.is_geometry_loaded());
+        EXPECT_EQ(0, object.get_triangle_count());
+        EXPECT_EQ(GAABB3(GVector3(0.0f), GVector3(1.0f, 1.0f, 0.0f)), object.compute_local_bbox());
+        ASSERT_EQ(1, object.get_material_slot_count());
+        EXPECT_EQ(std::string("material"), object.get_material_slot(0));
+    }
+
+    TEST_CASE_F(LoadGeometry_GivenDeferredObject_ReadsGeometry, Fixture)
+    {
+        ASSERT_TRUE(read_deferred());
+        ASSERT_EQ(1, m_objects.size());
+
+        MeshObject& object = *m_objects[0];
+        const bool success = object.load_geometry();
+
+        ASSERT_TRUE(success);
+        EXPECT_TRUE(object.is_geometry_loaded());
+        EXPECT_EQ(4, object.get_vertex_count());
+        EXPECT_EQ(2, object.get_triangle_count());
+        EXPECT_EQ(GAABB3(GVector3(0.0f), GVector3(1.0f, 1.0f, 0.0f)), object.compute_local_bbox());
+        EXPECT_LT(0, object.get_geometry_memory_size());
+    }
+
+    TEST_CASE_F(UnloadGeometry_GivenLoadedDeferredObject_FreesGeometryButKeepsBoundingBox, Fixture)
+    {
+        ASSERT_TRUE(read_deferred());
+        ASSERT_EQ(1, m_objects.size());
+
+        MeshObject& object = *m_objects[0];
+        object.load_geometry();
+        object.unload_geometry();
+
+        EXPECT_FALSE(object.is_geometry_loaded());
+        EXPECT_EQ(0, object.get_triangle_count());
+        EXPECT_EQ(0, object.get_geometry_memory_size());
+        EXPECT_EQ(GAABB3(GVector3(0.0f), GVector3(1.0f, 1.0f, 0.0f)), object.compute_local_bbox());
+    }
+
+    TEST_CASE(UnloadGeometry_GivenRegularObject_DoesNothing)
+    {
+        MeshObjectArray objects;
+        ASSERT_TRUE(
+            MeshObjectReader::read(
+                SearchPaths(),
+                "object",
+                ParamArray().insert("filename", "unit tests/inputs/test_objmeshfilereader_quad.obj"),
+                objects,
+                MeshObjectReader::DeferGeometryLoading));
+        ASSERT_EQ(1, objects.size());
+
+        MeshObject& object = *objects[0];
+        object.unload_geometry();
+
+        EXPECT_FALSE(object.has_deferred_geometry());
+        EXPECT_TRUE(object.is_geometry_loaded());
+        EXPECT_EQ(2, object.get_triangle_count());
+
+        object.release();
+    }
+}
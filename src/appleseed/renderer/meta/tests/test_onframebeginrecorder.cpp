@@ -0,0 +1,245 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/entity/entityvector.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
+#include "renderer/modeling/entity/onrenderbeginrecorder.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/memory/autoreleaseptr.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Entity_OnFrameBeginRecorder)
+{
+    class CountingEntity
+      : public DummyEntity
+    {
+      public:
+        CountingEntity(
+            const char*             name,
+            std::atomic<size_t>&    begin_count,
+            std::atomic<size_t>&    end_count,
+            const bool              fail = false)
+          : DummyEntity(name)
+          , m_begin_count(begin_count)
+          , m_end_count(end_count)
+          , m_fail(fail)
+        {
+        }
+
+        bool on_frame_begin(
+            const Project&          project,
+            const BaseGroup*        parent,
+            OnFrameBeginRecorder&   recorder,
+            IAbortSwitch*           abort_switch) override
+        {
+            if (!DummyEntity::on_frame_begin(project, parent, recorder, abort_switch))
+                return false;
+
+            ++m_begin_count;
+
+            return !m_fail;
+        }
+
+        void on_frame_end(
+            const Project&          project,
+            const BaseGroup*        parent) override
+        {
+            ++m_end_count;
+
+            DummyEntity::on_frame_end(project, parent);
+        }
+
+      private:
+        std::atomic<size_t>&        m_begin_count;
+        std::atomic<size_t>&        m_end_count;
+        const bool                  m_fail;
+    };
+
+    const size_t EntityCount = 1000;
+
+    struct Fixture
+    {
+        auto_release_ptr<Project>   m_project;
+        EntityVector                m_entities;
+        std::atomic<size_t>         m_begin_count;
+        std::atomic<size_t>         m_end_count;
+
+        Fixture()
+          : m_project(ProjectFactory::create("project"))
+          , m_begin_count(0)
+          , m_end_count(0)
+        {
+        }
+
+        void create_entities(const size_t failing_entity_index = EntityCount)
+        {
+            for (size_t i = 0; i < EntityCount; ++i)
+            {
+                const std::string name = "entity" + to_string(i);
+                m_entities.insert(
+                    auto_release_ptr<Entity>(
+                        new CountingEntity(
+                            name.c_str(),
+                            m_begin_count,
+                            m_end_count,
+                            i == failing_entity_index)));
+            }
+        }
+    };
+
+    TEST_CASE_F(InvokeOnFrameBegin_GivenMultipleThreads_InvokesOnFrameBeginOnEveryEntity, Fixture)
+    {
+        create_entities();
+
+        OnFrameBeginRecorder recorder(4);
+        const bool success =
+            invoke_on_frame_begin(m_entities, m_project.ref(), nullptr, recorder, nullptr);
+        recorder.on_frame_end(m_project.ref());
+
+        EXPECT_TRUE(success);
+        EXPECT_EQ(EntityCount, m_begin_count.load());
+        EXPECT_EQ(EntityCount, m_end_count.load());
+    }
+
+    TEST_CASE_F(InvokeOnFrameBegin_GivenMultipleThreadsAndFailingEntity_ReturnsFalse, Fixture)
+    {
+        create_entities(EntityCount / 2);
+
+        OnFrameBeginRecorder recorder(4);
+        const bool success =
+            invoke_on_frame_begin(m_entities, m_project.ref(), nullptr, recorder, nullptr);
+        recorder.on_frame_end(m_project.ref());
+
+        EXPECT_FALSE(success);
+
+        // on_frame_end() is called on every entity on which on_frame_begin() was called.
+        EXPECT_EQ(m_begin_count.load(), m_end_count.load());
+    }
+
+    TEST_CASE_F(InvokeOnFrameBegin_GivenSingleThread_InvokesOnFrameBeginOnEveryEntity, Fixture)
+    {
+        create_entities();
+
+        OnFrameBeginRecorder recorder;
+        const bool success =
+            invoke_on_frame_begin(m_entities, m_project.ref(), nullptr, recorder, nullptr);
+        recorder.on_frame_end(m_project.ref());
+
+        EXPECT_TRUE(success);
+        EXPECT_EQ(EntityCount, m_begin_count.load());
+        EXPECT_EQ(EntityCount, m_end_count.load());
+    }
+}
+
+TEST_SUITE(Renderer_Modeling_Entity_OnRenderBeginRecorder)
+{
+    class CountingJob
+      : public IJob
+    {
+      public:
+        CountingJob(
+            std::atomic<size_t>&    execute_count,
+            std::atomic<size_t>&    delete_count)
+          : m_execute_count(execute_count)
+          , m_delete_count(delete_count)
+        {
+        }
+
+        ~CountingJob() override
+        {
+            ++m_delete_count;
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            ++m_execute_count;
+        }
+
+      private:
+        std::atomic<size_t>&        m_execute_count;
+        std::atomic<size_t>&        m_delete_count;
+    };
+
+    const size_t JobCount = 100;
+
+    struct JobFixture
+    {
+        std::atomic<size_t>         m_execute_count;
+        std::atomic<size_t>         m_delete_count;
+
+        JobFixture()
+          : m_execute_count(0)
+          , m_delete_count(0)
+        {
+        }
+
+        void run_jobs(const size_t thread_count)
+        {
+            std::vector<IJob*> jobs;
+            for (size_t i = 0; i < JobCount; ++i)
+                jobs.push_back(new CountingJob(m_execute_count, m_delete_count));
+
+            OnRenderBeginRecorder recorder(thread_count);
+            recorder.run_jobs(jobs);
+        }
+    };
+
+    TEST_CASE_F(RunJobs_GivenMultipleThreads_ExecutesAndDeletesEveryJob, JobFixture)
+    {
+        run_jobs(4);
+
+        EXPECT_EQ(JobCount, m_execute_count.load());
+        EXPECT_EQ(JobCount, m_delete_count.load());
+    }
+
+    TEST_CASE_F(RunJobs_GivenSingleThread_ExecutesAndDeletesEveryJob, JobFixture)
+    {
+        run_jobs(1);
+
+        EXPECT_EQ(JobCount, m_execute_count.load());
+        EXPECT_EQ(JobCount, m_delete_count.load());
+    }
+}
@@ -28,11 +28,30 @@
 //
 
 // appleseed.renderer headers.
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/binaryprojectfilereader.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/project/projectfilereader.h"
 #include "renderer/modeling/project/projectfilewriter.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/shadergroup/shader.h"
+#include "renderer/modeling/shadergroup/shaderconnection.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/shadergroup/shaderparam.h"
+#include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/transform.h"
 #include "foundation/memory/autoreleaseptr.h"
 #include "foundation/utility/test.h"
 #include "foundation/utility/testutils.h"
@@ -41,7 +60,10 @@
 #include "boost/filesystem.hpp"
 
 // Standard headers.
+#include <cstddef>
+#include <cstring>
 #include <exception>
+#include <string>
 
 using namespace foundation;
 using namespace renderer;
@@ -75,6 +97,299 @@ TEST_SUITE(Renderer_Modeling_Project_ProjectFileReader)
         EXPECT_TRUE(identical);
     }
 
+    bool same_transform_sequences(const TransformSequence& lhs, const TransformSequence& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            float lhs_time, rhs_time;
+            Transformd lhs_transform, rhs_transform;
+            lhs.get_transform(i, lhs_time, lhs_transform);
+            rhs.get_transform(i, rhs_time, rhs_transform);
+
+            if (lhs_time != rhs_time || lhs_transform != rhs_transform)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Return the entity of `rhs` that has the same name and parameters as `entity`, or nullptr.
+    template <typename EntityContainer, typename EntityType>
+    const EntityType* find_same_entity(const EntityContainer& rhs, const EntityType& entity)
+    {
+        const EntityType* other = rhs.get_by_name(entity.get_name());
+        return other != nullptr && other->get_parameters() == entity.get_parameters() ? other : nullptr;
+    }
+
+    template <typename EntityContainer>
+    bool same_entities(const EntityContainer& lhs, const EntityContainer& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (const auto& entity : lhs)
+        {
+            if (find_same_entity(rhs, entity) == nullptr)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_colors(const ColorContainer& lhs, const ColorContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const ColorEntity& color : lhs)
+        {
+            const ColorEntity* other = rhs.get_by_name(color.get_name());
+            if (other->get_values() != color.get_values() || other->get_alpha() != color.get_alpha())
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_texture_instances(const TextureInstanceContainer& lhs, const TextureInstanceContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const TextureInstance& texture_instance : lhs)
+        {
+            const TextureInstance* other = rhs.get_by_name(texture_instance.get_name());
+            if (strcmp(other->get_texture_name(), texture_instance.get_texture_name()) != 0 ||
+                other->get_transform() != texture_instance.get_transform())
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_shader_groups(const ShaderGroupContainer& lhs, const ShaderGroupContainer& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (const ShaderGroup& shader_group : lhs)
+        {
+            const ShaderGroup* other = rhs.get_by_name(shader_group.get_name());
+            if (other == nullptr ||
+                other->shaders().size() != shader_group.shaders().size() ||
+                other->shader_connections().size() != shader_group.shader_connections().size())
+                return false;
+
+            // Shaders and shader connections must come back in their original order.
+            for (size_t i = 0; i < shader_group.shaders().size(); ++i)
+            {
+                const Shader* lhs_shader = shader_group.shaders().get_by_index(i);
+                const Shader* rhs_shader = other->shaders().get_by_index(i);
+                if (strcmp(lhs_shader->get_type(), rhs_shader->get_type()) != 0 ||
+                    strcmp(lhs_shader->get_shader(), rhs_shader->get_shader()) != 0 ||
+                    strcmp(lhs_shader->get_layer(), rhs_shader->get_layer()) != 0 ||
+                    lhs_shader->shader_params().size() != rhs_shader->shader_params().size())
+                    return false;
+
+                for (size_t j = 0; j < lhs_shader->shader_params().size(); ++j)
+                {
+                    const ShaderParam* lhs_param = lhs_shader->shader_params().get_by_index(j);
+                    const ShaderParam* rhs_param = rhs_shader->shader_params().get_by_index(j);
+                    if (strcmp(lhs_param->get_name(), rhs_param->get_name()) != 0 ||
+                        lhs_param->get_value_as_string() != rhs_param->get_value_as_string())
+                        return false;
+                }
+            }
+
+            for (size_t i = 0; i < shader_group.shader_connections().size(); ++i)
+            {
+                const ShaderConnection* lhs_connection = shader_group.shader_connections().get_by_index(i);
+                const ShaderConnection* rhs_connection = other->shader_connections().get_by_index(i);
+                if (strcmp(lhs_connection->get_src_layer(), rhs_connection->get_src_layer()) != 0 ||
+                    strcmp(lhs_connection->get_src_param(), rhs_connection->get_src_param()) != 0 ||
+                    strcmp(lhs_connection->get_dst_layer(), rhs_connection->get_dst_layer()) != 0 ||
+                    strcmp(lhs_connection->get_dst_param(), rhs_connection->get_dst_param()) != 0)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool same_lights(const LightContainer& lhs, const LightContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const Light& light : lhs)
+        {
+            const Light* other = rhs.get_by_name(light.get_name());
+            if (strcmp(other->get_model(), light.get_model()) != 0 ||
+                other->get_transform() != light.get_transform())
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_objects(const ObjectContainer& lhs, const ObjectContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const Object& object : lhs)
+        {
+            const Object* other = rhs.get_by_name(object.get_name());
+            if (strcmp(other->get_model(), object.get_model()) != 0)
+                return false;
+
+            if (strcmp(object.get_model(), MeshObjectFactory().get_model()) == 0)
+            {
+                const MeshObject& lhs_mesh = static_cast<const MeshObject&>(object);
+                const MeshObject& rhs_mesh = static_cast<const MeshObject&>(*other);
+                if (lhs_mesh.get_vertex_count() != rhs_mesh.get_vertex_count() ||
+                    lhs_mesh.get_triangle_count() != rhs_mesh.get_triangle_count())
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool same_object_instances(const ObjectInstanceContainer& lhs, const ObjectInstanceContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const ObjectInstance& object_instance : lhs)
+        {
+            const ObjectInstance* other = rhs.get_by_name(object_instance.get_name());
+            if (strcmp(other->get_object_name(), object_instance.get_object_name()) != 0 ||
+                other->get_transform() != object_instance.get_transform() ||
+                other->get_front_material_mappings() != object_instance.get_front_material_mappings() ||
+                other->get_back_material_mappings() != object_instance.get_back_material_mappings())
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_assembly_instances(const AssemblyInstanceContainer& lhs, const AssemblyInstanceContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const AssemblyInstance& assembly_instance : lhs)
+        {
+            const AssemblyInstance* other = rhs.get_by_name(assembly_instance.get_name());
+            if (strcmp(other->get_assembly_name(), assembly_instance.get_assembly_name()) != 0 ||
+                !same_transform_sequences(other->transform_sequence(), assembly_instance.transform_sequence()))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_assemblies(const AssemblyContainer& lhs, const AssemblyContainer& rhs)
+    {
+        if (!same_entities(lhs, rhs))
+            return false;
+
+        for (const Assembly& assembly : lhs)
+        {
+            const Assembly* other = rhs.get_by_name(assembly.get_name());
+            if (!same_colors(assembly.colors(), other->colors()) ||
+                !same_entities(assembly.textures(), other->textures()) ||
+                !same_texture_instances(assembly.texture_instances(), other->texture_instances()) ||
+                !same_shader_groups(assembly.shader_groups(), other->shader_groups()) ||
+                !same_entities(assembly.bsdfs(), other->bsdfs()) ||
+                !same_entities(assembly.surface_shaders(), other->surface_shaders()) ||
+                !same_entities(assembly.materials(), other->materials()) ||
+                !same_lights(assembly.lights(), other->lights()) ||
+                !same_objects(assembly.objects(), other->objects()) ||
+                !same_object_instances(assembly.object_instances(), other->object_instances()) ||
+                !same_assemblies(assembly.assemblies(), other->assemblies()) ||
+                !same_assembly_instances(assembly.assembly_instances(), other->assembly_instances()))
+                return false;
+        }
+
+        return true;
+    }
+
+    TEST_CASE(ReadBinaryProject)
+    {
+        auto_release_ptr<Project> xml_project =
+            ProjectFileReader::read(
+                "unit tests/inputs/test_projectfilereader_binaryproject.appleseed",
+                "../../../schemas/project.xsd",             // path relative to input file
+                ProjectFileReader::OmitProjectFileUpdate);
+
+        ASSERT_NEQ(0, xml_project.get());
+
+        const bool success =
+            ProjectFileWriter::write(
+                xml_project.ref(),
+                "unit tests/outputs/test_projectfilereader_binaryproject.appleseedb");
+
+        ASSERT_TRUE(success);
+        EXPECT_TRUE(BinaryProjectFileReader::is_binary_project_file("unit tests/outputs/test_projectfilereader_binaryproject.appleseedb"));
+        EXPECT_FALSE(BinaryProjectFileReader::is_binary_project_file("unit tests/inputs/test_projectfilereader_binaryproject.appleseed"));
+
+        auto_release_ptr<Project> binary_project =
+            ProjectFileReader::read(
+                "unit tests/outputs/test_projectfilereader_binaryproject.appleseedb",
+                nullptr,                                    // binary project files are not validated against the schema
+                ProjectFileReader::OmitProjectFileUpdate);
+
+        ASSERT_NEQ(0, binary_project.get());
+
+        // Make sure the fixture was actually loaded so that the comparisons below are not vacuous.
+        const Scene& xml_scene = *xml_project->get_scene();
+        const Assembly* world = xml_scene.assemblies().get_by_name("world");
+        ASSERT_NEQ(0, world);
+        ASSERT_EQ(2, world->objects().size());
+        ASSERT_EQ(2, world->object_instances().size());
+        ASSERT_EQ(1, world->shader_groups().size());
+        ASSERT_EQ(2, world->materials().size());
+        ASSERT_EQ(1, xml_scene.assemblies().get_by_name("lights")->lights().size());
+        EXPECT_LT(0, static_cast<const MeshObject*>(world->objects().get_by_name("plane.quad"))->get_triangle_count());
+
+        const Scene& binary_scene = *binary_project->get_scene();
+        EXPECT_TRUE(same_entities(xml_scene.cameras(), binary_scene.cameras()));
+        EXPECT_TRUE(
+            same_transform_sequences(
+                xml_scene.cameras().get_by_name("camera")->transform_sequence(),
+                binary_scene.cameras().get_by_name("camera")->transform_sequence()));
+        EXPECT_TRUE(same_colors(xml_scene.colors(), binary_scene.colors()));
+        EXPECT_TRUE(same_entities(xml_scene.textures(), binary_scene.textures()));
+        EXPECT_TRUE(same_texture_instances(xml_scene.texture_instances(), binary_scene.texture_instances()));
+        EXPECT_TRUE(same_assemblies(xml_scene.assemblies(), binary_scene.assemblies()));
+        EXPECT_TRUE(same_assembly_instances(xml_scene.assembly_instances(), binary_scene.assembly_instances()));
+        EXPECT_TRUE(xml_project->get_frame()->get_parameters() == binary_project->get_frame()->get_parameters());
+    }
+
+    TEST_CASE(DeduplicateMeshObjects_CollapsesIdenticalMeshesIntoInstancesOfASingleObject)
+    {
+        auto_release_ptr<Project> project =
+            ProjectFileReader::read(
+                "unit tests/inputs/test_projectfilereader_duplicatemeshes.appleseed",
+                "../../../schemas/project.xsd",             // path relative to input file
+                ProjectFileReader::OmitProjectFileUpdate | ProjectFileReader::DeduplicateMeshObjects);
+
+        ASSERT_NEQ(0, project.get());
+
+        const Assembly* assembly = project->get_scene()->assemblies().get_by_name("assembly");
+
+        ASSERT_NEQ(0, assembly);
+        ASSERT_EQ(1, assembly->objects().size());
+        ASSERT_EQ(2, assembly->object_instances().size());
+        EXPECT_EQ("quad1.quad", std::string(assembly->object_instances().get_by_name("quad1_inst")->get_object_name()));
+        EXPECT_EQ("quad1.quad", std::string(assembly->object_instances().get_by_name("quad2_inst")->get_object_name()));
+    }
+
     TEST_CASE(ReadValidPackedProject)
     {
         const char* UnpackDirectory = "unit tests/inputs/test_projectfilereader_validpackedproject.unpacked/";
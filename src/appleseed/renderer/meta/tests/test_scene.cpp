@@ -30,9 +30,11 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 #include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/project.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/proceduralassembly.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/paramarray.h"
 #include "renderer/utility/testutils.h"
@@ -44,9 +46,20 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/memory/autoreleaseptr.h"
+#include "foundation/utility/countof.h"
 #include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
+// Boost headers.
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
 using namespace foundation;
 using namespace renderer;
 
@@ -109,4 +122,143 @@ TEST_SUITE(Renderer_Modeling_Scene_Scene)
         EXPECT_FEQ(GVector3( -9.0), bbox.min);
         EXPECT_FEQ(GVector3(+11.0), bbox.max);
     }
+
+    // Records the expansion of procedural assemblies as "parent/name", or "name" for
+    // assemblies directly in the scene.
+    struct ExpansionLog
+    {
+        boost::mutex                m_mutex;
+        std::vector<std::string>    m_expansions;
+
+        void record(const Assembly& assembly, const Assembly* parent)
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            m_expansions.push_back(
+                parent != nullptr
+                    ? std::string(parent->get_name()) + "/" + assembly.get_name()
+                    : std::string(assembly.get_name()));
+        }
+    };
+
+    class TestProceduralAssembly
+      : public ProceduralAssembly
+    {
+      public:
+        // `generated_child_name` is the name of a procedural assembly created by the expansion, if any.
+        TestProceduralAssembly(
+            const char*             name,
+            ExpansionLog&           log,
+            const bool              thread_safe = false,
+            const char*             generated_child_name = nullptr)
+          : ProceduralAssembly(name, ParamArray())
+          , m_log(log)
+          , m_thread_safe(thread_safe)
+          , m_generated_child_name(generated_child_name != nullptr ? generated_child_name : "")
+        {
+        }
+
+        bool is_thread_safe_expansion() const override
+        {
+            return m_thread_safe;
+        }
+
+      private:
+        ExpansionLog&               m_log;
+        const bool                  m_thread_safe;
+        const std::string           m_generated_child_name;
+
+        bool do_expand_contents(
+            const Project&          project,
+            const Assembly*         parent,
+            IAbortSwitch*           abort_switch) override
+        {
+            m_log.record(*this, parent);
+
+            if (!m_generated_child_name.empty())
+            {
+                assemblies().insert(
+                    auto_release_ptr<Assembly>(
+                        new TestProceduralAssembly(
+                            m_generated_child_name.c_str(),
+                            m_log,
+                            m_thread_safe)));
+            }
+
+            return true;
+        }
+    };
+
+    //
+    // The test scene has the following assembly hierarchy, where `c` is created by the
+    // expansion of `a` and `e` is the only assembly that is not procedural:
+    //
+    //   scene
+    //     a
+    //       b
+    //       (c)
+    //     d
+    //     e
+    //       f
+    //
+
+    auto_release_ptr<Scene> create_nested_procedural_assemblies_scene(
+        ExpansionLog&               log,
+        const bool                  thread_safe)
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+
+        auto_release_ptr<Assembly> a(new TestProceduralAssembly("a", log, thread_safe, "c"));
+        a->assemblies().insert(
+            auto_release_ptr<Assembly>(new TestProceduralAssembly("b", log, thread_safe)));
+
+        auto_release_ptr<Assembly> e(AssemblyFactory().create("e", ParamArray()));
+        e->assemblies().insert(
+            auto_release_ptr<Assembly>(new TestProceduralAssembly("f", log, thread_safe)));
+
+        scene->assemblies().insert(a);
+        scene->assemblies().insert(
+            auto_release_ptr<Assembly>(new TestProceduralAssembly("d", log, thread_safe)));
+        scene->assemblies().insert(e);
+
+        return scene;
+    }
+
+    TEST_CASE(ExpandProceduralAssemblies_GivenNestedProceduralAssemblies_ExpandsOneLevelAtATime)
+    {
+        auto_release_ptr<Project> project(ProjectFactory::create("project"));
+        ExpansionLog log;
+        auto_release_ptr<Scene> scene(create_nested_procedural_assemblies_scene(log, false));
+
+        const bool success = scene->expand_procedural_assemblies(project.ref(), nullptr, 4);
+
+        ASSERT_TRUE(success);
+
+        const char* Expected[] = { "a", "d", "a/b", "a/c", "e/f" };
+        ASSERT_EQ(countof(Expected), log.m_expansions.size());
+
+        for (std::size_t i = 0; i < countof(Expected); ++i)
+            EXPECT_EQ(Expected[i], log.m_expansions[i]);
+    }
+
+    TEST_CASE(ExpandProceduralAssemblies_GivenThreadSafeNestedProceduralAssemblies_ExpandsParentsFirst)
+    {
+        auto_release_ptr<Project> project(ProjectFactory::create("project"));
+        ExpansionLog log;
+        auto_release_ptr<Scene> scene(create_nested_procedural_assemblies_scene(log, true));
+
+        const bool success = scene->expand_procedural_assemblies(project.ref(), nullptr, 4);
+
+        ASSERT_TRUE(success);
+        ASSERT_EQ(5, log.m_expansions.size());
+
+        // Assemblies of a same level may be expanded in any order.
+        std::sort(log.m_expansions.begin(), log.m_expansions.begin() + 2);
+        std::sort(log.m_expansions.begin() + 2, log.m_expansions.end());
+
+        const char* Expected[] = { "a", "d", "a/b", "a/c", "e/f" };
+
+        for (std::size_t i = 0; i < countof(Expected); ++i)
+            EXPECT_EQ(Expected[i], log.m_expansions[i]);
+    }
 }
@@ -0,0 +1,177 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/log/logger.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SDTree)
+{
+    // Learn a distribution concentrated around the +Z axis.
+    void build_distribution(DTree& dtree, const size_t iteration_count)
+    {
+        MersenneTwister rng;
+        DTree building;
+
+        for (size_t iteration = 0; iteration < iteration_count; ++iteration)
+        {
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                const Vector3f direction = sample_sphere_uniform(rand_vector2<Vector2f>(rng));
+                building.record(direction, direction[2] > 0.9f ? 10.0f : 0.1f);
+            }
+
+            dtree = building;
+            building.refine(dtree, 0.01f, 8);
+        }
+    }
+
+    TEST_CASE(Constructor_BuildsTreeWithoutEnergy)
+    {
+        const DTree dtree;
+
+        EXPECT_EQ(1, dtree.get_node_count());
+        EXPECT_EQ(0.0f, dtree.get_total());
+        EXPECT_EQ(0.0f, dtree.evaluate_pdf(Vector3f(0.0f, 0.0f, 1.0f)));
+    }
+
+    TEST_CASE(Record_AccumulatesValues)
+    {
+        DTree dtree;
+
+        dtree.record(Vector3f(0.0f, 0.0f, 1.0f), 1.0f);
+        dtree.record(Vector3f(1.0f, 0.0f, 0.0f), 2.0f);
+
+        EXPECT_FEQ(3.0f, dtree.get_total());
+    }
+
+    TEST_CASE(Record_IgnoresInvalidValues)
+    {
+        DTree dtree;
+
+        dtree.record(Vector3f(0.0f, 0.0f, 1.0f), 0.0f);
+        dtree.record(Vector3f(0.0f, 0.0f, 1.0f), -1.0f);
+
+        EXPECT_EQ(0.0f, dtree.get_total());
+    }
+
+    TEST_CASE(Refine_SubdividesQuadrantsWithMostEnergy)
+    {
+        DTree dtree;
+        build_distribution(dtree, 3);
+
+        EXPECT_GT(1, dtree.get_node_count());
+        EXPECT_GT(dtree.evaluate_pdf(Vector3f(0.0f, 1.0f, 0.0f)), dtree.evaluate_pdf(Vector3f(0.0f, 0.0f, 1.0f)));
+    }
+
+    TEST_CASE(EvaluatePdf_IntegratesToOne)
+    {
+        DTree dtree;
+        build_distribution(dtree, 3);
+
+        // Directions are mapped to the unit square with an equal-area mapping,
+        // and leaves are not smaller than 1/256 when the maximum depth is 8.
+        const size_t N = 256;
+        double integral = 0.0;
+
+        for (size_t y = 0; y < N; ++y)
+        {
+            for (size_t x = 0; x < N; ++x)
+            {
+                const float cos_theta = 2.0f * (x + 0.5f) / N - 1.0f;
+                const float sin_theta = std::sqrt(1.0f - cos_theta * cos_theta);
+                const float phi = TwoPi<float>() * (y + 0.5f) / N;
+                const Vector3f direction(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+                integral += dtree.evaluate_pdf(direction);
+            }
+        }
+
+        integral *= FourPi<double>() / (N * N);
+
+        EXPECT_FEQ_EPS(1.0, integral, 1.0e-3);
+    }
+
+    TEST_CASE(Sample_ReturnsProbabilityDensityOfSampledDirection)
+    {
+        DTree dtree;
+        build_distribution(dtree, 3);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            float pdf;
+            const Vector3f direction = dtree.sample(rand_vector2<Vector2f>(rng), pdf);
+
+            EXPECT_FEQ_EPS(1.0f, norm(direction), 1.0e-4f);
+            EXPECT_GT(0.0f, pdf);
+            EXPECT_FEQ_EPS(pdf, dtree.evaluate_pdf(direction), 1.0e-3f);
+        }
+    }
+
+    TEST_CASE(Refine_SplitsLeavesThatReceivedManySamples)
+    {
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 2);
+        job_manager.start();
+
+        STree stree(AABB3f(Vector3f(-1.0f), Vector3f(1.0f)));
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 10000; ++i)
+        {
+            const Vector3f point = rand_vector1<Vector3f>(rng) * 2.0f - Vector3f(1.0f);
+            stree.record(point, Vector3f(0.0f, 0.0f, 1.0f), 1.0f);
+        }
+
+        stree.refine(1000, 0.01f, 20, job_queue);
+
+        EXPECT_GT(8, stree.get_leaf_count());
+        EXPECT_EQ(2 * stree.get_leaf_count() - 1, stree.get_node_count());
+        EXPECT_GT(0.0f, stree.get_sampling_dtree(Vector3f(0.5f)).get_total());
+    }
+}
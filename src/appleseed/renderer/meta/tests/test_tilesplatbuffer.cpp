@@ -0,0 +1,139 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/tilesplatbuffer.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_TileSplatBuffer)
+{
+    Sample make_sample(const int x, const int y, const float value)
+    {
+        Sample sample;
+        sample.m_pixel_coords = Vector2i(x, y);
+        sample.m_color = Color4f(value, value, value, 1.0f);
+        return sample;
+    }
+
+    TEST_CASE(Build_GivenNoSample_ProducesNoSplat)
+    {
+        TileSplatBuffer buffer(64, 64, 32, 32);
+        const Sample sample = make_sample(0, 0, 1.0f);
+
+        buffer.build(0, &sample);
+
+        EXPECT_TRUE(buffer.empty());
+    }
+
+    TEST_CASE(Build_GivenSamplesOutsideCanvas_IgnoresThem)
+    {
+        TileSplatBuffer buffer(64, 64, 32, 32);
+        const Sample samples[] =
+        {
+            make_sample(-1, 0, 1.0f),
+            make_sample(0, -1, 1.0f),
+            make_sample(64, 0, 1.0f),
+            make_sample(0, 64, 1.0f)
+        };
+
+        buffer.build(4, samples);
+
+        EXPECT_TRUE(buffer.empty());
+    }
+
+    TEST_CASE(Build_GivenSamplesOnSamePixel_MergesThem)
+    {
+        TileSplatBuffer buffer(64, 64, 32, 32);
+        const Sample samples[] =
+        {
+            make_sample(5, 7, 1.0f),
+            make_sample(40, 2, 4.0f),
+            make_sample(5, 7, 2.0f)
+        };
+
+        buffer.build(3, samples);
+
+        ASSERT_EQ(2, buffer.size());
+        EXPECT_EQ(Vector2u(5, 7), buffer[0].m_pixel_coords);
+        EXPECT_FEQ(Color3f(3.0f), buffer[0].m_color);
+        EXPECT_EQ(2.0f, buffer[0].m_weight);
+        EXPECT_EQ(Vector2u(40, 2), buffer[1].m_pixel_coords);
+        EXPECT_FEQ(Color3f(4.0f), buffer[1].m_color);
+        EXPECT_EQ(1.0f, buffer[1].m_weight);
+    }
+
+    TEST_CASE(Build_GivenSamplesInDifferentTiles_SortsSplatsByTile)
+    {
+        // The canvas is 3 x 2 tiles, with partial tiles on the right and at the bottom.
+        TileSplatBuffer buffer(70, 40, 32, 32);
+        const Sample samples[] =
+        {
+            make_sample(69, 39, 1.0f),      // tile (2, 1)
+            make_sample(0, 33, 1.0f),       // tile (0, 1)
+            make_sample(31, 0, 1.0f),       // tile (0, 0)
+            make_sample(32, 0, 1.0f),       // tile (1, 0)
+            make_sample(0, 31, 1.0f)        // tile (0, 0)
+        };
+
+        buffer.build(5, samples);
+
+        ASSERT_EQ(5, buffer.size());
+        EXPECT_EQ(Vector2u(31, 0), buffer[0].m_pixel_coords);
+        EXPECT_EQ(Vector2u(0, 31), buffer[1].m_pixel_coords);
+        EXPECT_EQ(Vector2u(32, 0), buffer[2].m_pixel_coords);
+        EXPECT_EQ(Vector2u(0, 33), buffer[3].m_pixel_coords);
+        EXPECT_EQ(Vector2u(69, 39), buffer[4].m_pixel_coords);
+    }
+
+    TEST_CASE(Build_CalledTwice_ReplacesPreviousSplats)
+    {
+        TileSplatBuffer buffer(64, 64, 32, 32);
+        const Sample sample1 = make_sample(1, 1, 1.0f);
+        const Sample sample2 = make_sample(2, 2, 1.0f);
+
+        buffer.build(1, &sample1);
+        buffer.build(1, &sample2);
+
+        ASSERT_EQ(1, buffer.size());
+        EXPECT_EQ(Vector2u(2, 2), buffer[0].m_pixel_coords);
+    }
+}
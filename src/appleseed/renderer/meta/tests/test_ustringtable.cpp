@@ -0,0 +1,102 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/ustringtable.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/ustring.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_UStringTable)
+{
+    TEST_CASE(Get_GivenEmptyTable_ReturnsNullptr)
+    {
+        const UStringTable<int> table;
+
+        EXPECT_EQ(0, table.size());
+        EXPECT_EQ(nullptr, table.get(OIIO::ustring("key")));
+    }
+
+    TEST_CASE(Get_GivenPresentKeys_ReturnsTheirValues)
+    {
+        UStringTable<int> table;
+
+        for (int i = 0; i < 100; ++i)
+            table.insert(OIIO::ustring(("key" + std::to_string(i)).c_str()), i);
+
+        EXPECT_EQ(100, table.size());
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const int* value = table.get(OIIO::ustring(("key" + std::to_string(i)).c_str()));
+
+            ASSERT_NEQ(nullptr, value);
+            EXPECT_EQ(i, *value);
+        }
+    }
+
+    TEST_CASE(Get_GivenAbsentKey_ReturnsNullptr)
+    {
+        UStringTable<int> table;
+        table.insert(OIIO::ustring("Tn"), 1);
+        table.insert(OIIO::ustring("Bn"), 2);
+
+        EXPECT_EQ(nullptr, table.get(OIIO::ustring("dNdu")));
+    }
+
+    TEST_CASE(Get_GivenEmptyKey_ReturnsNullptr)
+    {
+        UStringTable<int> table;
+        table.insert(OIIO::ustring("Tn"), 1);
+
+        EXPECT_EQ(nullptr, table.get(OIIO::ustring()));
+    }
+
+    TEST_CASE(Insert_GivenExistingKey_ReplacesValue)
+    {
+        UStringTable<int> table;
+        table.insert(OIIO::ustring("Tn"), 1);
+        table.insert(OIIO::ustring("Tn"), 2);
+
+        EXPECT_EQ(1, table.size());
+        EXPECT_EQ(2, *table.get(OIIO::ustring("Tn")));
+    }
+}
@@ -46,6 +46,20 @@ using namespace foundation;
 namespace renderer
 {
 
+bool ConnectableEntity::on_frame_begin(
+    const Project&          project,
+    const BaseGroup*        parent,
+    OnFrameBeginRecorder&   recorder,
+    IAbortSwitch*           abort_switch)
+{
+    if (!Entity::on_frame_begin(project, parent, recorder, abort_switch))
+        return false;
+
+    m_inputs.update_uniform_values();
+
+    return true;
+}
+
 bool ConnectableEntity::is_uniform_zero_scalar(const Source* source)
 {
     assert(source);
@@ -65,6 +65,13 @@ class APPLESEED_DLLSYMBOL ConnectableEntity
     InputArray& get_inputs();
     const InputArray& get_inputs() const;
 
+    // Precomputes the values of uniform inputs.
+    bool on_frame_begin(
+        const Project&              project,
+        const BaseGroup*            parent,
+        OnFrameBeginRecorder&       recorder,
+        foundation::IAbortSwitch*   abort_switch = nullptr) override;
+
   protected:
     InputArray m_inputs;
 
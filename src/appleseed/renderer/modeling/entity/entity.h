@@ -30,6 +30,8 @@
 #pragma once
 
 // appleseed.renderer headers.
+#include "renderer/modeling/entity/onframebeginrecorder.h"
+#include "renderer/modeling/entity/onrenderbeginrecorder.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
@@ -46,6 +48,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class APIString; }
@@ -53,8 +56,6 @@ namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class StringArray; }
 namespace foundation    { class StringDictionary; }
 namespace renderer      { class BaseGroup; }
-namespace renderer      { class OnFrameBeginRecorder; }
-namespace renderer      { class OnRenderBeginRecorder; }
 namespace renderer      { class Project; }
 
 namespace renderer
@@ -192,6 +193,7 @@ void invoke_update_asset_paths(
     const foundation::StringDictionary& mappings);
 
 // Utility function to invoke on_render_begin() on a collection of entities.
+// Entities of a same collection must not depend on each other: they may be processed in parallel.
 // Returns true on success, or false if an error occurred or if the abort switch was triggered.
 template <typename EntityCollection>
 bool invoke_on_render_begin(
@@ -202,6 +204,7 @@ bool invoke_on_render_begin(
     foundation::IAbortSwitch*           abort_switch);
 
 // Utility function to invoke on_frame_begin() on a collection of entities.
+// Entities of a same collection must not depend on each other: they may be processed in parallel.
 // Returns true on success, or false if an error occurred or if the abort switch was triggered.
 template <typename EntityCollection>
 bool invoke_on_frame_begin(
@@ -279,16 +282,13 @@ bool invoke_on_render_begin(
     OnRenderBeginRecorder&              recorder,
     foundation::IAbortSwitch*           abort_switch)
 {
-    for (auto& entity : entities)
-    {
-        if (foundation::is_aborted(abort_switch))
-            return false;
+    std::vector<Entity*> entity_vector;
+    entity_vector.reserve(entities.size());
 
-        if (!entity.on_render_begin(project, parent, recorder, abort_switch))
-            return false;
-    }
+    for (auto& entity : entities)
+        entity_vector.push_back(&entity);
 
-    return true;
+    return recorder.invoke_on_render_begin(entity_vector, project, parent, abort_switch);
 }
 
 template <typename EntityCollection>
@@ -299,16 +299,13 @@ bool invoke_on_frame_begin(
     OnFrameBeginRecorder&               recorder,
     foundation::IAbortSwitch*           abort_switch)
 {
-    for (auto& entity : entities)
-    {
-        if (foundation::is_aborted(abort_switch))
-            return false;
+    std::vector<Entity*> entity_vector;
+    entity_vector.reserve(entities.size());
 
-        if (!entity.on_frame_begin(project, parent, recorder, abort_switch))
-            return false;
-    }
+    for (auto& entity : entities)
+        entity_vector.push_back(&entity);
 
-    return true;
+    return recorder.invoke_on_frame_begin(entity_vector, project, parent, abort_switch);
 }
 
 }   // namespace renderer
@@ -0,0 +1,289 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "entitycallbackinvoker.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/entity/entity.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// EntityCallbackInvoker class implementation.
+//
+
+namespace
+{
+    // Invocations taking at least this long are reported in the render log.
+    const double SlowInvocationThreshold = 0.001;   // in seconds
+
+    // Number of jobs per thread. Callbacks can have very different costs,
+    // so more jobs than threads are needed to balance the load.
+    const std::size_t JobsPerThread = 8;
+
+    bool invoke_timed(
+        const char*                             callback_name,
+        Entity&                                 entity,
+        const EntityCallbackInvoker::Callback&  callback)
+    {
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        const bool success = callback(entity);
+
+        stopwatch.measure();
+
+        const double seconds = stopwatch.get_seconds();
+        if (seconds >= SlowInvocationThreshold)
+        {
+            RENDERER_LOG_DEBUG(
+                "%s() on \"%s\" took %s.",
+                callback_name,
+                entity.get_path().c_str(),
+                pretty_time(seconds).c_str());
+        }
+
+        return success;
+    }
+
+    struct InvocationState
+    {
+        std::atomic<bool>                       m_success;
+        std::mutex                              m_exception_mutex;
+        std::exception_ptr                      m_exception;
+
+        InvocationState()
+          : m_success(true)
+        {
+        }
+    };
+
+    class InvocationJob
+      : public IJob
+    {
+      public:
+        InvocationJob(
+            const char*                             callback_name,
+            Entity* const*                          begin,
+            Entity* const*                          end,
+            const EntityCallbackInvoker::Callback&  callback,
+            IAbortSwitch*                           abort_switch,
+            InvocationState&                        state)
+          : m_callback_name(callback_name)
+          , m_begin(begin)
+          , m_end(end)
+          , m_callback(callback)
+          , m_abort_switch(abort_switch)
+          , m_state(state)
+        {
+        }
+
+        void execute(const std::size_t thread_index) override
+        {
+            try
+            {
+                for (Entity* const* i = m_begin; i != m_end; ++i)
+                {
+                    // Stop as soon as possible once any invocation has failed.
+                    if (is_aborted(m_abort_switch) || !m_state.m_success)
+                        return;
+
+                    if (!invoke_timed(m_callback_name, **i, m_callback))
+                        m_state.m_success = false;
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_state.m_exception_mutex);
+
+                if (!m_state.m_exception)
+                    m_state.m_exception = std::current_exception();
+
+                m_state.m_success = false;
+            }
+        }
+
+      private:
+        const char*                             m_callback_name;
+        Entity* const*                          m_begin;
+        Entity* const*                          m_end;
+        const EntityCallbackInvoker::Callback&  m_callback;
+        IAbortSwitch*                           m_abort_switch;
+        InvocationState&                        m_state;
+    };
+}
+
+struct EntityCallbackInvoker::Impl
+{
+    const char*                     m_callback_name;
+    const std::size_t               m_thread_count;
+    std::atomic<bool>               m_busy;
+
+    // The job manager is started on first use and must be destroyed before the job queue.
+    JobQueue                        m_job_queue;
+    std::unique_ptr<JobManager>     m_job_manager;
+
+    Impl(const char* callback_name, const std::size_t thread_count)
+      : m_callback_name(callback_name)
+      , m_thread_count(thread_count)
+      , m_busy(false)
+    {
+    }
+
+    void start_job_manager()
+    {
+        if (!m_job_manager)
+        {
+            m_job_manager.reset(
+                new JobManager(
+                    global_logger(),
+                    m_job_queue,
+                    m_thread_count,
+                    JobManager::KeepRunningOnEmptyQueue));
+            m_job_manager->start();
+        }
+    }
+};
+
+EntityCallbackInvoker::EntityCallbackInvoker(
+    const char*                 callback_name,
+    const std::size_t           thread_count)
+  : impl(new Impl(callback_name, thread_count))
+{
+}
+
+EntityCallbackInvoker::~EntityCallbackInvoker()
+{
+    delete impl;
+}
+
+bool EntityCallbackInvoker::invoke(
+    const std::vector<Entity*>& entities,
+    const Callback&             callback,
+    IAbortSwitch*               abort_switch)
+{
+    // Run on the calling thread if there is nothing to gain from parallelism,
+    // or if the invocation comes from within a callback already running in parallel.
+    bool expected = false;
+    if (impl->m_thread_count < 2 ||
+        entities.size() < 2 ||
+        !impl->m_busy.compare_exchange_strong(expected, true))
+    {
+        for (Entity* entity : entities)
+        {
+            if (is_aborted(abort_switch))
+                return false;
+
+            if (!invoke_timed(impl->m_callback_name, *entity, callback))
+                return false;
+        }
+
+        return true;
+    }
+
+    impl->start_job_manager();
+
+    // Split the entities into contiguous ranges, one job per range.
+    const std::size_t entity_count = entities.size();
+    const std::size_t job_count = std::min(entity_count, impl->m_thread_count * JobsPerThread);
+    InvocationState state;
+
+    for (std::size_t i = 0; i < job_count; ++i)
+    {
+        const std::size_t begin = (i * entity_count) / job_count;
+        const std::size_t end = ((i + 1) * entity_count) / job_count;
+        assert(begin < end);
+
+        impl->m_job_queue.schedule(
+            new InvocationJob(
+                impl->m_callback_name,
+                &entities[0] + begin,
+                &entities[0] + end,
+                callback,
+                abort_switch,
+                state));
+    }
+
+    impl->m_job_queue.wait_until_completion();
+    impl->m_busy = false;
+
+    if (state.m_exception)
+        std::rethrow_exception(state.m_exception);
+
+    return state.m_success && !is_aborted(abort_switch);
+}
+
+void EntityCallbackInvoker::run_jobs(const std::vector<IJob*>& jobs)
+{
+    bool expected = false;
+    if (impl->m_thread_count < 2 ||
+        jobs.size() < 2 ||
+        !impl->m_busy.compare_exchange_strong(expected, true))
+    {
+        for (IJob* job : jobs)
+        {
+            std::unique_ptr<IJob> owned_job(job);
+            owned_job->execute(0);
+        }
+
+        return;
+    }
+
+    impl->start_job_manager();
+
+    for (IJob* job : jobs)
+        impl->m_job_queue.schedule(job);
+
+    impl->m_job_queue.wait_until_completion();
+    impl->m_busy = false;
+}
+
+}   // namespace renderer
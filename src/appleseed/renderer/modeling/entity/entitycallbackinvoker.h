@@ -0,0 +1,92 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class IJob; }
+namespace renderer      { class Entity; }
+
+namespace renderer
+{
+
+//
+// Invokes a callback such as `on_frame_begin()` on sets of entities that do not depend
+// on each other, on multiple threads when there are enough entities to keep them busy.
+//
+// Sets are processed one at a time, so dependencies between sets are honored by invoking
+// the callback on each set in the right order. Invocations made from within a callback,
+// for instance when an assembly initializes its own entities, run on the calling thread.
+//
+// The time spent in the callback is measured for every entity and slow invocations are
+// reported in the render log.
+//
+
+class EntityCallbackInvoker
+  : public foundation::NonCopyable
+{
+  public:
+    // The callback returns true on success, false on failure.
+    typedef std::function<bool (Entity& entity)> Callback;
+
+    // Constructor.
+    EntityCallbackInvoker(
+        const char*                 callback_name,
+        const std::size_t           thread_count);
+
+    // Destructor.
+    ~EntityCallbackInvoker();
+
+    // Invoke `callback` on a set of entities that do not depend on each other.
+    // Returns true on success, or false if an error occurred or if the abort switch was triggered.
+    // Exceptions thrown by the callback are rethrown on the calling thread.
+    bool invoke(
+        const std::vector<Entity*>& entities,
+        const Callback&             callback,
+        foundation::IAbortSwitch*   abort_switch);
+
+    // Run independent jobs on the threads of this invoker and wait until they complete.
+    // The jobs run on the calling thread if it is one of several running callbacks in
+    // parallel, since all threads are then busy. Takes ownership of the jobs.
+    void run_jobs(const std::vector<foundation::IJob*>& jobs);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace renderer
@@ -31,11 +31,14 @@
 
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/entity/entitycallbackinvoker.h"
 
 // Standard headers.
 #include <cassert>
+#include <mutex>
 #include <stack>
 
+using namespace foundation;
 
 namespace renderer
 {
@@ -48,11 +51,18 @@ struct OnFrameBeginRecorder::Impl
         const BaseGroup*    m_parent;
     };
 
-    std::stack<Record> m_records;
+    std::mutex              m_records_mutex;
+    std::stack<Record>      m_records;
+    EntityCallbackInvoker   m_invoker;
+
+    explicit Impl(const size_t thread_count)
+      : m_invoker("on_frame_begin", thread_count)
+    {
+    }
 };
 
-OnFrameBeginRecorder::OnFrameBeginRecorder()
-  : impl(new Impl())
+OnFrameBeginRecorder::OnFrameBeginRecorder(const size_t thread_count)
+  : impl(new Impl(thread_count))
 {
 }
 
@@ -67,9 +77,27 @@ void OnFrameBeginRecorder::record(Entity* entity, const BaseGroup* parent)
     Impl::Record record;
     record.m_entity = entity;
     record.m_parent = parent;
+
+    std::lock_guard<std::mutex> lock(impl->m_records_mutex);
     impl->m_records.push(record);
 }
 
+bool OnFrameBeginRecorder::invoke_on_frame_begin(
+    const std::vector<Entity*>& entities,
+    const Project&              project,
+    const BaseGroup*            parent,
+    IAbortSwitch*               abort_switch)
+{
+    return
+        impl->m_invoker.invoke(
+            entities,
+            [&](Entity& entity)
+            {
+                return entity.on_frame_begin(project, parent, *this, abort_switch);
+            },
+            abort_switch);
+}
+
 void OnFrameBeginRecorder::on_frame_end(const Project& project)
 {
     while (!impl->m_records.empty())
@@ -31,10 +31,15 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 // Forward declarations.
-namespace renderer  { class BaseGroup; }
-namespace renderer  { class Entity; }
-namespace renderer  { class Project; }
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class BaseGroup; }
+namespace renderer      { class Entity; }
+namespace renderer      { class Project; }
 
 namespace renderer
 {
@@ -43,15 +48,27 @@ namespace renderer
 // Keep tracks of which entities we have called `on_frame_begin()` on,
 // and allows to call `on_frame_end()` on those entities, in reverse order.
 //
+// Also invokes `on_frame_begin()` on sets of independent entities, using up to
+// `thread_count` threads. See EntityCallbackInvoker for details.
+//
 
 class APPLESEED_DLLSYMBOL OnFrameBeginRecorder
 {
   public:
-    OnFrameBeginRecorder();
+    explicit OnFrameBeginRecorder(const std::size_t thread_count = 1);
     ~OnFrameBeginRecorder();
 
+    // Thread-safe.
     void record(Entity* entity, const BaseGroup* parent);
 
+    // Invoke `on_frame_begin()` on a set of entities that do not depend on each other.
+    // Returns true on success, or false if an error occurred or if the abort switch was triggered.
+    bool invoke_on_frame_begin(
+        const std::vector<Entity*>& entities,
+        const Project&              project,
+        const BaseGroup*            parent,
+        foundation::IAbortSwitch*   abort_switch);
+
     void on_frame_end(const Project& project);
 
   private:
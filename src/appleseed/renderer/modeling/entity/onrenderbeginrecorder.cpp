@@ -31,11 +31,14 @@
 
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/entity/entitycallbackinvoker.h"
 
 // Standard headers.
 #include <cassert>
+#include <mutex>
 #include <stack>
 
+using namespace foundation;
 
 namespace renderer
 {
@@ -48,11 +51,18 @@ struct OnRenderBeginRecorder::Impl
         const BaseGroup*    m_parent;
     };
 
-    std::stack<Record> m_records;
+    std::mutex              m_records_mutex;
+    std::stack<Record>      m_records;
+    EntityCallbackInvoker   m_invoker;
+
+    explicit Impl(const size_t thread_count)
+      : m_invoker("on_render_begin", thread_count)
+    {
+    }
 };
 
-OnRenderBeginRecorder::OnRenderBeginRecorder()
-  : impl(new Impl())
+OnRenderBeginRecorder::OnRenderBeginRecorder(const size_t thread_count)
+  : impl(new Impl(thread_count))
 {
 }
 
@@ -67,9 +77,32 @@ void OnRenderBeginRecorder::record(Entity* entity, const BaseGroup* parent)
     Impl::Record record;
     record.m_entity = entity;
     record.m_parent = parent;
+
+    std::lock_guard<std::mutex> lock(impl->m_records_mutex);
     impl->m_records.push(record);
 }
 
+bool OnRenderBeginRecorder::invoke_on_render_begin(
+    const std::vector<Entity*>& entities,
+    const Project&              project,
+    const BaseGroup*            parent,
+    IAbortSwitch*               abort_switch)
+{
+    return
+        impl->m_invoker.invoke(
+            entities,
+            [&](Entity& entity)
+            {
+                return entity.on_render_begin(project, parent, *this, abort_switch);
+            },
+            abort_switch);
+}
+
+void OnRenderBeginRecorder::run_jobs(const std::vector<IJob*>& jobs)
+{
+    impl->m_invoker.run_jobs(jobs);
+}
+
 void OnRenderBeginRecorder::on_render_end(const Project& project)
 {
     while (!impl->m_records.empty())
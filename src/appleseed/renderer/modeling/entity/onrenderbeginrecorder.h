@@ -31,10 +31,16 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 // Forward declarations.
-namespace renderer  { class BaseGroup; }
-namespace renderer  { class Entity; }
-namespace renderer  { class Project; }
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class IJob; }
+namespace renderer      { class BaseGroup; }
+namespace renderer      { class Entity; }
+namespace renderer      { class Project; }
 
 namespace renderer
 {
@@ -43,15 +49,32 @@ namespace renderer
 // Keep tracks of which entities we have called `on_render_begin()` on,
 // and allows to call `on_render_end()` on those entities, in reverse order.
 //
+// Also invokes `on_render_begin()` on sets of independent entities, using up to
+// `thread_count` threads. See EntityCallbackInvoker for details.
+//
 
 class APPLESEED_DLLSYMBOL OnRenderBeginRecorder
 {
   public:
-    OnRenderBeginRecorder();
+    explicit OnRenderBeginRecorder(const std::size_t thread_count = 1);
     ~OnRenderBeginRecorder();
 
+    // Thread-safe.
     void record(Entity* entity, const BaseGroup* parent);
 
+    // Invoke `on_render_begin()` on a set of entities that do not depend on each other.
+    // Returns true on success, or false if an error occurred or if the abort switch was triggered.
+    bool invoke_on_render_begin(
+        const std::vector<Entity*>& entities,
+        const Project&              project,
+        const BaseGroup*            parent,
+        foundation::IAbortSwitch*   abort_switch);
+
+    // Run independent jobs on the threads used to invoke `on_render_begin()` and wait until
+    // they complete. Allows entities to parallelize expensive preparations without creating
+    // threads of their own. Takes ownership of the jobs.
+    void run_jobs(const std::vector<foundation::IJob*>& jobs);
+
     void on_render_end(const Project& project);
 
   private:
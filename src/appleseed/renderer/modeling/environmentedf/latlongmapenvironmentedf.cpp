@@ -37,18 +37,22 @@
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/color/colorspace.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/entity/onrenderbeginrecorder.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/source.h"
 #include "renderer/modeling/input/sourceinputs.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/renderdatacache.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/paramarray.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/containers/dictionary.h"
+#include "foundation/hash/siphash.h"
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/math/matrix.h"
@@ -62,17 +66,20 @@
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/job/ijob.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 // Forward declarations.
 namespace renderer  { class OnFrameBeginRecorder; }
-namespace renderer  { class OnRenderBeginRecorder; }
 
 using namespace foundation;
 
@@ -97,6 +104,12 @@ namespace
 
     typedef ImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
 
+    //
+    // Samples the environment map to build its importance map. When the importance map
+    // has a lower resolution than the environment map, each of its pixels covers a block
+    // of texels whose radiance is averaged.
+    //
+
     class ImageSampler
     {
       public:
@@ -106,11 +119,15 @@ namespace
             const Source*   multiplier_source,
             const float     exposure_multiplier,
             const size_t    width,
-            const size_t    height)
+            const size_t    height,
+            const size_t    block_size = 1)
           : m_texture_cache(texture_cache)
           , m_radiance_source(radiance_source)
           , m_multiplier_source(multiplier_source)
           , m_exposure_multiplier(exposure_multiplier)
+          , m_width(width)
+          , m_height(height)
+          , m_block_size(block_size)
           , m_rcp_width(1.0f / width)
           , m_rcp_height(1.0f / height)
         {
@@ -125,24 +142,31 @@ namespace
                 return;
             }
 
-            const Vector2f uv(
-                (x + 0.5f) * m_rcp_width,
-                1.0f - (y + 0.5f) * m_rcp_height);
-
-            m_radiance_source->evaluate(m_texture_cache, SourceInputs(uv), payload);
-
-            if (is_finite(payload))
-            {
-                float multiplier;
-                m_multiplier_source->evaluate(m_texture_cache, SourceInputs(uv), multiplier);
-                payload *= multiplier * m_exposure_multiplier;
-                importance = luminance(payload);
-            }
+            if (m_block_size == 1)
+                sample_texel(x, y, payload);
             else
             {
+                const size_t x_begin = x * m_block_size;
+                const size_t y_begin = y * m_block_size;
+                const size_t x_end = std::min(x_begin + m_block_size, m_width);
+                const size_t y_end = std::min(y_begin + m_block_size, m_height);
+
                 payload.set(0.0f);
-                importance = 0.0f;
+
+                for (size_t ty = y_begin; ty < y_end; ++ty)
+                {
+                    for (size_t tx = x_begin; tx < x_end; ++tx)
+                    {
+                        Color3f texel;
+                        sample_texel(tx, ty, texel);
+                        payload += texel;
+                    }
+                }
+
+                payload /= static_cast<float>((x_end - x_begin) * (y_end - y_begin));
             }
+
+            importance = luminance(payload);
         }
 
       private:
@@ -150,8 +174,94 @@ namespace
         const Source*   m_radiance_source;
         const Source*   m_multiplier_source;
         const float     m_exposure_multiplier;
+        const size_t    m_width;
+        const size_t    m_height;
+        const size_t    m_block_size;
         const float     m_rcp_width;
         const float     m_rcp_height;
+
+        void sample_texel(const size_t x, const size_t y, Color3f& radiance)
+        {
+            const Vector2f uv(
+                (x + 0.5f) * m_rcp_width,
+                1.0f - (y + 0.5f) * m_rcp_height);
+
+            m_radiance_source->evaluate(m_texture_cache, SourceInputs(uv), radiance);
+
+            if (is_finite(radiance))
+            {
+                float multiplier;
+                m_multiplier_source->evaluate(m_texture_cache, SourceInputs(uv), multiplier);
+                radiance *= multiplier * m_exposure_multiplier;
+            }
+            else radiance.set(0.0f);
+        }
+    };
+
+    //
+    // Builds a range of rows of an importance map.
+    //
+
+    class ImportanceMapRowsJob
+      : public IJob
+    {
+      public:
+        ImportanceMapRowsJob(
+            ImageImportanceSamplerType& importance_sampler,
+            TextureStore&               texture_store,
+            const Source*               radiance_source,
+            const Source*               multiplier_source,
+            const float                 exposure_multiplier,
+            const size_t                width,
+            const size_t                height,
+            const size_t                block_size,
+            const size_t                row_begin,
+            const size_t                row_end,
+            IAbortSwitch*               abort_switch)
+          : m_importance_sampler(importance_sampler)
+          , m_texture_store(texture_store)
+          , m_radiance_source(radiance_source)
+          , m_multiplier_source(multiplier_source)
+          , m_exposure_multiplier(exposure_multiplier)
+          , m_width(width)
+          , m_height(height)
+          , m_block_size(block_size)
+          , m_row_begin(row_begin)
+          , m_row_end(row_end)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            if (is_aborted(m_abort_switch))
+                return;
+
+            TextureCache texture_cache(m_texture_store);
+            ImageSampler sampler(
+                texture_cache,
+                m_radiance_source,
+                m_multiplier_source,
+                m_exposure_multiplier,
+                m_width,
+                m_height,
+                m_block_size);
+
+            m_importance_sampler.rebuild_rows(sampler, m_row_begin, m_row_end);
+        }
+
+      private:
+        ImageImportanceSamplerType&     m_importance_sampler;
+        TextureStore&                   m_texture_store;
+        const Source*                   m_radiance_source;
+        const Source*                   m_multiplier_source;
+        const float                     m_exposure_multiplier;
+        const size_t                    m_width;
+        const size_t                    m_height;
+        const size_t                    m_block_size;
+        const size_t                    m_row_begin;
+        const size_t                    m_row_end;
+        IAbortSwitch*                   m_abort_switch;
     };
 
     const char* Model = "latlong_map_environment_edf";
@@ -166,6 +276,7 @@ namespace
           : EnvironmentEDF(name, params)
           , m_importance_map_width(0)
           , m_importance_map_height(0)
+          , m_importance_map_block_size(1)
           , m_probability_scale(0.0f)
         {
             m_inputs.declare("radiance", InputFormat::SpectralIlluminance);
@@ -174,6 +285,7 @@ namespace
 
             m_phi_shift = deg_to_rad(m_params.get_optional<float>("horizontal_shift", 0.0f));
             m_theta_shift = deg_to_rad(m_params.get_optional<float>("vertical_shift", 0.0f));
+            m_max_importance_map_size = std::max<size_t>(m_params.get_optional<size_t>("max_importance_map_size", 4096), 1);
         }
 
         void release() override
@@ -203,7 +315,7 @@ namespace
 
             // Build importance map only if this environment EDF is the active one.
             if (project.get_scene()->get_environment()->get_uncached_environment_edf() == this)
-                build_importance_map(*project.get_scene(), abort_switch);
+                build_importance_map(project, recorder, abort_switch);
 
             return true;
         }
@@ -258,8 +370,11 @@ namespace
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             outgoing = transform.vector_to_parent(local_outgoing);
 
-            // Return the emitted radiance.
-            value.set(payload, g_std_lighting_conditions, Spectrum::Illuminance);
+            // Return the emitted radiance. When the importance map has a lower resolution
+            // than the environment map, the payload is an average over several texels.
+            if (m_importance_map_block_size > 1)
+                lookup_environment_map(shading_context, u, v, value);
+            else value.set(payload, g_std_lighting_conditions, Spectrum::Illuminance);
 
             // Compute the probability density of this direction.
             probability = prob_xy * m_probability_scale / sin_theta;
@@ -374,26 +489,41 @@ namespace
         float   m_phi_shift;                        // horizontal shift in radians
         float   m_theta_shift;                      // vertical shift in radians
 
+        size_t  m_max_importance_map_size;          // maximum width and height of the importance map
         size_t  m_importance_map_width;
         size_t  m_importance_map_height;
+        size_t  m_importance_map_block_size;        // width and height in texels of a pixel of the importance map
 
         float   m_rcp_importance_map_width;
         float   m_rcp_importance_map_height;
         float   m_probability_scale;
 
-        std::unique_ptr<ImageImportanceSamplerType> m_importance_sampler;
+        std::shared_ptr<const ImageImportanceSamplerType> m_importance_sampler;
 
-        void build_importance_map(const Scene& scene, IAbortSwitch* abort_switch)
+        void build_importance_map(
+            const Project&          project,
+            OnRenderBeginRecorder&  recorder,
+            IAbortSwitch*           abort_switch)
         {
             Stopwatch<DefaultWallclockTimer> stopwatch;
             stopwatch.start();
 
             const Source* radiance_source = m_inputs.source("radiance");
             assert(radiance_source);
+            const Source* multiplier_source = m_inputs.source("radiance_multiplier");
 
+            // Huge environment maps are importance sampled at a lower resolution to bound
+            // the memory footprint and the build time of the importance map.
             const Source::Hints radiance_source_hints = radiance_source->get_hints();
-            m_importance_map_width = radiance_source_hints.m_width;
-            m_importance_map_height = radiance_source_hints.m_height;
+            m_importance_map_block_size = 1;
+            while (std::max(radiance_source_hints.m_width, radiance_source_hints.m_height) >
+                   m_max_importance_map_size * m_importance_map_block_size)
+                m_importance_map_block_size *= 2;
+
+            m_importance_map_width =
+                (radiance_source_hints.m_width + m_importance_map_block_size - 1) / m_importance_map_block_size;
+            m_importance_map_height =
+                (radiance_source_hints.m_height + m_importance_map_block_size - 1) / m_importance_map_block_size;
 
             m_rcp_importance_map_width = 1.0f / m_importance_map_width;
             m_rcp_importance_map_height = 1.0f / m_importance_map_height;
@@ -401,17 +531,29 @@ namespace
             const size_t texel_count = m_importance_map_width * m_importance_map_height;
             m_probability_scale = texel_count / (2.0f * PiSquare<float>());
 
-            TextureStore texture_store(scene);
-            TextureCache texture_cache(texture_store);
-            ImageSampler sampler(
-                texture_cache,
-                radiance_source,
-                m_inputs.source("radiance_multiplier"),
-                m_exposure_multiplier,
-                m_importance_map_width,
-                m_importance_map_height);
+            // Importance maps of large environment maps are expensive to build: reuse the one
+            // built by a previous render of the project if its inputs did not change.
+            std::uint64_t signature =
+                Entity::combine_signatures(
+                    radiance_source->compute_signature(),
+                    multiplier_source->compute_signature());
+            signature = Entity::combine_signatures(signature, siphash24(m_exposure_multiplier));
+            signature = Entity::combine_signatures(signature, siphash24(m_importance_map_block_size));
+
+            RenderDataCache& render_data_cache = project.get_render_data_cache();
+            m_importance_sampler =
+                render_data_cache.get<ImageImportanceSamplerType>(get_path().c_str(), signature);
+            if (m_importance_sampler)
+            {
+                RENDERER_LOG_INFO(
+                    "reusing " FMT_SIZE_T "x" FMT_SIZE_T " importance map for environment edf \"%s\".",
+                    m_importance_map_width,
+                    m_importance_map_height,
+                    get_path().c_str());
+                return;
+            }
 
-            m_importance_sampler.reset(
+            std::shared_ptr<ImageImportanceSamplerType> importance_sampler(
                 new ImageImportanceSamplerType(
                     m_importance_map_width,
                     m_importance_map_height));
@@ -423,19 +565,45 @@ namespace
                 m_importance_map_height,
                 get_path().c_str());
 
-            m_importance_sampler->rebuild(sampler, abort_switch);
+            // Build rows of the importance map in parallel, on the threads used to prepare the scene.
+            const size_t RowsPerJob = 16;
+            const Scene& scene = *project.get_scene();
+            TextureStore texture_store(scene);
+            std::vector<IJob*> jobs;
 
-            if (is_aborted(abort_switch))
-                m_importance_sampler.reset();
-            else
+            for (size_t row_begin = 0; row_begin < m_importance_map_height; row_begin += RowsPerJob)
             {
-                stopwatch.measure();
-
-                RENDERER_LOG_INFO(
-                    "built importance map for environment edf \"%s\" in %s.",
-                    get_path().c_str(),
-                    pretty_time(stopwatch.get_seconds()).c_str());
+                jobs.push_back(
+                    new ImportanceMapRowsJob(
+                        *importance_sampler,
+                        texture_store,
+                        radiance_source,
+                        multiplier_source,
+                        m_exposure_multiplier,
+                        radiance_source_hints.m_width,
+                        radiance_source_hints.m_height,
+                        m_importance_map_block_size,
+                        row_begin,
+                        std::min(row_begin + RowsPerJob, m_importance_map_height),
+                        abort_switch));
             }
+
+            recorder.run_jobs(jobs);
+
+            if (is_aborted(abort_switch))
+                return;
+
+            importance_sampler->rebuild_rows_cdf();
+
+            m_importance_sampler = importance_sampler;
+            render_data_cache.set(get_path().c_str(), signature, m_importance_sampler);
+
+            stopwatch.measure();
+
+            RENDERER_LOG_INFO(
+                "built importance map for environment edf \"%s\" in %s.",
+                get_path().c_str(),
+                pretty_time(stopwatch.get_seconds()).c_str());
         }
 
         void lookup_environment_map(
@@ -584,6 +752,23 @@ DictionaryArray LatLongMapEnvironmentEDFFactory::get_input_metadata() const
             .insert("use", "optional")
             .insert("help", "Environment texture vertical shift in degrees"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "max_importance_map_size")
+            .insert("label", "Max Importance Map Size")
+            .insert("type", "numeric")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "16")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "16384")
+                    .insert("type", "soft"))
+            .insert("default", "4096")
+            .insert("use", "optional")
+            .insert("help", "Maximum resolution of the importance map; larger environment maps are importance sampled at a lower resolution"));
+
     add_common_input_metadata(metadata);
 
     return metadata;
@@ -36,6 +36,7 @@
 #include "renderer/modeling/input/sourceinputs.h"
 
 // appleseed.foundation headers.
+#include "foundation/memory/alignedallocator.h"
 #include "foundation/memory/memory.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/otherwise.h"
@@ -332,12 +333,21 @@ namespace
 
 struct InputArray::Impl
 {
+    typedef std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>> ValueVector;
+
     InputVector m_inputs;
+
+    // When no input is bound to a varying source, the values of all inputs,
+    // precomputed by update_uniform_values() so that evaluating them is a plain copy.
+    // Declaring or binding an input invalidates them until the next update.
+    bool        m_all_uniform;
+    ValueVector m_uniform_values;
 };
 
 InputArray::InputArray()
   : impl(new Impl())
 {
+    impl->m_all_uniform = false;
 }
 
 InputArray::~InputArray()
@@ -367,6 +377,7 @@ void InputArray::declare(
     input.m_entity = nullptr;
 
     impl->m_inputs.push_back(input);
+    impl->m_all_uniform = false;
 }
 
 InputArray::iterator InputArray::begin()
@@ -466,14 +477,39 @@ void InputArray::evaluate(
 
     std::uint8_t* ptr = static_cast<std::uint8_t*>(values);
 
-#ifdef APPLESEED_USE_SSE
+    // Input values are laid out at 16-byte aligned offsets, whether SSE is used or not.
     assert(is_aligned(ptr, 16));
-#endif
+
+    if (impl->m_all_uniform)
+    {
+        if (!impl->m_uniform_values.empty())
+            std::memcpy(ptr, impl->m_uniform_values.data(), impl->m_uniform_values.size());
+        return;
+    }
 
     for (const_each<InputVector> i = impl->m_inputs; i; ++i)
         ptr = i->evaluate(texture_cache, source_inputs, ptr);
 }
 
+void InputArray::update_uniform_values()
+{
+    impl->m_all_uniform = false;
+    impl->m_uniform_values.clear();
+
+    for (const_each<InputVector> i = impl->m_inputs; i; ++i)
+    {
+        if (i->m_source && !i->m_source->is_uniform())
+            return;
+    }
+
+    impl->m_uniform_values.resize(compute_data_size());
+
+    if (!impl->m_uniform_values.empty())
+        evaluate_uniforms(impl->m_uniform_values.data());
+
+    impl->m_all_uniform = true;
+}
+
 void InputArray::evaluate_uniforms(
     void*               values) const
 {
@@ -621,6 +657,8 @@ void InputArray::iterator::bind(Source* source)
     Input& input = m_input_array->impl->m_inputs[m_input_index];
     delete input.m_source;
     input.m_source = source;
+
+    m_input_array->impl->m_all_uniform = false;
 }
 
 void InputArray::iterator::bind(Entity* entity)
@@ -226,6 +226,10 @@ class APPLESEED_DLLSYMBOL InputArray
     void evaluate_uniforms(
         void*                       values) const;
 
+    // Precompute the values of all inputs if none of them is bound to a varying source,
+    // so that evaluate() becomes a plain copy. Called once per frame by the owning entity.
+    void update_uniform_values();
+
   private:
     struct Impl;
     Impl* impl;
@@ -0,0 +1,220 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "asyncmeshobjectreader.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <cassert>
+#include <deque>
+#include <string>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+namespace
+{
+    struct Read
+    {
+        const SearchPaths       m_search_paths;
+        const std::string       m_base_object_name;
+        const ParamArray        m_params;
+        MeshObjectArray         m_objects;
+        bool                    m_success;
+        double                  m_seconds;
+
+        Read(
+            const SearchPaths&  search_paths,
+            const char*         base_object_name,
+            const ParamArray&   params)
+          : m_search_paths(search_paths)
+          , m_base_object_name(base_object_name)
+          , m_params(params)
+          , m_success(false)
+          , m_seconds(0.0)
+        {
+        }
+    };
+
+    class ReadJob
+      : public IJob
+    {
+      public:
+        explicit ReadJob(Read& read)
+          : m_read(read)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+
+            // Per-file loading times are reported by the mesh object reader.
+            // Files are already read concurrently, each one is parsed on a single thread.
+            m_read.m_success =
+                MeshObjectReader::read(
+                    m_read.m_search_paths,
+                    m_read.m_base_object_name.c_str(),
+                    m_read.m_params,
+                    m_read.m_objects,
+                    MeshObjectReader::OmitParallelParsing);
+
+            m_read.m_seconds = stopwatch.measure().get_seconds();
+        }
+
+      private:
+        Read& m_read;
+    };
+
+    void delete_objects(MeshObjectArray& objects)
+    {
+        for (size_t i = 0, e = objects.size(); i < e; ++i)
+            objects[i]->release();
+
+        objects.clear();
+    }
+}
+
+struct AsyncMeshObjectReader::Impl
+{
+    std::deque<Read>            m_reads;        // a deque never moves existing elements
+    JobQueue                    m_job_queue;
+    JobManager                  m_job_manager;
+    Stopwatch<DefaultWallclockTimer> m_stopwatch;
+
+    explicit Impl(const size_t thread_count)
+      : m_job_manager(
+            global_logger(),
+            m_job_queue,
+            thread_count,
+            JobManager::KeepRunningOnEmptyQueue | JobManager::KeepRunningOnJobFailure)
+    {
+    }
+};
+
+AsyncMeshObjectReader::AsyncMeshObjectReader(const size_t thread_count)
+  : impl(new Impl(thread_count))
+{
+    impl->m_stopwatch.start();
+    impl->m_job_manager.start();
+}
+
+AsyncMeshObjectReader::~AsyncMeshObjectReader()
+{
+    impl->m_job_queue.wait_until_completion();
+    impl->m_job_manager.stop();
+
+    for (Read& read : impl->m_reads)
+        delete_objects(read.m_objects);
+
+    delete impl;
+}
+
+size_t AsyncMeshObjectReader::enqueue(
+    const SearchPaths&          search_paths,
+    const char*                 base_object_name,
+    const ParamArray&           params)
+{
+    impl->m_reads.emplace_back(search_paths, base_object_name, params);
+    impl->m_job_queue.schedule(new ReadJob(impl->m_reads.back()));
+
+    return impl->m_reads.size() - 1;
+}
+
+size_t AsyncMeshObjectReader::size() const
+{
+    return impl->m_reads.size();
+}
+
+void AsyncMeshObjectReader::wait()
+{
+    impl->m_job_queue.wait_until_completion();
+
+    if (impl->m_reads.empty())
+        return;
+
+    double total_seconds = 0.0;
+    size_t object_count = 0;
+
+    for (const Read& read : impl->m_reads)
+    {
+        total_seconds += read.m_seconds;
+        object_count += read.m_objects.size();
+    }
+
+    const double elapsed_seconds = impl->m_stopwatch.measure().get_seconds();
+
+    RENDERER_LOG_INFO(
+        "read %s %s from %s mesh %s using %s %s in %s (cumulative read time %s).",
+        pretty_uint(object_count).c_str(),
+        object_count > 1 ? "objects" : "object",
+        pretty_uint(impl->m_reads.size()).c_str(),
+        impl->m_reads.size() > 1 ? "definitions" : "definition",
+        pretty_uint(impl->m_job_manager.get_thread_count()).c_str(),
+        impl->m_job_manager.get_thread_count() > 1 ? "threads" : "thread",
+        pretty_time(elapsed_seconds).c_str(),
+        pretty_time(total_seconds).c_str());
+}
+
+bool AsyncMeshObjectReader::take_objects(
+    const size_t                read_index,
+    MeshObjectArray&            objects)
+{
+    assert(read_index < impl->m_reads.size());
+
+    Read& read = impl->m_reads[read_index];
+
+    if (!read.m_success)
+    {
+        delete_objects(read.m_objects);
+        return false;
+    }
+
+    objects = read.m_objects;
+    read.m_objects.clear();
+
+    return true;
+}
+
+}   // namespace renderer
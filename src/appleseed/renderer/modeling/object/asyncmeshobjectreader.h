@@ -0,0 +1,89 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/modeling/object/meshobjectreader.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class SearchPaths; }
+namespace renderer      { class ParamArray; }
+
+namespace renderer
+{
+
+//
+// Read mesh objects from disk on a pool of worker threads.
+//
+// Reads are enqueued (typically while a project file is being parsed) and start
+// immediately; their results are claimed once wait() has returned.
+//
+
+class AsyncMeshObjectReader
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Worker threads are started immediately.
+    explicit AsyncMeshObjectReader(const size_t thread_count);
+
+    // Destructor. Waits for all reads to complete and deletes unclaimed mesh objects.
+    ~AsyncMeshObjectReader();
+
+    // Enqueue the reading of mesh objects from disk. The filenames are defined in params.
+    // Return the index of the read.
+    size_t enqueue(
+        const foundation::SearchPaths&  search_paths,
+        const char*                     base_object_name,
+        const ParamArray&               params);
+
+    // Return the number of enqueued reads.
+    size_t size() const;
+
+    // Wait until all enqueued reads are complete and print a summary.
+    void wait();
+
+    // Transfer the mesh objects produced by a given read to the caller.
+    // Return false if this read failed. Must only be called after wait().
+    bool take_objects(
+        const size_t                    read_index,
+        MeshObjectArray&                objects);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace renderer
@@ -44,6 +44,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -63,8 +64,21 @@ namespace
 
 struct MeshObject::Impl
 {
-    StaticTriangleTess          m_tess;
-    std::vector<std::string>    m_material_slots;
+    std::unique_ptr<StaticTriangleTess> m_tess;
+    std::vector<std::string>            m_material_slots;
+
+    // Deferred geometry loading.
+    std::string                         m_geometry_filepath;
+    size_t                              m_geometry_mesh_index;
+    GAABB3                              m_geometry_bbox;
+    bool                                m_geometry_loaded;
+
+    Impl()
+      : m_tess(new StaticTriangleTess())
+      , m_geometry_mesh_index(0)
+      , m_geometry_loaded(true)
+    {
+    }
 };
 
 MeshObject::MeshObject(
@@ -98,28 +112,31 @@ const Source* MeshObject::get_uncached_alpha_map() const
 
 GAABB3 MeshObject::compute_local_bbox() const
 {
-    return impl->m_tess.compute_local_bbox();
+    return
+        impl->m_geometry_loaded
+            ? impl->m_tess->compute_local_bbox()
+            : impl->m_geometry_bbox;
 }
 
 const StaticTriangleTess& MeshObject::get_static_triangle_tess() const
 {
-    return impl->m_tess;
+    return *impl->m_tess;
 }
 
 void MeshObject::rasterize(ObjectRasterizer& rasterizer) const
 {
-    rasterizer.begin_object(impl->m_tess.m_primitives.size());
+    rasterizer.begin_object(impl->m_tess->m_primitives.size());
 
-    for (const auto& prim : impl->m_tess.m_primitives)
+    for (const auto& prim : impl->m_tess->m_primitives)
     {
-        const auto& v0 = impl->m_tess.m_vertices[prim.m_v0];
-        const auto& v1 = impl->m_tess.m_vertices[prim.m_v1];
-        const auto& v2 = impl->m_tess.m_vertices[prim.m_v2];
+        const auto& v0 = impl->m_tess->m_vertices[prim.m_v0];
+        const auto& v1 = impl->m_tess->m_vertices[prim.m_v1];
+        const auto& v2 = impl->m_tess->m_vertices[prim.m_v2];
 
         // todo: check that vertex normals are available.
-        const auto& n0 = impl->m_tess.m_vertex_normals[prim.m_n0];
-        const auto& n1 = impl->m_tess.m_vertex_normals[prim.m_n1];
-        const auto& n2 = impl->m_tess.m_vertex_normals[prim.m_n2];
+        const auto& n0 = impl->m_tess->m_vertex_normals[prim.m_n0];
+        const auto& n1 = impl->m_tess->m_vertex_normals[prim.m_n1];
+        const auto& n2 = impl->m_tess->m_vertex_normals[prim.m_n2];
 
         ObjectRasterizer::Triangle triangle;
 
@@ -155,135 +172,161 @@ void MeshObject::rasterize(ObjectRasterizer& rasterizer) const
 
 void MeshObject::reserve_vertices(const size_t count)
 {
-    impl->m_tess.m_vertices.reserve(count);
+    impl->m_tess->m_vertices.reserve(count);
 }
 
 size_t MeshObject::push_vertex(const GVector3& vertex)
 {
-    const size_t index = impl->m_tess.m_vertices.size();
-    impl->m_tess.m_vertices.push_back(vertex);
+    const size_t index = impl->m_tess->m_vertices.size();
+    impl->m_tess->m_vertices.push_back(vertex);
+    return index;
+}
+
+size_t MeshObject::push_vertices(const GVector3 vertices[], const size_t count)
+{
+    const size_t index = impl->m_tess->m_vertices.size();
+    impl->m_tess->m_vertices.insert(impl->m_tess->m_vertices.end(), vertices, vertices + count);
     return index;
 }
 
 size_t MeshObject::get_vertex_count() const
 {
-    return impl->m_tess.m_vertices.size();
+    return impl->m_tess->m_vertices.size();
 }
 
 const GVector3& MeshObject::get_vertex(const size_t index) const
 {
-    return impl->m_tess.m_vertices[index];
+    return impl->m_tess->m_vertices[index];
 }
 
 void MeshObject::reserve_vertex_normals(const size_t count)
 {
-    impl->m_tess.m_vertex_normals.reserve(count);
+    impl->m_tess->m_vertex_normals.reserve(count);
 }
 
 size_t MeshObject::push_vertex_normal(const GVector3& normal)
 {
     assert(is_normalized(normal));
 
-    const size_t index = impl->m_tess.m_vertex_normals.size();
-    impl->m_tess.m_vertex_normals.push_back(normal);
+    const size_t index = impl->m_tess->m_vertex_normals.size();
+    impl->m_tess->m_vertex_normals.push_back(normal);
+    return index;
+}
+
+size_t MeshObject::push_vertex_normals(const GVector3 normals[], const size_t count)
+{
+    const size_t index = impl->m_tess->m_vertex_normals.size();
+    impl->m_tess->m_vertex_normals.insert(impl->m_tess->m_vertex_normals.end(), normals, normals + count);
     return index;
 }
 
 size_t MeshObject::get_vertex_normal_count() const
 {
-    return impl->m_tess.m_vertex_normals.size();
+    return impl->m_tess->m_vertex_normals.size();
 }
 
 const GVector3& MeshObject::get_vertex_normal(const size_t index) const
 {
-    return impl->m_tess.m_vertex_normals[index];
+    return impl->m_tess->m_vertex_normals[index];
 }
 
 void MeshObject::clear_vertex_normals()
 {
-    impl->m_tess.m_vertex_normals.clear();
+    impl->m_tess->m_vertex_normals.clear();
 }
 
 void MeshObject::reserve_vertex_tangents(const size_t count)
 {
-    impl->m_tess.reserve_vertex_tangents(count);
+    impl->m_tess->reserve_vertex_tangents(count);
 }
 
 size_t MeshObject::push_vertex_tangent(const GVector3& tangent)
 {
-    return impl->m_tess.push_vertex_tangent(tangent);
+    return impl->m_tess->push_vertex_tangent(tangent);
 }
 
 size_t MeshObject::get_vertex_tangent_count() const
 {
-    return impl->m_tess.get_vertex_tangent_count();
+    return impl->m_tess->get_vertex_tangent_count();
 }
 
 GVector3 MeshObject::get_vertex_tangent(const size_t index) const
 {
-    return impl->m_tess.get_vertex_tangent(index);
+    return impl->m_tess->get_vertex_tangent(index);
 }
 
 void MeshObject::reserve_tex_coords(const size_t count)
 {
-    impl->m_tess.reserve_tex_coords(count);
+    impl->m_tess->reserve_tex_coords(count);
 }
 
 size_t MeshObject::push_tex_coords(const GVector2& tex_coords)
 {
-    return impl->m_tess.push_tex_coords(tex_coords);
+    return impl->m_tess->push_tex_coords(tex_coords);
+}
+
+size_t MeshObject::push_tex_coords(const GVector2 tex_coords[], const size_t count)
+{
+    return impl->m_tess->push_tex_coords(tex_coords, count);
 }
 
 size_t MeshObject::get_tex_coords_count() const
 {
-    return impl->m_tess.get_tex_coords_count();
+    return impl->m_tess->get_tex_coords_count();
 }
 
 GVector2 MeshObject::get_tex_coords(const size_t index) const
 {
-    return impl->m_tess.get_tex_coords(index);
+    return impl->m_tess->get_tex_coords(index);
 }
 
 void MeshObject::reserve_triangles(const size_t count)
 {
-    impl->m_tess.m_primitives.reserve(count);
+    impl->m_tess->m_primitives.reserve(count);
 }
 
 size_t MeshObject::push_triangle(const Triangle& triangle)
 {
-    const size_t index = impl->m_tess.m_primitives.size();
-    impl->m_tess.m_primitives.push_back(triangle);
+    const size_t index = impl->m_tess->m_primitives.size();
+    impl->m_tess->m_primitives.push_back(triangle);
+    return index;
+}
+
+size_t MeshObject::push_triangles(const Triangle triangles[], const size_t count)
+{
+    const size_t index = impl->m_tess->m_primitives.size();
+    impl->m_tess->m_primitives.insert(impl->m_tess->m_primitives.end(), triangles, triangles + count);
     return index;
 }
 
 size_t MeshObject::get_triangle_count() const
 {
-    return impl->m_tess.m_primitives.size();
+    return impl->m_tess->m_primitives.size();
 }
 
 const Triangle& MeshObject::get_triangle(const size_t index) const
 {
-    return impl->m_tess.m_primitives[index];
+    return impl->m_tess->m_primitives[index];
 }
 
 Triangle& MeshObject::get_triangle(const size_t index)
 {
-    return impl->m_tess.m_primitives[index];
+    return impl->m_tess->m_primitives[index];
 }
 
 void MeshObject::clear_triangles()
 {
-    impl->m_tess.m_primitives.clear();
+    impl->m_tess->m_primitives.clear();
 }
 
 void MeshObject::set_motion_segment_count(const size_t count)
 {
-    impl->m_tess.set_motion_segment_count(count);
+    impl->m_tess->set_motion_segment_count(count);
 }
 
 size_t MeshObject::get_motion_segment_count() const
 {
-    return impl->m_tess.get_motion_segment_count();
+    return impl->m_tess->get_motion_segment_count();
 }
 
 void MeshObject::set_vertex_pose(
@@ -291,19 +334,19 @@ void MeshObject::set_vertex_pose(
     const size_t            motion_segment_index,
     const GVector3&         vertex)
 {
-    impl->m_tess.set_vertex_pose(vertex_index, motion_segment_index, vertex);
+    impl->m_tess->set_vertex_pose(vertex_index, motion_segment_index, vertex);
 }
 
 GVector3 MeshObject::get_vertex_pose(
     const size_t            vertex_index,
     const size_t            motion_segment_index) const
 {
-    return impl->m_tess.get_vertex_pose(vertex_index, motion_segment_index);
+    return impl->m_tess->get_vertex_pose(vertex_index, motion_segment_index);
 }
 
 void MeshObject::clear_vertex_poses()
 {
-    impl->m_tess.clear_vertex_poses();
+    impl->m_tess->clear_vertex_poses();
 }
 
 void MeshObject::set_vertex_normal_pose(
@@ -311,19 +354,19 @@ void MeshObject::set_vertex_normal_pose(
     const size_t            motion_segment_index,
     const GVector3&         normal)
 {
-    impl->m_tess.set_vertex_normal_pose(normal_index, motion_segment_index, normal);
+    impl->m_tess->set_vertex_normal_pose(normal_index, motion_segment_index, normal);
 }
 
 GVector3 MeshObject::get_vertex_normal_pose(
     const size_t            normal_index,
     const size_t            motion_segment_index) const
 {
-    return impl->m_tess.get_vertex_normal_pose(normal_index, motion_segment_index);
+    return impl->m_tess->get_vertex_normal_pose(normal_index, motion_segment_index);
 }
 
 void MeshObject::clear_vertex_normal_poses()
 {
-    impl->m_tess.clear_vertex_normal_poses();
+    impl->m_tess->clear_vertex_normal_poses();
 }
 
 void MeshObject::set_vertex_tangent_pose(
@@ -331,19 +374,19 @@ void MeshObject::set_vertex_tangent_pose(
     const size_t            motion_segment_index,
     const GVector3&         tangent)
 {
-    impl->m_tess.set_vertex_tangent_pose(tangent_index, motion_segment_index, tangent);
+    impl->m_tess->set_vertex_tangent_pose(tangent_index, motion_segment_index, tangent);
 }
 
 GVector3 MeshObject::get_vertex_tangent_pose(
     const size_t            tangent_index,
     const size_t            motion_segment_index) const
 {
-    return impl->m_tess.get_vertex_tangent_pose(tangent_index, motion_segment_index);
+    return impl->m_tess->get_vertex_tangent_pose(tangent_index, motion_segment_index);
 }
 
 void MeshObject::clear_vertex_tangent_poses()
 {
-    impl->m_tess.clear_vertex_tangent_poses();
+    impl->m_tess->clear_vertex_tangent_poses();
 }
 
 void MeshObject::reserve_material_slots(const size_t count)
@@ -392,6 +435,70 @@ void MeshObject::update_asset_paths(const StringDictionary& mappings)
     }
 }
 
+void MeshObject::defer_geometry_loading(
+    const char*             filepath,
+    const size_t            mesh_index,
+    const GAABB3&           bbox)
+{
+    assert(filepath);
+
+    impl->m_tess.reset(new StaticTriangleTess());
+    impl->m_geometry_filepath = filepath;
+    impl->m_geometry_mesh_index = mesh_index;
+    impl->m_geometry_bbox = bbox;
+    impl->m_geometry_loaded = false;
+}
+
+bool MeshObject::has_deferred_geometry() const
+{
+    return !impl->m_geometry_filepath.empty();
+}
+
+bool MeshObject::is_geometry_loaded() const
+{
+    return impl->m_geometry_loaded;
+}
+
+bool MeshObject::load_geometry()
+{
+    if (impl->m_geometry_loaded)
+        return true;
+
+    if (!MeshObjectReader::read_deferred_geometry(
+            *this,
+            impl->m_geometry_filepath.c_str(),
+            impl->m_geometry_mesh_index))
+    {
+        impl->m_tess.reset(new StaticTriangleTess());
+        return false;
+    }
+
+    impl->m_geometry_loaded = true;
+    return true;
+}
+
+void MeshObject::unload_geometry()
+{
+    if (!has_deferred_geometry() || !impl->m_geometry_loaded)
+        return;
+
+    impl->m_tess.reset(new StaticTriangleTess());
+    impl->m_geometry_loaded = false;
+}
+
+size_t MeshObject::get_geometry_memory_size() const
+{
+    const StaticTriangleTess& tess = *impl->m_tess;
+    const size_t pose_count = tess.get_motion_segment_count() + 1;
+
+    return
+          tess.m_vertices.capacity() * pose_count * sizeof(GVector3)
+        + tess.m_vertex_normals.capacity() * pose_count * sizeof(GVector3)
+        + tess.get_vertex_tangent_count() * pose_count * sizeof(GVector3)
+        + tess.get_tex_coords_count() * sizeof(GVector2)
+        + tess.m_primitives.capacity() * sizeof(Triangle);
+}
+
 
 //
 // MeshObjectFactory class implementation.
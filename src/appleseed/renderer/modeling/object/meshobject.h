@@ -90,12 +90,14 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Insert and access vertices.
     void reserve_vertices(const size_t count);
     size_t push_vertex(const GVector3& vertex);
+    size_t push_vertices(const GVector3 vertices[], const size_t count);
     size_t get_vertex_count() const;
     const GVector3& get_vertex(const size_t index) const;
 
     // Insert and access vertex normals.
     void reserve_vertex_normals(const size_t count);
     size_t push_vertex_normal(const GVector3& normal);      // the normal must be unit-length
+    size_t push_vertex_normals(const GVector3 normals[], const size_t count);
     size_t get_vertex_normal_count() const;
     const GVector3& get_vertex_normal(const size_t index) const;
     void clear_vertex_normals();
@@ -109,12 +111,14 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Insert and access texture coordinates.
     void reserve_tex_coords(const size_t count);
     size_t push_tex_coords(const GVector2& tex_coords);
+    size_t push_tex_coords(const GVector2 tex_coords[], const size_t count);
     size_t get_tex_coords_count() const;
     GVector2 get_tex_coords(const size_t index) const;
 
     // Insert and access triangles.
     void reserve_triangles(const size_t count);
     size_t push_triangle(const Triangle& triangle);
+    size_t push_triangles(const Triangle triangles[], const size_t count);
     size_t get_triangle_count() const;
     const Triangle& get_triangle(const size_t index) const;
     Triangle& get_triangle(const size_t index);
@@ -176,6 +180,27 @@ class APPLESEED_DLLSYMBOL MeshObject
     void collect_asset_paths(foundation::StringArray& paths) const override;
     void update_asset_paths(const foundation::StringDictionary& mappings) override;
 
+    // Defer loading the geometry of this object from a given mesh of a mesh file.
+    // Until its geometry is loaded, the object only knows its bounding box and its material slots.
+    void defer_geometry_loading(
+        const char*         filepath,
+        const size_t        mesh_index,
+        const GAABB3&       bbox);
+
+    // Return true if the geometry of this object is loaded on demand.
+    bool has_deferred_geometry() const;
+
+    // Return true if the geometry of this object is in memory. Always true for regular objects.
+    bool is_geometry_loaded() const;
+
+    // Load or unload the geometry of an object whose loading is deferred.
+    // These methods do nothing for regular objects.
+    bool load_geometry();
+    void unload_geometry();
+
+    // Return the approximate size in bytes of the geometry of this object.
+    size_t get_geometry_memory_size() const;
+
   private:
     friend class MeshObjectFactory;
 
@@ -48,9 +48,11 @@
 #include "foundation/meshio/genericmeshfilereader.h"
 #include "foundation/meshio/imeshbuilder.h"
 #include "foundation/meshio/imeshfilereader.h"
+#include "foundation/meshio/mappedbinarymeshfile.h"
 #include "foundation/meshio/objmeshfilereader.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/string/string.h"
 #include "foundation/utility/api/apistring.h"
@@ -87,6 +89,41 @@ APPLESEED_DEFINE_APIARRAY(MeshObjectArray);
 
 namespace
 {
+    static_assert(
+        sizeof(Triangle) == MappedBinaryMeshFile::TriangleSize * sizeof(std::uint32_t),
+        "renderer::Triangle must match the triangle layout of page-aligned binarymesh files");
+
+    void copy_mapped_mesh(
+        const MappedBinaryMeshFile::Mesh&   mesh,
+        const bool                          ignore_vertex_normals,
+        MeshObject&                         object)
+    {
+        object.push_vertices(mesh.m_vertices, mesh.m_vertex_count);
+
+        // Vertex normals are normalized when the file is written.
+        if (!ignore_vertex_normals)
+            object.push_vertex_normals(mesh.m_vertex_normals, mesh.m_vertex_normal_count);
+
+        if (mesh.m_tex_coords_count > 0)
+            object.push_tex_coords(mesh.m_tex_coords, mesh.m_tex_coords_count);
+
+        const size_t first_triangle =
+            object.push_triangles(
+                reinterpret_cast<const Triangle*>(mesh.m_triangles),
+                mesh.m_triangle_count);
+
+        if (ignore_vertex_normals)
+        {
+            for (size_t i = first_triangle, e = object.get_triangle_count(); i < e; ++i)
+            {
+                Triangle& triangle = object.get_triangle(i);
+                triangle.m_n0 = Triangle::None;
+                triangle.m_n1 = Triangle::None;
+                triangle.m_n2 = Triangle::None;
+            }
+        }
+    }
+
     class MeshObjectBuilder
       : public IMeshBuilder
     {
@@ -167,6 +204,43 @@ namespace
             m_total_triangle_count += m_objects.back()->get_triangle_count();
         }
 
+        // Insert a mesh from a page-aligned binarymesh file by copying its arrays in bulk.
+        void insert_mapped_mesh(const MappedBinaryMeshFile::Mesh& mesh)
+        {
+            begin_mesh(mesh.m_name.c_str());
+
+            MeshObject& object = *m_objects.back();
+
+            for (size_t i = 0, e = mesh.m_material_slots.size(); i < e; ++i)
+                object.push_material_slot(mesh.m_material_slots[i].c_str());
+
+            copy_mapped_mesh(mesh, m_ignore_vertex_normals, object);
+
+            m_face_count = mesh.m_triangle_count;
+            m_normal_count = mesh.m_vertex_normal_count;
+
+            end_mesh();
+        }
+
+        // Register a mesh from a page-aligned binarymesh file without reading its arrays.
+        void insert_deferred_mesh(
+            const MappedBinaryMeshFile::Mesh&   mesh,
+            const char*                         filepath,
+            const size_t                        mesh_index)
+        {
+            begin_mesh(mesh.m_name.c_str());
+
+            MeshObject& object = *m_objects.back();
+
+            for (size_t i = 0, e = mesh.m_material_slots.size(); i < e; ++i)
+                object.push_material_slot(mesh.m_material_slots[i].c_str());
+
+            object.defer_geometry_loading(filepath, mesh_index, GAABB3(mesh.m_bbox));
+
+            m_total_vertex_count += mesh.m_vertex_count;
+            m_total_triangle_count += mesh.m_triangle_count;
+        }
+
         size_t push_vertex(const Vector3d& v) override
         {
             return m_objects.back()->push_vertex(GVector3(v));
@@ -398,7 +472,9 @@ namespace
         const char*             filename,
         const char*             base_object_name,
         const ParamArray&       params,
-        MeshObjectArray&        objects)
+        MeshObjectArray&        objects,
+        const bool              parallel_parsing,
+        const bool              defer_geometry_loading = false)
     {
         GenericMeshFileReader reader(filename);
 
@@ -427,6 +503,10 @@ namespace
                 reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
         }
 
+        // Large OBJ files are split at line boundaries and parsed on multiple threads.
+        if (parallel_parsing)
+            reader.enable_obj_parallel_parsing(global_logger(), System::get_logical_cpu_core_count());
+
         MeshObjectBuilder builder(params, base_object_name);
 
         Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -434,7 +514,19 @@ namespace
 
         try
         {
-            reader.read(builder);
+            if (MappedBinaryMeshFile::is_mappable(filename))
+            {
+                // Page-aligned binarymesh files are mapped in memory and their arrays copied in bulk.
+                // When geometry loading is deferred, only the mesh headers are read.
+                const MappedBinaryMeshFile mapped_file(filename);
+                for (size_t i = 0, e = mapped_file.get_mesh_count(); i < e; ++i)
+                {
+                    if (defer_geometry_loading)
+                        builder.insert_deferred_mesh(mapped_file.get_mesh(i), filename, i);
+                    else builder.insert_mapped_mesh(mapped_file.get_mesh(i));
+                }
+            }
+            else reader.read(builder);
         }
         catch (const OBJMeshFileReader::ExceptionInvalidFaceDef& e)
         {
@@ -467,7 +559,8 @@ namespace
         stopwatch.measure();
 
         RENDERER_LOG_INFO(
-            "loaded mesh file %s (%s %s, %s %s, %s %s) in %s.",
+            "%s mesh file %s (%s %s, %s %s, %s %s) in %s.",
+            defer_geometry_loading ? "read headers of" : "loaded",
             filename,
             pretty_int(builder.get_objects().size()).c_str(),
             builder.get_objects().size() > 1 ? "objects" : "object",
@@ -701,7 +794,8 @@ namespace
         const StringDictionary& filenames,
         const char*             base_object_name,
         const ParamArray&       params,
-        MeshObjectArray&        objects)
+        MeshObjectArray&        objects,
+        const bool              parallel_parsing)
     {
         assert(filenames.size() >= 2);
 
@@ -721,7 +815,8 @@ namespace
                 search_paths.qualify(key_frames[0].m_filename).c_str(),
                 base_object_name,
                 params,
-                objects))
+                objects,
+                parallel_parsing))
             return false;
 
         for (size_t i = 0; i < objects.size(); ++i)
@@ -743,7 +838,8 @@ namespace
                     search_paths.qualify(filename).c_str(),
                     base_object_name,
                     params,
-                    poses))
+                    poses,
+                    parallel_parsing))
                 return false;
 
             for (size_t j = 0; j < poses.size(); ++j)
@@ -810,7 +906,8 @@ bool MeshObjectReader::read(
     const SearchPaths&  search_paths,
     const char*         base_object_name,
     const ParamArray&   params,
-    MeshObjectArray&    objects)
+    MeshObjectArray&    objects,
+    const int           options)
 {
     assert(base_object_name);
 
@@ -818,6 +915,12 @@ bool MeshObjectReader::read(
     ParamArray completed_params(params);
     completed_params.insert("__base_object_name", base_object_name);
 
+    const bool defer_geometry_loading =
+        (options & DeferGeometryLoading) != 0 &&
+        can_defer_geometry_loading(search_paths, params);
+
+    const bool parallel_parsing = (options & OmitParallelParsing) == 0;
+
     // Read object(s) from disk.
     if (params.strings().exist("filename"))
     {
@@ -835,7 +938,9 @@ bool MeshObjectReader::read(
                 search_paths.qualify(params.strings().get<std::string>("filename")).c_str(),
                 base_object_name,
                 completed_params,
-                objects))
+                objects,
+                parallel_parsing,
+                defer_geometry_loading))
             return false;
     }
     else if (params.dictionaries().exist("filename"))
@@ -860,7 +965,9 @@ bool MeshObjectReader::read(
                         search_paths.qualify(filenames.begin().value()).c_str(),
                         base_object_name,
                         completed_params,
-                        objects))
+                        objects,
+                        parallel_parsing,
+                        defer_geometry_loading))
                     return false;
             }
             break;
@@ -883,7 +990,8 @@ bool MeshObjectReader::read(
                         filenames,
                         base_object_name,
                         completed_params,
-                        objects))
+                        objects,
+                        parallel_parsing))
                     return false;
             }
             break;
@@ -917,4 +1025,72 @@ bool MeshObjectReader::read(
     return true;
 }
 
+bool MeshObjectReader::can_defer_geometry_loading(
+    const SearchPaths&  search_paths,
+    const ParamArray&   params)
+{
+    // Smooth normals and tangents are computed from the whole geometry when it is read.
+    if (params.strings().exist("compute_smooth_normals") ||
+        params.strings().exist("compute_smooth_tangents"))
+        return false;
+
+    std::string filename;
+
+    if (params.strings().exist("filename"))
+    {
+        if (params.dictionaries().exist("filename"))
+            return false;
+
+        filename = params.strings().get<std::string>("filename");
+    }
+    else if (params.dictionaries().exist("filename"))
+    {
+        // Multi-pose objects need all their poses to be read at once.
+        const StringDictionary& filenames = params.dictionaries().get("filename").strings();
+        if (filenames.size() != 1)
+            return false;
+
+        filename = filenames.begin().value();
+    }
+    else return false;
+
+    return MappedBinaryMeshFile::is_mappable(search_paths.qualify(filename).c_str());
+}
+
+bool MeshObjectReader::read_deferred_geometry(
+    MeshObject&         object,
+    const char*         filepath,
+    const size_t        mesh_index)
+{
+    try
+    {
+        const MappedBinaryMeshFile mapped_file(filepath);
+
+        if (mesh_index >= mapped_file.get_mesh_count())
+        {
+            RENDERER_LOG_ERROR(
+                "failed to load geometry of mesh object \"%s\": mesh file %s has changed since it was read.",
+                object.get_path().c_str(),
+                filepath);
+            return false;
+        }
+
+        copy_mapped_mesh(
+            mapped_file.get_mesh(mesh_index),
+            object.get_parameters().get_optional<bool>("ignore_vertex_normals"),
+            object);
+    }
+    catch (const std::exception& e)
+    {
+        RENDERER_LOG_ERROR(
+            "failed to load geometry of mesh object \"%s\" from mesh file %s: %s.",
+            object.get_path().c_str(),
+            filepath,
+            e.what());
+        return false;
+    }
+
+    return true;
+}
+
 }   // namespace renderer
@@ -35,6 +35,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class SearchPaths; }
 namespace renderer      { class MeshObject; }
@@ -57,6 +60,13 @@ APPLESEED_DECLARE_APIARRAY(MeshObjectArray, MeshObject*);
 class APPLESEED_DLLSYMBOL MeshObjectReader
 {
   public:
+    enum Options
+    {
+        Defaults                = 0,
+        DeferGeometryLoading    = 1UL << 0,     // only read bounding boxes and material slots when possible
+        OmitParallelParsing     = 1UL << 1      // parse large OBJ files on the calling thread only
+    };
+
     // Read mesh objects from disk. The filenames are defined in params.
     // Returns true on success, false otherwise. When false is returned,
     // nothing should be assumed on the state of the objects parameter.
@@ -64,7 +74,20 @@ class APPLESEED_DLLSYMBOL MeshObjectReader
         const foundation::SearchPaths&  search_paths,
         const char*                     base_object_name,
         const ParamArray&               params,
-        MeshObjectArray&                objects);
+        MeshObjectArray&                objects,
+        const int                       options = Defaults);
+
+    // Return true if the geometry of the mesh objects defined in params can be loaded on demand.
+    // This is the case of single-pose objects read from page-aligned binarymesh files.
+    static bool can_defer_geometry_loading(
+        const foundation::SearchPaths&  search_paths,
+        const ParamArray&               params);
+
+    // Read the geometry of a mesh object whose loading was deferred.
+    static bool read_deferred_geometry(
+        MeshObject&                     object,
+        const char*                     filepath,
+        const size_t                    mesh_index);
 };
 
 }   // namespace renderer
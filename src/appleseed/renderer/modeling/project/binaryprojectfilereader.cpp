@@ -0,0 +1,1052 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "binaryprojectfilereader.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/aov/aovfactoryregistrar.h"
+#include "renderer/modeling/aov/iaovfactory.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bsdf/bsdffactoryregistrar.h"
+#include "renderer/modeling/bsdf/ibsdffactory.h"
+#include "renderer/modeling/bssrdf/bssrdf.h"
+#include "renderer/modeling/bssrdf/bssrdffactoryregistrar.h"
+#include "renderer/modeling/bssrdf/ibssrdffactory.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/camera/camerafactoryregistrar.h"
+#include "renderer/modeling/camera/icamerafactory.h"
+#include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/display/display.h"
+#include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/edf/edffactoryregistrar.h"
+#include "renderer/modeling/edf/iedffactory.h"
+#include "renderer/modeling/environment/environment.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/environmentedffactoryregistrar.h"
+#include "renderer/modeling/environmentedf/ienvironmentedffactory.h"
+#include "renderer/modeling/environmentshader/environmentshader.h"
+#include "renderer/modeling/environmentshader/environmentshaderfactoryregistrar.h"
+#include "renderer/modeling/environmentshader/ienvironmentshaderfactory.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/light/ilightfactory.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/light/lightfactoryregistrar.h"
+#include "renderer/modeling/material/imaterialfactory.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/material/materialfactoryregistrar.h"
+#include "renderer/modeling/object/iobjectfactory.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/objectfactoryregistrar.h"
+#include "renderer/modeling/postprocessingstage/ipostprocessingstagefactory.h"
+#include "renderer/modeling/postprocessingstage/postprocessingstage.h"
+#include "renderer/modeling/postprocessingstage/postprocessingstagefactoryregistrar.h"
+#include "renderer/modeling/project/configuration.h"
+#include "renderer/modeling/project/configurationcontainer.h"
+#include "renderer/modeling/project/eventcounters.h"
+#include "renderer/modeling/project/meshobjectloader.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/projectfilereader.h"
+#include "renderer/modeling/project/projectformatrevision.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyfactoryregistrar.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/iassemblyfactory.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/surfaceshader/isurfaceshaderfactory.h"
+#include "renderer/modeling/surfaceshader/surfaceshader.h"
+#include "renderer/modeling/surfaceshader/surfaceshaderfactoryregistrar.h"
+#include "renderer/modeling/texture/itexturefactory.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/modeling/texture/texturefactoryregistrar.h"
+#include "renderer/modeling/volume/ivolumefactory.h"
+#include "renderer/modeling/volume/volume.h"
+#include "renderer/modeling/volume/volumefactoryregistrar.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/pluginstore.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/api/apiarray.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/searchpaths.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// BinaryProjectFileReader class implementation.
+//
+
+namespace
+{
+    const char Signature[13] = { 'B', 'I', 'N', 'A', 'R', 'Y', 'P', 'R', 'O', 'J', 'E', 'C', 'T' };
+
+    // Version of the binary project file format read by this code.
+    const std::uint16_t Version = 1;
+
+    class Reader
+    {
+      public:
+        // Constructor.
+        Reader(
+            Project&        project,
+            ReaderAdapter&  reader,
+            const int       options,
+            const size_t    thread_count,
+            EventCounters&  event_counters)
+          : m_project(project)
+          , m_reader(reader)
+          , m_options(options)
+          , m_event_counters(event_counters)
+          , m_mesh_object_loader(project, options, thread_count, event_counters)
+        {
+        }
+
+        // Read a project.
+        void read_project()
+        {
+            const size_t format_revision = read_size();
+
+            if (format_revision > ProjectFormatRevision)
+            {
+                RENDERER_LOG_WARNING(
+                    "this project was created with a newer version of appleseed; it may fail to load or render properly with this version.");
+                m_event_counters.signal_warning();
+            }
+
+            m_project.set_format_revision(format_revision);
+
+            read_search_paths();
+
+            if (read_bool())
+                read_display();
+
+            if (read_bool())
+            {
+                auto_release_ptr<Scene> scene = read_scene();
+                m_project.set_scene(scene);
+            }
+
+            if (read_bool())
+                m_project.set_frame(read_frame());
+
+            read_configurations();
+
+            // Join mesh files read while the project file was being read.
+            m_mesh_object_loader.complete();
+        }
+
+      private:
+        typedef std::vector<Object*> ObjectVector;
+
+        Project&                    m_project;
+        ReaderAdapter&              m_reader;
+        const int                   m_options;
+        EventCounters&              m_event_counters;
+        std::deque<std::string>     m_strings;              // references to elements are stable
+        MeshObjectLoader            m_mesh_object_loader;
+
+        //
+        // Primitive values.
+        //
+
+        bool read_bool()
+        {
+            std::uint8_t value;
+            checked_read(m_reader, value);
+            return value != 0;
+        }
+
+        size_t read_size()
+        {
+            std::uint32_t size;
+            checked_read(m_reader, size);
+            return static_cast<size_t>(size);
+        }
+
+        const std::string& read_string()
+        {
+            std::uint32_t index;
+            checked_read(m_reader, index);
+
+            if (index == m_strings.size())
+            {
+                // First occurrence of this string.
+                std::uint32_t length;
+                checked_read(m_reader, length);
+
+                m_strings.emplace_back();
+                std::string& s = m_strings.back();
+                s.resize(length);
+                if (length > 0)
+                    checked_read(m_reader, &s[0], length);
+            }
+            else if (index > m_strings.size())
+                throw ExceptionIOError("invalid string reference");
+
+            return m_strings[index];
+        }
+
+        void read_params(Dictionary& params)
+        {
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& key = read_string();
+                const std::string& value = read_string();
+                params.strings().insert(key.c_str(), value.c_str());
+            }
+
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& key = read_string();
+                Dictionary dictionary;
+                read_params(dictionary);
+                params.dictionaries().insert(key.c_str(), dictionary);
+            }
+        }
+
+        ParamArray read_params()
+        {
+            ParamArray params;
+            read_params(params);
+            return params;
+        }
+
+        StringDictionary read_string_dictionary()
+        {
+            StringDictionary dictionary;
+
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& key = read_string();
+                const std::string& value = read_string();
+                dictionary.insert(key.c_str(), value.c_str());
+            }
+
+            return dictionary;
+        }
+
+        Transformd read_transform()
+        {
+            Matrix4d matrix;
+            checked_read(m_reader, &matrix[0], 16 * sizeof(double));
+
+            try
+            {
+                return Transformd::from_local_to_parent(matrix);
+            }
+            catch (const ExceptionSingularMatrix&)
+            {
+                RENDERER_LOG_ERROR("while reading transform: the transformation matrix is singular.");
+                m_event_counters.signal_error();
+                return Transformd::identity();
+            }
+        }
+
+        // Read a transform sequence into `target` (if it is not null).
+        void read_transform_sequence(TransformSequence* target)
+        {
+            if (target)
+                target->clear();
+
+            const size_t count = read_size();
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                float time;
+                checked_read(m_reader, time);
+
+                const Transformd transform = read_transform();
+
+                if (target)
+                    target->set_transform(time, transform);
+            }
+
+            if (target && count == 0)
+                target->set_transform(0.0f, Transformd::identity());
+        }
+
+        ColorValueArray read_value_array()
+        {
+            ColorValueArray values;
+            values.resize(read_size());
+
+            if (!values.empty())
+                checked_read(m_reader, &values[0], values.size() * sizeof(float));
+
+            return values;
+        }
+
+        //
+        // Entities.
+        //
+
+        template <typename Entity, typename EntityFactoryRegistrar>
+        auto_release_ptr<Entity> create_entity(
+            const EntityFactoryRegistrar&   registrar,
+            const char*                     type,
+            const std::string&              model,
+            const std::string&              name,
+            const ParamArray&               params)
+        {
+            try
+            {
+                const typename EntityFactoryRegistrar::FactoryType* factory =
+                    registrar.lookup(model.c_str());
+
+                if (factory)
+                {
+                    return factory->create(name.c_str(), params);
+                }
+                else
+                {
+                    RENDERER_LOG_ERROR(
+                        "while defining %s \"%s\": invalid model \"%s\".",
+                        type,
+                        name.c_str(),
+                        model.c_str());
+                    m_event_counters.signal_error();
+                }
+            }
+            catch (const ExceptionDictionaryKeyNotFound& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining %s \"%s\": required parameter \"%s\" missing.",
+                    type,
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+            catch (const ExceptionUnknownEntity& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining %s \"%s\": unknown entity \"%s\".",
+                    type,
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+
+            return auto_release_ptr<Entity>(nullptr);
+        }
+
+        // Read an entity defined by a name, a model and a set of parameters.
+        template <typename Entity>
+        auto_release_ptr<Entity> read_entity(const char* type)
+        {
+            const std::string& name = read_string();
+            const std::string& model = read_string();
+            const ParamArray params = read_params();
+
+            return
+                create_entity<Entity>(
+                    m_project.get_factory_registrar<Entity>(),
+                    type,
+                    model,
+                    name,
+                    params);
+        }
+
+        template <typename Container, typename Entity>
+        void insert(Container& container, auto_release_ptr<Entity> entity)
+        {
+            if (entity.get() == nullptr)
+                return;
+
+            if (container.get_by_name(entity->get_name()) != nullptr)
+            {
+                RENDERER_LOG_ERROR(
+                    "an entity with the path \"%s\" already exists.",
+                    entity->get_path().c_str());
+                m_event_counters.signal_error();
+                return;
+            }
+
+            container.insert(entity);
+        }
+
+        template <typename Container, typename ReadEntity>
+        void read_collection(Container& container, ReadEntity read_entity)
+        {
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+                insert(container, read_entity());
+        }
+
+        auto_release_ptr<Assembly> read_assembly()
+        {
+            const std::string& name = read_string();
+            const std::string& model = read_string();
+            const ParamArray params = read_params();
+            const bool procedural = read_bool();
+
+            const IAssemblyFactory* factory =
+                m_project.get_factory_registrar<Assembly>().lookup(model.c_str());
+
+            if (factory == nullptr)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining assembly \"%s\": invalid model \"%s\".",
+                    name.c_str(),
+                    model.c_str());
+                m_event_counters.signal_error();
+            }
+
+            // The content of an assembly with an invalid model is still read but then discarded.
+            auto_release_ptr<Assembly> assembly =
+                factory != nullptr
+                    ? factory->create(name.c_str(), params)
+                    : AssemblyFactory().create(name.c_str(), params);
+
+            if (!procedural)
+            {
+                read_collection(assembly->colors(), [this]() { return read_color(); });
+                read_collection(assembly->textures(), [this]() { return read_texture(); });
+                read_collection(assembly->texture_instances(), [this]() { return read_texture_instance(); });
+                read_collection(assembly->bsdfs(), [this]() { return read_entity<BSDF>("bsdf"); });
+                read_collection(assembly->bssrdfs(), [this]() { return read_entity<BSSRDF>("bssrdf"); });
+                read_collection(assembly->edfs(), [this]() { return read_entity<EDF>("edf"); });
+                read_collection(assembly->shader_groups(), [this]() { return read_shader_group(); });
+                read_collection(assembly->surface_shaders(), [this]() { return read_entity<SurfaceShader>("surface shader"); });
+                read_collection(assembly->materials(), [this]() { return read_entity<Material>("material"); });
+                read_collection(assembly->lights(), [this]() { return read_light(); });
+                read_objects(assembly->objects());
+                read_collection(assembly->object_instances(), [this]() { return read_object_instance(); });
+                read_collection(assembly->volumes(), [this]() { return read_entity<Volume>("volume"); });
+                read_collection(assembly->assemblies(), [this]() { return read_assembly(); });
+                read_collection(assembly->assembly_instances(), [this]() { return read_assembly_instance(); });
+            }
+
+            return factory != nullptr ? assembly : auto_release_ptr<Assembly>(nullptr);
+        }
+
+        auto_release_ptr<AssemblyInstance> read_assembly_instance()
+        {
+            const std::string& name = read_string();
+            const std::string& assembly = read_string();
+            const ParamArray params = read_params();
+
+            auto_release_ptr<AssemblyInstance> assembly_instance =
+                AssemblyInstanceFactory::create(
+                    name.c_str(),
+                    params,
+                    assembly.c_str());
+
+            read_transform_sequence(&assembly_instance->transform_sequence());
+
+            return assembly_instance;
+        }
+
+        auto_release_ptr<Camera> read_camera()
+        {
+            auto_release_ptr<Camera> camera = read_entity<Camera>("camera");
+            read_transform_sequence(camera.get() ? &camera->transform_sequence() : nullptr);
+            return camera;
+        }
+
+        auto_release_ptr<ColorEntity> read_color()
+        {
+            const std::string& name = read_string();
+            const ParamArray params = read_params();
+            const ColorValueArray values = read_value_array();
+            const ColorValueArray alpha = read_value_array();
+
+            try
+            {
+                return
+                    alpha.empty()
+                        ? ColorEntityFactory::create(name.c_str(), params, values)
+                        : ColorEntityFactory::create(name.c_str(), params, values, alpha);
+            }
+            catch (const ExceptionDictionaryKeyNotFound& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining color \"%s\": required parameter \"%s\" missing.",
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+                return auto_release_ptr<ColorEntity>(nullptr);
+            }
+        }
+
+        void read_configurations()
+        {
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& name = read_string();
+                const std::string& base_name = read_string();
+                const ParamArray params = read_params();
+
+                auto_release_ptr<Configuration> configuration =
+                    ConfigurationFactory::create(name.c_str(), params);
+
+                // Handle configuration inheritance.
+                if (!base_name.empty())
+                {
+                    const Configuration* base =
+                        m_project.configurations().get_by_name(base_name.c_str());
+
+                    if (base)
+                        configuration->set_base(base);
+                    else
+                    {
+                        RENDERER_LOG_ERROR(
+                            "while defining configuration \"%s\": the configuration \"%s\" does not exist.",
+                            configuration->get_path().c_str(),
+                            base_name.c_str());
+                        m_event_counters.signal_error();
+                    }
+                }
+
+                m_project.configurations().insert(configuration);
+            }
+        }
+
+        void read_display()
+        {
+            const std::string& name = read_string();
+            const ParamArray params = read_params();
+
+            m_project.set_display(DisplayFactory::create(name.c_str(), params));
+        }
+
+        auto_release_ptr<Environment> read_environment()
+        {
+            const std::string& name = read_string();
+            const std::string& model = read_string();
+            const ParamArray params = read_params();
+
+            if (model == EnvironmentFactory::get_model())
+                return EnvironmentFactory::create(name.c_str(), params);
+
+            RENDERER_LOG_ERROR(
+                "while defining environment \"%s\": invalid model \"%s\".",
+                name.c_str(),
+                model.c_str());
+            m_event_counters.signal_error();
+
+            return auto_release_ptr<Environment>(nullptr);
+        }
+
+        auto_release_ptr<EnvironmentEDF> read_environment_edf()
+        {
+            auto_release_ptr<EnvironmentEDF> env_edf = read_entity<EnvironmentEDF>("environment edf");
+            read_transform_sequence(env_edf.get() ? &env_edf->transform_sequence() : nullptr);
+            return env_edf;
+        }
+
+        auto_release_ptr<Frame> read_frame()
+        {
+            const std::string& name = read_string();
+            const ParamArray params = read_params();
+
+            AOVContainer aovs;
+            read_collection(aovs, [this]() { return read_aov(); });
+
+            PostProcessingStageContainer post_processing_stages;
+            read_collection(
+                post_processing_stages,
+                [this]() { return read_entity<PostProcessingStage>("post-processing stage"); });
+
+            auto_release_ptr<Frame> frame =
+                FrameFactory::create(
+                    name.c_str(),
+                    params,
+                    aovs,
+                    m_project.search_paths());
+
+            frame->post_processing_stages().swap(post_processing_stages);
+
+            return frame;
+        }
+
+        auto_release_ptr<AOV> read_aov()
+        {
+            const std::string& model = read_string();
+            const ParamArray params = read_params();
+
+            try
+            {
+                const IAOVFactory* factory =
+                    m_project.get_factory_registrar<AOV>().lookup(model.c_str());
+
+                if (factory)
+                    return factory->create(params);
+
+                RENDERER_LOG_ERROR(
+                    "while defining aov: invalid model \"%s\".",
+                    model.c_str());
+                m_event_counters.signal_error();
+            }
+            catch (const ExceptionDictionaryKeyNotFound& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining aov \"%s\": required parameter \"%s\" missing.",
+                    model.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+            catch (const ExceptionUnknownEntity& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining aov \"%s\": unknown entity \"%s\".",
+                    model.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+
+            return auto_release_ptr<AOV>(nullptr);
+        }
+
+        auto_release_ptr<Light> read_light()
+        {
+            auto_release_ptr<Light> light = read_entity<Light>("light");
+            const Transformd transform = read_transform();
+
+            if (light.get())
+                light->set_transform(transform);
+
+            return light;
+        }
+
+        void read_objects(ObjectContainer& objects)
+        {
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& name = read_string();
+                const std::string& model = read_string();
+                const ParamArray params = read_params();
+
+                for (Object* object : create_objects(name, model, params))
+                    insert(objects, auto_release_ptr<Object>(object));
+            }
+        }
+
+        ObjectVector create_objects(
+            const std::string&  name,
+            const std::string&  model,
+            const ParamArray&   params)
+        {
+            try
+            {
+                const IObjectFactory* factory =
+                    m_project.get_factory_registrar<Object>().lookup(model.c_str());
+
+                if (factory)
+                {
+                    ObjectArray objects;
+                    m_mesh_object_loader.create_objects(
+                        *factory,
+                        name.c_str(),
+                        params,
+                        objects);
+
+                    return array_vector<ObjectVector>(objects);
+                }
+                else
+                {
+                    RENDERER_LOG_ERROR(
+                        "while defining object \"%s\": invalid model \"%s\".",
+                        name.c_str(),
+                        model.c_str());
+                    m_event_counters.signal_error();
+                }
+            }
+            catch (const ExceptionDictionaryKeyNotFound& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining object \"%s\": required parameter \"%s\" missing.",
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+            catch (const ExceptionUnknownEntity& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining object \"%s\": unknown entity \"%s\".",
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+            catch (const Exception& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining object \"%s\": %s",
+                    name.c_str(),
+                    e.what());
+                m_event_counters.signal_error();
+            }
+
+            return ObjectVector();
+        }
+
+        auto_release_ptr<ObjectInstance> read_object_instance()
+        {
+            const std::string& name = read_string();
+            const std::string& object = read_string();
+            const ParamArray params = read_params();
+            const Transformd transform = read_transform();
+            const StringDictionary front_material_mappings = read_string_dictionary();
+            const StringDictionary back_material_mappings = read_string_dictionary();
+
+            return
+                ObjectInstanceFactory::create(
+                    name.c_str(),
+                    params,
+                    object.c_str(),
+                    transform,
+                    front_material_mappings,
+                    back_material_mappings);
+        }
+
+        auto_release_ptr<Scene> read_scene()
+        {
+            // Discover and load plugins before building the scene.
+            m_project.get_plugin_store().load_all_plugins_from_paths(m_project.search_paths());
+
+            auto_release_ptr<Scene> scene = SceneFactory::create();
+            scene->get_parameters() = read_params();
+
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                auto_release_ptr<Camera> camera = read_camera();
+                if (camera.get())
+                    scene->cameras().insert(camera);
+            }
+
+            read_collection(scene->colors(), [this]() { return read_color(); });
+            read_collection(scene->textures(), [this]() { return read_texture(); });
+            read_collection(scene->texture_instances(), [this]() { return read_texture_instance(); });
+            read_collection(scene->environment_edfs(), [this]() { return read_environment_edf(); });
+            read_collection(scene->environment_shaders(), [this]() { return read_entity<EnvironmentShader>("environment shader"); });
+
+            if (read_bool())
+            {
+                auto_release_ptr<Environment> environment = read_environment();
+                if (environment.get())
+                    scene->set_environment(environment);
+            }
+
+            read_collection(scene->shader_groups(), [this]() { return read_shader_group(); });
+            read_collection(scene->assemblies(), [this]() { return read_assembly(); });
+            read_collection(scene->assembly_instances(), [this]() { return read_assembly_instance(); });
+
+            const GAABB3 scene_bbox = scene->compute_bbox();
+            const Vector3d scene_center(scene_bbox.center());
+
+            RENDERER_LOG_INFO(
+                "scene bounding box: (%f, %f, %f)-(%f, %f, %f).\n"
+                "scene bounding sphere: center (%f, %f, %f), diameter %f.",
+                scene_bbox.min[0], scene_bbox.min[1], scene_bbox.min[2],
+                scene_bbox.max[0], scene_bbox.max[1], scene_bbox.max[2],
+                scene_center[0], scene_center[1], scene_center[2],
+                scene_bbox.diameter());
+
+            return scene;
+        }
+
+        void read_search_paths()
+        {
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& path = read_string();
+
+                // Skip search paths if asked to do so.
+                if (!(m_options & ProjectFileReader::OmitSearchPaths) && !path.empty())
+                    m_project.search_paths().push_back_explicit_path(path);
+            }
+        }
+
+        auto_release_ptr<ShaderGroup> read_shader_group()
+        {
+            auto_release_ptr<ShaderGroup> shader_group =
+                ShaderGroupFactory::create(read_string().c_str());
+
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& type = read_string();
+                const std::string& name = read_string();
+                const std::string& layer = read_string();
+                const std::string& code = read_string();
+
+                ParamArray params;
+                for (size_t j = 0, param_count = read_size(); j < param_count; ++j)
+                {
+                    const std::string& param_name = read_string();
+                    const std::string& param_value = read_string();
+                    params.insert_path(param_name.c_str(), param_value);
+                }
+
+                if (code.empty())
+                {
+                    shader_group->add_shader(
+                        type.c_str(),
+                        name.c_str(),
+                        layer.c_str(),
+                        params);
+                }
+                else
+                {
+                    shader_group->add_source_shader(
+                        type.c_str(),
+                        name.c_str(),
+                        layer.c_str(),
+                        code.c_str(),
+                        params);
+                }
+            }
+
+            for (size_t i = 0, e = read_size(); i < e; ++i)
+            {
+                const std::string& src_layer = read_string();
+                const std::string& src_param = read_string();
+                const std::string& dst_layer = read_string();
+                const std::string& dst_param = read_string();
+
+                shader_group->add_connection(
+                    src_layer.c_str(),
+                    src_param.c_str(),
+                    dst_layer.c_str(),
+                    dst_param.c_str());
+            }
+
+            return shader_group;
+        }
+
+        auto_release_ptr<Texture> read_texture()
+        {
+            const std::string& name = read_string();
+            const std::string& model = read_string();
+            const ParamArray params = read_params();
+
+            try
+            {
+                const ITextureFactory* factory =
+                    m_project.get_factory_registrar<Texture>().lookup(model.c_str());
+
+                if (factory)
+                    return factory->create(name.c_str(), params, m_project.search_paths());
+
+                RENDERER_LOG_ERROR(
+                    "while defining texture \"%s\": invalid model \"%s\".",
+                    name.c_str(),
+                    model.c_str());
+                m_event_counters.signal_error();
+            }
+            catch (const ExceptionDictionaryKeyNotFound& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining texture \"%s\": required parameter \"%s\" missing.",
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+            }
+
+            return auto_release_ptr<Texture>(nullptr);
+        }
+
+        auto_release_ptr<TextureInstance> read_texture_instance()
+        {
+            const std::string& name = read_string();
+            const std::string& texture = read_string();
+            const ParamArray params = read_params();
+            const Transformd transform = read_transform();
+
+            try
+            {
+                return
+                    TextureInstanceFactory::create(
+                        name.c_str(),
+                        params,
+                        texture.c_str(),
+                        Transformf(
+                            transform.get_local_to_parent(),
+                            transform.get_parent_to_local()));
+            }
+            catch (const ExceptionDictionaryKeyNotFound& e)
+            {
+                RENDERER_LOG_ERROR(
+                    "while defining texture instance \"%s\": required parameter \"%s\" missing.",
+                    name.c_str(),
+                    e.string());
+                m_event_counters.signal_error();
+                return auto_release_ptr<TextureInstance>(nullptr);
+            }
+        }
+    };
+
+    bool read_signature(BufferedFile& file)
+    {
+        char signature[sizeof(Signature)];
+        return
+            file.read(signature, sizeof(signature)) == sizeof(signature) &&
+            memcmp(signature, Signature, sizeof(Signature)) == 0;
+    }
+}
+
+bool BinaryProjectFileReader::is_binary_project_file(const char* filepath)
+{
+    BufferedFile file;
+
+    return
+        file.open(filepath, BufferedFile::BinaryType, BufferedFile::ReadMode) &&
+        read_signature(file);
+}
+
+auto_release_ptr<Project> BinaryProjectFileReader::read(
+    const char*             project_filepath,
+    const int               options,
+    const size_t            thread_count,
+    EventCounters&          event_counters)
+{
+    assert(project_filepath);
+
+    return load_project_file(project_filepath, options, thread_count, event_counters);
+}
+
+auto_release_ptr<Project> BinaryProjectFileReader::read_archive(
+    const char*             archive_filepath,
+    const SearchPaths&      search_paths,
+    const int               options,
+    const size_t            thread_count,
+    EventCounters&          event_counters)
+{
+    assert(archive_filepath);
+
+    return
+        load_project_file(
+            archive_filepath,
+            options | ProjectFileReader::OmitSearchPaths,
+            thread_count,
+            event_counters,
+            &search_paths);
+}
+
+auto_release_ptr<Project> BinaryProjectFileReader::load_project_file(
+    const char*             project_filepath,
+    const int               options,
+    const size_t            thread_count,
+    EventCounters&          event_counters,
+    const SearchPaths*      search_paths)
+{
+    // Create an empty project.
+    auto_release_ptr<Project> project(ProjectFactory::create(project_filepath));
+    project->set_path(project_filepath);
+
+    if (!(options & ProjectFileReader::OmitSearchPaths))
+    {
+        project->search_paths().set_root_path(
+            bf::absolute(project_filepath).parent_path().string());
+    }
+    else
+    {
+        assert(search_paths);
+        project->search_paths() = *search_paths;
+    }
+
+    RENDERER_LOG_INFO("loading project file %s...", project_filepath);
+
+    BufferedFile file(project_filepath, BufferedFile::BinaryType, BufferedFile::ReadMode);
+    if (!file.is_open())
+    {
+        RENDERER_LOG_ERROR("failed to load project file %s: i/o error.", project_filepath);
+        event_counters.signal_error();
+        return auto_release_ptr<Project>(nullptr);
+    }
+
+    try
+    {
+        if (!read_signature(file))
+        {
+            RENDERER_LOG_ERROR("failed to load project file %s: not a binary project file.", project_filepath);
+            event_counters.signal_error();
+            return auto_release_ptr<Project>(nullptr);
+        }
+
+        std::uint16_t version;
+        checked_read(file, version);
+
+        if (version != Version)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to load project file %s: unsupported binary project file format version %u.",
+                project_filepath,
+                static_cast<unsigned int>(version));
+            event_counters.signal_error();
+            return auto_release_ptr<Project>(nullptr);
+        }
+
+        LZ4CompressedReaderAdapter reader(file);
+        Reader project_reader(project.ref(), reader, options, thread_count, event_counters);
+        project_reader.read_project();
+    }
+    catch (const ExceptionEOF&)
+    {
+        RENDERER_LOG_ERROR("failed to load project file %s: unexpected end of file.", project_filepath);
+        event_counters.signal_error();
+        return auto_release_ptr<Project>(nullptr);
+    }
+    catch (const ExceptionIOError& e)
+    {
+        RENDERER_LOG_ERROR("failed to load project file %s: %s.", project_filepath, e.what());
+        event_counters.signal_error();
+        return auto_release_ptr<Project>(nullptr);
+    }
+
+    return project;
+}
+
+}   // namespace renderer
@@ -0,0 +1,82 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/memory/autoreleaseptr.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation { class SearchPaths; }
+namespace renderer   { class EventCounters; }
+namespace renderer   { class Project; }
+
+namespace renderer
+{
+
+//
+// Binary project file reader.
+//
+
+class BinaryProjectFileReader
+{
+  public:
+    // Return true if a given file is a binary project file.
+    static bool is_binary_project_file(const char* filepath);
+
+    // Read a project from disk.
+    // Return 0 if reading the file failed.
+    static foundation::auto_release_ptr<Project> read(
+        const char*                     project_filepath,
+        const int                       options,
+        const size_t                    thread_count,
+        EventCounters&                  event_counters);
+
+    // Read an archive from disk.
+    // Return 0 if reading the file failed.
+    static foundation::auto_release_ptr<Project> read_archive(
+        const char*                     archive_filepath,
+        const foundation::SearchPaths&  search_paths,
+        const int                       options,
+        const size_t                    thread_count,
+        EventCounters&                  event_counters);
+
+  private:
+    static foundation::auto_release_ptr<Project> load_project_file(
+        const char*                     project_filepath,
+        const int                       options,
+        const size_t                    thread_count,
+        EventCounters&                  event_counters,
+        const foundation::SearchPaths*  search_paths = nullptr);
+};
+
+}   // namespace renderer
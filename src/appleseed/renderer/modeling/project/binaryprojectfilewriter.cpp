@@ -0,0 +1,590 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "binaryprojectfilewriter.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bssrdf/bssrdf.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/display/display.h"
+#include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/environment/environment.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentshader/environmentshader.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/postprocessingstage/postprocessingstage.h"
+#include "renderer/modeling/project/assethandler.h"
+#include "renderer/modeling/project/configuration.h"
+#include "renderer/modeling/project/configurationcontainer.h"
+#include "renderer/modeling/project/objectrecordcollector.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/projectfilewriter.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/proceduralassembly.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/shadergroup/shader.h"
+#include "renderer/modeling/shadergroup/shaderconnection.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/shadergroup/shaderparam.h"
+#include "renderer/modeling/surfaceshader/surfaceshader.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/modeling/volume/volume.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/string/string.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/stopwatch.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace foundation;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// BinaryProjectFileWriter class implementation.
+//
+// A binary project file starts with a signature and a format version, followed by the
+// LZ4-compressed entity graph. Entities are written in the same order as in XML project
+// files. Collections are prefixed by their size. Strings are interned: each string is
+// written as its index in a table of strings; the first occurrence of a string is
+// followed by its length and characters.
+//
+
+namespace
+{
+    // Version of the binary project file format being written by this code.
+    const std::uint16_t Version = 1;
+
+    class Writer
+    {
+      public:
+        // Constructor.
+        Writer(
+            const char*         filepath,
+            WriterAdapter&      writer,
+            const int           options)
+          : m_writer(writer)
+          , m_object_record_collector(bf::path(filepath).parent_path(), options)
+        {
+        }
+
+        // Write a project.
+        void write_project(const Project& project)
+        {
+            write_size(project.get_format_revision());
+
+            write_search_paths(project);
+
+            write_bool(project.get_display() != nullptr);
+            if (project.get_display())
+                write(*project.get_display());
+
+            write_bool(project.get_scene() != nullptr);
+            if (project.get_scene())
+                write_scene(*project.get_scene());
+
+            write_bool(project.get_frame() != nullptr);
+            if (project.get_frame())
+                write_frame(*project.get_frame());
+
+            write_configurations(project);
+        }
+
+      private:
+        typedef std::unordered_map<std::string, std::uint32_t> StringIndexMap;
+
+        WriterAdapter&          m_writer;
+        ObjectRecordCollector   m_object_record_collector;
+        StringIndexMap          m_string_indices;
+
+        void write_bool(const bool value)
+        {
+            checked_write(m_writer, static_cast<std::uint8_t>(value ? 1 : 0));
+        }
+
+        void write_size(const size_t size)
+        {
+            checked_write(m_writer, static_cast<std::uint32_t>(size));
+        }
+
+        void write_string(const char* s)
+        {
+            const StringIndexMap::const_iterator i = m_string_indices.find(s);
+
+            if (i != m_string_indices.end())
+            {
+                checked_write(m_writer, i->second);
+                return;
+            }
+
+            const std::uint32_t index = static_cast<std::uint32_t>(m_string_indices.size());
+            m_string_indices.insert(std::make_pair(std::string(s), index));
+
+            const std::uint32_t length = static_cast<std::uint32_t>(strlen(s));
+            checked_write(m_writer, index);
+            checked_write(m_writer, length);
+            checked_write(m_writer, s, length);
+        }
+
+        void write_string(const std::string& s)
+        {
+            write_string(s.c_str());
+        }
+
+        // Write a (possibly hierarchical) set of parameters.
+        void write_params(const Dictionary& params)
+        {
+            write_size(params.strings().size());
+            for (const_each<StringDictionary> i = params.strings(); i; ++i)
+            {
+                write_string(i->key());
+                write_string(i->value());
+            }
+
+            write_size(params.dictionaries().size());
+            for (const_each<DictionaryDictionary> i = params.dictionaries(); i; ++i)
+            {
+                write_string(i->key());
+                write_params(i->value());
+            }
+        }
+
+        void write_string_dictionary(const StringDictionary& dictionary)
+        {
+            write_size(dictionary.size());
+            for (const_each<StringDictionary> i = dictionary; i; ++i)
+            {
+                write_string(i->key());
+                write_string(i->value());
+            }
+        }
+
+        void write_matrix(const Matrix4d& m)
+        {
+            checked_write(m_writer, &m[0], 16 * sizeof(double));
+        }
+
+        void write_transform_sequence(const TransformSequence& transform_sequence)
+        {
+            write_size(transform_sequence.size());
+
+            for (size_t i = 0, e = transform_sequence.size(); i < e; ++i)
+            {
+                float time;
+                Transformd transform;
+                transform_sequence.get_transform(i, time, transform);
+
+                checked_write(m_writer, time);
+                write_matrix(transform.get_local_to_parent());
+            }
+        }
+
+        void write_value_array(const ColorValueArray& values)
+        {
+            write_size(values.size());
+
+            if (!values.empty())
+                checked_write(m_writer, &values[0], values.size() * sizeof(float));
+        }
+
+        template <typename Entity>
+        void write_entity(const Entity& entity)
+        {
+            write_string(entity.get_name());
+            write_string(entity.get_model());
+            write_params(entity.get_parameters());
+        }
+
+        template <typename Collection>
+        void write_collection(const Collection& collection)
+        {
+            write_size(collection.size());
+
+            for (const auto& entity : collection)
+                write(entity);
+        }
+
+        void write(const AOV& aov)
+        {
+            write_string(aov.get_model());
+            write_params(aov.get_parameters());
+        }
+
+        void write(const Assembly& assembly)
+        {
+            write_entity(assembly);
+
+            // Don't write the content of the assembly if it was
+            // generated procedurally.
+            const bool procedural = dynamic_cast<const ProceduralAssembly*>(&assembly) != nullptr;
+            write_bool(procedural);
+            if (procedural)
+                return;
+
+            write_collection(assembly.colors());
+            write_collection(assembly.textures());
+            write_collection(assembly.texture_instances());
+            write_collection(assembly.bsdfs());
+            write_collection(assembly.bssrdfs());
+            write_collection(assembly.edfs());
+            write_collection(assembly.shader_groups());
+            write_collection(assembly.surface_shaders());
+            write_collection(assembly.materials());
+            write_collection(assembly.lights());
+            write_object_collection(assembly.objects());
+            write_collection(assembly.object_instances());
+            write_collection(assembly.volumes());
+            write_collection(assembly.assemblies());
+            write_collection(assembly.assembly_instances());
+        }
+
+        void write(const AssemblyInstance& assembly_instance)
+        {
+            write_string(assembly_instance.get_name());
+            write_string(assembly_instance.get_assembly_name());
+            write_params(assembly_instance.get_parameters());
+            write_transform_sequence(assembly_instance.transform_sequence());
+        }
+
+        void write(const BSDF& bsdf)
+        {
+            write_entity(bsdf);
+        }
+
+        void write(const BSSRDF& bssrdf)
+        {
+            write_entity(bssrdf);
+        }
+
+        void write(const Camera& camera)
+        {
+            write_entity(camera);
+            write_transform_sequence(camera.transform_sequence());
+        }
+
+        void write(const ColorEntity& color_entity)
+        {
+            write_string(color_entity.get_name());
+            write_params(color_entity.get_parameters());
+            write_value_array(color_entity.get_values());
+            write_value_array(color_entity.get_alpha());
+        }
+
+        void write_configurations(const Project& project)
+        {
+            // Base configurations are built into every project.
+            std::vector<const Configuration*> configurations;
+            for (const Configuration& configuration : project.configurations())
+            {
+                if (!BaseConfigurationFactory::is_base_configuration(configuration.get_name()))
+                    configurations.push_back(&configuration);
+            }
+
+            // Configurations are written in insertion order so that base
+            // configurations are always defined before they are referenced.
+            write_size(configurations.size());
+            for (const Configuration* configuration : configurations)
+            {
+                write_string(configuration->get_name());
+                write_string(configuration->get_base() ? configuration->get_base()->get_name() : "");
+                write_params(configuration->get_parameters());
+            }
+        }
+
+        void write(const Display& display)
+        {
+            write_string(display.get_name());
+            write_params(display.get_parameters());
+        }
+
+        void write(const EDF& edf)
+        {
+            write_entity(edf);
+        }
+
+        void write(const Environment& environment)
+        {
+            write_entity(environment);
+        }
+
+        void write(const EnvironmentEDF& env_edf)
+        {
+            write_entity(env_edf);
+            write_transform_sequence(env_edf.transform_sequence());
+        }
+
+        void write(const EnvironmentShader& env_shader)
+        {
+            write_entity(env_shader);
+        }
+
+        void write_frame(const Frame& frame)
+        {
+            write_string(frame.get_name());
+            write_params(frame.get_parameters());
+            write_collection(frame.aovs());
+            write_collection(frame.post_processing_stages());
+        }
+
+        void write(const Light& light)
+        {
+            write_entity(light);
+            write_matrix(light.get_transform().get_local_to_parent());
+        }
+
+        void write(const Material& material)
+        {
+            write_entity(material);
+        }
+
+        void write(const Volume& volume)
+        {
+            write_entity(volume);
+        }
+
+        void write_object_collection(ObjectContainer& objects)
+        {
+            // Objects belonging to the same group are written as a single record,
+            // so the number of records is only known once all objects were visited.
+            ObjectRecordCollector::ObjectRecordVector records;
+            m_object_record_collector.begin_collection();
+            for (Object& object : objects)
+                m_object_record_collector.collect(object, records);
+
+            write_size(records.size());
+            for (const ObjectRecordCollector::ObjectRecord& record : records)
+            {
+                if (record.m_write_geometry_file)
+                    record.m_write_geometry_file();
+
+                write_string(record.m_name);
+                write_string(record.m_object->get_model());
+                write_params(record.m_params);
+            }
+        }
+
+        void write(const ObjectInstance& object_instance)
+        {
+            write_string(object_instance.get_name());
+            write_string(m_object_record_collector.translate_object_name(object_instance.get_object_name()));
+            write_params(object_instance.get_parameters());
+            write_matrix(object_instance.get_transform().get_local_to_parent());
+            write_string_dictionary(object_instance.get_front_material_mappings());
+            write_string_dictionary(object_instance.get_back_material_mappings());
+        }
+
+        void write(const PostProcessingStage& stage)
+        {
+            write_entity(stage);
+        }
+
+        void write_scene(const Scene& scene)
+        {
+            write_params(scene.get_parameters());
+            write_collection(scene.cameras());
+            write_collection(scene.colors());
+            write_collection(scene.textures());
+            write_collection(scene.texture_instances());
+            write_collection(scene.environment_edfs());
+            write_collection(scene.environment_shaders());
+            write_bool(scene.get_environment() != nullptr);
+            if (scene.get_environment())
+                write(*scene.get_environment());
+            write_collection(scene.shader_groups());
+            write_collection(scene.assemblies());
+            write_collection(scene.assembly_instances());
+        }
+
+        void write_search_paths(const Project& project)
+        {
+            const SearchPaths& search_paths = project.search_paths();
+
+            write_size(search_paths.get_explicit_path_count());
+            for (size_t i = 0; i < search_paths.get_explicit_path_count(); ++i)
+                write_string(search_paths.get_explicit_path(i));
+        }
+
+        void write(const Shader& shader)
+        {
+            write_string(shader.get_type());
+            write_string(shader.get_shader());
+            write_string(shader.get_layer());
+            write_string(shader.get_source_code() ? shader.get_source_code() : "");
+
+            write_size(shader.shader_params().size());
+            for (const ShaderParam& param : shader.shader_params())
+            {
+                write_string(param.get_name());
+                write_string(param.get_value_as_string());
+            }
+        }
+
+        void write(const ShaderConnection& connection)
+        {
+            write_string(connection.get_src_layer());
+            write_string(connection.get_src_param());
+            write_string(connection.get_dst_layer());
+            write_string(connection.get_dst_param());
+        }
+
+        void write(const ShaderGroup& shader_group)
+        {
+            write_string(shader_group.get_name());
+
+            // Shaders and shader connections are written in their original order.
+            write_collection(shader_group.shaders());
+            write_collection(shader_group.shader_connections());
+        }
+
+        void write(const SurfaceShader& surface_shader)
+        {
+            write_entity(surface_shader);
+        }
+
+        void write(const Texture& texture)
+        {
+            write_entity(texture);
+        }
+
+        void write(const TextureInstance& texture_instance)
+        {
+            write_string(texture_instance.get_name());
+            write_string(texture_instance.get_texture_name());
+            write_params(texture_instance.get_parameters());
+            write_matrix(Matrix4d(texture_instance.get_transform().get_local_to_parent()));
+        }
+    };
+
+    void write_signature(BufferedFile& file)
+    {
+        static const char Signature[13] = { 'B', 'I', 'N', 'A', 'R', 'Y', 'P', 'R', 'O', 'J', 'E', 'C', 'T' };
+        checked_write(file, Signature, sizeof(Signature));
+    }
+}
+
+bool BinaryProjectFileWriter::write(
+    Project&        project,
+    const char*     filepath,
+    const int       options)
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    RENDERER_LOG_INFO("writing project file %s...", filepath);
+
+    if (!(options & ProjectFileWriter::OmitHandlingAssetFiles))
+    {
+        // Manage references to external asset files.
+        const AssetHandler asset_handler(
+            project,
+            filepath,
+            (options & ProjectFileWriter::CopyAllAssets) != 0
+                ? AssetHandler::CopyAllAssets
+                : AssetHandler::CopyRelativeAssetsOnly);
+        if (!asset_handler.handle_assets())
+        {
+            RENDERER_LOG_ERROR("failed to write project file %s.", filepath);
+            return false;
+        }
+    }
+
+    // Open the file for writing.
+    BufferedFile file(filepath, BufferedFile::BinaryType, BufferedFile::WriteMode);
+    if (!file.is_open())
+    {
+        RENDERER_LOG_ERROR("failed to write project file %s: i/o error.", filepath);
+        return false;
+    }
+
+    try
+    {
+        // Write the file header.
+        write_signature(file);
+        checked_write(file, Version);
+
+        // Write the project. The compressed stream is flushed when the adapter is destroyed.
+        LZ4CompressedWriterAdapter compressed_writer(file, 1024 * 1024);
+        Writer writer(filepath, compressed_writer, options);
+        writer.write_project(project);
+    }
+    catch (const Exception& e)
+    {
+        RENDERER_LOG_ERROR("failed to write project file %s: %s.", filepath, e.what());
+        return false;
+    }
+
+    if (!file.close())
+    {
+        RENDERER_LOG_ERROR("failed to write project file %s: i/o error.", filepath);
+        return false;
+    }
+
+    stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "wrote project file %s in %s.",
+        filepath,
+        pretty_time(stopwatch.get_seconds()).c_str());
+
+    return true;
+}
+
+}   // namespace renderer
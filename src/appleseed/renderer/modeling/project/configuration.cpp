@@ -170,6 +170,14 @@ Dictionary Configuration::get_metadata()
             .insert("label", "Render Threads")
             .insert("help", "Number of threads to use for rendering"));
 
+    metadata.insert(
+        "deferred_geometry_memory_budget",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1073741824")
+            .insert("label", "Deferred Geometry Memory Budget")
+            .insert("help", "Maximum size in bytes of the geometry of deferred mesh objects kept in memory when the scene no longer uses it"));
+
 #ifdef APPLESEED_WITH_EMBREE
 
     metadata.insert(
@@ -0,0 +1,192 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "meshobjectloader.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/object/asyncmeshobjectreader.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/eventcounters.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/projectfilereader.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/memory/autoreleaseptr.h"
+#include "foundation/utility/api/apiarray.h"
+
+// Standard headers.
+#include <vector>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// MeshObjectLoader class implementation.
+//
+
+MeshObjectLoader::MeshObjectLoader(
+    Project&                project,
+    const int               options,
+    const size_t            thread_count,
+    EventCounters&          event_counters)
+  : m_project(project)
+  , m_options(options)
+  , m_event_counters(event_counters)
+{
+    if ((options & ProjectFileReader::ReadMeshFilesAsynchronously) &&
+        !(options & ProjectFileReader::OmitReadingMeshFiles))
+        m_async_reader.reset(new AsyncMeshObjectReader(thread_count));
+}
+
+MeshObjectLoader::~MeshObjectLoader()
+{
+}
+
+bool MeshObjectLoader::is_async() const
+{
+    return m_async_reader != nullptr;
+}
+
+void MeshObjectLoader::create_objects(
+    const IObjectFactory&   factory,
+    const char*             name,
+    const ParamArray&       params,
+    ObjectArray&            objects)
+{
+    if (can_defer_geometry_loading(factory, params))
+    {
+        // Only read the headers of the mesh files, geometry will be loaded when rendering.
+        MeshObjectArray mesh_objects;
+        if (!MeshObjectReader::read(
+                m_project.search_paths(),
+                name,
+                params,
+                mesh_objects,
+                MeshObjectReader::DeferGeometryLoading))
+            m_event_counters.signal_error();
+
+        objects = array_vector<ObjectArray>(mesh_objects);
+    }
+    else if (can_defer_reading(factory, params))
+    {
+        // Insert an empty placeholder object while the mesh files are being read.
+        auto_release_ptr<Object> placeholder = factory.create(name, params);
+        m_pending_reads[placeholder->get_uid()] =
+            m_async_reader->enqueue(
+                m_project.search_paths(),
+                placeholder->get_name(),
+                params);
+        objects.clear();
+        objects.push_back(placeholder.release());
+    }
+    else
+    {
+        if (!factory.create(
+                name,
+                params,
+                m_project.search_paths(),
+                (m_options & ProjectFileReader::OmitReadingMeshFiles) != 0,
+                objects))
+            m_event_counters.signal_error();
+    }
+}
+
+void MeshObjectLoader::complete()
+{
+    if (!m_async_reader)
+        return;
+
+    m_async_reader->wait();
+
+    // Placeholders of assemblies that failed to load no longer exist;
+    // the mesh objects read for them are deleted with the reader.
+    if (m_project.get_scene() != nullptr)
+        replace_placeholder_objects(m_project.get_scene()->assemblies());
+
+    m_pending_reads.clear();
+}
+
+bool MeshObjectLoader::can_defer_reading(
+    const IObjectFactory&   factory,
+    const ParamArray&       params) const
+{
+    return
+        m_async_reader != nullptr &&
+        dynamic_cast<const MeshObjectFactory*>(&factory) != nullptr &&
+        !params.strings().exist("primitive");
+}
+
+bool MeshObjectLoader::can_defer_geometry_loading(
+    const IObjectFactory&   factory,
+    const ParamArray&       params) const
+{
+    return
+        (m_options & ProjectFileReader::DeferMeshGeometryLoading) &&
+        !(m_options & ProjectFileReader::OmitReadingMeshFiles) &&
+        dynamic_cast<const MeshObjectFactory*>(&factory) != nullptr &&
+        !params.strings().exist("primitive") &&
+        MeshObjectReader::can_defer_geometry_loading(m_project.search_paths(), params);
+}
+
+void MeshObjectLoader::replace_placeholder_objects(AssemblyContainer& assemblies)
+{
+    for (Assembly& assembly : assemblies)
+    {
+        std::vector<Object*> placeholders;
+        for (Object& object : assembly.objects())
+        {
+            if (m_pending_reads.count(object.get_uid()) > 0)
+                placeholders.push_back(&object);
+        }
+
+        for (Object* placeholder : placeholders)
+        {
+            MeshObjectArray objects;
+            if (!m_async_reader->take_objects(m_pending_reads[placeholder->get_uid()], objects))
+                m_event_counters.signal_error();
+
+            assembly.objects().remove(placeholder);
+
+            for (size_t i = 0, e = objects.size(); i < e; ++i)
+                assembly.objects().insert(auto_release_ptr<Object>(objects[i]));
+        }
+
+        replace_placeholder_objects(assembly.assemblies());
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,112 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/modeling/object/iobjectfactory.h"
+#include "renderer/modeling/scene/containers.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/uid.h"
+
+// Standard headers.
+#include <cstddef>
+#include <map>
+#include <memory>
+
+// Forward declarations.
+namespace renderer  { class AsyncMeshObjectReader; }
+namespace renderer  { class EventCounters; }
+namespace renderer  { class Object; }
+namespace renderer  { class ParamArray; }
+namespace renderer  { class Project; }
+
+namespace renderer
+{
+
+//
+// Create the objects of a project being read by a project file reader.
+//
+// Depending on the options of the project file reader, mesh files are read on worker
+// threads (placeholder objects stand for their mesh objects until complete() is called)
+// or only their headers are read, their geometry being loaded when rendering.
+//
+
+class MeshObjectLoader
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. `options` are ProjectFileReader::Options flags.
+    MeshObjectLoader(
+        Project&                project,
+        const int               options,
+        const size_t            thread_count,
+        EventCounters&          event_counters);
+
+    // Destructor.
+    ~MeshObjectLoader();
+
+    // Return true if mesh files are read asynchronously.
+    bool is_async() const;
+
+    // Create the objects defined by an object factory and parameters. Errors are signaled
+    // to the event counters; exceptions thrown by the object factory are propagated.
+    void create_objects(
+        const IObjectFactory&   factory,
+        const char*             name,
+        const ParamArray&       params,
+        ObjectArray&            objects);
+
+    // Wait until all asynchronous mesh object reads are complete and replace
+    // placeholder objects by the mesh objects that were read from disk.
+    void complete();
+
+  private:
+    typedef std::map<foundation::UniqueID, size_t> PendingReads;
+
+    Project&                                m_project;
+    const int                               m_options;
+    EventCounters&                          m_event_counters;
+    std::unique_ptr<AsyncMeshObjectReader>  m_async_reader;
+    PendingReads                            m_pending_reads;    // placeholder object UID -> read index
+
+    bool can_defer_reading(
+        const IObjectFactory&   factory,
+        const ParamArray&       params) const;
+
+    bool can_defer_geometry_loading(
+        const IObjectFactory&   factory,
+        const ParamArray&       params) const;
+
+    void replace_placeholder_objects(AssemblyContainer& assemblies);
+};
+
+}   // namespace renderer
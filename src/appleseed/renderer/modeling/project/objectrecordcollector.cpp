@@ -0,0 +1,175 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "objectrecordcollector.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/object/curveobject.h"
+#include "renderer/modeling/object/curveobjectwriter.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectwriter.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/projectfilewriter.h"
+
+// Standard headers.
+#include <cstring>
+
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// ObjectRecordCollector class implementation.
+//
+
+ObjectRecordCollector::ObjectRecordCollector(
+    const bf::path&         project_new_root_dir,
+    const int               options)
+  : m_project_new_root_dir(project_new_root_dir)
+  , m_options(options)
+{
+}
+
+void ObjectRecordCollector::begin_collection()
+{
+    m_groups.clear();
+}
+
+void ObjectRecordCollector::collect(
+    Object&                 object,
+    ObjectRecordVector&     records)
+{
+    if (strcmp(object.get_model(), MeshObjectFactory().get_model()) == 0)
+        collect_mesh_object(static_cast<MeshObject&>(object), records);
+    else if (strcmp(object.get_model(), CurveObjectFactory().get_model()) == 0)
+        collect_curve_object(static_cast<CurveObject&>(object), records);
+    else records.push_back(ObjectRecord{ &object, object.get_name(), object.get_parameters(), nullptr });
+}
+
+std::string ObjectRecordCollector::translate_object_name(const std::string& old_name) const
+{
+    const ObjectNameMapping::const_iterator i = m_object_name_mapping.find(old_name);
+    return i == m_object_name_mapping.end() ? old_name : i->second;
+}
+
+void ObjectRecordCollector::collect_mesh_object(
+    const MeshObject&       object,
+    ObjectRecordVector&     records)
+{
+    const ParamArray& params = object.get_parameters();
+
+    // If the object is a mesh primitive, do not write geometry to disk.
+    if (params.strings().exist("primitive"))
+        records.push_back(ObjectRecord{ &object, object.get_name(), params, nullptr });
+    else if (params.strings().exist("__base_object_name"))
+    {
+        // This object belongs to a group of objects.
+        const std::string group_name = params.get<std::string>("__base_object_name");
+        if (m_groups.insert(group_name).second)
+        {
+            // This is the first time we encounter this group of objects.
+            ParamArray group_params = params;
+            group_params.strings().remove("__base_object_name");
+            records.push_back(ObjectRecord{ &object, group_name, group_params, nullptr });
+        }
+    }
+    else if (params.strings().exist("filename") || params.dictionaries().exist("filename"))
+    {
+        // This object has a filename parameter.
+        records.push_back(ObjectRecord{ &object, object.get_name(), params, nullptr });
+    }
+    else
+    {
+        // This object does not belong to a group and does not have a filename parameter.
+        collect_orphan_mesh_object(object, records);
+    }
+}
+
+void ObjectRecordCollector::collect_orphan_mesh_object(
+    const MeshObject&       object,
+    ObjectRecordVector&     records)
+{
+    // Construct the name of the mesh file.
+    const std::string object_name = object.get_name();
+    const std::string filename = object_name + ".binarymesh";
+
+    ObjectRecord record{ &object, object_name, object.get_parameters(), nullptr };
+
+    if (!(m_options & ProjectFileWriter::OmitWritingGeometryFiles))
+    {
+        // Write the mesh file to disk.
+        const std::string filepath = (m_project_new_root_dir / filename).string();
+        record.m_write_geometry_file =
+            [&object, object_name, filepath]()
+            {
+                MeshObjectWriter::write(object, object_name.c_str(), filepath.c_str());
+            };
+    }
+
+    // Output a "filename" parameter but don't add it to the object.
+    record.m_params.insert("filename", filename);
+    records.push_back(record);
+
+    // Update the object name mapping.
+    m_object_name_mapping[object_name] = object_name + "." + object_name;
+}
+
+void ObjectRecordCollector::collect_curve_object(
+    CurveObject&            object,
+    ObjectRecordVector&     records)
+{
+    ParamArray& params = object.get_parameters();
+
+    ObjectRecord record{ &object, object.get_name(), ParamArray(), nullptr };
+
+    if (!params.strings().exist("filepath"))
+    {
+        const std::string filename = record.m_name + ".binarycurve";
+
+        if (!(m_options & ProjectFileWriter::OmitWritingGeometryFiles))
+        {
+            // Write the curve file to disk.
+            const std::string filepath = (m_project_new_root_dir / filename).string();
+            record.m_write_geometry_file =
+                [&object, filepath]()
+                {
+                    CurveObjectWriter::write(object, filepath.c_str());
+                };
+        }
+
+        // Add a file path parameter to the object.
+        params.insert("filepath", filename);
+    }
+
+    record.m_params = params;
+    records.push_back(record);
+}
+
+}   // namespace renderer
@@ -0,0 +1,117 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class CurveObject; }
+namespace renderer  { class MeshObject; }
+namespace renderer  { class Object; }
+
+namespace renderer
+{
+
+//
+// Decide how the objects of a project being written by a project file writer must
+// appear in the project file.
+//
+// Objects of a group are written once under the name of their group, and mesh and
+// curve objects without a file get one written next to the project file. Object
+// instances must then refer to objects by the names returned by translate_object_name().
+//
+
+class ObjectRecordCollector
+  : public foundation::NonCopyable
+{
+  public:
+    // An object as it must appear in the project file.
+    struct ObjectRecord
+    {
+        const Object*               m_object;
+        std::string                 m_name;
+        ParamArray                  m_params;
+        std::function<void ()>      m_write_geometry_file;  // writes the geometry file of the object, if any
+    };
+
+    typedef std::vector<ObjectRecord> ObjectRecordVector;
+
+    // Constructor. `options` are ProjectFileWriter::Options flags.
+    ObjectRecordCollector(
+        const boost::filesystem::path&  project_new_root_dir,
+        const int                       options);
+
+    // Start collecting the objects of a new object collection.
+    void begin_collection();
+
+    // Append to `records` the record of an object, if any: objects of a group
+    // after the first one encountered in the collection have no record.
+    void collect(
+        Object&                         object,
+        ObjectRecordVector&             records);
+
+    // Get the new name of an object, given its old name.
+    std::string translate_object_name(const std::string& old_name) const;
+
+  private:
+    typedef std::map<std::string, std::string> ObjectNameMapping;
+
+    const boost::filesystem::path       m_project_new_root_dir;
+    const int                           m_options;
+    std::set<std::string>               m_groups;               // groups of objects of the current collection
+    ObjectNameMapping                   m_object_name_mapping;  // established by collect_orphan_mesh_object()
+
+    void collect_mesh_object(
+        const MeshObject&               object,
+        ObjectRecordVector&             records);
+
+    void collect_orphan_mesh_object(
+        const MeshObject&               object,
+        ObjectRecordVector&             records);
+
+    void collect_curve_object(
+        CurveObject&                    object,
+        ObjectRecordVector&             records);
+};
+
+}   // namespace renderer
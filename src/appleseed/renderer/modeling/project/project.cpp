@@ -50,6 +50,7 @@
 #include "renderer/modeling/project/configuration.h"
 #include "renderer/modeling/project/configurationcontainer.h"
 #include "renderer/modeling/project/projectformatrevision.h"
+#include "renderer/modeling/project/renderdatacache.h"
 #include "renderer/modeling/scene/assemblyfactoryregistrar.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/scene.h"
@@ -124,6 +125,7 @@ struct Project::Impl
 
     // Project-specific components.
     LightPathRecorder                   m_light_path_recorder;
+    RenderDataCache                     m_render_data_cache;
     std::unique_ptr<TraceContext>       m_trace_context;
     RenderingTimer                      m_rendering_timer;
 
@@ -340,6 +342,11 @@ LightPathRecorder& Project::get_light_path_recorder() const
     return impl->m_light_path_recorder;
 }
 
+RenderDataCache& Project::get_render_data_cache() const
+{
+    return impl->m_render_data_cache;
+}
+
 #ifdef APPLESEED_WITH_EMBREE
 
 void Project::set_use_embree(const bool value)
@@ -350,6 +357,12 @@ void Project::set_use_embree(const bool value)
 
 #endif
 
+void Project::set_deferred_geometry_memory_budget(const size_t budget)
+{
+    if (impl->m_trace_context)
+        impl->m_trace_context->set_deferred_geometry_memory_budget(budget);
+}
+
 bool Project::has_trace_context() const
 {
     return impl->m_trace_context.get() != nullptr;
@@ -366,10 +379,12 @@ const TraceContext& Project::get_trace_context() const
     return *impl->m_trace_context;
 }
 
-void Project::update_trace_context()
+bool Project::update_trace_context()
 {
     if (impl->m_trace_context)
-        impl->m_trace_context->update();
+        return impl->m_trace_context->update();
+
+    return true;
 }
 
 RenderingTimer& Project::get_rendering_timer()
@@ -82,6 +82,7 @@ namespace renderer      { class Object; }
 namespace renderer      { class OnFrameBeginRecorder; }
 namespace renderer      { class PluginStore; }
 namespace renderer      { class PostProcessingStage; }
+namespace renderer      { class RenderDataCache; }
 namespace renderer      { class Scene; }
 namespace renderer      { class SurfaceShader; }
 namespace renderer      { class Texture; }
@@ -160,11 +161,17 @@ class APPLESEED_DLLSYMBOL Project
     // Access the light path recorder.
     LightPathRecorder& get_light_path_recorder() const;
 
+    // Access the cache of data built by entities at render time and reused across renders.
+    RenderDataCache& get_render_data_cache() const;
+
 #ifdef APPLESEED_WITH_EMBREE
     // Set use Embree flag for trace context
     void set_use_embree(const bool value);
 #endif
 
+    // Set the memory budget (in bytes) for the geometry of deferred mesh objects.
+    void set_deferred_geometry_memory_budget(const size_t budget);
+
     // Return true if the trace context has already been built.
     bool has_trace_context() const;
 
@@ -172,7 +179,8 @@ class APPLESEED_DLLSYMBOL Project
     const TraceContext& get_trace_context() const;
 
     // Synchronize the trace context with the scene.
-    void update_trace_context();
+    // Return false if the geometry of a deferred mesh object failed to load.
+    bool update_trace_context();
 
     // Access the timer used to track and measure frame rendering time.
     RenderingTimer& get_rendering_timer();
@@ -33,21 +33,33 @@
 // appleseed.renderer headers.
 #include "renderer/modeling/project-builtin/cornellboxproject.h"
 #include "renderer/modeling/project-builtin/defaultproject.h"
+#include "renderer/modeling/project/binaryprojectfilereader.h"
 #include "renderer/modeling/project/configuration.h"
 #include "renderer/modeling/project/eventcounters.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/project/projectfileupdater.h"
 #include "renderer/modeling/project/projectformatrevision.h"
 #include "renderer/modeling/project/xmlprojectfilereader.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
+#include "renderer/modeling/object/object.h"
 #include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 
 // appleseed.foundation headers.
+#include "foundation/hash/murmurhash.h"
+#include "foundation/platform/system.h"
 #include "foundation/string/string.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace foundation;
 
@@ -60,6 +72,11 @@ namespace renderer
 
 namespace
 {
+    size_t get_reader_thread_count(const size_t thread_count)
+    {
+        return thread_count > 0 ? thread_count : System::get_logical_cpu_core_count();
+    }
+
     bool is_builtin_project(const std::string& project_filepath, std::string& project_name)
     {
         const std::string BuiltInPrefix = "builtin:";
@@ -72,12 +89,189 @@ namespace
 
         return false;
     }
+
+    //
+    // Collapses mesh objects of a same assembly that have identical contents into a single
+    // object, and makes the object instances of the duplicates instantiate that object.
+    //
+
+    class MeshObjectDeduplicator
+    {
+      public:
+        MeshObjectDeduplicator()
+          : m_duplicate_count(0)
+          , m_saved_bytes(0)
+        {
+        }
+
+        void deduplicate(Assembly& assembly)
+        {
+            for (Assembly& child_assembly : assembly.assemblies())
+                deduplicate(child_assembly);
+
+            deduplicate_objects(assembly);
+        }
+
+        size_t get_duplicate_count() const
+        {
+            return m_duplicate_count;
+        }
+
+        size_t get_saved_bytes() const
+        {
+            return m_saved_bytes;
+        }
+
+      private:
+        size_t m_duplicate_count;
+        size_t m_saved_bytes;
+
+        // Return the parameters of an object that affect its appearance.
+        static ParamArray get_content_params(const Object& object)
+        {
+            ParamArray params = object.get_parameters();
+            params.strings().remove("filename");
+            params.dictionaries().remove("filename");
+            params.strings().remove("__base_object_name");
+            return params;
+        }
+
+        // Return true if an object instance would find `object` if it referenced it by name.
+        static bool can_instantiate(const ObjectInstance& object_instance, const Object& object)
+        {
+            for (const Entity* parent = object_instance.get_parent(); parent; parent = parent->get_parent())
+            {
+                const Assembly* parent_assembly = dynamic_cast<const Assembly*>(parent);
+
+                if (parent_assembly == nullptr)
+                    break;
+
+                const Object* found_object = parent_assembly->objects().get_by_name(object.get_name());
+
+                if (found_object)
+                    return found_object == &object;
+            }
+
+            return false;
+        }
+
+        // Replace an object instance by an identical one that instantiates another object.
+        static void replace_object(ObjectInstance& object_instance, const Object& object)
+        {
+            auto_release_ptr<ObjectInstance> new_object_instance(
+                ObjectInstanceFactory::create(
+                    object_instance.get_name(),
+                    object_instance.get_parameters(),
+                    object.get_name(),
+                    object_instance.get_transform(),
+                    object_instance.get_front_material_mappings(),
+                    object_instance.get_back_material_mappings()));
+
+            Assembly* parent_assembly = static_cast<Assembly*>(object_instance.get_parent());
+            parent_assembly->object_instances().remove(&object_instance);
+            parent_assembly->object_instances().insert(new_object_instance);
+        }
+
+        typedef std::map<const Object*, std::vector<ObjectInstance*>> ObjectInstancesByObject;
+
+        static void collect_object_instances(Assembly& assembly, ObjectInstancesByObject& object_instances)
+        {
+            for (ObjectInstance& object_instance : assembly.object_instances())
+                object_instances[object_instance.find_object()].push_back(&object_instance);
+
+            for (Assembly& child_assembly : assembly.assemblies())
+                collect_object_instances(child_assembly, object_instances);
+        }
+
+        void deduplicate_objects(Assembly& assembly)
+        {
+            // Find mesh objects identical to a previous mesh object of the assembly.
+            std::map<MurmurHash, std::vector<const MeshObject*>> unique_objects;
+            std::vector<std::pair<MeshObject*, const MeshObject*>> duplicates;
+
+            for (Object& object : assembly.objects())
+            {
+                if (strcmp(object.get_model(), MeshObjectFactory().get_model()) != 0)
+                    continue;
+
+                MeshObject& mesh_object = static_cast<MeshObject&>(object);
+
+                // The geometry of deferred mesh objects is not available at load time.
+                if (!mesh_object.is_geometry_loaded())
+                    continue;
+
+                MurmurHash hash;
+                compute_signature(hash, mesh_object);
+
+                std::vector<const MeshObject*>& candidates = unique_objects[hash];
+                const ParamArray params = get_content_params(mesh_object);
+                const MeshObject* original = nullptr;
+
+                for (const MeshObject* candidate : candidates)
+                {
+                    if (get_content_params(*candidate) == params)
+                    {
+                        original = candidate;
+                        break;
+                    }
+                }
+
+                if (original)
+                    duplicates.emplace_back(&mesh_object, original);
+                else candidates.push_back(&mesh_object);
+            }
+
+            if (duplicates.empty())
+                return;
+
+            // Object instances of this assembly and of its child assemblies may instantiate the duplicates.
+            ObjectInstancesByObject object_instances;
+            collect_object_instances(assembly, object_instances);
+
+            for (const auto& duplicate : duplicates)
+            {
+                // Make sure the object instances of the duplicate can instantiate the original instead.
+                const ObjectInstancesByObject::const_iterator it = object_instances.find(duplicate.first);
+                bool can_collapse = true;
+
+                if (it != object_instances.end())
+                {
+                    for (const ObjectInstance* object_instance : it->second)
+                    {
+                        if (!can_instantiate(*object_instance, *duplicate.second))
+                        {
+                            can_collapse = false;
+                            break;
+                        }
+                    }
+                }
+
+                if (!can_collapse)
+                    continue;
+
+                // The replaced object instances are destroyed, forget about them.
+                if (it != object_instances.end())
+                {
+                    for (ObjectInstance* object_instance : it->second)
+                        replace_object(*object_instance, *duplicate.second);
+
+                    object_instances.erase(it);
+                }
+
+                ++m_duplicate_count;
+                m_saved_bytes += duplicate.first->get_geometry_memory_size();
+
+                assembly.objects().remove(duplicate.first);
+            }
+        }
+    };
 }
 
 auto_release_ptr<Project> ProjectFileReader::read(
     const char*             project_filepath,
     const char*             schema_filepath,
-    const int               options)
+    const int               options,
+    const size_t            thread_count)
 {
     assert(project_filepath);
 
@@ -92,10 +286,17 @@ auto_release_ptr<Project> ProjectFileReader::read(
     EventCounters event_counters;
 
     auto_release_ptr<Project> project =
-        XMLProjectFileReader::read(
+        BinaryProjectFileReader::is_binary_project_file(project_filepath)
+            ? BinaryProjectFileReader::read(
+                project_filepath,
+                options,
+                get_reader_thread_count(thread_count),
+                event_counters)
+            : XMLProjectFileReader::read(
                 project_filepath,
                 schema_filepath,
                 options,
+                get_reader_thread_count(thread_count),
                 event_counters);
 
     if (project.get())
@@ -116,7 +317,8 @@ auto_release_ptr<Assembly> ProjectFileReader::read_archive(
     const char*             archive_filepath,
     const char*             schema_filepath,
     const SearchPaths&      search_paths,
-    const int               options)
+    const int               options,
+    const size_t            thread_count)
 {
     assert(archive_filepath);
 
@@ -126,12 +328,20 @@ auto_release_ptr<Assembly> ProjectFileReader::read_archive(
     stopwatch.start();
 
     auto_release_ptr<Project> project =
-        XMLProjectFileReader::read_archive(
-            archive_filepath,
-            schema_filepath,
-            search_paths,
-            options | OmitSearchPaths,
-            event_counters);
+        BinaryProjectFileReader::is_binary_project_file(archive_filepath)
+            ? BinaryProjectFileReader::read_archive(
+                archive_filepath,
+                search_paths,
+                options | OmitSearchPaths,
+                get_reader_thread_count(thread_count),
+                event_counters)
+            : XMLProjectFileReader::read_archive(
+                archive_filepath,
+                schema_filepath,
+                search_paths,
+                options | OmitSearchPaths,
+                get_reader_thread_count(thread_count),
+                event_counters);
 
     if (project.get())
     {
@@ -225,6 +435,10 @@ void ProjectFileReader::postprocess_project(
         !(options & OmitProjectFileUpdate) &&
         project.get_format_revision() < ProjectFormatRevision)
         upgrade_project(project, event_counters);
+
+    if (!event_counters.has_errors() &&
+        (options & DeduplicateMeshObjects))
+        deduplicate_mesh_objects(project);
 }
 
 void ProjectFileReader::validate_project(
@@ -288,6 +502,28 @@ void ProjectFileReader::upgrade_project(
     updater.update(project, event_counters);
 }
 
+void ProjectFileReader::deduplicate_mesh_objects(Project& project)
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    MeshObjectDeduplicator deduplicator;
+
+    for (Assembly& assembly : project.get_scene()->assemblies())
+        deduplicator.deduplicate(assembly);
+
+    stopwatch.measure();
+
+    const size_t duplicate_count = deduplicator.get_duplicate_count();
+
+    RENDERER_LOG_INFO(
+        "collapsed %s duplicate mesh %s, saving %s, in %s.",
+        pretty_uint(duplicate_count).c_str(),
+        plural(duplicate_count, "object").c_str(),
+        pretty_size(deduplicator.get_saved_bytes()).c_str(),
+        pretty_time(stopwatch.get_seconds()).c_str());
+}
+
 void ProjectFileReader::print_loading_results(
     const char*             project_name,
     const bool              builtin_project,
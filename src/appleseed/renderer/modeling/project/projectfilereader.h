@@ -35,6 +35,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation { class SearchPaths; }
 namespace renderer   { class Assembly; }
@@ -57,15 +60,21 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         OmitReadingMeshFiles        = 1UL << 0,     // do not read mesh files from disk
         OmitProjectFileUpdate       = 1UL << 1,     // do not update the project file format to the latest revision
         OmitSearchPaths             = 1UL << 2,     // do not read search paths from the project
-        OmitProjectSchemaValidation = 1UL << 3      // do not validate project against schema
+        OmitProjectSchemaValidation = 1UL << 3,     // do not validate project against schema
+        ReadMeshFilesAsynchronously = 1UL << 4,     // read mesh files on worker threads while the project file is being parsed
+        DeferMeshGeometryLoading    = 1UL << 5,     // only read bounding boxes of page-aligned binarymesh files, load their geometry when rendering
+        DeduplicateMeshObjects      = 1UL << 6      // collapse mesh objects with identical contents into a single object
     };
 
     // Read a project from disk (or load a built-in project).
+    // Mesh files read asynchronously are read on `thread_count` threads, or on as many
+    // threads as there are logical CPU cores if `thread_count` is 0.
     // Return 0 if reading or parsing the file failed.
     static foundation::auto_release_ptr<Project> read(
         const char*                     project_filepath,
         const char*                     schema_filepath,
-        const int                       options = Defaults);
+        const int                       options = Defaults,
+        const size_t                    thread_count = 0);
 
     // Load a built-in project.
     // Return 0 if the requested built-in project does not exist.
@@ -78,7 +87,8 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         const char*                     archive_filepath,
         const char*                     schema_filepath,
         const foundation::SearchPaths&  search_paths,
-        const int                       options = Defaults);
+        const int                       options = Defaults,
+        const size_t                    thread_count = 0);
 
   private:
     static foundation::auto_release_ptr<Project> load_project_file(
@@ -113,6 +123,10 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         Project&                        project,
         EventCounters&                  event_counters);
 
+    // Collapse mesh objects with identical contents.
+    static void deduplicate_mesh_objects(
+        Project&                        project);
+
     static void print_loading_results(
         const char*                     project_name,
         const bool                      builtin_project,
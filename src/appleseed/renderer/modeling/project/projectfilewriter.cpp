@@ -31,6 +31,7 @@
 #include "projectfilewriter.h"
 
 // appleseed.renderer headers.
+#include "renderer/modeling/project/binaryprojectfilewriter.h"
 #include "renderer/modeling/project/xmlprojectfilewriter.h"
 
 // appleseed.foundation headers.
@@ -57,6 +58,12 @@ bool ProjectFileWriter::write(
 {
     const auto ext = lower_case(bf::path(filepath).extension().string());
 
+    if (ext == ".appleseedb")
+        return BinaryProjectFileWriter::write(
+            project,
+            filepath,
+            options);
+
     if (ext == ".appleseedz")
         return XMLProjectFileWriter::write_packed_project_file(
             project,
@@ -54,7 +54,9 @@ class APPLESEED_DLLSYMBOL ProjectFileWriter
         CopyAllAssets               = 1UL << 3      // copy all asset files (by default copy asset files with relative paths only)
     };
 
-    // Write a project to disk.
+    // Write a project to disk. The file format is selected from the file extension:
+    // *.appleseedz files are packed projects, *.appleseedb files are binary projects
+    // and all other files are plain XML projects.
     // Returns true on success, false otherwise.
     static bool write(
         Project&        project,
@@ -0,0 +1,71 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "renderdatacache.h"
+
+// Standard headers.
+#include <utility>
+
+namespace renderer
+{
+
+//
+// RenderDataCache class implementation.
+//
+
+void RenderDataCache::set(
+    const std::string&                  entity_path,
+    const std::uint64_t                 signature,
+    std::shared_ptr<const void>         data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry& entry = m_entries[entity_path];
+    entry.m_signature = signature;
+    entry.m_data = std::move(data);
+}
+
+void RenderDataCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+std::shared_ptr<const void> RenderDataCache::get_data(
+    const std::string&                  entity_path,
+    const std::uint64_t                 signature) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto i = m_entries.find(entity_path);
+    return i != m_entries.end() && i->second.m_signature == signature ? i->second.m_data : nullptr;
+}
+
+}   // namespace renderer
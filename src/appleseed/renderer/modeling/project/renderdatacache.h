@@ -0,0 +1,103 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace renderer
+{
+
+//
+// A cache for data that entities build at render time and that are expensive to rebuild,
+// such as the importance maps of environment maps. Data are stored under the path of the
+// entity that built them, along with a signature of the inputs they were built from, so
+// that subsequent renders of the project can reuse them as long as these inputs did not
+// change. Only the most recent data of each entity are kept.
+//
+// All methods are thread-safe.
+//
+
+class RenderDataCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Return the data stored for a given entity, or nullptr if there are no data
+    // for this entity or if they were built from inputs with a different signature.
+    template <typename T>
+    std::shared_ptr<const T> get(
+        const std::string&              entity_path,
+        const std::uint64_t             signature) const;
+
+    // Store data for a given entity, replacing any data previously stored for it.
+    void set(
+        const std::string&              entity_path,
+        const std::uint64_t             signature,
+        std::shared_ptr<const void>     data);
+
+    // Remove all data from the cache.
+    void clear();
+
+  private:
+    struct Entry
+    {
+        std::uint64_t                   m_signature;
+        std::shared_ptr<const void>     m_data;
+    };
+
+    mutable std::mutex                  m_mutex;
+    std::map<std::string, Entry>        m_entries;
+
+    std::shared_ptr<const void> get_data(
+        const std::string&              entity_path,
+        const std::uint64_t             signature) const;
+};
+
+
+//
+// RenderDataCache class implementation.
+//
+
+template <typename T>
+inline std::shared_ptr<const T> RenderDataCache::get(
+    const std::string&                  entity_path,
+    const std::uint64_t                 signature) const
+{
+    return std::static_pointer_cast<const T>(get_data(entity_path, signature));
+}
+
+}   // namespace renderer
@@ -73,6 +73,7 @@
 #include "renderer/modeling/project/configuration.h"
 #include "renderer/modeling/project/configurationcontainer.h"
 #include "renderer/modeling/project/eventcounters.h"
+#include "renderer/modeling/project/meshobjectloader.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/project/projectfilereader.h"
 #include "renderer/modeling/project/projectformatrevision.h"
@@ -214,10 +215,12 @@ namespace
         ParseContext(
             Project&        project,
             const int       options,
+            const size_t    thread_count,
             EventCounters&  event_counters)
           : m_project(project)
           , m_options(options)
           , m_event_counters(event_counters)
+          , m_mesh_object_loader(project, options, thread_count, event_counters)
         {
         }
 
@@ -236,10 +239,16 @@ namespace
             return m_event_counters;
         }
 
+        MeshObjectLoader& get_mesh_object_loader()
+        {
+            return m_mesh_object_loader;
+        }
+
       private:
         Project&            m_project;
         const int           m_options;
         EventCounters&      m_event_counters;
+        MeshObjectLoader    m_mesh_object_loader;
     };
 
 
@@ -1553,13 +1562,11 @@ namespace
                 if (factory)
                 {
                     ObjectArray objects;
-                    if (!factory->create(
-                            m_name.c_str(),
-                            m_params,
-                            m_context.get_project().search_paths(),
-                            m_context.get_options() & ProjectFileReader::OmitReadingMeshFiles,
-                            objects))
-                        m_context.get_event_counters().signal_error();
+                    m_context.get_mesh_object_loader().create_objects(
+                        *factory,
+                        m_name.c_str(),
+                        m_params,
+                        objects);
 
                     m_objects = array_vector<ObjectVector>(objects);
                 }
@@ -3155,6 +3162,7 @@ auto_release_ptr<Project> XMLProjectFileReader::read(
     const char*             project_filepath,
     const char*             schema_filepath,
     const int               options,
+    const size_t            thread_count,
     EventCounters&          event_counters)
 {
     assert(project_filepath);
@@ -3204,6 +3212,7 @@ auto_release_ptr<Project> XMLProjectFileReader::read(
                 project_filepath,
                 schema_filepath,
                 options,
+                thread_count,
                 event_counters);
 }
 
@@ -3212,6 +3221,7 @@ auto_release_ptr<Project> XMLProjectFileReader::read_archive(
     const char*             schema_filepath,
     const SearchPaths&      search_paths,
     const int               options,
+    const size_t            thread_count,
     EventCounters&          event_counters)
 {
     // Handle packed archives.
@@ -3254,6 +3264,7 @@ auto_release_ptr<Project> XMLProjectFileReader::read_archive(
                 archive_filepath,
                 schema_filepath,
                 options | ProjectFileReader::OmitSearchPaths,
+                thread_count,
                 event_counters,
                 &search_paths);
 }
@@ -3262,6 +3273,7 @@ auto_release_ptr<Project> XMLProjectFileReader::load_project_file(
     const char*                     project_filepath,
     const char*                     schema_filepath,
     const int                       options,
+    const size_t                    thread_count,
     EventCounters&                  event_counters,
     const foundation::SearchPaths*  search_paths)
 {
@@ -3287,7 +3299,7 @@ auto_release_ptr<Project> XMLProjectFileReader::load_project_file(
             event_counters));
 
     // Create the content handler.
-    ParseContext context(project.ref(), options, event_counters);
+    ParseContext context(project.ref(), options, thread_count, event_counters);
     std::unique_ptr<ContentHandler> content_handler(
         new ContentHandler(
             project.get(),
@@ -3332,6 +3344,9 @@ auto_release_ptr<Project> XMLProjectFileReader::load_project_file(
         return auto_release_ptr<Project>(nullptr);
     }
 
+    // Join mesh files read while the project file was being parsed.
+    context.get_mesh_object_loader().complete();
+
     // Report a failure in case of warnings or errors.
     if (error_handler->get_warning_count() > 0 ||
         error_handler->get_error_count() > 0 ||
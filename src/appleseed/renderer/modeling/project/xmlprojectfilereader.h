@@ -32,6 +32,9 @@
 // appleseed.foundation headers.
 #include "foundation/memory/autoreleaseptr.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation { class SearchPaths; }
 namespace renderer   { class EventCounters; }
@@ -53,6 +56,7 @@ class XMLProjectFileReader
         const char*                     project_filepath,
         const char*                     schema_filepath,
         const int                       options,
+        const size_t                    thread_count,
         EventCounters&                  event_counters);
 
     // Read an archive from disk.
@@ -62,6 +66,7 @@ class XMLProjectFileReader
         const char*                     schema_filepath,
         const foundation::SearchPaths&  search_paths,
         const int                       options,
+        const size_t                    thread_count,
         EventCounters&                  event_counters);
 
   private:
@@ -69,6 +74,7 @@ class XMLProjectFileReader
         const char*                     project_filepath,
         const char*                     schema_filepath,
         const int                       options,
+        const size_t                    thread_count,
         EventCounters&                  event_counters,
         const foundation::SearchPaths*  search_paths = nullptr);
 };
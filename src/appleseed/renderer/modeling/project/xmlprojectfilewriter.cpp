@@ -44,15 +44,12 @@
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
-#include "renderer/modeling/object/curveobject.h"
-#include "renderer/modeling/object/curveobjectwriter.h"
-#include "renderer/modeling/object/meshobject.h"
-#include "renderer/modeling/object/meshobjectwriter.h"
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/postprocessingstage/postprocessingstage.h"
 #include "renderer/modeling/project/assethandler.h"
 #include "renderer/modeling/project/configuration.h"
 #include "renderer/modeling/project/configurationcontainer.h"
+#include "renderer/modeling/project/objectrecordcollector.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/project/projectfilewriter.h"
 #include "renderer/modeling/scene/assembly.h"
@@ -76,9 +73,11 @@
 #include "foundation/core/appleseed.h"
 #include "foundation/math/transform.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/system.h"
 #include "foundation/string/string.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/indenter.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/xmlelement.h"
@@ -94,8 +93,7 @@
 #include <cstring>
 #include <exception>
 #include <functional>
-#include <map>
-#include <set>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -116,6 +114,28 @@ namespace
     const char* MatrixFormat     = "%.17f";
     const char* ColorValueFormat = "%.9f";
 
+    // Size of the buffer of the project file stream.
+    const size_t ProjectFileBufferSize = 1024 * 1024;
+
+    // Write a geometry file. Writers report their own errors.
+    class WriteGeometryFileJob
+      : public IJob
+    {
+      public:
+        explicit WriteGeometryFileJob(const std::function<void ()>& write)
+          : m_write(write)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_write();
+        }
+
+      private:
+        const std::function<void ()> m_write;
+    };
+
     class Writer
     {
       public:
@@ -125,11 +145,16 @@ namespace
             const char*         filepath,
             FILE*               file,
             const int           options)
-          : m_project_new_root_dir(filesystem::path(filepath).parent_path())
-          , m_file(file)
-          , m_options(options)
+          : m_file(file)
           , m_indenter(4)
+          , m_object_record_collector(filesystem::path(filepath).parent_path(), options)
+        {
+        }
+
+        // Destructor.
+        ~Writer()
         {
+            wait_for_geometry_files();
         }
 
         // Write the <project> element.
@@ -151,11 +176,39 @@ namespace
             write_configurations(project);
         }
 
+        // Wait until all geometry files are written.
+        void wait_for_geometry_files()
+        {
+            if (m_geometry_job_manager)
+                m_geometry_job_queue.wait_until_completion();
+        }
+
       private:
-        const filesystem::path  m_project_new_root_dir;
         FILE*                   m_file;
-        const int               m_options;
         Indenter                m_indenter;
+        ObjectRecordCollector   m_object_record_collector;
+
+        // Geometry files are written by worker threads while the project file is being written.
+        // The job manager must be destroyed before the job queue.
+        JobQueue                    m_geometry_job_queue;
+        std::unique_ptr<JobManager> m_geometry_job_manager;
+
+        // Write a geometry file in the background.
+        void schedule_geometry_file(const std::function<void ()>& write)
+        {
+            if (!m_geometry_job_manager)
+            {
+                m_geometry_job_manager.reset(
+                    new JobManager(
+                        global_logger(),
+                        m_geometry_job_queue,
+                        System::get_logical_cpu_core_count(),
+                        JobManager::KeepRunningOnEmptyQueue));
+                m_geometry_job_manager->start();
+            }
+
+            m_geometry_job_queue.schedule(new WriteGeometryFileJob(write));
+        }
 
         // Return a lexicographically-sorted vector of references to entities.
         template <typename Collection>
@@ -606,130 +659,28 @@ namespace
         // Write a collection of <object> elements.
         void write_object_collection(ObjectContainer& objects)
         {
-            std::set<std::string> groups;
-
-            for (Object& object : sorted(objects))
-            {
-                if (strcmp(object.get_model(), MeshObjectFactory().get_model()) == 0)
-                    write_mesh_object(static_cast<MeshObject&>(object), groups);
-                else if (strcmp(object.get_model(), CurveObjectFactory().get_model()) == 0)
-                    write_curve_object(static_cast<CurveObject&>(object));
-                else write(object);
-            }
-        }
-
-        // Write a mesh object.
-        void write_mesh_object(MeshObject& object, std::set<std::string>& groups)
-        {
-            ParamArray& params = object.get_parameters();
-
-            // If the object is a mesh primitive, do not write geometry to disk.
-            if (params.strings().exist("primitive"))
-            {
-                XMLElement element("object", m_file, m_indenter);
-                element.add_attribute("name", object.get_name());
-                element.add_attribute("model", MeshObjectFactory().get_model());
-                element.write(XMLElement::HasChildElements);
-                write_params(params);
-                return;
-            }
-
-            if (params.strings().exist("__base_object_name"))
-            {
-                // This object belongs to a group of objects.
-                const std::string group_name = params.get<std::string>("__base_object_name");
-                if (groups.find(group_name) == groups.end())
-                {
-                    // This is the first time we encounter this group of objects.
-                    groups.insert(group_name);
-
-                    // Write the object group.
-                    params.strings().remove("__base_object_name");
-                    write_entity("object", object, group_name.c_str());
-                    params.strings().insert("__base_object_name", group_name);
-                }
-            }
-            else if (params.strings().exist("filename") || params.dictionaries().exist("filename"))
-            {
-                // This object has a filename parameter.
-                write_entity("object", object, object.get_name());
-            }
-            else
-            {
-                // This object does not belong to a group and does not have a filename parameter.
-                write_orphan_mesh_object(object);
-            }
-        }
-
-        // Object name mapping established by do_write_orphan_mesh_object().
-        typedef std::map<std::string, std::string> ObjectNameMapping;
-        ObjectNameMapping m_object_name_mapping;
-
-        // Get the new name of an object, given its old name.
-        std::string translate_object_name(const std::string& old_name) const
-        {
-            const ObjectNameMapping::const_iterator i = m_object_name_mapping.find(old_name);
-            return i == m_object_name_mapping.end() ? old_name : i->second;
-        }
-
-        // Write an <object> element for a mesh object without a filename.
-        void write_orphan_mesh_object(const MeshObject& object)
-        {
-            // Construct the name of the mesh file.
-            const std::string object_name = object.get_name();
-            const std::string filename = object_name + ".binarymesh";
-
-            if (!(m_options & ProjectFileWriter::OmitWritingGeometryFiles))
-            {
-                // Write the mesh file to disk.
-                const std::string filepath = (m_project_new_root_dir / filename).string();
-                MeshObjectWriter::write(object, object_name.c_str(), filepath.c_str());
-            }
-
-            // Write the <object> element.
-            XMLElement element("object", m_file, m_indenter);
-            element.add_attribute("name", object_name);
-            element.add_attribute("model", MeshObjectFactory().get_model());
-            element.write(XMLElement::HasChildElements);
-
-            // Output a "filename" parameter but don't add it to the object.
-            ParamArray params = object.get_parameters();
-            params.insert("filename", filename);
-            write_params(params);
+            ObjectRecordCollector::ObjectRecordVector records;
 
-            // Update the object name mapping.
-            m_object_name_mapping[object_name] = object_name + "." + object_name;
-        }
+            m_object_record_collector.begin_collection();
 
-        // Write a curve object.
-        void write_curve_object(CurveObject& object)
-        {
-            ParamArray& params = object.get_parameters();
+            for (Object& object : sorted(objects))
+                m_object_record_collector.collect(object, records);
 
-            if (!params.strings().exist("filepath"))
+            for (const ObjectRecordCollector::ObjectRecord& record : records)
             {
-                const std::string object_name = object.get_name();
-                const std::string filename = object_name + ".binarycurve";
+                if (record.m_write_geometry_file)
+                    schedule_geometry_file(record.m_write_geometry_file);
 
-                if (!(m_options & ProjectFileWriter::OmitWritingGeometryFiles))
-                {
-                    // Write the curve file to disk.
-                    const std::string filepath = (m_project_new_root_dir / filename).string();
-                    CurveObjectWriter::write(object, filepath.c_str());
-                }
+                XMLElement element("object", m_file, m_indenter);
+                element.add_attribute("name", record.m_name);
+                element.add_attribute("model", record.m_object->get_model());
+                element.write(
+                    !record.m_params.empty()
+                        ? XMLElement::HasChildElements
+                        : XMLElement::HasNoContent);
 
-                // Add a file path parameter to the object.
-                params.insert("filepath", filename);
+                write_params(record.m_params);
             }
-
-            // Write the <object> element.
-            write_entity("object", object);
-        }
-
-        // Write an <object> element.
-        void write(const Object& object)
-        {
-            write_entity("object", object);
         }
 
         // Write an <object_instance> element.
@@ -737,7 +688,7 @@ namespace
         {
             XMLElement element("object_instance", m_file, m_indenter);
             element.add_attribute("name", object_instance.get_name());
-            element.add_attribute("object", translate_object_name(object_instance.get_object_name()));
+            element.add_attribute("object", m_object_record_collector.translate_object_name(object_instance.get_object_name()));
             element.write(XMLElement::HasChildElements);
 
             write_params(object_instance.get_parameters());
@@ -955,6 +906,9 @@ bool XMLProjectFileWriter::write_plain_project_file(
         return false;
     }
 
+    // The project file is written incrementally: use a large buffer to limit the number of writes.
+    setvbuf(file, nullptr, _IOFBF, ProjectFileBufferSize);
+
     // Write the file header.
     fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
 
@@ -983,6 +937,7 @@ bool XMLProjectFileWriter::write_plain_project_file(
     // Write the project.
     Writer writer(project, filepath, file, options);
     writer.write_project(project);
+    writer.wait_for_geometry_files();
 
     // Close the file.
     fclose(file);
@@ -1037,7 +992,7 @@ bool XMLProjectFileWriter::write_packed_project_file(
 
             RENDERER_LOG_INFO("packing project to %s...", filepath);
 
-            zip(filepath, temp_directory.string());
+            zip(filepath, temp_directory.string(), global_logger());
 
             stopwatch.measure();
 
@@ -33,8 +33,12 @@
 #include <string>
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/project/projectfilereader.h"
+#include "renderer/modeling/scene/archiveownerregistry.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/paramarray.h"
 
@@ -46,7 +50,11 @@
 #include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/searchpaths.h"
 
+// Boost headers.
+#include "boost/thread/locks.hpp"
+
 // Standard headers.
+#include <memory>
 #include <string>
 
 using namespace foundation;
@@ -61,6 +69,23 @@ namespace renderer
 namespace
 {
     const char* Model = "archive_assembly";
+
+    // Archives referenced by several archive assemblies are only read once: the first
+    // archive assembly to be expanded takes the contents of the archive, and the other
+    // ones instantiate it instead of reading the archive again.
+    ArchiveOwnerRegistry g_archive_owner_registry;
+
+    auto_release_ptr<Assembly> read_archive(
+        const std::string&          filepath,
+        const SearchPaths&          search_paths)
+    {
+        return
+            ProjectFileReader::read_archive(
+                filepath.c_str(),
+                nullptr,  // for now, we don't validate archives
+                search_paths,
+                ProjectFileReader::OmitProjectSchemaValidation);
+    }
 }
 
 ArchiveAssembly::ArchiveAssembly(
@@ -93,6 +118,11 @@ void ArchiveAssembly::update_asset_paths(const StringDictionary& mappings)
         m_params.set("filename", mappings.get(m_params.get("filename")));
 }
 
+bool ArchiveAssembly::is_thread_safe_expansion() const
+{
+    return true;
+}
+
 bool ArchiveAssembly::do_expand_contents(
     const Project&      project,
     const Assembly*     parent,
@@ -105,18 +135,43 @@ bool ArchiveAssembly::do_expand_contents(
         const std::string filepath =
             to_string(search_paths.qualify(m_params.get_required<std::string>("filename", "")));
 
-        auto_release_ptr<Assembly> assembly =
-            ProjectFileReader::read_archive(
-                filepath.c_str(),
-                nullptr,  // for now, we don't validate archives
-                search_paths,
-                ProjectFileReader::OmitProjectSchemaValidation);
+        const std::shared_ptr<ArchiveOwnerRegistry::Entry> entry =
+            g_archive_owner_registry.get_entry(filepath);
+
+        boost::lock_guard<boost::mutex> lock(entry->m_mutex);
 
-        if (assembly.get())
+        const Assembly* owner = find_archive_owner(*this, *entry);
+
+        if (owner)
         {
-            swap_contents(*assembly);
+            RENDERER_LOG_DEBUG(
+                "archive assembly \"%s\" instantiates the contents of archive assembly \"%s\".",
+                get_path().c_str(),
+                owner->get_path().c_str());
+
+            const std::string instance_name = std::string(get_name()) + "_inst";
+            assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    instance_name.c_str(),
+                    ParamArray(),
+                    owner->get_name()));
+
             m_archive_opened = true;
         }
+        else
+        {
+            auto_release_ptr<Assembly> assembly = read_archive(filepath, search_paths);
+
+            if (assembly.get())
+            {
+                swap_contents(*assembly);
+                m_archive_opened = true;
+
+                entry->m_has_owner = true;
+                entry->m_owner_uid = get_uid();
+                entry->m_owner_name = get_name();
+            }
+        }
     }
 
     return true;
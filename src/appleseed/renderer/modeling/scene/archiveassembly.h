@@ -71,6 +71,9 @@ class APPLESEED_DLLSYMBOL ArchiveAssembly
     void collect_asset_paths(foundation::StringArray& paths) const override;
     void update_asset_paths(const foundation::StringDictionary& mappings) override;
 
+    // Archive assemblies can be expanded concurrently.
+    bool is_thread_safe_expansion() const override;
+
   private:
     friend class ArchiveAssemblyFactory;
 
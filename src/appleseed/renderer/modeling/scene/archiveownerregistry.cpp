@@ -0,0 +1,100 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "archiveownerregistry.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/containers.h"
+
+// Boost headers.
+#include "boost/thread/locks.hpp"
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// ArchiveOwnerRegistry class implementation.
+//
+
+ArchiveOwnerRegistry::Entry::Entry()
+  : m_has_owner(false)
+{
+}
+
+std::shared_ptr<ArchiveOwnerRegistry::Entry> ArchiveOwnerRegistry::get_entry(const std::string& filepath)
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    std::shared_ptr<Entry>& entry = m_entries[filepath];
+
+    if (!entry)
+        entry = std::make_shared<Entry>();
+
+    return entry;
+}
+
+
+//
+// find_archive_owner() function implementation.
+//
+
+const Assembly* find_archive_owner(
+    const Assembly&                     assembly,
+    const ArchiveOwnerRegistry::Entry&  entry)
+{
+    if (!entry.m_has_owner)
+        return nullptr;
+
+    for (const Entity* parent = assembly.get_parent(); parent; parent = parent->get_parent())
+    {
+        if (parent->get_uid() == entry.m_owner_uid)
+            return nullptr;
+
+        const BaseGroup* parent_base_group = dynamic_cast<const BaseGroup*>(parent);
+
+        if (parent_base_group)
+        {
+            const Assembly* owner =
+                parent_base_group->assemblies().get_by_name(entry.m_owner_name.c_str());
+
+            // The owner may have been renamed or removed, or may be hidden by another assembly.
+            if (owner)
+                return owner->get_uid() == entry.m_owner_uid ? owner : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+}   // namespace renderer
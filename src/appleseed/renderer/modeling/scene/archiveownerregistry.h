@@ -0,0 +1,93 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/uid.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <map>
+#include <memory>
+#include <string>
+
+// Forward declarations.
+namespace renderer  { class Assembly; }
+
+namespace renderer
+{
+
+//
+// Records, for every archive file, which archive assembly holds the contents of the
+// archive, so that other archive assemblies referencing the same file can instantiate
+// that assembly instead of reading the archive again.
+//
+// Entries are keyed by the qualified path of the archive and outlive the scenes they
+// were created for. Owners are identified by their unique ID, so an owner recorded by
+// another scene is never found and the archive is read again, picking up changes made
+// to the file in the meantime.
+//
+
+class ArchiveOwnerRegistry
+  : public foundation::NonCopyable
+{
+  public:
+    struct Entry
+    {
+        // Held while the archive is being read, and while its owner is looked up.
+        boost::mutex            m_mutex;
+
+        // Archive assembly holding the contents of the archive, if any.
+        bool                    m_has_owner;
+        foundation::UniqueID    m_owner_uid;
+        std::string             m_owner_name;
+
+        Entry();
+    };
+
+    // Return the entry of an archive, creating it if it does not exist yet.
+    // Thread-safe.
+    std::shared_ptr<Entry> get_entry(const std::string& filepath);
+
+  private:
+    boost::mutex                                    m_mutex;
+    std::map<std::string, std::shared_ptr<Entry>>   m_entries;
+};
+
+// Return the archive assembly holding the contents of an archive if it can be instantiated
+// from `assembly`, that is, if an assembly instance created in `assembly` would find it and
+// if it is not an ancestor of `assembly`.
+const Assembly* find_archive_owner(
+    const Assembly&                     assembly,
+    const ArchiveOwnerRegistry::Entry&  entry);
+
+}   // namespace renderer
@@ -139,6 +139,38 @@ bool BaseGroup::create_optimized_osl_shader_groups(
     return true;
 }
 
+bool BaseGroup::create_osl_shader_groups(
+    OSLShadingSystem&           shading_system,
+    const ShaderCompiler*       shader_compiler,
+    IAbortSwitch*               abort_switch)
+{
+    for (Assembly& assembly : assemblies())
+    {
+        if (is_aborted(abort_switch))
+            return false;
+
+        if (!assembly.create_osl_shader_groups(
+                shading_system,
+                shader_compiler,
+                abort_switch))
+            return false;
+    }
+
+    for (ShaderGroup& shader_group : shader_groups())
+    {
+        if (is_aborted(abort_switch))
+            return false;
+
+        if (!shader_group.create_osl_shader_group(
+                shading_system,
+                shader_compiler,
+                abort_switch))
+            return false;
+    }
+
+    return true;
+}
+
 void BaseGroup::release_optimized_osl_shader_groups()
 {
     for (Assembly& assembly : assemblies())
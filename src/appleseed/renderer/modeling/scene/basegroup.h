@@ -77,6 +77,12 @@ class APPLESEED_DLLSYMBOL BaseGroup
         const ShaderCompiler*       shader_compiler,
         foundation::IAbortSwitch*   abort_switch = nullptr);
 
+    // Create OSL shader groups without optimizing them.
+    bool create_osl_shader_groups(
+        OSLShadingSystem&           shading_system,
+        const ShaderCompiler*       shader_compiler,
+        foundation::IAbortSwitch*   abort_switch = nullptr);
+
     // Release internal OSL shader groups.
     void release_optimized_osl_shader_groups();
 
@@ -105,6 +105,11 @@ bool ProceduralAssembly::expand_contents(
     return true;
 }
 
+bool ProceduralAssembly::is_thread_safe_expansion() const
+{
+    return false;
+}
+
 void ProceduralAssembly::swap_contents(Assembly& assembly)
 {
     assemblies().swap(assembly.assemblies());
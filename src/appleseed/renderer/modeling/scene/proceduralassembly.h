@@ -56,6 +56,11 @@ class APPLESEED_DLLSYMBOL ProceduralAssembly
         const Assembly*             parent,
         foundation::IAbortSwitch*   abort_switch = nullptr);
 
+    // Return true if do_expand_contents() may be called concurrently with the expansion
+    // of other procedural assemblies. Procedural assemblies that don't opt in are expanded
+    // one at a time. Returns false by default.
+    virtual bool is_thread_safe_expansion() const;
+
   protected:
     // Constructor.
     ProceduralAssembly(
@@ -36,6 +36,7 @@
 #endif
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/entity/entitycallbackinvoker.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentshader/environmentshader.h"
 #include "renderer/modeling/frame/frame.h"
@@ -61,6 +62,7 @@
 
 // Standard headers.
 #include <set>
+#include <vector>
 
 using namespace foundation;
 
@@ -307,41 +309,60 @@ void Scene::update_asset_paths(const StringDictionary& mappings)
     invoke_update_asset_paths(environment_shaders(), mappings);
 }
 
-namespace
+bool Scene::expand_procedural_assemblies(
+    const Project&          project,
+    IAbortSwitch*           abort_switch,
+    const size_t            thread_count)
 {
-    bool invoke_procedural_expand(
-        Assembly&               assembly,
-        const Project&          project,
-        const Assembly*         parent,
-        IAbortSwitch*           abort_switch)
-    {
-        ProceduralAssembly* proc_assembly =
-            dynamic_cast<ProceduralAssembly*>(&assembly);
+    EntityCallbackInvoker parallel_invoker("expand_contents", thread_count);
+    EntityCallbackInvoker serial_invoker("expand_contents", 1);
 
-        if (proc_assembly)
+    const EntityCallbackInvoker::Callback expand =
+        [&project, abort_switch](Entity& entity)
         {
-            if (!proc_assembly->expand_contents(project, parent, abort_switch))
-                return false;
-        }
-
-        for (each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
+            ProceduralAssembly& proc_assembly = static_cast<ProceduralAssembly&>(entity);
+            const Assembly* parent = dynamic_cast<const Assembly*>(proc_assembly.get_parent());
+            return proc_assembly.expand_contents(project, parent, abort_switch);
+        };
+
+    // Procedural assemblies are expanded one level of the assembly hierarchy at a time:
+    // assemblies of a same level are independent and those whose expansion is thread-safe
+    // are expanded in parallel, then the child assemblies they contain, including those
+    // created by the expansion, form the next level.
+    std::vector<Entity*> level;
+    for (Assembly& assembly : assemblies())
+        level.push_back(&assembly);
+
+    while (!level.empty())
+    {
+        std::vector<Entity*> serial_assemblies;
+        std::vector<Entity*> parallel_assemblies;
+        for (Entity* entity : level)
         {
-            if (!invoke_procedural_expand(*i, project, &assembly, abort_switch))
-                return false;
+            const ProceduralAssembly* proc_assembly = dynamic_cast<ProceduralAssembly*>(entity);
+
+            if (proc_assembly != nullptr)
+            {
+                if (proc_assembly->is_thread_safe_expansion())
+                    parallel_assemblies.push_back(entity);
+                else serial_assemblies.push_back(entity);
+            }
         }
 
-        return true;
-    }
-}
+        if (!serial_invoker.invoke(serial_assemblies, expand, abort_switch))
+            return false;
 
-bool Scene::expand_procedural_assemblies(
-    const Project&          project,
-    IAbortSwitch*           abort_switch)
-{
-    for (each<AssemblyContainer> i = assemblies(); i; ++i)
-    {
-        if (!invoke_procedural_expand(*i, project, nullptr, abort_switch))
+        if (!parallel_invoker.invoke(parallel_assemblies, expand, abort_switch))
             return false;
+
+        std::vector<Entity*> next_level;
+        for (Entity* entity : level)
+        {
+            for (Assembly& child : static_cast<Assembly*>(entity)->assemblies())
+                next_level.push_back(&child);
+        }
+
+        level.swap(next_level);
     }
 
     return true;
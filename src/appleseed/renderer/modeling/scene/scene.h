@@ -45,6 +45,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <cstddef>
 
 // Forward declarations.
 namespace renderer      { class Camera; }
@@ -109,11 +110,12 @@ class APPLESEED_DLLSYMBOL Scene
     void collect_asset_paths(foundation::StringArray& paths) const override;
     void update_asset_paths(const foundation::StringDictionary& mappings) override;
 
-    // Expand all procedural assemblies in the scene.
+    // Expand all procedural assemblies in the scene, using up to `thread_count` threads.
     // todo: should return one of { Success, Failed, Abort }.
     bool expand_procedural_assemblies(
         const Project&              project,
-        foundation::IAbortSwitch*   abort_switch = nullptr);
+        foundation::IAbortSwitch*   abort_switch = nullptr,
+        const size_t                thread_count = 1);
 
     // todo: should return one of { Success, Failed, Abort }.
     bool on_render_begin(
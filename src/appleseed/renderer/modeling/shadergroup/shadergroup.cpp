@@ -38,19 +38,27 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/containers/dictionary.h"
+#include "foundation/string/string.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/foreach.h"
 #include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/uid.h"
 
 // Boost headers.
+#include "boost/filesystem.hpp"
 #include "boost/unordered/unordered_map.hpp"
 
 // Standard headers.
+#include <cstdint>
+#include <ctime>
 #include <exception>
+#include <string>
 #include <utility>
 
 using namespace foundation;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -75,6 +83,7 @@ namespace
     const OIIO::ustring g_npr_contour_str("as_npr_contour");
 
     const OIIO::ustring g_dPdtime_str("dPdtime");
+    const OIIO::ustring g_Ci_str("Ci");
 
     bool is_subsurface_closure(const OIIO::ustring& closure_name)
     {
@@ -82,6 +91,72 @@ namespace
             closure_name == g_subsurface_str ||
             closure_name == g_randomwalk_glass_str;
     }
+
+    void append_key_field(std::string& key, const char* field)
+    {
+        // Fields are NUL-terminated so that they cannot run into each other.
+        key += field;
+        key += '\0';
+    }
+
+    // Identify the version of the compiled shader a shader name resolves to,
+    // so that a shader recompiled during the session yields a different key.
+    void append_shader_file_key_fields(
+        std::string&                        key,
+        OSLShadingSystem&                   shading_system,
+        const char*                         shader_name)
+    {
+        const std::string path = shading_system.find_shader_file(shader_name);
+        append_key_field(key, path.c_str());
+
+        if (path.empty())
+            return;
+
+        boost::system::error_code ec;
+        const std::time_t write_time = bf::last_write_time(path, ec);
+        const std::uintmax_t file_size = bf::file_size(path, ec);
+        append_key_field(key, to_string(write_time).c_str());
+        append_key_field(key, to_string(file_size).c_str());
+    }
+
+    // Build a string that uniquely identifies the content of a shader group.
+    std::string make_shader_group_key(
+        OSLShadingSystem&                   shading_system,
+        const ShaderContainer&              shaders,
+        const ShaderConnectionContainer&    connections)
+    {
+        std::string key;
+
+        for (const Shader& shader : shaders)
+        {
+            append_key_field(key, shader.get_type());
+            append_key_field(key, shader.get_shader());
+            append_key_field(key, shader.get_layer());
+
+            const char* source_code = shader.get_source_code();
+            if (source_code != nullptr)
+                append_key_field(key, source_code);
+            else append_shader_file_key_fields(key, shading_system, shader.get_shader());
+
+            for (const_each<StringDictionary> i = shader.get_parameters().strings(); i; ++i)
+            {
+                append_key_field(key, i.it().key());
+                append_key_field(key, i.it().value());
+            }
+
+            append_key_field(key, "");
+        }
+
+        for (const ShaderConnection& connection : connections)
+        {
+            append_key_field(key, connection.get_src_layer());
+            append_key_field(key, connection.get_src_param());
+            append_key_field(key, connection.get_dst_layer());
+            append_key_field(key, connection.get_dst_param());
+        }
+
+        return key;
+    }
 }
 
 struct ShaderGroup::Impl
@@ -92,6 +167,7 @@ struct ShaderGroup::Impl
     ShaderContainer             m_shaders;
     ShaderConnectionContainer   m_connections;
     mutable OSL::ShaderGroupRef m_shader_group_ref;
+    bool                        m_optimized;
     mutable SurfaceAreaMap      m_surface_areas;
 };
 
@@ -123,6 +199,7 @@ void ShaderGroup::clear()
     impl->m_shaders.clear();
     impl->m_connections.clear();
     impl->m_shader_group_ref.reset();
+    impl->m_optimized = false;
     m_flags = 0;
 }
 
@@ -191,6 +268,19 @@ bool ShaderGroup::create_optimized_osl_shader_group(
     OSLShadingSystem&       shading_system,
     const ShaderCompiler*   shader_compiler,
     IAbortSwitch*           abort_switch)
+{
+    if (!create_osl_shader_group(shading_system, shader_compiler, abort_switch))
+        return false;
+
+    optimize_osl_shader_group(shading_system);
+
+    return true;
+}
+
+bool ShaderGroup::create_osl_shader_group(
+    OSLShadingSystem&       shading_system,
+    const ShaderCompiler*   shader_compiler,
+    IAbortSwitch*           abort_switch)
 {
     if (is_valid())
         return true;
@@ -202,58 +292,62 @@ bool ShaderGroup::create_optimized_osl_shader_group(
 
     try
     {
-        OSL::ShaderGroupRef shader_group_ref = shading_system.ShaderGroupBegin(get_name());
+        // Reuse the OSL shader group of an identical shader group, if any,
+        // to avoid optimizing and JIT-compiling the same code twice.
+        const std::string key = make_shader_group_key(shading_system, impl->m_shaders, impl->m_connections);
+        OSL::ShaderGroupRef shader_group_ref = shading_system.find_shader_group(key);
 
-        if (shader_group_ref.get() == nullptr)
+        if (shader_group_ref.get() != nullptr)
         {
-            RENDERER_LOG_ERROR("failed to setup shader group \"%s\": ShaderGroupBegin() call failed.", get_path().c_str());
-            return false;
+            RENDERER_LOG_DEBUG(
+                "shader group \"%s\" is identical to a previously set up shader group, sharing it.",
+                get_path().c_str());
         }
-
-        for (Shader& shader : impl->m_shaders)
+        else
         {
-            if (is_aborted(abort_switch))
+            shader_group_ref = shading_system.ShaderGroupBegin(get_name());
+
+            if (shader_group_ref.get() == nullptr)
             {
-                shading_system.ShaderGroupEnd();
-                return true;
+                RENDERER_LOG_ERROR("failed to setup shader group \"%s\": ShaderGroupBegin() call failed.", get_path().c_str());
+                return false;
             }
 
-            if (!shader.add(shading_system))
-                return false;
-        }
+            for (Shader& shader : impl->m_shaders)
+            {
+                if (is_aborted(abort_switch))
+                {
+                    shading_system.ShaderGroupEnd();
+                    return true;
+                }
+
+                if (!shader.add(shading_system))
+                    return false;
+            }
 
-        for (ShaderConnection& connection : impl->m_connections)
-        {
-            if (is_aborted(abort_switch))
+            for (ShaderConnection& connection : impl->m_connections)
             {
-                shading_system.ShaderGroupEnd();
-                return true;
+                if (is_aborted(abort_switch))
+                {
+                    shading_system.ShaderGroupEnd();
+                    return true;
+                }
+
+                if (!connection.add(shading_system))
+                    return false;
             }
 
-            if (!connection.add(shading_system))
+            if (!shading_system.ShaderGroupEnd())
+            {
+                RENDERER_LOG_ERROR("failed to setup shader group \"%s\": ShaderGroupEnd() call failed.", get_path().c_str());
                 return false;
-        }
+            }
 
-        if (!shading_system.ShaderGroupEnd())
-        {
-            RENDERER_LOG_ERROR("failed to setup shader group \"%s\": ShaderGroupEnd() call failed.", get_path().c_str());
-            return false;
+            shading_system.insert_shader_group(key, shader_group_ref);
         }
 
         impl->m_shader_group_ref = shader_group_ref;
-
-        get_shadergroup_closures_info(shading_system);
-        report_has_closure("bsdf", HasBSDFs);
-        report_has_closure(g_emission_str.c_str(), HasEmission);
-        report_has_closure(g_transparent_str.c_str(), HasTransparency);
-        report_has_closure(g_subsurface_str.c_str(), HasSubsurface);
-        report_has_closure(g_debug_str.c_str(), HasDebug);
-
-        report_has_closure("NPR", HasNPR);
-        report_has_closure(g_matte_str.c_str(), HasMatte);
-
-        get_shadergroup_globals_info(shading_system);
-        report_uses_global("dPdtime", UsesdPdTime);
+        impl->m_optimized = false;
 
         return true;
     }
@@ -264,9 +358,38 @@ bool ShaderGroup::create_optimized_osl_shader_group(
     }
 }
 
+void ShaderGroup::optimize_osl_shader_group(OSLShadingSystem& shading_system)
+{
+    if (!is_valid() || impl->m_optimized)
+        return;
+
+    // Querying closures or globals would trigger optimization anyway; make it explicit.
+    shading_system.optimize_group(impl->m_shader_group_ref.get());
+
+    get_shadergroup_closures_info(shading_system);
+    report_has_closure("bsdf", HasBSDFs);
+    report_has_closure(g_emission_str.c_str(), HasEmission);
+    report_has_closure(g_transparent_str.c_str(), HasTransparency);
+    report_has_closure(g_subsurface_str.c_str(), HasSubsurface);
+    report_has_closure(g_debug_str.c_str(), HasDebug);
+
+    report_has_closure("NPR", HasNPR);
+    report_has_closure(g_matte_str.c_str(), HasMatte);
+
+    get_shadergroup_globals_info(shading_system);
+    report_uses_global("dPdtime", UsesdPdTime);
+
+    get_shadergroup_uniformity_info(shading_system);
+    if (is_uniform())
+        RENDERER_LOG_DEBUG("shader group \"%s\" is uniform.", get_path().c_str());
+
+    impl->m_optimized = true;
+}
+
 void ShaderGroup::release_optimized_osl_shader_group()
 {
     impl->m_shader_group_ref.reset();
+    impl->m_optimized = false;
 }
 
 const ShaderContainer& ShaderGroup::shaders() const
@@ -485,6 +608,51 @@ void ShaderGroup::report_uses_global(const char* global_name, const Flags flag)
     }
 }
 
+void ShaderGroup::get_shadergroup_uniformity_info(OSLShadingSystem& shading_system)
+{
+    // Assume the shader group is not uniform.
+    m_flags &= ~IsUniform;
+
+    OSL::ShaderGroup* group = impl->m_shader_group_ref.get();
+
+    // The shader group must not read any global. It always writes Ci.
+    int num_globals = 0;
+    if (!shading_system.getattribute(group, "num_globals_needed", num_globals))
+        return;
+
+    if (num_globals != 0)
+    {
+        OIIO::ustring* globals = nullptr;
+        if (!shading_system.getattribute(group, "globals_needed", OIIO::TypeDesc::PTR, &globals))
+            return;
+
+        for (int i = 0; i < num_globals; ++i)
+        {
+            if (globals[i] != g_Ci_str)
+                return;
+        }
+    }
+
+    // The shader group must not look up any texture, attribute or user data.
+    const char* QueryNames[] =
+    {
+        "num_textures_needed",
+        "unknown_textures_needed",
+        "num_attributes_needed",
+        "unknown_attributes_needed",
+        "num_userdata"
+    };
+
+    for (const char* query_name : QueryNames)
+    {
+        int count = 0;
+        if (!shading_system.getattribute(group, query_name, count) || count != 0)
+            return;
+    }
+
+    m_flags |= IsUniform;
+}
+
 void ShaderGroup::set_surface_area(
     const AssemblyInstance* assembly_instance,
     const ObjectInstance*   object_instance,
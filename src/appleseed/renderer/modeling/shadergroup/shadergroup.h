@@ -94,12 +94,22 @@ class APPLESEED_DLLSYMBOL ShaderGroup
         const char*                 dst_layer,
         const char*                 dst_param);
 
-    // Create internal OSL shader group.
+    // Create internal OSL shader group and optimize it.
     bool create_optimized_osl_shader_group(
         OSLShadingSystem&           shading_system,
         const ShaderCompiler*       shader_compiler,
         foundation::IAbortSwitch*   abort_switch = nullptr);
 
+    // Create internal OSL shader group without optimizing it.
+    bool create_osl_shader_group(
+        OSLShadingSystem&           shading_system,
+        const ShaderCompiler*       shader_compiler,
+        foundation::IAbortSwitch*   abort_switch = nullptr);
+
+    // Optimize and JIT-compile the internal OSL shader group, and query its properties.
+    // Can be called concurrently on different shader groups.
+    void optimize_osl_shader_group(OSLShadingSystem& shading_system);
+
     // Release internal OSL shader group.
     void release_optimized_osl_shader_group();
 
@@ -136,6 +146,10 @@ class APPLESEED_DLLSYMBOL ShaderGroup
     // Return true if the shader group uses the dPdtime global.
     bool uses_dPdtime() const;
 
+    // Return true if the shader group reads no globals, textures, attributes or user data,
+    // i.e. if it computes the same closures at every shading point.
+    bool is_uniform() const;
+
     // Return the surface area of an object.
     // Can only be called if the shader group has emission closures.
     float get_surface_area(
@@ -173,7 +187,10 @@ class APPLESEED_DLLSYMBOL ShaderGroup
 
         // Globals.
         UsesdPdTime     = 1u << 7,
-        UsesAllGlobals  = UsesdPdTime
+        UsesAllGlobals  = UsesdPdTime,
+
+        // Uniformity.
+        IsUniform       = 1u << 8
     };
 
     std::uint32_t m_flags;
@@ -192,6 +209,8 @@ class APPLESEED_DLLSYMBOL ShaderGroup
     void get_shadergroup_globals_info(OSLShadingSystem& shading_system);
     void report_uses_global(const char* global_name, const Flags flag) const;
 
+    void get_shadergroup_uniformity_info(OSLShadingSystem& shading_system);
+
     void set_surface_area(
         const AssemblyInstance* assembly_instance,
         const ObjectInstance*   object_instance,
@@ -266,4 +285,9 @@ inline bool ShaderGroup::uses_dPdtime() const
     return (m_flags & UsesdPdTime) != 0;
 }
 
+inline bool ShaderGroup::is_uniform() const
+{
+    return (m_flags & IsUniform) != 0;
+}
+
 }   // namespace renderer
@@ -56,6 +56,12 @@ CommandLineHandler::CommandLineHandler()
             .add_name("--print-bounding-boxes")
             .add_name("-b")
             .set_description("print mesh bounding boxes"));
+
+    parser().add_option_handler(
+        &m_page_aligned
+            .add_name("--page-aligned")
+            .add_name("-p")
+            .set_description("write binarymesh files in the uncompressed, page-aligned format that can be memory-mapped"));
 }
 
 void CommandLineHandler::print_program_usage(
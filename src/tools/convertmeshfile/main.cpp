@@ -37,6 +37,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/vector.h"
+#include "foundation/meshio/binarymeshfilewriter.h"
 #include "foundation/meshio/genericmeshfilereader.h"
 #include "foundation/meshio/genericmeshfilewriter.h"
 #include "foundation/meshio/imeshbuilder.h"
@@ -333,7 +334,11 @@ int main(int argc, char* argv[])
     }
 
     // Write the output mesh file.
-    GenericMeshFileWriter writer(output_filepath.c_str());
+    GenericMeshFileWriter writer(
+        output_filepath.c_str(),
+        cl.m_page_aligned.is_set()
+            ? BinaryMeshFileWriter::PageAligned
+            : BinaryMeshFileWriter::Defaults);
     try
     {
         for (const_each<std::list<Mesh>> i = builder.get_meshes(); i; ++i)
@@ -74,6 +74,8 @@ void CommandLineHandler::print_program_usage(
     LOG_INFO(logger, "  clean                update a project to the latest revision and remove unused entities");
     LOG_INFO(logger, "  pack                 pack a project to an *.appleseedz file");
     LOG_INFO(logger, "  unpack               unpack an *.appleseedz file");
+    LOG_INFO(logger, "  tobinary             convert a project to an *.appleseedb file");
+    LOG_INFO(logger, "  toxml                convert an *.appleseedb file to an *.appleseed file");
     LOG_INFO(logger, "  deps                 print dependencies between entities");
     LOG_INFO(logger, "options:");
 
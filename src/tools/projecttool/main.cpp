@@ -199,6 +199,60 @@ bool unpack_project()
 }
 
 
+//
+// Convert a project to an *.appleseedb file.
+//
+
+bool convert_project_to_binary()
+{
+    // Retrieve the input project path.
+    const std::string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Build the path of the output project.
+    const std::string binary_file_path =
+        bf::path(input_filepath).replace_extension(".appleseedb").string();
+
+    // Write the project to disk, next to the input project.
+    return
+        ProjectFileWriter::write(
+            project.ref(),
+            binary_file_path.c_str(),
+            ProjectFileWriter::OmitWritingGeometryFiles | ProjectFileWriter::OmitHandlingAssetFiles);
+}
+
+
+//
+// Convert an *.appleseedb file to a plain project file.
+//
+
+bool convert_project_to_xml()
+{
+    // Retrieve the input project path.
+    const std::string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Build the path of the output project.
+    const std::string plain_file_path =
+        bf::path(input_filepath).replace_extension(".appleseed").string();
+
+    // Write the project to disk, next to the input project.
+    return
+        ProjectFileWriter::write(
+            project.ref(),
+            plain_file_path.c_str(),
+            ProjectFileWriter::OmitWritingGeometryFiles | ProjectFileWriter::OmitHandlingAssetFiles);
+}
+
+
 //
 // Print dependencies between entities.
 //
@@ -266,6 +320,10 @@ int main(int argc, char* argv[])
         success = pack_project();
     else if (command == "unpack")
         success = unpack_project();
+    else if (command == "tobinary")
+        success = convert_project_to_binary();
+    else if (command == "toxml")
+        success = convert_project_to_xml();
     else if (command == "deps")
         success = print_entity_dependencies(logger);
     else LOG_ERROR(logger, "unknown command: %s", command.c_str());